@@ -0,0 +1,45 @@
+# C-simulation of the 512-bit kernels against the scalar ones, and of
+# krnl_heavy_compute_fast (interleaved recurrences) against the exact sum.
+#
+#    cd kernels/fpga/csim && vitis_hls -f run_csim.tcl
+#
+# The part only matters for synthesis; override it with PART=... if needed.
+
+set part "xcu250-figd2104-2L-e"
+if {[info exists ::env(PART)]} {
+   set part $::env(PART)
+}
+
+open_project -reset csim_wide
+set_top krnl_polynomial_op_wide
+
+add_files ../krnl_vadd_wide.cpp -cflags "-I.."
+add_files ../krnl_polynomial_op_wide.cpp -cflags "-I.."
+add_files ../krnl_deep_pipeline_calculation_wide.cpp -cflags "-I.."
+
+add_files -tb tb_wide_kernels.cpp -cflags "-I.."
+add_files -tb ../krnl_vadd.cpp
+add_files -tb ../krnl_polynomial_op.cpp
+add_files -tb ../krnl_deep_pipeline_calculation.cpp
+
+open_solution -reset solution1 -flow_target vitis
+set_part $part
+create_clock -period 3.33 -name default
+
+csim_design
+
+open_project -reset csim_heavy_fast
+set_top krnl_heavy_compute_fast
+
+add_files ../krnl_heavy_compute_fast.cpp
+
+add_files -tb tb_heavy_compute_fast.cpp
+add_files -tb ../krnl_heavy_compute.cpp
+
+open_solution -reset solution1 -flow_target vitis
+set_part $part
+create_clock -period 3.33 -name default
+
+csim_design
+
+exit
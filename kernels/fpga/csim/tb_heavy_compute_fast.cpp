@@ -0,0 +1,91 @@
+/*******************************************************************************
+Description:
+
+    C-simulation testbench for krnl_heavy_compute_fast. The kernel keeps the
+    (sin, cos) pairs of LANES elements in arrays updated with DEPENDENCE
+    inter false, so this checks that interleaving the elements gives each one
+    its own recurrence: every output must be explained by the exact sum
+    (computed here in double, like krnl_heavy_compute) within the error bound
+    of the recurrence, plus the truncation to int. Sizes that are not a
+    multiple of LANES exercise the last, partial group.
+
+    The outputs are also compared with krnl_heavy_compute: they may differ by
+    one unit where the exact sum is close to an integer.
+
+    Run with: vitis_hls -f run_csim.tcl
+
+*******************************************************************************/
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdint.h>
+#include <vector>
+
+#define HEAVY_ITERS 200
+
+extern "C" {
+void krnl_heavy_compute(int32_t *in1, int32_t *in2, int32_t *out, int size);
+void krnl_heavy_compute_fast(int32_t *in1, int32_t *in2, int32_t *out, int size);
+}
+
+// Stesso limite di heavy_fast_error_bound() dell'host: 3 HEAVY_ITERS² FLT_EPSILON.
+static const double ERROR_BOUND = 3.0 * HEAVY_ITERS * HEAVY_ITERS * FLT_EPSILON;
+
+// Somma esatta (in double) di sin(a + j) * cos(b - j) per j < HEAVY_ITERS.
+static double exact_sum(int32_t a, int32_t b) {
+   double result = 0.0;
+   for (int j = 0; j < HEAVY_ITERS; ++j)
+      result += std::sin(double(a) + j) * std::cos(double(b) - j);
+   return result;
+}
+
+// Vero se un valore entro ERROR_BOUND da exact può essere troncato (verso zero) in c.
+static bool explained(int32_t c, double exact) {
+   double lo = c > 0 ? double(c) : double(c) - 1.0;
+   double hi = c < 0 ? double(c) : double(c) + 1.0;
+   return exact + ERROR_BOUND > lo && exact - ERROR_BOUND < hi;
+}
+
+int main() {
+   const int sizes[] = {1, 15, 16, 17, 1000, 4096, 5003};
+   const int max_size = 5003;
+   int errors = 0;
+
+   // Prima metà come i task generati dall'host (a = i, b = 2 i), poi valori casuali con segno
+   // entro 2^24, dove la conversione in float è esatta.
+   std::vector<int32_t> a(max_size), b(max_size);
+   srand(42);
+   for (int i = 0; i < max_size; i++) {
+      a[i] = i < max_size / 2 ? i : rand() % (1 << 24) - (1 << 23);
+      b[i] = i < max_size / 2 ? 2 * i : rand() % (1 << 24) - (1 << 23);
+   }
+
+   for (int size : sizes) {
+      std::vector<int32_t> ref(size), fast(size);
+      krnl_heavy_compute(a.data(), b.data(), ref.data(), size);
+      krnl_heavy_compute_fast(a.data(), b.data(), fast.data(), size);
+
+      int failures = 0, differ = 0;
+      double max_error = 0.0;
+      for (int i = 0; i < size; i++) {
+         double exact = exact_sum(a[i], b[i]);
+         max_error = std::fmax(max_error, std::fabs(double(fast[i]) - exact));
+         differ += fast[i] != ref[i];
+         if (!explained(fast[i], exact)) {
+            if (failures < 10)
+               printf("  mismatch at %d (size %d): exact %.6f, got %d\n", i, size, exact,
+                      fast[i]);
+            failures++;
+         }
+      }
+      printf("krnl_heavy_compute_fast size=%d: %s (max abs error %.6f, bound %.6f + "
+             "truncation, %d / %d differ from krnl_heavy_compute)\n",
+             size, failures == 0 ? "PASS" : "FAIL", max_error, ERROR_BOUND, differ, size);
+      errors += failures;
+   }
+
+   printf(errors == 0 ? "TEST PASSED\n" : "TEST FAILED\n");
+   return errors == 0 ? 0 : 1;
+}
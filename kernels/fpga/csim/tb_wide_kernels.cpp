@@ -0,0 +1,93 @@
+/*******************************************************************************
+Description:
+
+    C-simulation testbench for the 512-bit ("_wide") HLS kernels. Every wide
+    kernel runs on the same inputs as its scalar counterpart and the outputs
+    must match element by element. Sizes that are not a multiple of 16
+    exercise the padding of the last beat, which must not change the results
+    inside 'size'.
+
+    krnl_deep_pipeline_calculation always processes c_size (4096) elements,
+    so it is compared only on that size.
+
+    Run with: vitis_hls -f run_csim.tcl
+
+*******************************************************************************/
+
+#include "../wide_io.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+void krnl_vadd(uint32_t *in1, uint32_t *in2, uint32_t *out, int size);
+void krnl_vadd_wide(const wide_t *in1, const wide_t *in2, wide_t *out, int size);
+void krnl_polynomial_op(int32_t *in1, int32_t *in2, int32_t *out, int size);
+void krnl_polynomial_op_wide(const wide_t *in1, const wide_t *in2, wide_t *out, int size);
+void krnl_deep_pipeline_calculation(int32_t *in1, int32_t *in2, int32_t *out, int size);
+void krnl_deep_pipeline_calculation_wide(const wide_t *in1, const wide_t *in2, wide_t *out,
+                                         int size);
+}
+
+// Copia 'size' interi in un buffer di beat da 512 bit, con padding a zero come farebbe l'host.
+static std::vector<wide_t> pack(const std::vector<int32_t> &v, int size) {
+   std::vector<wide_t> words(num_words(size), wide_t(0));
+   for (int i = 0; i < size; i++)
+      set_lane(words[i / LANES], i % LANES, v[i]);
+   return words;
+}
+
+// Confronta i primi 'size' lane del risultato wide con il risultato scalare.
+static int compare(const char *name, const std::vector<int32_t> &expected,
+                   const std::vector<wide_t> &got, int size) {
+   int errors = 0;
+   for (int i = 0; i < size; i++) {
+      int32_t value = get_lane(got[i / LANES], i % LANES);
+      if (value != expected[i]) {
+         if (errors < 10)
+            printf("  %s: mismatch at %d (size %d): expected %d, got %d\n", name, i, size,
+                   expected[i], value);
+         errors++;
+      }
+   }
+   printf("%s size=%d: %s\n", name, size, errors == 0 ? "PASS" : "FAIL");
+   return errors;
+}
+
+int main() {
+   const int sizes[] = {1, 15, 16, 17, 1000, 4096, 5003};
+   const int max_size = 5003;
+   int errors = 0;
+
+   // Valori piccoli: b^5 resta nel range di int64 come nei task generati dall'host.
+   std::vector<int32_t> a(max_size), b(max_size);
+   srand(42);
+   for (int i = 0; i < max_size; i++) {
+      a[i] = rand() % 201 - 100;
+      b[i] = rand() % 201 - 100;
+   }
+
+   for (int size : sizes) {
+      std::vector<wide_t> wa = pack(a, size), wb = pack(b, size);
+      std::vector<wide_t> wc(num_words(size));
+      std::vector<int32_t> ca(a.begin(), a.begin() + size), cb(b.begin(), b.begin() + size);
+      std::vector<int32_t> expected(size);
+
+      krnl_vadd((uint32_t *)ca.data(), (uint32_t *)cb.data(), (uint32_t *)expected.data(), size);
+      krnl_vadd_wide(wa.data(), wb.data(), wc.data(), size);
+      errors += compare("krnl_vadd_wide", expected, wc, size);
+
+      krnl_polynomial_op(ca.data(), cb.data(), expected.data(), size);
+      krnl_polynomial_op_wide(wa.data(), wb.data(), wc.data(), size);
+      errors += compare("krnl_polynomial_op_wide", expected, wc, size);
+
+      if (size == 4096) {
+         krnl_deep_pipeline_calculation(ca.data(), cb.data(), expected.data(), size);
+         krnl_deep_pipeline_calculation_wide(wa.data(), wb.data(), wc.data(), size);
+         errors += compare("krnl_deep_pipeline_calculation_wide", expected, wc, size);
+      }
+   }
+
+   printf(errors == 0 ? "TEST PASSED\n" : "TEST FAILED\n");
+   return errors == 0 ? 0 : 1;
+}
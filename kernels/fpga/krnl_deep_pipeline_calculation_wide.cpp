@@ -0,0 +1,143 @@
+/*******************************************************************************
+Description:
+
+    512-bit variant of krnl_deep_pipeline_calculation. The 4 stages are the
+    same as the scalar kernel and still relay a struct between them, but each
+    struct carries the 16 lanes of a 512-bit beat, so every stage processes 16
+    elements per clock cycle. Each argument has its own m_axi bundle and the
+    ports use 4 KB bursts.
+
+    Unlike the scalar kernel, which always processes c_size elements, this
+    kernel processes 'size' elements; buffers are padded by the host to a
+    multiple of 16 elements (see wide_io.hpp).
+
+*******************************************************************************/
+
+// Includes
+#include "wide_io.hpp"
+
+/**
+ * @brief Struct per trasportare i 16 lane di un beat attraverso la pipeline.
+ */
+struct WideData {
+   int64_t result[LANES];
+   int32_t val_a[LANES];
+   int32_t val_b[LANES];
+};
+
+// --- Load/Store Functions ---
+
+static void load_inputs(const wide_t *in1, const wide_t *in2, hls::stream<WideData> &out_stream,
+                        int words) {
+   for (int i = 0; i < words; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_words max = c_words
+#pragma HLS PIPELINE II = 1
+      wide_t a = in1[i];
+      wide_t b = in2[i];
+      WideData data;
+#pragma HLS ARRAY_PARTITION variable = data complete
+      for (int l = 0; l < LANES; l++) {
+#pragma HLS UNROLL
+         data.val_a[l] = get_lane(a, l);
+         data.val_b[l] = get_lane(b, l);
+         data.result[l] = 0;
+      }
+      out_stream << data;
+   }
+}
+
+static void store_result(wide_t *out, hls::stream<wide_t> &in_stream, int words) {
+   store_wide(out, in_stream, words);
+}
+
+// --- Pipeline Stages ---
+
+static void stage1(hls::stream<WideData> &in_stream, hls::stream<WideData> &out_stream,
+                   int words) {
+   for (int i = 0; i < words; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_words max = c_words
+#pragma HLS PIPELINE II = 1
+      WideData data = in_stream.read();
+      for (int l = 0; l < LANES; l++) {
+#pragma HLS UNROLL
+         data.result[l] = ((int64_t)data.val_a[l] * 3) - data.val_b[l];
+      }
+      out_stream << data;
+   }
+}
+
+static void stage2(hls::stream<WideData> &in_stream, hls::stream<WideData> &out_stream,
+                   int words) {
+   for (int i = 0; i < words; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_words max = c_words
+#pragma HLS PIPELINE II = 1
+      WideData data = in_stream.read();
+      for (int l = 0; l < LANES; l++) {
+#pragma HLS UNROLL
+         data.result[l] = data.result[l] * (data.result[l] + 5);
+      }
+      out_stream << data;
+   }
+}
+
+static void stage3(hls::stream<WideData> &in_stream, hls::stream<WideData> &out_stream,
+                   int words) {
+   for (int i = 0; i < words; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_words max = c_words
+#pragma HLS PIPELINE II = 1
+      WideData data = in_stream.read();
+      for (int l = 0; l < LANES; l++) {
+#pragma HLS UNROLL
+         int64_t abs_val_a =
+            (data.val_a[l] < 0) ? -(int64_t)data.val_a[l] : (int64_t)data.val_a[l];
+         data.result[l] = data.result[l] / (abs_val_a + 1);
+      }
+      out_stream << data;
+   }
+}
+
+static void stage4(hls::stream<WideData> &in_stream, hls::stream<wide_t> &out_stream, int words) {
+   for (int i = 0; i < words; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_words max = c_words
+#pragma HLS PIPELINE II = 1
+      WideData data = in_stream.read();
+      wide_t c;
+      for (int l = 0; l < LANES; l++) {
+#pragma HLS UNROLL
+         int64_t final_result = data.result[l] + ((int64_t)data.val_b[l] * 7);
+         set_lane(c, l, (int32_t)final_result);
+      }
+      out_stream << c;
+   }
+}
+
+extern "C" {
+
+/**
+ * @brief Top-level kernel that implements a 4-stage deep pipeline on 512-bit beats.
+ */
+void krnl_deep_pipeline_calculation_wide(const wide_t *in1, const wide_t *in2, wide_t *out,
+                                         int size) {
+#pragma HLS INTERFACE m_axi port = in1 bundle = gmem0 max_read_burst_length = 64
+#pragma HLS INTERFACE m_axi port = in2 bundle = gmem1 max_read_burst_length = 64
+#pragma HLS INTERFACE m_axi port = out bundle = gmem2 max_write_burst_length = 64
+
+   // Streams to connect the pipeline stages
+   static hls::stream<WideData> stream_load_to_s1("stream_load_to_s1");
+   static hls::stream<WideData> stream_s1_to_s2("stream_s1_to_s2");
+   static hls::stream<WideData> stream_s2_to_s3("stream_s2_to_s3");
+   static hls::stream<WideData> stream_s3_to_s4("stream_s3_to_s4");
+   static hls::stream<wide_t> stream_s4_to_store("stream_s4_to_store");
+
+   int words = num_words(size);
+
+#pragma HLS dataflow
+   // La regione dataflow crea una pipeline hardware lineare dalle seguenti chiamate
+   load_inputs(in1, in2, stream_load_to_s1, words);
+   stage1(stream_load_to_s1, stream_s1_to_s2, words);
+   stage2(stream_s1_to_s2, stream_s2_to_s3, words);
+   stage3(stream_s2_to_s3, stream_s3_to_s4, words);
+   stage4(stream_s3_to_s4, stream_s4_to_store, words);
+   store_result(out, stream_s4_to_store, words);
+}
+}
@@ -0,0 +1,141 @@
+/*******************************************************************************
+Description:
+
+    Reduced-precision variant of krnl_heavy_compute, with the same
+    load/compute/store dataflow architecture:
+    1. load_input: Reads data from global memory into streams.
+    2. compute_heavy_fast: Evaluates the sum of sin(a + j) * cos(b - j) with a
+       rotation recurrence instead of sin/cos calls in the loop.
+    3. store_result: Writes the results from a stream back to global memory.
+
+    The arguments step by exactly +1 and -1 every iteration, so sin and cos
+    are computed once per element (in float) and each iteration rotates the
+    (sin, cos) pairs by one radian with the angle-addition identities: 8
+    multiplications and 4 additions, no transcendental cores in the loop.
+
+    The recurrence of one element is a loop-carried dependency, so elements
+    are processed in groups of LANES interleaved in the inner loop: the same
+    element is updated again only LANES cycles later, which covers the
+    multiply-add latency and lets the loop run at II = 1.
+
+*******************************************************************************/
+
+// Includes
+#include <hls_math.h>
+#include <hls_stream.h>
+#include <stdint.h>
+
+#define DATA_SIZE 4096
+#define HEAVY_ITERS 200
+#define LANES 16 // Elements interleaved in the recurrence (>= multiply-add latency)
+
+// TRIPCOUNT identifier
+const int c_size = DATA_SIZE;
+
+/**
+ * @brief Reads data from global memory and writes it into an HLS stream.
+ */
+static void load_input(int32_t *in, hls::stream<int32_t> &inStream, int size) {
+mem_rd:
+   for (int i = 0; i < size; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_size max = c_size
+#pragma HLS PIPELINE II = 1
+      inStream << in[i];
+   }
+}
+
+/**
+ * @brief Reads from input streams, runs the sin/cos recurrence on groups of LANES
+ * elements and writes to an output stream.
+ */
+static void compute_heavy_fast(hls::stream<int32_t> &in1_stream, hls::stream<int32_t> &in2_stream,
+                               hls::stream<int32_t> &out_stream, int size) {
+   const float s1 = 0.841470984807897f; // sin(1)
+   const float c1 = 0.540302305868140f; // cos(1)
+   float sa[LANES], ca[LANES], sb[LANES], cb[LANES], acc[LANES];
+
+execute:
+   for (int base = 0; base < size; base += LANES) {
+#pragma HLS LOOP_TRIPCOUNT min = c_size / LANES max = c_size / LANES
+      const int len = size - base < LANES ? size - base : LANES;
+
+   // Seno e coseno una sola volta per elemento.
+   init_lanes:
+      for (int k = 0; k < LANES; ++k) {
+#pragma HLS PIPELINE II = 1
+         float val_a = k < len ? (float)in1_stream.read() : 0.0f;
+         float val_b = k < len ? (float)in2_stream.read() : 0.0f;
+         sa[k] = hls::sin(val_a);
+         ca[k] = hls::cos(val_a);
+         sb[k] = hls::sin(val_b);
+         cb[k] = hls::cos(val_b);
+         acc[k] = 0.0f;
+      }
+
+   // Rotazione di un radiante per iterazione, elementi del gruppo alternati.
+   rotate:
+      for (int j = 0; j < HEAVY_ITERS; ++j) {
+         for (int k = 0; k < LANES; ++k) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS DEPENDENCE variable = sa inter false
+#pragma HLS DEPENDENCE variable = ca inter false
+#pragma HLS DEPENDENCE variable = sb inter false
+#pragma HLS DEPENDENCE variable = cb inter false
+#pragma HLS DEPENDENCE variable = acc inter false
+            float a_s = sa[k], a_c = ca[k], b_s = sb[k], b_c = cb[k];
+            acc[k] += a_s * b_c;
+            sa[k] = a_s * c1 + a_c * s1;
+            ca[k] = a_c * c1 - a_s * s1;
+            sb[k] = b_s * c1 - b_c * s1;
+            cb[k] = b_c * c1 + b_s * s1;
+         }
+      }
+
+   store_lanes:
+      for (int k = 0; k < len; ++k) {
+#pragma HLS LOOP_TRIPCOUNT min = LANES max = LANES
+#pragma HLS PIPELINE II = 1
+         out_stream << (int32_t)acc[k];
+      }
+   }
+}
+
+/**
+ * @brief Reads data from an HLS stream and writes it to global memory.
+ */
+static void store_result(int32_t *out, hls::stream<int32_t> &out_stream, int size) {
+mem_wr:
+   for (int i = 0; i < size; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_size max = c_size
+#pragma HLS PIPELINE II = 1
+      out[i] = out_stream.read();
+   }
+}
+
+extern "C" {
+
+/**
+ * @brief Top-level kernel function that orchestrates the dataflow pipeline.
+ *
+ * @param in1  (input)  --> Input vector 'a'
+ * @param in2  (input)  --> Input vector 'b'
+ * @param out  (output) --> Output vector 'c'
+ * @param size (input)  --> Number of elements in vectors
+ */
+void krnl_heavy_compute_fast(int32_t *in1, int32_t *in2, int32_t *out, int size) {
+#pragma HLS INTERFACE m_axi port = in1 bundle = gmem0
+#pragma HLS INTERFACE m_axi port = in2 bundle = gmem1
+#pragma HLS INTERFACE m_axi port = out bundle = gmem0
+
+   static hls::stream<int32_t> in1_stream("input_stream_1");
+   static hls::stream<int32_t> in2_stream("input_stream_2");
+   static hls::stream<int32_t> out_stream("output_stream");
+
+#pragma HLS dataflow
+   // dataflow pragma instruct compiler to run following three APIs in parallel
+   load_input(in1, in1_stream, size);
+   load_input(in2, in2_stream, size);
+   compute_heavy_fast(in1_stream, in2_stream, out_stream, size);
+   store_result(out, out_stream, size);
+}
+}
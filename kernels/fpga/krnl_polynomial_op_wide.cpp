@@ -0,0 +1,96 @@
+//
+// Kernel
+//
+
+/*******************************************************************************
+Description:
+
+    512-bit variant of krnl_polynomial_op. Same load/compute/store dataflow
+    architecture, but:
+    1. load_wide: Reads 16 integers per beat from global memory, in 4 KB bursts.
+    2. compute_poly: Unpacks the 16 lanes of a beat and evaluates the
+       polynomial on all of them in parallel.
+    3. store_wide: Writes 16 results per beat back to global memory.
+
+    Each argument has its own m_axi bundle (in the scalar kernel 'in1' and
+    'out' share gmem0), so reads and writes proceed concurrently.
+
+    The operation performed is the same as the scalar kernel:
+    c[i] = (2 * a[i]^2) + (3 * a[i]^3) - (4 * b[i]^2) + (5 * b[i]^5)
+
+    'size' is the number of elements; buffers are padded by the host to a
+    multiple of 16 elements (see wide_io.hpp).
+
+*******************************************************************************/
+
+// Includes
+#include "wide_io.hpp"
+
+/**
+ * @brief Polynomial on a single lane, with the same 64-bit intermediates as the
+ * scalar kernel.
+ */
+static int32_t poly_lane(int32_t val_a, int32_t val_b) {
+#pragma HLS INLINE
+   int64_t a2 = (int64_t)val_a * val_a;
+   int64_t a3 = a2 * val_a;
+   int64_t b2 = (int64_t)val_b * val_b;
+   int64_t b4 = b2 * b2;
+   int64_t b5 = b4 * val_b;
+
+   int64_t result = (2 * a2) + (3 * a3) - (4 * b2) + (5 * b5);
+   return (int32_t)result;
+}
+
+/**
+ * @brief Reads one beat from each input stream, evaluates the polynomial on its
+ * 16 lanes and writes one beat to the output stream.
+ * * @param words The number of 512-bit beats to process.
+ */
+static void compute_poly(hls::stream<wide_t> &in1_stream, hls::stream<wide_t> &in2_stream,
+                         hls::stream<wide_t> &out_stream, int words) {
+execute:
+   for (int i = 0; i < words; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_words max = c_words
+#pragma HLS PIPELINE II = 1
+      wide_t a = in1_stream.read();
+      wide_t b = in2_stream.read();
+      wide_t c;
+   lanes:
+      for (int l = 0; l < LANES; l++) {
+#pragma HLS UNROLL
+         set_lane(c, l, poly_lane(get_lane(a, l), get_lane(b, l)));
+      }
+      out_stream << c;
+   }
+}
+
+extern "C" {
+
+/**
+ * @brief Top-level kernel function that orchestrates the dataflow pipeline.
+ *
+ * @param in1  (input)  --> Input vector 'a'
+ * @param in2  (input)  --> Input vector 'b'
+ * @param out  (output) --> Output vector 'c'
+ * @param size (input)  --> Number of elements in vectors
+ */
+void krnl_polynomial_op_wide(const wide_t *in1, const wide_t *in2, wide_t *out, int size) {
+#pragma HLS INTERFACE m_axi port = in1 bundle = gmem0 max_read_burst_length = 64
+#pragma HLS INTERFACE m_axi port = in2 bundle = gmem1 max_read_burst_length = 64
+#pragma HLS INTERFACE m_axi port = out bundle = gmem2 max_write_burst_length = 64
+
+   static hls::stream<wide_t> in1_stream("input_stream_1");
+   static hls::stream<wide_t> in2_stream("input_stream_2");
+   static hls::stream<wide_t> out_stream("output_stream");
+
+   int words = num_words(size);
+
+#pragma HLS dataflow
+   // dataflow pragma instructs compiler to run following three APIs in parallel
+   load_wide(in1, in1_stream, words);
+   load_wide(in2, in2_stream, words);
+   compute_poly(in1_stream, in2_stream, out_stream, words);
+   store_wide(out, out_stream, words);
+}
+}
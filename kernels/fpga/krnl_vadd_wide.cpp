@@ -0,0 +1,70 @@
+//
+// Kernel
+//
+
+/*******************************************************************************
+Description:
+
+    512-bit variant of krnl_vadd. Same load/compute/store dataflow structure,
+    but every port moves 16 integers per beat in 4 KB bursts and each input and
+    output has its own m_axi bundle, so the two reads and the write never
+    compete for the same AXI port. compute_add performs 16 additions per
+    clock cycle.
+
+    'size' is the number of elements; buffers are padded by the host to a
+    multiple of 16 elements (see wide_io.hpp).
+
+*******************************************************************************/
+
+// Includes
+#include "wide_io.hpp"
+
+static void compute_add(hls::stream<wide_t> &in1_stream, hls::stream<wide_t> &in2_stream,
+                        hls::stream<wide_t> &out_stream, int words) {
+execute:
+   for (int i = 0; i < words; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_words max = c_words
+#pragma HLS PIPELINE II = 1
+      wide_t a = in1_stream.read();
+      wide_t b = in2_stream.read();
+      wide_t c;
+   lanes:
+      for (int l = 0; l < LANES; l++) {
+#pragma HLS UNROLL
+         set_lane(c, l, (int32_t)((uint32_t)get_lane(a, l) + (uint32_t)get_lane(b, l)));
+      }
+      out_stream << c;
+   }
+}
+
+extern "C" {
+
+/*
+    Vector Addition Kernel (512-bit ports)
+
+    Arguments:
+        in1  (input)  --> Input vector 1
+        in2  (input)  --> Input vector 2
+        out  (output) --> Output vector
+        size (input)  --> Number of elements in vector
+*/
+
+void krnl_vadd_wide(const wide_t *in1, const wide_t *in2, wide_t *out, int size) {
+#pragma HLS INTERFACE m_axi port = in1 bundle = gmem0 max_read_burst_length = 64
+#pragma HLS INTERFACE m_axi port = in2 bundle = gmem1 max_read_burst_length = 64
+#pragma HLS INTERFACE m_axi port = out bundle = gmem2 max_write_burst_length = 64
+
+   static hls::stream<wide_t> in1_stream("input_stream_1");
+   static hls::stream<wide_t> in2_stream("input_stream_2");
+   static hls::stream<wide_t> out_stream("output_stream");
+
+   int words = num_words(size);
+
+#pragma HLS dataflow
+   // dataflow pragma instruct compiler to run following three APIs in parallel
+   load_wide(in1, in1_stream, words);
+   load_wide(in2, in2_stream, words);
+   compute_add(in1_stream, in2_stream, out_stream, words);
+   store_wide(out, out_stream, words);
+}
+}
@@ -0,0 +1,71 @@
+/*******************************************************************************
+Description:
+
+    Helpers shared by the 512-bit ("_wide") variants of the HLS kernels.
+
+    Every m_axi port moves one 512-bit beat (16 int32 lanes) per clock cycle
+    instead of one int32, in bursts of BURST_BEATS beats. The load/store
+    stages move whole beats between global memory and the dataflow streams,
+    the compute stages unpack the 16 lanes of a beat and process them in
+    parallel.
+
+    Buffers must hold a whole number of beats: the host pads their size to a
+    multiple of 64 bytes, so the last beat may contain lanes past 'size'.
+    Those lanes are computed and stored in the padding and ignored by the host.
+
+*******************************************************************************/
+
+#pragma once
+
+#include <ap_int.h>
+#include <hls_stream.h>
+#include <stdint.h>
+
+typedef ap_uint<512> wide_t;
+
+// int32 lanes in a 512-bit beat.
+const int LANES = 512 / 32;
+
+// Beats per AXI burst: 64 beats x 64 bytes = 4 KB, the largest burst that never crosses an AXI
+// 4 KB boundary.
+const int BURST_BEATS = 64;
+
+// TRIPCOUNT identifier (4096 elements).
+const int c_words = 4096 / LANES;
+
+// Number of beats holding 'size' int32 elements.
+static inline int num_words(int size) { return (size + LANES - 1) / LANES; }
+
+static inline int32_t get_lane(const wide_t &word, int lane) {
+#pragma HLS INLINE
+   return (int32_t)(uint32_t)word.range(32 * lane + 31, 32 * lane);
+}
+
+static inline void set_lane(wide_t &word, int lane, int32_t value) {
+#pragma HLS INLINE
+   word.range(32 * lane + 31, 32 * lane) = (uint32_t)value;
+}
+
+/**
+ * @brief Reads 'words' beats from global memory into an HLS stream.
+ */
+static void load_wide(const wide_t *in, hls::stream<wide_t> &inStream, int words) {
+mem_rd:
+   for (int i = 0; i < words; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_words max = c_words
+#pragma HLS PIPELINE II = 1
+      inStream << in[i];
+   }
+}
+
+/**
+ * @brief Writes 'words' beats from an HLS stream to global memory.
+ */
+static void store_wide(wide_t *out, hls::stream<wide_t> &outStream, int words) {
+mem_wr:
+   for (int i = 0; i < words; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = c_words max = c_words
+#pragma HLS PIPELINE II = 1
+      out[i] = outStream.read();
+   }
+}
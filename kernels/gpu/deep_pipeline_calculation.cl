@@ -1,3 +1,6 @@
+// N_ELEMS (numero di elementi) è definito dall'host, vedi KernelSpecializer::N_ELEMS_PROLOGUE:
+// l'argomento n, o la costante SPEC_N nelle varianti JIT per dimensione (--jit).
+
 /**
  * @brief Esegue un'operazione a pipeline profonda a 4 stadi su due vettori.
  *
@@ -18,7 +21,7 @@ __kernel void deep_pipeline_calculation(__global const int* a,
 
     const int i = get_global_id(0);
 
-    if (i < n) {
+    if (i < N_ELEMS) {
         long val_a = a[i];
         long val_b = b[i];
 
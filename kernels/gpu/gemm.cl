@@ -0,0 +1,50 @@
+// Lato dei blocchi in memoria locale: deve coincidere con GEMM_TILE di Gpu_OpenCL_Accelerator,
+// che lancia work-group di GEMM_TILE x GEMM_TILE work-item.
+#ifndef GEMM_TILE
+#define GEMM_TILE 16
+#endif
+
+/**
+ * @brief Moltiplicazione di matrici C = A x B (float, per righe) a blocchi in memoria locale.
+ *
+ * Ogni work-item calcola un elemento di C (colonna get_global_id(0), riga get_global_id(1)). Il
+ * work-group copia in memoria locale un blocco GEMM_TILE x GEMM_TILE di A e uno di B per volta
+ * (un elemento per work-item), poi ogni work-item accumula il prodotto della sua riga e colonna
+ * dei blocchi: ogni elemento letto dalla memoria globale viene usato GEMM_TILE volte invece di
+ * una. Gli elementi fuori dalle matrici (bordi non multipli di GEMM_TILE) valgono 0.
+ *
+ * @param a Matrice A (m x k, righe di lda elementi).
+ * @param b Matrice B (k x n, righe di ldb elementi).
+ * @param c Matrice C (m x n, righe di ldc elementi).
+ */
+__kernel void gemm(__global const float* a,
+                   __global const float* b,
+                   __global float* c,
+                   const unsigned int m,
+                   const unsigned int n,
+                   const unsigned int k,
+                   const unsigned int lda,
+                   const unsigned int ldb,
+                   const unsigned int ldc) {
+    __local float tile_a[GEMM_TILE][GEMM_TILE];
+    __local float tile_b[GEMM_TILE][GEMM_TILE];
+
+    const uint col = get_global_id(0);
+    const uint row = get_global_id(1);
+    const uint lc = get_local_id(0);
+    const uint lr = get_local_id(1);
+
+    float acc = 0.0f;
+    for (uint t = 0; t < k; t += GEMM_TILE) {
+        tile_a[lr][lc] = (row < m && t + lc < k) ? a[row * lda + t + lc] : 0.0f;
+        tile_b[lr][lc] = (t + lr < k && col < n) ? b[(t + lr) * ldb + col] : 0.0f;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (uint p = 0; p < GEMM_TILE; ++p)
+            acc += tile_a[lr][p] * tile_b[p][lc];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (row < m && col < n)
+        c[row * ldc + col] = acc;
+}
@@ -0,0 +1,57 @@
+// N_ELEMS (numero di elementi) è definito dall'host, vedi KernelSpecializer::N_ELEMS_PROLOGUE:
+// l'argomento n, o la costante SPEC_N nelle varianti JIT per dimensione (--jit).
+
+// Tipo usato per i calcoli (-DREAL_T=double richiede anche -DUSE_FP64) e numero di iterazioni
+// del ciclo, fissati alla compilazione.
+#ifdef USE_FP64
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+#ifndef REAL_T
+#define REAL_T float
+#endif
+#ifndef HEAVY_ITERS
+#define HEAVY_ITERS 200
+#endif
+
+/**
+ * @brief Variante veloce di heavy_compute_kernel, a precisione ridotta.
+ *
+ * Calcola la stessa somma di sin(a + j) * cos(b - j), ma gli argomenti avanzano di +1 e -1 a
+ * ogni iterazione: seno e coseno si calcolano solo per j = 0, poi le coppie (sin, cos) ruotano
+ * di un radiante con le formule di addizione (8 moltiplicazioni e 4 somme per iterazione,
+ * nessuna funzione trascendente). L'errore cresce con il quadrato delle iterazioni (vedi
+ * src/cpu_runner/CpuHeavyFast.hpp).
+ *
+ * @param a Puntatore al primo vettore di input in memoria globale.
+ * @param b Puntatore al secondo vettore di input in memoria globale.
+ * @param c Puntatore al vettore di output in memoria globale.
+ * @param n Il numero totale di elementi nei vettori.
+ */
+__kernel void heavy_compute_fast(__global const int* a,
+                                 __global const int* b,
+                                 __global int* c,
+                                 const unsigned int n) {
+
+    const int i = get_global_id(0);
+
+    if (i < N_ELEMS) {
+        const REAL_T s1 = sin((REAL_T)1), c1 = cos((REAL_T)1);
+        const REAL_T val_a = (REAL_T)a[i];
+        const REAL_T val_b = (REAL_T)b[i];
+        REAL_T sa = sin(val_a), ca = cos(val_a);
+        REAL_T sb = sin(val_b), cb = cos(val_b);
+        REAL_T result = 0;
+
+        for (int j = 0; j < HEAVY_ITERS; ++j) {
+            result += sa * cb;
+            const REAL_T next_sa = sa * c1 + ca * s1;
+            ca = ca * c1 - sa * s1;
+            sa = next_sa;
+            const REAL_T next_sb = sb * c1 - cb * s1;
+            cb = cb * c1 + sb * s1;
+            sb = next_sb;
+        }
+
+        c[i] = (int)result;
+    }
+}
@@ -0,0 +1,44 @@
+#include <metal_stdlib>
+using namespace metal;
+
+/**
+ * @brief Variante veloce di heavy_compute_kernel, a precisione ridotta (versione MSL).
+ *
+ * Seno e coseno si calcolano solo per j = 0, poi le coppie (sin, cos) ruotano di un radiante a
+ * ogni iterazione con le formule di addizione, senza funzioni trascendenti nel ciclo.
+ *
+ * @param a         Puntatore al primo vettore di input [buffer(0)].
+ * @param b         Puntatore al secondo vettore di input [buffer(1)].
+ * @param c         Puntatore al vettore di output [buffer(2)].
+ * @param n         Il numero totale di elementi [buffer(3)].
+ * @param gid       L'ID globale del thread.
+ */
+kernel void heavy_compute_fast(device const int* a [[buffer(0)]],
+                               device const int* b [[buffer(1)]],
+                               device int* c       [[buffer(2)]],
+                               constant uint& n    [[buffer(3)]],
+                               uint gid            [[thread_position_in_grid]])
+{
+    if (gid >= n) {
+        return;
+    }
+
+    const float s1 = sin(1.0f), c1 = cos(1.0f);
+    float val_a = (float)a[gid];
+    float val_b = (float)b[gid];
+    float sa = sin(val_a), ca = cos(val_a);
+    float sb = sin(val_b), cb = cos(val_b);
+    float result = 0.0f;
+
+    for (int j = 0; j < 200; ++j) {
+        result += sa * cb;
+        const float next_sa = sa * c1 + ca * s1;
+        ca = ca * c1 - sa * s1;
+        sa = next_sa;
+        const float next_sb = sb * c1 - cb * s1;
+        cb = cb * c1 + sb * s1;
+        sb = next_sb;
+    }
+
+    c[gid] = (int)result;
+}
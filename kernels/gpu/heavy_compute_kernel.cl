@@ -1,3 +1,18 @@
+// N_ELEMS (numero di elementi) è definito dall'host, vedi KernelSpecializer::N_ELEMS_PROLOGUE:
+// l'argomento n, o la costante SPEC_N nelle varianti JIT per dimensione (--jit).
+
+// Tipo usato per i calcoli trigonometrici (-DREAL_T=double richiede anche -DUSE_FP64) e numero
+// di iterazioni del ciclo, fissati alla compilazione.
+#ifdef USE_FP64
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+#ifndef REAL_T
+#define REAL_T float
+#endif
+#ifndef HEAVY_ITERS
+#define HEAVY_ITERS 200
+#endif
+
 /**
  * @brief Esegue un calcolo computazionalmente intensivo (compute-bound).
  *
@@ -16,14 +31,14 @@ __kernel void heavy_compute_kernel(__global const int* a,
 
     const int i = get_global_id(0);
 
-    if (i < n) {
-        // Converte gli input in float per le funzioni trigonometriche
-        float val_a = (float)a[i];
-        float val_b = (float)b[i];
-        float result = 0.0f;
+    if (i < N_ELEMS) {
+        // Converte gli input in REAL_T (float di default) per le funzioni trigonometriche
+        REAL_T val_a = (REAL_T)a[i];
+        REAL_T val_b = (REAL_T)b[i];
+        REAL_T result = 0;
 
         // Ciclo computazionalmente pesante
-        for (int j = 0; j < 200; ++j) {
+        for (int j = 0; j < HEAVY_ITERS; ++j) {
             result += sin(val_a + j) * cos(val_b - j);
         }
 
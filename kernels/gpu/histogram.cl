@@ -0,0 +1,45 @@
+// N_ELEMS (numero di elementi) è definito dall'host, vedi KernelSpecializer::N_ELEMS_PROLOGUE:
+// l'argomento n, o la costante SPEC_N nelle varianti JIT per dimensione (--jit).
+
+// Numero di bin (HISTOGRAM_BINS di CpuKernels.hpp): il bin di un valore è il suo byte basso.
+#define HISTOGRAM_BINS 256
+
+// Dimensione massima del work-group (potenza di 2): deve coincidere con REDUCE_LOCAL_MAX di
+// Gpu_OpenCL_Accelerator, che lancia work-group di al più questa dimensione.
+#ifndef REDUCE_LOCAL_MAX
+#define REDUCE_LOCAL_MAX 256
+#endif
+
+/**
+ * @brief Istogramma degli elementi di a su HISTOGRAM_BINS bin.
+ *
+ * Riduzione gerarchica in due livelli di atomiche: ogni work-group conta i propri elementi
+ * (grid-stride, come le altre riduzioni) in un istogramma in memoria locale, dove le atomiche
+ * sono economiche, poi lo somma all'istogramma globale con una sola atomic_add per bin. Le
+ * atomiche sulla memoria globale sono quindi HISTOGRAM_BINS per gruppo invece di una per
+ * elemento. bins va azzerato prima del lancio.
+ *
+ * @param a Vettore di input in memoria globale.
+ * @param b Non usato (stessa firma dei kernel elemento per elemento).
+ * @param bins Istogramma globale, HISTOGRAM_BINS contatori.
+ * @param n Numero di elementi di a.
+ */
+__kernel void histogram(__global const int* a,
+                        __global const int* b,
+                        __global int* bins,
+                        const unsigned int n) {
+    __local int local_bins[HISTOGRAM_BINS];
+    const uint lid = get_local_id(0);
+
+    for (uint k = lid; k < HISTOGRAM_BINS; k += get_local_size(0))
+        local_bins[k] = 0;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint i = get_global_id(0); i < N_ELEMS; i += get_global_size(0))
+        atomic_inc(&local_bins[(uint)a[i] & (HISTOGRAM_BINS - 1)]);
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint k = lid; k < HISTOGRAM_BINS; k += get_local_size(0))
+        if (local_bins[k] != 0)
+            atomic_add(&bins[k], local_bins[k]);
+}
@@ -1,3 +1,6 @@
+// N_ELEMS (numero di elementi) è definito dall'host, vedi KernelSpecializer::N_ELEMS_PROLOGUE:
+// l'argomento n, o la costante SPEC_N nelle varianti JIT per dimensione (--jit).
+
 /**
  * @brief Esegue un'operazione polinomiale complessa su due vettori di input.
  *
@@ -15,7 +18,7 @@ __kernel void polynomial_op(__global const int* a,
                          const unsigned int n) {
     const int i = get_global_id(0);
 
-    if (i < n) {
+    if (i < N_ELEMS) {
         int val_a = a[i];
         int val_b = b[i];
 
@@ -28,3 +31,50 @@ __kernel void polynomial_op(__global const int* a,
         c[i] = (2 * a2) + (3 * a3) - (4 * b2) + (5 * b5);
     }
 }
+
+/**
+ * @brief Varianti per l'autotuner di Gpu_OpenCL_Accelerator.
+ *
+ * Ogni work-item calcola il polinomio su vettori da 1, 4 o 8 int (vload/vstore) e scorre
+ * l'array a passi di get_global_size(0), quindi il numero di elementi per work-item dipende solo
+ * dalla dimensione globale del lancio. Gli ultimi n % W elementi vengono calcolati uno alla volta.
+ * Le operazioni sui vettori sono per componente, quindi il risultato è identico a polynomial_op.
+ */
+#define POLY(va, vb) ((2 * (va) * (va)) + (3 * (va) * (va) * (va)) - (4 * (vb) * (vb)) + \
+                      (5 * (vb) * (vb) * (vb) * (vb) * (vb)))
+
+__kernel void polynomial_op_v1(__global const int* a,
+                               __global const int* b,
+                               __global int* c,
+                               const unsigned int n) {
+    for (unsigned int i = get_global_id(0); i < N_ELEMS; i += get_global_size(0))
+        c[i] = POLY(a[i], b[i]);
+}
+
+__kernel void polynomial_op_v4(__global const int* a,
+                               __global const int* b,
+                               __global int* c,
+                               const unsigned int n) {
+    const unsigned int stride = get_global_size(0);
+    for (unsigned int v = get_global_id(0); v < N_ELEMS / 4; v += stride) {
+        int4 va = vload4(v, a);
+        int4 vb = vload4(v, b);
+        vstore4(POLY(va, vb), v, c);
+    }
+    for (unsigned int i = (N_ELEMS / 4) * 4 + get_global_id(0); i < N_ELEMS; i += stride)
+        c[i] = POLY(a[i], b[i]);
+}
+
+__kernel void polynomial_op_v8(__global const int* a,
+                               __global const int* b,
+                               __global int* c,
+                               const unsigned int n) {
+    const unsigned int stride = get_global_size(0);
+    for (unsigned int v = get_global_id(0); v < N_ELEMS / 8; v += stride) {
+        int8 va = vload8(v, a);
+        int8 vb = vload8(v, b);
+        vstore8(POLY(va, vb), v, c);
+    }
+    for (unsigned int i = (N_ELEMS / 8) * 8 + get_global_id(0); i < N_ELEMS; i += stride)
+        c[i] = POLY(a[i], b[i]);
+}
@@ -0,0 +1,89 @@
+// N_ELEMS (numero di elementi) è definito dall'host, vedi KernelSpecializer::N_ELEMS_PROLOGUE:
+// l'argomento n, o la costante SPEC_N nelle varianti JIT per dimensione (--jit).
+
+// Sorgente unico di reduce_sum, reduce_min e reduce_max: l'operazione è fissata dall'host alla
+// compilazione (Gpu_OpenCL_Accelerator, reduce_defines()) con
+//   REDUCE_KERNEL    nome del kernel (il secondo livello è REDUCE_KERNEL##_final),
+//   REDUCE_T         tipo dell'accumulatore e dei parziali,
+//   REDUCE_OP        combinazione di due valori (funzione a due argomenti),
+//   REDUCE_IDENTITY  elemento neutro di REDUCE_OP.
+// Senza opzioni il programma calcola reduce_sum.
+#ifndef REDUCE_KERNEL
+#define REDUCE_KERNEL reduce_sum
+#define REDUCE_T long
+#define REDUCE_OP reduce_add
+#define REDUCE_IDENTITY 0
+#endif
+
+#define REDUCE_CAT_(a, b) a##b
+#define REDUCE_CAT(a, b) REDUCE_CAT_(a, b)
+
+// Dimensione massima del work-group (potenza di 2): deve coincidere con REDUCE_LOCAL_MAX di
+// Gpu_OpenCL_Accelerator, che lancia work-group di al più questa dimensione.
+#ifndef REDUCE_LOCAL_MAX
+#define REDUCE_LOCAL_MAX 256
+#endif
+
+// Somma di reduce_sum, accumulata a 64 bit (long) per non andare in overflow.
+inline long reduce_add(long x, long y) { return x + y; }
+
+/**
+ * @brief Riduzione degli elementi di a con REDUCE_OP.
+ *
+ * Primo livello della riduzione gerarchica: ogni work-item accumula in registro gli elementi
+ * a[i] con i = get_global_id(0) + k * get_global_size(0), poi il work-group combina gli
+ * accumulatori in memoria locale con un albero (log2(local size) passi separati da barriere) e il
+ * work-item 0 scrive il risultato del gruppo in partials[get_group_id(0)]. Con al più qualche
+ * migliaio di gruppi i parziali sono pochi KB, invece dei 4 byte per elemento di un kernel
+ * elemento per elemento.
+ *
+ * @param a Vettore di input in memoria globale.
+ * @param b Non usato (stessa firma dei kernel elemento per elemento).
+ * @param partials Un risultato parziale per work-group.
+ * @param n Numero di elementi di a.
+ */
+__kernel void REDUCE_KERNEL(__global const int* a,
+                            __global const int* b,
+                            __global REDUCE_T* partials,
+                            const unsigned int n) {
+    __local REDUCE_T scratch[REDUCE_LOCAL_MAX];
+    const uint lid = get_local_id(0);
+
+    REDUCE_T acc = REDUCE_IDENTITY;
+    for (uint i = get_global_id(0); i < N_ELEMS; i += get_global_size(0))
+        acc = REDUCE_OP(acc, (REDUCE_T)a[i]);
+    scratch[lid] = acc;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint s = get_local_size(0) / 2; s > 0; s >>= 1) {
+        if (lid < s)
+            scratch[lid] = REDUCE_OP(scratch[lid], scratch[lid + s]);
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if (lid == 0)
+        partials[get_group_id(0)] = scratch[0];
+}
+
+/**
+ * @brief Secondo livello, facoltativo (--reduce-final=device): un solo work-group combina i count
+ * parziali e scrive il risultato in partials[0], così l'host scarica un solo valore.
+ */
+__kernel void REDUCE_CAT(REDUCE_KERNEL, _final)(__global REDUCE_T* partials,
+                                                const unsigned int count) {
+    __local REDUCE_T scratch[REDUCE_LOCAL_MAX];
+    const uint lid = get_local_id(0);
+
+    REDUCE_T acc = REDUCE_IDENTITY;
+    for (uint i = lid; i < count; i += get_local_size(0))
+        acc = REDUCE_OP(acc, partials[i]);
+    scratch[lid] = acc;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint s = get_local_size(0) / 2; s > 0; s >>= 1) {
+        if (lid < s)
+            scratch[lid] = REDUCE_OP(scratch[lid], scratch[lid + s]);
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if (lid == 0)
+        partials[0] = scratch[0];
+}
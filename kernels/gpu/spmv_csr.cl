@@ -0,0 +1,31 @@
+/**
+ * @brief y = A x con A sparsa in formato CSR, un work-item per riga.
+ *
+ * Gli array della matrice arrivano in un solo buffer (csr), uno dopo l'altro: row_ptr (rows + 1
+ * int), col_idx (nnz int) e values (nnz float). Ogni work-item scorre la propria riga: con righe
+ * corte è il lancio più semplice, ma i work-item vicini leggono values e col_idx in posizioni
+ * lontane (accessi non coalescenti) e una riga lunga tiene occupato un solo work-item. Per righe
+ * lunghe vedi spmv_csr_vector.
+ *
+ * @param csr row_ptr, col_idx e values della matrice.
+ * @param x Vettore di input (cols elementi), letto agli indici col_idx.
+ * @param y Vettore di output (rows elementi).
+ */
+__kernel void spmv_csr(__global const int* csr,
+                       __global const float* x,
+                       __global float* y,
+                       const unsigned int rows,
+                       const unsigned int nnz) {
+    const uint r = get_global_id(0);
+    if (r >= rows)
+        return;
+
+    __global const int* row_ptr = csr;
+    __global const int* col_idx = csr + rows + 1;
+    __global const float* values = (__global const float*)(col_idx + nnz);
+
+    float sum = 0.0f;
+    for (int j = row_ptr[r]; j < row_ptr[r + 1]; ++j)
+        sum += values[j] * x[col_idx[j]];
+    y[r] = sum;
+}
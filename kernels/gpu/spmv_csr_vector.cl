@@ -0,0 +1,48 @@
+// Work-item per riga (dimensione del work-group, potenza di 2): deve coincidere con
+// SPMV_VECTOR_WIDTH di Gpu_OpenCL_Accelerator.
+#ifndef SPMV_VECTOR_WIDTH
+#define SPMV_VECTOR_WIDTH 32
+#endif
+
+/**
+ * @brief y = A x con A sparsa in formato CSR, un work-group di SPMV_VECTOR_WIDTH work-item per
+ * riga ("vector" CSR).
+ *
+ * Stesso buffer csr di spmv_csr (row_ptr, col_idx, values uno dopo l'altro). I work-item del
+ * gruppo scorrono la riga a passi di SPMV_VECTOR_WIDTH, quindi leggono elementi consecutivi di
+ * values e col_idx (accessi coalescenti), e le somme parziali vengono combinate con un albero in
+ * memoria locale. Conviene con righe lunghe o di lunghezza molto diversa; con righe più corte di
+ * SPMV_VECTOR_WIDTH buona parte dei work-item resta inattiva.
+ *
+ * @param csr row_ptr, col_idx e values della matrice.
+ * @param x Vettore di input (cols elementi), letto agli indici col_idx.
+ * @param y Vettore di output (rows elementi).
+ */
+__kernel void spmv_csr_vector(__global const int* csr,
+                              __global const float* x,
+                              __global float* y,
+                              const unsigned int rows,
+                              const unsigned int nnz) {
+    __local float scratch[SPMV_VECTOR_WIDTH];
+    const uint r = get_group_id(0);
+    const uint lane = get_local_id(0);
+
+    __global const int* row_ptr = csr;
+    __global const int* col_idx = csr + rows + 1;
+    __global const float* values = (__global const float*)(col_idx + nnz);
+
+    float sum = 0.0f;
+    if (r < rows)
+        for (int j = row_ptr[r] + (int)lane; j < row_ptr[r + 1]; j += SPMV_VECTOR_WIDTH)
+            sum += values[j] * x[col_idx[j]];
+    scratch[lane] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint s = SPMV_VECTOR_WIDTH / 2; s > 0; s >>= 1) {
+        if (lane < s)
+            scratch[lane] += scratch[lane + s];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if (lane == 0 && r < rows)
+        y[r] = scratch[0];
+}
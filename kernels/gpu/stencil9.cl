@@ -0,0 +1,56 @@
+// Lato dei work-group (STENCIL_TILE x STENCIL_TILE): deve coincidere con STENCIL_TILE di
+// Gpu_OpenCL_Accelerator.
+#ifndef STENCIL_TILE
+#define STENCIL_TILE 16
+#endif
+
+/**
+ * @brief Uno sweep dello stencil a 9 punti (filtro gaussiano 3 x 3: pesi 4 al centro, 2 ai lati,
+ * 1 agli angoli, diviso 16) su una griglia float rows x cols, per righe. Le celle sul bordo della
+ * griglia vengono copiate.
+ *
+ * Ogni work-item calcola una cella (colonna get_global_id(0), riga get_global_id(1)). Il
+ * work-group copia prima in memoria locale il suo blocco con un bordo di una cella, così ogni
+ * cella letta dalla memoria globale serve a tutti i vicini del gruppo. Gli sweep successivi
+ * vengono lanciati dall'host scambiando a e c, senza trasferimenti fra uno sweep e l'altro.
+ *
+ * @param a Griglia di input.
+ * @param b Non usato (stessa firma degli altri kernel).
+ * @param c Griglia di output.
+ */
+__kernel void stencil9(__global const float* a,
+                       __global const float* b,
+                       __global float* c,
+                       const unsigned int rows,
+                       const unsigned int cols) {
+    __local float tile[STENCIL_TILE + 2][STENCIL_TILE + 2];
+
+    const int col = get_global_id(0);
+    const int row = get_global_id(1);
+    const int lc = get_local_id(0);
+    const int lr = get_local_id(1);
+    const int row0 = (int)get_group_id(1) * STENCIL_TILE - 1;
+    const int col0 = (int)get_group_id(0) * STENCIL_TILE - 1;
+
+    for (int i = lr * STENCIL_TILE + lc; i < (STENCIL_TILE + 2) * (STENCIL_TILE + 2);
+         i += STENCIL_TILE * STENCIL_TILE) {
+        const int r = row0 + i / (STENCIL_TILE + 2);
+        const int k = col0 + i % (STENCIL_TILE + 2);
+        tile[i / (STENCIL_TILE + 2)][i % (STENCIL_TILE + 2)] =
+            (r >= 0 && r < (int)rows && k >= 0 && k < (int)cols) ? a[r * cols + k] : 0.0f;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (row >= (int)rows || col >= (int)cols)
+        return;
+    const float mid = tile[lr + 1][lc + 1];
+    if (row == 0 || row == (int)rows - 1 || col == 0 || col == (int)cols - 1) {
+        c[row * cols + col] = mid;
+        return;
+    }
+    const float up = tile[lr][lc + 1], down = tile[lr + 2][lc + 1];
+    const float left = tile[lr + 1][lc], right = tile[lr + 1][lc + 2];
+    c[row * cols + col] = 0.0625f * (4.0f * mid + 2.0f * (up + down + left + right) +
+                                     (tile[lr][lc] + tile[lr][lc + 2] + tile[lr + 2][lc] +
+                                      tile[lr + 2][lc + 2]));
+}
@@ -1,7 +1,46 @@
+// N_ELEMS (numero di elementi) è definito dall'host, vedi KernelSpecializer::N_ELEMS_PROLOGUE:
+// l'argomento n, o la costante SPEC_N nelle varianti JIT per dimensione (--jit).
+
 __kernel void vecAdd(__global const int* a,
                      __global const int* b,
                      __global int* c,
                      const uint n) {
   uint i = get_global_id(0);
-  if (i < n) c[i] = a[i] + b[i];
+  if (i < N_ELEMS) c[i] = a[i] + b[i];
+}
+
+/*
+ * Varianti per l'autotuner di Gpu_OpenCL_Accelerator: ogni work-item somma vettori da 1, 4 o 8
+ * int (vload/vstore) e scorre l'array a passi di get_global_size(0), quindi il numero di
+ * elementi per work-item dipende solo dalla dimensione globale del lancio. Gli ultimi n % W
+ * elementi vengono sommati uno alla volta.
+ */
+__kernel void vecAdd_v1(__global const int* a,
+                        __global const int* b,
+                        __global int* c,
+                        const uint n) {
+  for (uint i = get_global_id(0); i < N_ELEMS; i += get_global_size(0))
+    c[i] = a[i] + b[i];
+}
+
+__kernel void vecAdd_v4(__global const int* a,
+                        __global const int* b,
+                        __global int* c,
+                        const uint n) {
+  const uint stride = get_global_size(0);
+  for (uint v = get_global_id(0); v < N_ELEMS / 4; v += stride)
+    vstore4(vload4(v, a) + vload4(v, b), v, c);
+  for (uint i = (N_ELEMS / 4) * 4 + get_global_id(0); i < N_ELEMS; i += stride)
+    c[i] = a[i] + b[i];
+}
+
+__kernel void vecAdd_v8(__global const int* a,
+                        __global const int* b,
+                        __global int* c,
+                        const uint n) {
+  const uint stride = get_global_size(0);
+  for (uint v = get_global_id(0); v < N_ELEMS / 8; v += stride)
+    vstore8(vload8(v, a) + vload8(v, b), v, c);
+  for (uint i = (N_ELEMS / 8) * 8 + get_global_id(0); i < N_ELEMS; i += stride)
+    c[i] = a[i] + b[i];
 }
@@ -0,0 +1,30 @@
+#!/bin/bash
+# Curva throughput / latenza p99 del batching dei task piccoli.
+#
+# Esegue lo stesso benchmark con budget di batch crescenti e stampa una tabella CSV
+# (batch_bytes, throughput in task/s, p50 e p99 in ms), da usare per scegliere il compromesso fra
+# throughput e latenza aggiunta.
+#
+# Uso: scripts/batch_sweep.sh [N] [NUM_TASKS] [DEVICE] [KERNEL] [LATENCY_US]
+# Esempio: scripts/batch_sweep.sh 10000 2000 gpu_opencl kernels/gpu/vecAdd.cl 500
+
+N=${1:-10000}
+NUM_TASKS=${2:-2000}
+DEVICE=${3:-gpu_opencl}
+KERNEL=${4:-kernels/gpu/vecAdd.cl}
+LATENCY_US=${5:-200}
+EXEC=${EXEC:-./build/tesi-exec}
+
+TASK_BYTES=$((3 * 4 * N))
+
+echo "batch_bytes,tasks_per_batch,throughput_tasks_s,p50_ms,p99_ms"
+for TASKS_PER_BATCH in 0 2 4 8 16 32 64; do
+   BATCH_BYTES=$((TASKS_PER_BATCH * TASK_BYTES))
+   OUT=$("$EXEC" "$N" "$NUM_TASKS" "$DEVICE" "$KERNEL" --batch-bytes="$BATCH_BYTES" \
+      --batch-latency-us="$LATENCY_US" 2>/dev/null)
+
+   THROUGHPUT=$(echo "$OUT" | awk '/^Throughput:/ {print $2}')
+   P50=$(echo "$OUT" | awk '/p50:/ {print $2}')
+   P99=$(echo "$OUT" | awk '/p99:/ {print $5}')
+   echo "$BATCH_BYTES,$TASKS_PER_BATCH,$THROUGHPUT,$P50,$P99"
+done
@@ -1,26 +1,47 @@
 #include "BufferManager.hpp"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 
+#if !defined(__APPLE__) && __has_include(<CL/cl_ext_xilinx.h>)
+#include <CL/cl_ext_xilinx.h>
+#endif
+
 /**
- * @brief Costruttore: inizializza il pool di buffer.
+ * @brief Costruttore: inizializza il pool di buffer. Il set i appartiene al gruppo
+ * i % num_groups e gli indici liberi partono in ordine, quindi i set acquisiti
+ * uno dopo l'altro si alternano fra le compute unit.
  */
-BufferManager::BufferManager(cl_context context) : context_(context) {
-   buffer_pool_.resize(POOL_SIZE);
-   for (size_t i = 0; i < POOL_SIZE; ++i)
+BufferManager::BufferManager(cl_context context, size_t num_groups, bool bank_aware,
+                             bool use_host_ptr)
+    : context_(context), num_groups_(std::max<size_t>(1, num_groups)), bank_aware_(bank_aware),
+      use_host_ptr_(use_host_ptr) {
+   size_t pool_size = num_groups_ > 1 ? num_groups_ * SETS_PER_GROUP : POOL_SIZE;
+   buffer_pool_.resize(pool_size);
+   free_buffer_indices_ = RingBuffer<size_t>(pool_size); // Non cresce mai
+   for (size_t i = 0; i < pool_size; ++i) {
+      buffer_pool_[i].group = i % num_groups_;
       free_buffer_indices_.push(i);
+   }
 }
 
 /**
- * @brief Distruttore: rilascia tutti i buffer di memoria nel pool.
+ * @brief Distruttore: rilascia tutti i buffer di memoria e i kernel del pool, poi
+ * la memoria host su cui erano creati i buffer (se presente).
  */
 BufferManager::~BufferManager() {
    for (auto &buffer_set : buffer_pool_) {
+      if (buffer_set.kernel)
+         clReleaseKernel(buffer_set.kernel);
       if (buffer_set.bufferA)
          clReleaseMemObject(buffer_set.bufferA);
       if (buffer_set.bufferB)
          clReleaseMemObject(buffer_set.bufferB);
       if (buffer_set.bufferC)
          clReleaseMemObject(buffer_set.bufferC);
+      std::free(buffer_set.hostA);
+      std::free(buffer_set.hostB);
+      std::free(buffer_set.hostC);
    }
 }
 
@@ -29,44 +50,121 @@ BufferManager::BufferSet &BufferManager::get_buffer_set(size_t index) {
 }
 
 /**
- * @brief Helper per allocare o riallocare la memoria per tutti i buffer del
- * pool. Viene invocata al primo utilizzo o quando un task richiede una
- * dimensione di dati differente da quella corrente.
+ * @brief Crea il kernel di ogni set. Gli argomenti 0-2 (i buffer) vengono legati
+ * all'allocazione del set, l'argomento 3 (n) solo quando cambia.
  */
-bool BufferManager::reallocate_buffers_if_needed(size_t required_size_bytes) {
-   if (allocated_size_bytes_ == required_size_bytes)
+bool BufferManager::create_kernels(cl_program program, const std::string &kernel_name) {
+   return create_kernels(program, std::vector<std::string>(num_groups_, kernel_name));
+}
+
+bool BufferManager::create_kernels(cl_program program,
+                                   const std::vector<std::string> &group_kernel_names) {
+   cl_int ret;
+   for (auto &buffer_set : buffer_pool_) {
+      const std::string &name = group_kernel_names[buffer_set.group];
+      buffer_set.kernel = clCreateKernel(program, name.c_str(), &ret);
+      if (!buffer_set.kernel || ret != CL_SUCCESS) {
+         std::cerr << "[ERROR] BufferManager: Failed to create kernel object.\n";
+         return false;
+      }
+   }
+   return true;
+}
+
+/**
+ * @brief Helper per allocare o riallocare la memoria di un set di buffer. Viene
+ * invocata al primo utilizzo del set o quando un task richiede una dimensione
+ * di dati maggiore di quella corrente. I task più piccoli usano i buffer già
+ * allocati, così task di dimensione variabile (es. la parte acceleratore di un
+ * task ibrido) non causano una riallocazione ciascuno. Gli altri set, che
+ * possono essere in uso sul device, non vengono toccati.
+ *
+ * Con use_host_ptr i buffer vengono creati con CL_MEM_USE_HOST_PTR su memoria
+ * host allineata a HOST_ALIGNMENT: il runtime Xilinx può fare DMA direttamente da
+ * quella memoria, senza una copia interna in un'area allineata.
+ */
+bool BufferManager::reallocate_buffer_set_if_needed(size_t index, size_t required_size_bytes) {
+   auto &buffer_set = buffer_pool_[index];
+   if (buffer_set.allocated_size_bytes >= required_size_bytes)
       return true; // Nessuna riallocazione necessaria
 
-   std::cerr << "  [BufferManager - DEBUG] Allocating pool buffers for "
+   std::cerr << "  [BufferManager - DEBUG] Allocating buffer set " << index << " for "
              << required_size_bytes << " bytes\n";
 
    // Rilascia eventuali buffer esistenti.
-   for (auto &buffer_set : buffer_pool_) {
-      if (buffer_set.bufferA)
-         clReleaseMemObject(buffer_set.bufferA);
-      if (buffer_set.bufferB)
-         clReleaseMemObject(buffer_set.bufferB);
-      if (buffer_set.bufferC)
-         clReleaseMemObject(buffer_set.bufferC);
-   }
+   if (buffer_set.bufferA)
+      clReleaseMemObject(buffer_set.bufferA);
+   if (buffer_set.bufferB)
+      clReleaseMemObject(buffer_set.bufferB);
+   if (buffer_set.bufferC)
+      clReleaseMemObject(buffer_set.bufferC);
+   std::free(buffer_set.hostA);
+   std::free(buffer_set.hostB);
+   std::free(buffer_set.hostC);
+   buffer_set.hostA = buffer_set.hostB = buffer_set.hostC = nullptr;
 
-   // Alloca nuovi buffer.
+   // Alloca nuovi buffer. C è anche letto dai kernel delle riduzioni (atomiche dell'istogramma,
+   // combinazione dei parziali sul device).
+   cl_mem_flags flags[3] = {CL_MEM_READ_ONLY, CL_MEM_READ_ONLY, CL_MEM_READ_WRITE};
+   void *host_ptrs[3] = {nullptr, nullptr, nullptr};
+   if (use_host_ptr_) {
+      // aligned_alloc vuole una dimensione multipla dell'allineamento.
+      size_t host_bytes =
+         (required_size_bytes + HOST_ALIGNMENT - 1) / HOST_ALIGNMENT * HOST_ALIGNMENT;
+      buffer_set.hostA = std::aligned_alloc(HOST_ALIGNMENT, host_bytes);
+      buffer_set.hostB = std::aligned_alloc(HOST_ALIGNMENT, host_bytes);
+      buffer_set.hostC = std::aligned_alloc(HOST_ALIGNMENT, host_bytes);
+      if (!buffer_set.hostA || !buffer_set.hostB || !buffer_set.hostC) {
+         std::cerr << "[ERROR] BufferManager: Failed to allocate aligned host memory.\n";
+         return false;
+      }
+      void *host_mem[3] = {buffer_set.hostA, buffer_set.hostB, buffer_set.hostC};
+      for (int arg = 0; arg < 3; ++arg) {
+         flags[arg] |= CL_MEM_USE_HOST_PTR;
+         host_ptrs[arg] = host_mem[arg];
+      }
+   }
+#ifdef CL_MEM_EXT_PTR_XILINX
+   // Con più compute unit ognuna può essere collegata a un banco DDR/HBM diverso: passando
+   // il kernel e l'indice dell'argomento, XRT alloca il buffer nel banco di quell'argomento.
+   cl_mem_ext_ptr_t ext[3];
+   if (bank_aware_ && buffer_set.kernel) {
+      for (unsigned int arg = 0; arg < 3; ++arg) {
+         ext[arg] = {};
+         ext[arg].flags = arg;
+         ext[arg].obj = host_ptrs[arg]; // Memoria host del buffer, se usata
+         ext[arg].param = buffer_set.kernel;
+         flags[arg] |= CL_MEM_EXT_PTR_XILINX;
+         host_ptrs[arg] = &ext[arg];
+      }
+   }
+#endif
    cl_int ret;
-   for (size_t i = 0; i < POOL_SIZE; ++i) {
-      buffer_pool_[i].bufferA = clCreateBuffer(context_, CL_MEM_READ_ONLY,
-                                               required_size_bytes, NULL, &ret);
-      buffer_pool_[i].bufferB = clCreateBuffer(context_, CL_MEM_READ_ONLY,
-                                               required_size_bytes, NULL, &ret);
-      buffer_pool_[i].bufferC = clCreateBuffer(context_, CL_MEM_WRITE_ONLY,
-                                               required_size_bytes, NULL, &ret);
+   cl_int ret_a, ret_b;
+   buffer_set.bufferA =
+      clCreateBuffer(context_, flags[0], required_size_bytes, host_ptrs[0], &ret_a);
+   buffer_set.bufferB =
+      clCreateBuffer(context_, flags[1], required_size_bytes, host_ptrs[1], &ret_b);
+   buffer_set.bufferC =
+      clCreateBuffer(context_, flags[2], required_size_bytes, host_ptrs[2], &ret);
+   if (ret_a != CL_SUCCESS || ret_b != CL_SUCCESS || ret != CL_SUCCESS) {
+      std::cerr << "[ERROR] BufferManager: Failed to allocate buffer set.\n";
+      return false;
+   }
+
+   // Lega i nuovi buffer al kernel del set.
+   if (buffer_set.kernel) {
+      ret = clSetKernelArg(buffer_set.kernel, 0, sizeof(cl_mem), &buffer_set.bufferA);
+      ret |= clSetKernelArg(buffer_set.kernel, 1, sizeof(cl_mem), &buffer_set.bufferB);
+      ret |= clSetKernelArg(buffer_set.kernel, 2, sizeof(cl_mem), &buffer_set.bufferC);
       if (ret != CL_SUCCESS) {
-         std::cerr
-            << "[ERROR] BufferManager: Failed to allocate buffer pool.\n";
+         std::cerr << "[ERROR] BufferManager: Failed to bind buffers to the kernel.\n";
          return false;
       }
    }
 
-   allocated_size_bytes_ = required_size_bytes;
+   buffer_set.allocated_size_bytes = required_size_bytes;
+   buffer_set.generation++;
    return true;
 }
 
@@ -2,9 +2,11 @@
 
 #include <condition_variable>
 #include <mutex>
-#include <queue>
+#include <string>
 #include <vector>
 
+#include "../common/RingBuffer.hpp"
+
 #ifdef __APPLE__
 #include <OpenCL/opencl.h>
 #else
@@ -15,32 +17,69 @@
  * @brief Gestisce un pool di set di buffer OpenCL. Incapsula la logica per
  * l'acquisizione, il rilascio e la riallocazione dei buffer di memoria sul
  * device.
+ *
+ * Ogni set ha anche il proprio oggetto kernel, con i buffer già impostati come
+ * argomenti: chi possiede un set può lanciare il kernel senza toccare stato
+ * condiviso, quindi più thread producer possono usare set diversi in parallelo.
+ *
+ * I set possono essere divisi in gruppi, uno per compute unit del kernel (FPGA con
+ * più CU): il kernel di un set è quello della sua CU e, se richiesto, i buffer
+ * vengono allocati nel banco di memoria collegato agli argomenti di quella CU.
  */
 class BufferManager {
  public:
-   explicit BufferManager(cl_context context);
+   // num_groups: gruppi di set (compute unit). bank_aware: alloca i buffer nel banco di
+   // memoria dell'argomento del kernel del set (estensione Xilinx, se disponibile).
+   // use_host_ptr: crea i buffer su memoria host allineata di proprietà del set.
+   explicit BufferManager(cl_context context, size_t num_groups = 1, bool bank_aware = false,
+                          bool use_host_ptr = false);
    ~BufferManager();
 
-   // Set di buffer, 2 per input e 1 per l'output.
+   // Set di buffer, 2 per input e 1 per l'output, con il kernel che li usa.
    struct BufferSet {
       cl_mem bufferA{nullptr};
       cl_mem bufferB{nullptr};
       cl_mem bufferC{nullptr};
+      cl_kernel kernel{nullptr};     // Kernel del set, argomenti 0-2 legati ai buffer
+      size_t allocated_size_bytes{0}; // Dimensione attualmente allocata per i buffer del set
+      unsigned int bound_n{0};        // Ultimo valore dell'argomento n (3) impostato
+      unsigned int generation{0};     // Allocazioni dei buffer fatte (cambiano i cl_mem)
+      size_t group{0};                // Gruppo (compute unit) a cui appartiene il set
+      // Memoria host allineata su cui sono creati i buffer (solo con use_host_ptr).
+      void *hostA{nullptr};
+      void *hostB{nullptr};
+      void *hostC{nullptr};
    };
 
+   // Crea un oggetto kernel per ogni set. Va chiamata una volta, dopo la compilazione.
+   bool create_kernels(cl_program program, const std::string &kernel_name);
+   // Come sopra, con il nome del kernel di ogni gruppo (es. "krnl:{krnl_1}" per la prima CU).
+   bool create_kernels(cl_program program, const std::vector<std::string> &group_kernel_names);
+
+   size_t num_groups() const { return num_groups_; }
+   size_t size() const { return buffer_pool_.size(); }
+
    // Metodi per l'acquisizione e il rilascio dei buffer.
    size_t acquire_buffer_set();
    void release_buffer_set(size_t index);
 
-   // Viene chiamata la prima volta o quando un task arriva con una
-   // dimensione di dati diversa da quella per cui i buffer sono stati allocati.
-   bool reallocate_buffers_if_needed(size_t required_size_bytes);
+   // Viene chiamata la prima volta o quando un task arriva con una dimensione di dati
+   // maggiore di quella per cui i buffer del set sono stati allocati. Tocca solo il set
+   // indicato, quindi può essere chiamata in parallelo da chi possiede set diversi.
+   bool reallocate_buffer_set_if_needed(size_t index, size_t required_size_bytes);
 
    // Restituisce un riferimento a un set di buffer specifico.
    BufferSet &get_buffer_set(size_t index);
 
  private:
    cl_context context_; // Contesto OpenCL per creare i buffer
+   size_t num_groups_;
+   bool bank_aware_;
+   bool use_host_ptr_;
+
+   // Allineamento della memoria host dei buffer: una pagina, come richiesto da XRT per il DMA
+   // senza copie.
+   static constexpr size_t HOST_ALIGNMENT = 4096;
 
    // Dati per il pool di buffer nel device e per la gestione della concorrenza.
    const size_t POOL_SIZE =
@@ -50,11 +89,11 @@ class BufferManager {
          // ! l'OS o potrebber fallire l'alloc su FPGA, inoltre non aumenterebbe il throughput.
          // ! Se usassi POOL_SIZE = 100, dovrei allocare 9GB di VRAM su FPGA!
          // ! Con POOL_SIZE = 3 ho un buon compromesso fra performance e minimo utilizzo di memoria.
+   // Con più gruppi bastano 2 set per CU (uno in trasferimento, uno in calcolo) per tenerle
+   // tutte occupate senza moltiplicare la memoria per POOL_SIZE.
+   const size_t SETS_PER_GROUP = 2;
    std::vector<BufferSet> buffer_pool_;
-   std::queue<size_t> free_buffer_indices_;
+   RingBuffer<size_t> free_buffer_indices_;
    std::mutex pool_mutex_;
    std::condition_variable buffer_available_cond_;
-
-   // Dimensione attualmente allocata per i buffer nel pool.
-   size_t allocated_size_bytes_{0};
 };
@@ -0,0 +1,89 @@
+#include "DeviceDiscovery.hpp"
+#include <algorithm>
+#include <iostream>
+
+/**
+ * @brief Enumera i device di tutte le piattaforme, non solo della prima come fa initialize()
+ * degli acceleratori quando non riceve un device già scelto.
+ */
+std::vector<cl_device_id> discover_devices(cl_device_type type, size_t sub_devices) {
+   std::vector<cl_device_id> devices;
+
+   cl_uint num_platforms = 0;
+   if (clGetPlatformIDs(0, NULL, &num_platforms) != CL_SUCCESS || num_platforms == 0)
+      return devices;
+
+   std::vector<cl_platform_id> platforms(num_platforms);
+   clGetPlatformIDs(num_platforms, platforms.data(), NULL);
+
+   for (cl_platform_id platform : platforms) {
+      cl_uint num_devices = 0;
+      if (clGetDeviceIDs(platform, type, 0, NULL, &num_devices) != CL_SUCCESS ||
+          num_devices == 0)
+         continue;
+
+      std::vector<cl_device_id> platform_devices(num_devices);
+      clGetDeviceIDs(platform, type, num_devices, platform_devices.data(), NULL);
+      devices.insert(devices.end(), platform_devices.begin(), platform_devices.end());
+   }
+
+   if (sub_devices == 0 || devices.empty())
+      return devices;
+
+   // Partiziona il primo device in sub-device con lo stesso numero di compute unit.
+   cl_uint max_compute_units = 0;
+   clGetDeviceInfo(devices[0], CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &max_compute_units,
+                   NULL);
+   cl_uint units_per_sub = std::max<cl_uint>(1, max_compute_units / sub_devices);
+
+   const cl_device_partition_property props[] = {CL_DEVICE_PARTITION_EQUALLY,
+                                                 (cl_device_partition_property)units_per_sub, 0};
+   cl_uint num_sub = 0;
+   if (clCreateSubDevices(devices[0], props, 0, NULL, &num_sub) != CL_SUCCESS || num_sub == 0) {
+      std::cerr << "[WARNING] DeviceDiscovery: Device does not support partitioning, using the "
+                   "root devices.\n";
+      return devices;
+   }
+
+   std::vector<cl_device_id> subs(num_sub);
+   clCreateSubDevices(devices[0], props, num_sub, subs.data(), NULL);
+
+   // clCreateSubDevices può restituire più partizioni di quelle richieste.
+   for (size_t i = sub_devices; i < subs.size(); ++i)
+      clReleaseDevice(subs[i]);
+   subs.resize(std::min<size_t>(sub_devices, subs.size()));
+
+   std::cerr << "[DeviceDiscovery] Partitioned '" << get_device_name(devices[0]) << "' into "
+             << subs.size() << " sub-devices of " << units_per_sub << " compute units.\n";
+   return subs;
+}
+
+void release_device(cl_device_id device) {
+   cl_device_id parent = nullptr;
+   if (device &&
+       clGetDeviceInfo(device, CL_DEVICE_PARENT_DEVICE, sizeof(parent), &parent, NULL) ==
+          CL_SUCCESS &&
+       parent)
+      clReleaseDevice(device);
+}
+
+cl_device_type parse_device_type(const std::string &type_name) {
+   if (type_name == "cpu")
+      return CL_DEVICE_TYPE_CPU;
+   if (type_name == "accelerator")
+      return CL_DEVICE_TYPE_ACCELERATOR;
+   if (type_name == "all")
+      return CL_DEVICE_TYPE_ALL;
+   return CL_DEVICE_TYPE_GPU;
+}
+
+std::string get_device_name(cl_device_id device) {
+   size_t size = 0;
+   if (clGetDeviceInfo(device, CL_DEVICE_NAME, 0, NULL, &size) != CL_SUCCESS || size == 0)
+      return "unknown";
+
+   std::string name(size, '\0');
+   clGetDeviceInfo(device, CL_DEVICE_NAME, size, &name[0], NULL);
+   name.resize(name.find('\0') == std::string::npos ? name.size() : name.find('\0'));
+   return name;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+/**
+ * @brief Enumera tutti i device OpenCL del tipo richiesto su tutte le piattaforme disponibili.
+ *
+ * @param type Tipo di device (CL_DEVICE_TYPE_GPU, CL_DEVICE_TYPE_ACCELERATOR, ...).
+ * @param sub_devices Se > 0, il primo device trovato viene partizionato in questo numero di
+ * sub-device equivalenti e vengono restituiti solo questi.
+ * @return I device trovati (vuoto se nessuno). I sub-device appartengono al chiamante, che li
+ * rilascia con release_device() (gli acceleratori lo fanno per il device che ricevono).
+ */
+std::vector<cl_device_id> discover_devices(cl_device_type type, size_t sub_devices = 0);
+
+// Rilascia un sub-device creato da discover_devices(); sui device radice non fa nulla.
+void release_device(cl_device_id device);
+
+// Converte "gpu", "cpu", "accelerator" o "all" nel corrispondente cl_device_type.
+cl_device_type parse_device_type(const std::string &type_name);
+
+// Restituisce il nome leggibile di un device OpenCL.
+std::string get_device_name(cl_device_id device);
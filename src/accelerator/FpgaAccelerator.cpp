@@ -1,5 +1,8 @@
 #include "FpgaAccelerator.hpp"
+#include "DeviceDiscovery.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -26,9 +29,16 @@
  * @brief Il costruttrore prende in input il nome della funzione kernel e il suo
  * path.
  */
-FpgaAccelerator::FpgaAccelerator(const std::string &kernel_path,
-                                 const std::string &kernel_name)
-    : kernel_path_(kernel_path), kernel_name_(kernel_name) {}
+FpgaAccelerator::FpgaAccelerator(const std::string &kernel_path, const std::string &kernel_name,
+                                 cl_device_id device, size_t max_compute_units, bool migrate)
+    : device_(device), kernel_path_(kernel_path), kernel_name_(kernel_name),
+      max_compute_units_(max_compute_units), migrate_(migrate) {
+   const std::string wide_suffix = "_wide";
+   bool wide = kernel_name_.size() > wide_suffix.size() &&
+               kernel_name_.compare(kernel_name_.size() - wide_suffix.size(), wide_suffix.size(),
+                                    wide_suffix) == 0;
+   port_bytes_ = wide ? WIDE_PORT_BYTES : sizeof(int);
+}
 
 /**
  * @brief Il distruttore si occupa di rilasciare in ordine inverso tutte le
@@ -36,14 +46,19 @@ FpgaAccelerator::FpgaAccelerator(const std::string &kernel_path,
  distruttore di buffer_manager_.
  */
 FpgaAccelerator::~FpgaAccelerator() {
-   if (kernel_)
-      clReleaseKernel(kernel_);
+   // Attende i trasferimenti in corso, così le loro callback hanno aggiornato le statistiche.
+   for (cl_command_queue queue : queues_)
+      clFinish(queue);
+   print_transfer_stats();
+
+   buffer_manager_.reset(); // Rilascia buffer e kernel prima del programma
    if (program_)
       clReleaseProgram(program_);
-   if (queue_)
-      clReleaseCommandQueue(queue_);
+   for (cl_command_queue queue : queues_)
+      clReleaseCommandQueue(queue);
    if (context_)
       clReleaseContext(context_);
+   release_device(device_); // Solo se è un sub-device
 
    std::cerr << "[FpgaAccelerator] Destroyed and OpenCL resources released.\n";
 }
@@ -57,35 +72,26 @@ FpgaAccelerator::~FpgaAccelerator() {
 bool FpgaAccelerator::initialize() {
    cl_int ret; // Codice di ritorno delle chiamate OpenCL.
    cl_platform_id platform_id = NULL;
-   cl_device_id device_id = NULL;
 
-   // Trova una piattaforma OpenCL e un dispositivo di tipo ACCELERATOR.
-   OCL_CHECK(ret, clGetPlatformIDs(1, &platform_id, NULL), return false);
-   OCL_CHECK(ret,
-             clGetDeviceIDs(platform_id, CL_DEVICE_TYPE_ACCELERATOR, 1,
-                            &device_id, NULL),
-             {
-                std::cerr << "[FATAL] FPGA not found.\n";
-                exit(EXIT_FAILURE);
-             });
+   // Se il device non è stato scelto dal chiamante (es. farm multi-device), trova una
+   // piattaforma OpenCL e un dispositivo di tipo ACCELERATOR.
+   if (!device_) {
+      OCL_CHECK(ret, clGetPlatformIDs(1, &platform_id, NULL), return false);
+      OCL_CHECK(ret,
+                clGetDeviceIDs(platform_id, CL_DEVICE_TYPE_ACCELERATOR, 1, &device_, NULL),
+                {
+                   std::cerr << "[ERROR] FpgaAccelerator: FPGA not found.\n";
+                   return false;
+                });
+   }
 
    // Crea un contesto
-   context_ = clCreateContext(NULL, 1, &device_id, NULL, NULL, &ret);
+   context_ = clCreateContext(NULL, 1, &device_, NULL, NULL, &ret);
    if (!context_) {
       std::cerr << "[ERROR] FpgaAccelerator: Failed creating OpenCL context.\n";
       return false;
    }
 
-   // Crea la coda di comandi
-   queue_ = clCreateCommandQueue(context_, device_id, 0, &ret);
-   if (!queue_) {
-      std::cerr << "[ERROR] FpgaAccelerator: Failed to create command queue.\n";
-      return false;
-   }
-
-   // Chiama il costruttore di BufferManager che iniializza il pool di buffer.
-   buffer_manager_ = std::make_unique<BufferManager>(context_);
-
    // Caricamento del file binario dell'FPGA (.xclbin).
    std::ifstream binaryFile(kernel_path_, std::ios::binary);
 
@@ -108,7 +114,7 @@ bool FpgaAccelerator::initialize() {
    const size_t binary_sizes[] = {binarySize};
 
    // Crea il programma con il binario xclbin caricato.
-   program_ = clCreateProgramWithBinary(context_, 1, &device_id, binary_sizes,
+   program_ = clCreateProgramWithBinary(context_, 1, &device_, binary_sizes,
                                         binaries, NULL, &ret);
    if (!program_ || ret != CL_SUCCESS) {
       std::cerr
@@ -120,17 +126,62 @@ bool FpgaAccelerator::initialize() {
    // compilato => l'inizializzazione dell'FPGA è molto più veloce di
    // quella della GPU.
 
-   // Crea il kernel.
-   kernel_ = clCreateKernel(program_, kernel_name_.c_str(), &ret);
-   if (!kernel_ || ret != CL_SUCCESS) {
+   // Trova le compute unit del kernel e crea una coda di comandi per ognuna.
+   std::vector<std::string> cu_names = discover_compute_units();
+   for (size_t i = 0; i < cu_names.size(); ++i) {
+      // Il profiling serve a misurare la durata dei trasferimenti (vedi record_transfer).
+      cl_command_queue queue =
+         clCreateCommandQueue(context_, device_, CL_QUEUE_PROFILING_ENABLE, &ret);
+      if (!queue) {
+         std::cerr << "[ERROR] FpgaAccelerator: Failed to create command queue.\n";
+         return false;
+      }
+      queues_.push_back(queue);
+   }
+
+   // Chiama il costruttore di BufferManager che iniializza il pool di buffer, con un gruppo di
+   // buffer set per compute unit allocati nei banchi di memoria collegati alla CU. Con la
+   // migrazione i buffer sono creati su memoria host allineata (CL_MEM_USE_HOST_PTR).
+   buffer_manager_ = std::make_unique<BufferManager>(context_, cu_names.size(), true, migrate_);
+
+   // Crea un kernel per ogni buffer set, quello della CU del suo gruppo.
+   if (!buffer_manager_->create_kernels(program_, cu_names)) {
       std::cerr << "[ERROR] FpgaAccelerator: Failed to create kernel.\n";
       exit(EXIT_FAILURE);
    }
 
-   std::cerr << "[FpgaAccelerator] Initialization successful.\n";
+   std::cerr << "[FpgaAccelerator] Initialization successful (" << cu_names.size()
+             << " compute units).\n";
    return true;
 }
 
+/**
+ * @brief Cerca le compute unit del kernel con i nomi assegnati di default da v++
+ * (kernel_1, kernel_2, ...): XRT accetta "kernel:{cu}" come nome del kernel per
+ * legare l'oggetto kernel a una sola CU. Se non ne trova nessuna (runtime non
+ * Xilinx o CU con nomi personalizzati) usa il kernel senza CU, che XRT
+ * distribuisce da solo.
+ */
+std::vector<std::string> FpgaAccelerator::discover_compute_units() {
+   std::vector<std::string> names;
+   size_t limit = max_compute_units_ > 0 ? std::min(max_compute_units_, MAX_COMPUTE_UNITS)
+                                         : MAX_COMPUTE_UNITS;
+
+   for (size_t i = 1; i <= limit; ++i) {
+      std::string name = kernel_name_ + ":{" + kernel_name_ + "_" + std::to_string(i) + "}";
+      cl_int ret;
+      cl_kernel probe = clCreateKernel(program_, name.c_str(), &ret);
+      if (!probe || ret != CL_SUCCESS)
+         break;
+      clReleaseKernel(probe);
+      names.push_back(name);
+   }
+
+   if (names.empty())
+      names.push_back(kernel_name_);
+   return names;
+}
+
 size_t FpgaAccelerator::acquire_buffer_set() {
    return buffer_manager_->acquire_buffer_set();
 }
@@ -139,6 +190,8 @@ void FpgaAccelerator::release_buffer_set(size_t index) {
    buffer_manager_->release_buffer_set(index);
 }
 
+size_t FpgaAccelerator::buffer_set_count() const { return buffer_manager_->size(); }
+
 /**
  * @brief Stadio 1 (Upload).
  * Fa l'upload dei dati di input A e B dall'host alla device memory.
@@ -153,29 +206,55 @@ void FpgaAccelerator::send_data_to_device(void *task_context) {
    std::cerr << "[FpgaAccelerator - START] Processing task " << task->id
              << " with N=" << task->n << "...\n";
 
-   // Se la dimensione richiesta è diversa da quella allocata, rialloca
-   // tutti i buffer del pool e ottieni il set di buffer.
+   // Se la dimensione richiesta è maggiore di quella allocata, rialloca
+   // i buffer del set del task e ottieni il set di buffer. Con i kernel "_wide"
+   // l'ultimo beat viene letto e scritto per intero: l'allocazione è arrotondata
+   // al beat, mentre i trasferimenti restano di n elementi.
    size_t required_size_bytes = sizeof(int) * task->n;
-   buffer_manager_->reallocate_buffers_if_needed(required_size_bytes);
+   size_t padded_size_bytes = (required_size_bytes + port_bytes_ - 1) / port_bytes_ * port_bytes_;
+   buffer_manager_->reallocate_buffer_set_if_needed(task->buffer_idx, padded_size_bytes);
    auto &current_buffers = buffer_manager_->get_buffer_set(task->buffer_idx);
+   cl_command_queue queue = queues_[current_buffers.group];
+
+   if (migrate_) {
+      // Copia gli input nella memoria host allineata dei buffer e li migra sul device con
+      // un'unica operazione, nella coda della CU del buffer set.
+      std::memcpy(current_buffers.hostA, task->a, required_size_bytes);
+      std::memcpy(current_buffers.hostB, task->b, required_size_bytes);
+      cl_mem inputs[2] = {current_buffers.bufferA, current_buffers.bufferB};
+      OCL_CHECK(ret,
+                clEnqueueMigrateMemObjects(queue, 2, inputs, 0, 0, NULL, &task->event),
+                return);
+      // La migrazione sposta i buffer interi, ma si contano i byte utili del task come nelle
+      // scritture, così le due modalità sono confrontabili.
+      h2d_bytes_ += 2 * required_size_bytes;
+      track_transfer(task->event, h2d_ns_);
+      return;
+   }
 
-   // Scrive i due input sulla device memory.
+   // Scrive i due input sulla device memory, nella coda della CU del buffer set.
+   cl_event write_a = nullptr;
    OCL_CHECK(ret,
-             clEnqueueWriteBuffer(queue_, current_buffers.bufferA, CL_FALSE, 0,
-                                  required_size_bytes, task->a, 0, NULL, NULL),
+             clEnqueueWriteBuffer(queue, current_buffers.bufferA, CL_FALSE, 0,
+                                  required_size_bytes, task->a, 0, NULL, &write_a),
              return);
+   track_transfer(write_a, h2d_ns_);
+   clReleaseEvent(write_a);
    OCL_CHECK(ret,
-             clEnqueueWriteBuffer(queue_, current_buffers.bufferB, CL_FALSE, 0,
+             clEnqueueWriteBuffer(queue, current_buffers.bufferB, CL_FALSE, 0,
                                   required_size_bytes, task->b, 0, NULL,
                                   &task->event),
              return);
+   track_transfer(task->event, h2d_ns_);
+   h2d_bytes_ += 2 * required_size_bytes;
 }
 
 /**
  * @brief Stadio 2 (Execute).
- * Imposta gli argomenti del kernel e accoda la sua esecuzione, rilasciando
- * l'evento del completamento del trasferimento dati e ottenendo un nuovo evento
- * che rappresenta il completamento del kernel.
+ * Accoda l'esecuzione del kernel del buffer set, rilasciando l'evento del
+ * completamento del trasferimento dati e ottenendo un nuovo evento che
+ * rappresenta il completamento del kernel. I buffer sono già legati al kernel
+ * del set: si imposta solo n, e solo se è cambiato.
  */
 void FpgaAccelerator::execute_kernel(void *task_context) {
    cl_int ret; // Codice di ritorno delle chiamate OpenCL.
@@ -183,21 +262,17 @@ void FpgaAccelerator::execute_kernel(void *task_context) {
    auto &current_buffers = buffer_manager_->get_buffer_set(task->buffer_idx);
    cl_event previous_event = task->event;
 
-   // Imposta gli argomenti del kernel.
-   OCL_CHECK(
-      ret, clSetKernelArg(kernel_, 0, sizeof(cl_mem), &current_buffers.bufferA),
-      return);
-   OCL_CHECK(
-      ret, clSetKernelArg(kernel_, 1, sizeof(cl_mem), &current_buffers.bufferB),
-      return);
-   OCL_CHECK(
-      ret, clSetKernelArg(kernel_, 2, sizeof(cl_mem), &current_buffers.bufferC),
-      return);
-   OCL_CHECK(ret, clSetKernelArg(kernel_, 3, sizeof(int), &(task->n)), return);
+   unsigned int n = static_cast<unsigned int>(task->n);
+   if (current_buffers.bound_n != n) {
+      OCL_CHECK(ret, clSetKernelArg(current_buffers.kernel, 3, sizeof(unsigned int), &n),
+                return);
+      current_buffers.bound_n = n;
+   }
 
    // Accoda l'esecuzione del kernel.
    OCL_CHECK(ret,
-             clEnqueueTask(queue_, kernel_, 1, &previous_event, &task->event),
+             clEnqueueTask(queues_[current_buffers.group], current_buffers.kernel, 1,
+                           &previous_event, &task->event),
              return);
 
    // Rilascia l'evento precedente.
@@ -220,13 +295,31 @@ void FpgaAccelerator::get_results_from_device(void *task_context,
    cl_event previous_event = task->event;
 
    auto t0 = std::chrono::steady_clock::now();
-
-   // Recupera i risultati dalla device memory alla memoria host.
-   OCL_CHECK(ret,
-             clEnqueueReadBuffer(queue_, current_buffers.bufferC, CL_TRUE, 0,
-                                 required_size_bytes, task->c, 1,
-                                 &previous_event, NULL),
-             return);
+   cl_event download = nullptr;
+
+   if (migrate_) {
+      // Migra il buffer di output sull'host con un'unica operazione, attende e copia i
+      // risultati dalla memoria host allineata del buffer.
+      OCL_CHECK(ret,
+                clEnqueueMigrateMemObjects(queues_[current_buffers.group], 1,
+                                           &current_buffers.bufferC,
+                                           CL_MIGRATE_MEM_OBJECT_HOST, 1, &previous_event,
+                                           &download),
+                return);
+      OCL_CHECK(ret, clWaitForEvents(1, &download), return);
+      std::memcpy(task->c, current_buffers.hostC, required_size_bytes);
+      d2h_bytes_ += required_size_bytes;
+   } else {
+      // Recupera i risultati dalla device memory alla memoria host.
+      OCL_CHECK(ret,
+                clEnqueueReadBuffer(queues_[current_buffers.group], current_buffers.bufferC,
+                                    CL_TRUE, 0, required_size_bytes, task->c, 1,
+                                    &previous_event, &download),
+                return);
+      d2h_bytes_ += required_size_bytes;
+   }
+   track_transfer(download, d2h_ns_);
+   clReleaseEvent(download);
 
    // Rilascia l'evento precedente.
    if (previous_event)
@@ -239,4 +332,38 @@ void FpgaAccelerator::get_results_from_device(void *task_context,
       std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
 
    std::cerr << "[FpgaAccelerator - END] Task " << task->id << " finished.\n";
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Aggiunge a 'total_ns' la durata del trasferimento dell'evento, letta dal
+ * profiling della coda quando il comando è completato (in una callback, così gli
+ * stadi della pipeline non si fermano ad aspettarlo).
+ */
+void FpgaAccelerator::track_transfer(cl_event event, std::atomic<long long> &total_ns) {
+   auto on_complete = [](cl_event ev, cl_int status, void *user_data) {
+      if (status != CL_COMPLETE)
+         return;
+      cl_ulong start = 0, end = 0;
+      clGetEventProfilingInfo(ev, CL_PROFILING_COMMAND_START, sizeof(start), &start, NULL);
+      clGetEventProfilingInfo(ev, CL_PROFILING_COMMAND_END, sizeof(end), &end, NULL);
+      if (end > start)
+         *static_cast<std::atomic<long long> *>(user_data) += (long long)(end - start);
+   };
+   clSetEventCallback(event, CL_COMPLETE, on_complete, &total_ns);
+}
+
+/**
+ * @brief Stampa il throughput dei trasferimenti host -> device e device -> host,
+ * per confrontare la migrazione con le scritture/letture separate. In entrambe le
+ * modalità si contano i byte dei task, quindi i GB/s sono la banda utile.
+ */
+void FpgaAccelerator::print_transfer_stats() const {
+   if (h2d_bytes_ == 0)
+      return;
+
+   auto gbps = [](size_t bytes, long long ns) { return ns > 0 ? double(bytes) / ns : 0.0; };
+   std::cerr << "[FpgaAccelerator] Transfers (" << (migrate_ ? "migrate" : "write/read")
+             << "): H2D " << h2d_bytes_ / (1024 * 1024) << " MiB at "
+             << gbps(h2d_bytes_, h2d_ns_) << " GB/s, D2H " << d2h_bytes_ / (1024 * 1024)
+             << " MiB at " << gbps(d2h_bytes_, d2h_ns_) << " GB/s.\n";
+}
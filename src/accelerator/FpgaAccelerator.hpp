@@ -2,7 +2,9 @@
 
 #include "BufferManager.hpp"
 #include "IAccelerator.hpp"
+#include <atomic>
 #include <string>
+#include <vector>
 
 #ifdef __APPLE__
 #include <OpenCL/opencl.h>
@@ -18,11 +20,30 @@
  * funzioni qui dichiarate send_data_to_device() e execute_kernel().
  * - Il thread Consumer esegue lo stadio di Download, utilizzando la
  * funzione qui dichiarata get_results_from_device().
+ *
+ * Se il binario contiene più compute unit del kernel (link con nk=kernel:K), ogni
+ * CU ha la propria coda di comandi, il proprio gruppo di buffer set e il proprio
+ * oggetto kernel ("kernel:{kernel_i}"): i task vengono distribuiti fra le CU
+ * alternando i buffer set, e le CU lavorano in parallelo.
+ *
+ * Le varianti "_wide" dei kernel (porte m_axi da 512 bit) leggono e scrivono beat
+ * interi da 16 int: i buffer sul device vengono allocati con la dimensione
+ * arrotondata a un multiplo di WIDE_PORT_BYTES, e l'host trasferisce solo i primi
+ * n elementi.
+ *
+ * Con la migrazione (default) i buffer sono creati su memoria host allineata a
+ * 4 KB (CL_MEM_USE_HOST_PTR) e ogni direzione richiede un solo
+ * clEnqueueMigrateMemObjects: A e B insieme verso il device, C verso l'host.
+ * Altrimenti si usano le scritture e la lettura separate di OpenCL.
  */
 class FpgaAccelerator : public IAccelerator {
  public:
-   FpgaAccelerator(const std::string &kernel_path,
-                   const std::string &kernel_name);
+   // Se device è nullptr, initialize() usa il primo acceleratore della prima piattaforma.
+   // max_compute_units limita le CU usate (0 = tutte quelle trovate nel binario). migrate
+   // sceglie la migrazione dei buffer su memoria host allineata invece di write/read.
+   FpgaAccelerator(const std::string &kernel_path, const std::string &kernel_name,
+                   cl_device_id device = nullptr, size_t max_compute_units = 0,
+                   bool migrate = true);
    ~FpgaAccelerator() override;
 
    // Esegue tutte le operazioni di setup una volta sola (creare contesto,
@@ -32,6 +53,7 @@ class FpgaAccelerator : public IAccelerator {
    // Metodi per l'acquisizione e il rilascio dei buffer.
    size_t acquire_buffer_set() override;
    void release_buffer_set(size_t index) override;
+   size_t buffer_set_count() const override;
 
    // Metoodi utili per i thread della pipeline interna.
    void send_data_to_device(void *task_context) override;
@@ -40,10 +62,24 @@ class FpgaAccelerator : public IAccelerator {
                                 long long &computed_ns) override;
 
  private:
+   // Nomi "kernel:{cu}" delle compute unit del kernel nel programma (al più MAX_COMPUTE_UNITS).
+   std::vector<std::string> discover_compute_units();
+   static constexpr size_t MAX_COMPUTE_UNITS = 16;
+
+   // Statistiche dei trasferimenti, dal profiling degli eventi OpenCL.
+   static void track_transfer(cl_event event, std::atomic<long long> &total_ns);
+   void print_transfer_stats() const;
+
+   // Larghezza in byte di un beat delle porte dei kernel "_wide" (ap_uint<512>).
+   static constexpr size_t WIDE_PORT_BYTES = 64;
+
+   cl_device_id device_{nullptr};    // Il device OpenCL (scelto qui o dal chiamante)
    cl_context context_{nullptr};     // Il contesto OpenCL
-   cl_command_queue queue_{nullptr}; // La coda di comandi OpenCL
    cl_program program_{nullptr};     // Il programma OpenCL (kernel compilato)
-   cl_kernel kernel_{nullptr};       // Il kernel OpenCL (func da eseguire)
+
+   // Una coda di comandi in-order per compute unit: l'ordine upload -> kernel -> download di
+   // un task è garantito dalla coda, mentre le code di CU diverse procedono in parallelo.
+   std::vector<cl_command_queue> queues_;
 
    // Incapsula la logica per l'acquisizione, il rilascio e la riallocazione dei
    // buffer di memoria sul device.
@@ -51,4 +87,14 @@ class FpgaAccelerator : public IAccelerator {
 
    std::string kernel_path_;
    std::string kernel_name_;
+   size_t max_compute_units_;
+   size_t port_bytes_; // Granularità delle allocazioni: un beat della porta del kernel
+   bool migrate_;
+
+   // Byte dei task trasferiti (n elementi per vettore, in entrambe le modalità, anche se la
+   // migrazione sposta i buffer interi) e tempo dei trasferimenti sul device.
+   std::atomic<size_t> h2d_bytes_{0};
+   std::atomic<size_t> d2h_bytes_{0};
+   std::atomic<long long> h2d_ns_{0};
+   std::atomic<long long> d2h_ns_{0};
 };
\ No newline at end of file
@@ -23,6 +23,7 @@ class Gpu_Metal_Accelerator : public IAccelerator {
    // Metodi per l'acquisizione e il rilascio dei buffer.
    size_t acquire_buffer_set() override;
    void release_buffer_set(size_t index) override;
+   size_t buffer_set_count() const override;
 
    // Metoodi utili per i thread della pipeline interna.
    void send_data_to_device(void *task_context) override;
@@ -1,4 +1,5 @@
 #import "Gpu_Metal_Accelerator.hpp"
+#include "../common/RingBuffer.hpp"
 #include "../common/Task.hpp"
 #import <Metal/Metal.h>
 #include <chrono>
@@ -7,7 +8,6 @@
 #include <fstream>
 #include <iostream>
 #include <mutex>
-#include <queue>
 #include <vector>
 
 /**
@@ -27,6 +27,7 @@ class MetalBufferManager {
       id<MTLBuffer> bufferA{nullptr};
       id<MTLBuffer> bufferB{nullptr};
       id<MTLBuffer> bufferC{nullptr};
+      size_t allocated_size_bytes{0}; // Dimensione attualmente allocata per i buffer del set
    };
 
    /**
@@ -43,29 +44,27 @@ class MetalBufferManager {
 
    BufferSet &get_buffer_set(size_t index) { return buffer_pool_[index]; }
 
-   bool reallocate_buffers_if_needed(size_t required_size_bytes) {
-      if (allocated_size_bytes_ == required_size_bytes)
+   // Rialloca solo i buffer del set indicato: gli altri possono essere in uso sulla GPU.
+   bool reallocate_buffer_set_if_needed(size_t index, size_t required_size_bytes) {
+      // I buffer crescono soltanto: i task più piccoli riusano quelli già allocati.
+      auto &buffer_set = buffer_pool_[index];
+      if (buffer_set.allocated_size_bytes >= required_size_bytes)
          return true;
 
-      allocated_size_bytes_ = required_size_bytes;
-      // Su Apple Silicon la memoria è condivisa tra CPU e GPU, quindi possiamo accedere agli stessi
-      // dati senza copie esplicite sul bus PCIe.
+      buffer_set.allocated_size_bytes = required_size_bytes;
+      // Su Apple Silicon la memoria è condivisa tra CPU e GPU, quindi possiamo accedere agli
+      // stessi dati senza copie esplicite sul bus PCIe.
       MTLResourceOptions options = MTLResourceStorageModeShared;
 
-      for (size_t i = 0; i < POOL_SIZE; ++i) {
-         buffer_pool_[i].bufferA = [device_ newBufferWithLength:required_size_bytes
-                                                        options:options];
-         buffer_pool_[i].bufferB = [device_ newBufferWithLength:required_size_bytes
-                                                        options:options];
-         buffer_pool_[i].bufferC = [device_ newBufferWithLength:required_size_bytes
-                                                        options:options];
-         if (!buffer_pool_[i].bufferA || !buffer_pool_[i].bufferB || !buffer_pool_[i].bufferC) {
-            std::cerr << "[ERROR] MetalBufferManager: Failed to allocate "
-                         "buffer pool.\n";
-            return false;
-         }
+      buffer_set.bufferA = [device_ newBufferWithLength:required_size_bytes options:options];
+      buffer_set.bufferB = [device_ newBufferWithLength:required_size_bytes options:options];
+      buffer_set.bufferC = [device_ newBufferWithLength:required_size_bytes options:options];
+      if (!buffer_set.bufferA || !buffer_set.bufferB || !buffer_set.bufferC) {
+         std::cerr << "[ERROR] MetalBufferManager: Failed to allocate "
+                      "buffer set.\n";
+         return false;
       }
-      std::cerr << "  [MetalBufferManager - DEBUG] Allocating pool buffers for "
+      std::cerr << "  [MetalBufferManager - DEBUG] Allocating buffer set " << index << " for "
                 << required_size_bytes << " bytes\n";
 
       return true;
@@ -98,18 +97,17 @@ class MetalBufferManager {
       buffer_available_cond_.notify_one();
    }
 
+   size_t size() const { return buffer_pool_.size(); }
+
  private:
    id<MTLDevice> device_; // Riferimento al device Metal.
 
    // Dati per il pool di buffer nel device e per la gestione della concorrenza.
    const size_t POOL_SIZE = 3;
    std::vector<BufferSet> buffer_pool_;
-   std::queue<size_t> free_buffer_indices_;
+   RingBuffer<size_t> free_buffer_indices_;
    std::mutex pool_mutex_;
    std::condition_variable buffer_available_cond_;
-
-   // Dimensione attualmente allocata per i buffer nel pool.
-   size_t allocated_size_bytes_{0};
 };
 
 // =======================================================================
@@ -215,15 +213,17 @@ void Gpu_Metal_Accelerator::release_buffer_set(size_t index) {
    buffer_manager_->release_buffer_set(index);
 }
 
+size_t Gpu_Metal_Accelerator::buffer_set_count() const { return buffer_manager_->size(); }
+
 void Gpu_Metal_Accelerator::send_data_to_device(void *task_context) {
    auto *task = static_cast<Task *>(task_context);
    std::cerr << "[Gpu_Metal_Accelerator - START] Processing task " << task->id
              << " with N=" << task->n << "...\n";
 
-   // Se la dimensione richiesta è diversa da quella allocata, rialloca tutti i buffer del pool e
-   // ottieni il set di buffer.
+   // Se la dimensione richiesta è maggiore di quella allocata, rialloca i buffer del set del task
+   // e ottieni il set di buffer.
    size_t required_size_bytes = sizeof(int) * task->n;
-   buffer_manager_->reallocate_buffers_if_needed(required_size_bytes);
+   buffer_manager_->reallocate_buffer_set_if_needed(task->buffer_idx, required_size_bytes);
    auto &current_buffers = buffer_manager_->get_buffer_set(task->buffer_idx);
 
    // Grazie alla memoria unificata, copia i dati direttamente.
@@ -1,9 +1,14 @@
 #include "Gpu_OpenCL_Accelerator.hpp"
+#include "../dsl/DslKernels.hpp"
+#include "DeviceDiscovery.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <thread>
+#include <utility>
 #include <vector>
 
 /**
@@ -22,13 +27,44 @@
       }                                                                        \
    } while (0)
 
+/**
+ * @brief Opzioni di build che scelgono l'operazione di kernels/gpu/reduce.cl, vuote per gli
+ * altri kernel.
+ */
+static std::string reduce_defines(CpuKernel kind) {
+   switch (kind) {
+   case CpuKernel::ReduceSum:
+      return "-DREDUCE_KERNEL=reduce_sum -DREDUCE_T=long -DREDUCE_OP=reduce_add "
+             "-DREDUCE_IDENTITY=0";
+   case CpuKernel::ReduceMin:
+      return "-DREDUCE_KERNEL=reduce_min -DREDUCE_T=int -DREDUCE_OP=min -DREDUCE_IDENTITY=INT_MAX";
+   case CpuKernel::ReduceMax:
+      return "-DREDUCE_KERNEL=reduce_max -DREDUCE_T=int -DREDUCE_OP=max -DREDUCE_IDENTITY=INT_MIN";
+   default:
+      return "";
+   }
+}
+
 /**
  * @brief Il costruttrore prende in input il nome della funzione kernel e il suo
  * path.
  */
 Gpu_OpenCL_Accelerator::Gpu_OpenCL_Accelerator(const std::string &kernel_path,
-                               const std::string &kernel_name)
-    : kernel_path_(kernel_path), kernel_name_(kernel_name) {}
+                                               const std::string &kernel_name,
+                                               cl_device_id device, size_t tile_elems,
+                                               const std::string &tune_cache,
+                                               const JitOptions &jit, bool reduce_on_device)
+    : device_(device), tune_cache_(tune_cache), jit_(jit), kind_(parse_cpu_kernel(kernel_name)),
+      reduce_on_device_(reduce_on_device), kernel_path_(kernel_path), kernel_name_(kernel_name),
+      tile_elems_(tile_elems) {
+   launch_.variant = kernel_name_;
+   // Le varianti JIT fissano le iterazioni di heavy_compute a quelle del riferimento sull'host;
+   // senza JIT il programma usa il default del sorgente.
+   if (jit_.enabled() &&
+       (kind_ == CpuKernel::HeavyCompute || kind_ == CpuKernel::HeavyComputeFast))
+      jit_.heavy_iters = HEAVY_ITERS;
+   jit_.defines = reduce_defines(kind_);
+}
 
 /**
  * @brief Il distruttore si occupa di rilasciare in ordine inverso tutte le
@@ -36,6 +72,28 @@ Gpu_OpenCL_Accelerator::Gpu_OpenCL_Accelerator(const std::string &kernel_path,
  distruttore di buffer_manager_.
  */
 Gpu_OpenCL_Accelerator::~Gpu_OpenCL_Accelerator() {
+   buffer_manager_.reset(); // Rilascia buffer e kernel prima del programma
+   for (auto &entry : jit_kernels_)
+      if (entry.second.kernel)
+         clReleaseKernel(entry.second.kernel);
+   for (auto &entry : final_kernels_)
+      if (entry.second)
+         clReleaseKernel(entry.second);
+   specializer_.reset(); // Rilascia le varianti JIT prima del contesto
+   for (size_t s = 0; s < NUM_TILE_SLOTS; ++s) {
+      if (slot_free_[s])
+         clReleaseEvent(slot_free_[s]);
+      if (tile_slots_[s].bufferA)
+         clReleaseMemObject(tile_slots_[s].bufferA);
+      if (tile_slots_[s].bufferB)
+         clReleaseMemObject(tile_slots_[s].bufferB);
+      if (tile_slots_[s].bufferC)
+         clReleaseMemObject(tile_slots_[s].bufferC);
+   }
+   if (h2d_queue_)
+      clReleaseCommandQueue(h2d_queue_);
+   if (d2h_queue_)
+      clReleaseCommandQueue(d2h_queue_);
    if (kernel_)
       clReleaseKernel(kernel_);
    if (program_)
@@ -44,7 +102,10 @@ Gpu_OpenCL_Accelerator::~Gpu_OpenCL_Accelerator() {
       clReleaseCommandQueue(queue_);
    if (context_)
       clReleaseContext(context_);
+   release_device(device_); // Solo se è un sub-device (farm con --sub-devices)
 
+   std::cerr << "[Gpu_OpenCL_Accelerator] Transferred " << bytes_up_.load() << " bytes up, "
+             << bytes_down_.load() << " bytes down.\n";
    std::cerr << "[Gpu_OpenCL_Accelerator] Destroyed and OpenCL resources released.\n";
 }
 
@@ -57,48 +118,78 @@ Gpu_OpenCL_Accelerator::~Gpu_OpenCL_Accelerator() {
 bool Gpu_OpenCL_Accelerator::initialize() {
    cl_int ret; // Codice di ritorno delle chiamate OpenCL
    cl_platform_id platform_id = NULL;
-   cl_device_id device_id = NULL;
-
-   // Trova una piattaforma OpenCL e un dispositivo di tipo GPU.
-   OCL_CHECK(ret, clGetPlatformIDs(1, &platform_id, NULL), return false);
-   OCL_CHECK(
-      ret, clGetDeviceIDs(platform_id, CL_DEVICE_TYPE_GPU, 1, &device_id, NULL),
-      {
-         std::cerr << "[FATAL] GPU not found.\n";
-         exit(EXIT_FAILURE);
+
+   // Se il device non è stato scelto dal chiamante (es. farm multi-device), trova una
+   // piattaforma OpenCL e un dispositivo di tipo GPU.
+   if (!device_) {
+      OCL_CHECK(ret, clGetPlatformIDs(1, &platform_id, NULL), return false);
+      OCL_CHECK(ret, clGetDeviceIDs(platform_id, CL_DEVICE_TYPE_GPU, 1, &device_, NULL), {
+         std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: GPU not found.\n";
+         return false;
       });
+   }
 
    // Crea un contesto OpenCL.
-   context_ = clCreateContext(NULL, 1, &device_id, NULL, NULL, &ret);
+   context_ = clCreateContext(NULL, 1, &device_, NULL, NULL, &ret);
    if (!context_ || ret != CL_SUCCESS) {
       std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Failed to create OpenCL context.\n";
       return false;
    }
 
    // Crea la coda di comandi.
-   queue_ = clCreateCommandQueue(context_, device_id, 0, &ret);
+   queue_ = clCreateCommandQueue(context_, device_, 0, &ret);
    if (!queue_ || ret != CL_SUCCESS) {
       std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Failed to create command queue.\n";
       return false;
    }
 
+   // Code dedicate a upload e download dei tile, per sovrapporli al calcolo.
+   h2d_queue_ = clCreateCommandQueue(context_, device_, 0, &ret);
+   d2h_queue_ = clCreateCommandQueue(context_, device_, 0, &ret);
+   if (!h2d_queue_ || !d2h_queue_ || ret != CL_SUCCESS) {
+      std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Failed to create transfer queues.\n";
+      return false;
+   }
+
+   // Dimensione massima di un singolo buffer: i task più grandi vengono eseguiti a tile.
+   OCL_CHECK(ret,
+             clGetDeviceInfo(device_, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(max_alloc_bytes_),
+                             &max_alloc_bytes_, NULL),
+             return false);
+
    // Chiama il costruttore di BufferManager che iniializza il pool di buffer.
    buffer_manager_ = std::make_unique<BufferManager>(context_);
 
-   // Legge il kernel OpenCL e verifica che il percorso sia un file valido.
-   std::ifstream kernelFile(kernel_path_);
+   // Legge il kernel OpenCL, oppure lo genera con la DSL se il percorso è "dsl:<kernel>".
+   std::string kernelSource;
+   if (kernel_path_.rfind("dsl:", 0) == 0) {
+      kernelSource = dsl::kernel_source(kernel_name_);
+      if (kernelSource.empty()) {
+         std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Unknown DSL kernel: " << kernel_name_
+                   << "\n";
+         exit(EXIT_FAILURE);
+      }
+   } else {
+      // reduce_sum, reduce_min e reduce_max hanno un solo sorgente, reduce.cl nella stessa
+      // cartella: il nome nel percorso (es. kernels/gpu/reduce_sum.cl) sceglie l'operazione.
+      std::string source_path = kernel_path_;
+      if (kind_ == CpuKernel::ReduceSum || kind_ == CpuKernel::ReduceMin ||
+          kind_ == CpuKernel::ReduceMax)
+         source_path = (std::filesystem::path(kernel_path_).parent_path() / "reduce.cl").string();
+      std::ifstream kernelFile(source_path);
 
-   // Controllo che il file sia stato aperto correttamente e che abbia
-   // estensione .cl, poi lo leggo.
-   if (!kernelFile.is_open() ||
-       !std::filesystem::is_regular_file(kernel_path_) ||
-       kernel_path_.rfind(".cl") == std::string::npos) {
-      std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Could not open kernel file: " << kernel_path_
-                << "\n";
-      exit(EXIT_FAILURE);
+      // Controllo che il file sia stato aperto correttamente e che abbia
+      // estensione .cl, poi lo leggo.
+      if (!kernelFile.is_open() || !std::filesystem::is_regular_file(source_path) ||
+          kernel_path_.rfind(".cl") == std::string::npos) {
+         std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Could not open kernel file: "
+                   << source_path << "\n";
+         exit(EXIT_FAILURE);
+      }
+      kernelSource.assign((std::istreambuf_iterator<char>(kernelFile)),
+                          (std::istreambuf_iterator<char>()));
    }
-   std::string kernelSource((std::istreambuf_iterator<char>(kernelFile)),
-                            (std::istreambuf_iterator<char>()));
+   kernelSource.insert(0, KernelSpecializer::N_ELEMS_PROLOGUE);
    const char *source_str = kernelSource.c_str();
    size_t source_size = kernelSource.length();
 
@@ -111,26 +202,88 @@ bool Gpu_OpenCL_Accelerator::initialize() {
    }
 
    // Compila il programma OpenCL.
-   ret = clBuildProgram(program_, 1, &device_id, NULL, NULL, NULL);
+   ret = clBuildProgram(program_, 1, &device_, jit_.defines.c_str(), NULL, NULL);
    if (ret != CL_SUCCESS) {
       std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Kernel "
                    "compilation failed.\n";
       size_t log_size;
-      clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_LOG, 0, NULL,
+      clGetProgramBuildInfo(program_, device_, CL_PROGRAM_BUILD_LOG, 0, NULL,
                             &log_size);
       std::vector<char> log(log_size);
-      clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_LOG, log_size,
+      clGetProgramBuildInfo(program_, device_, CL_PROGRAM_BUILD_LOG, log_size,
                             log.data(), NULL);
       exit(EXIT_FAILURE);
    }
 
-   // Crea l'oggetto kernel.
-   kernel_ = clCreateKernel(program_, kernel_name_.c_str(), &ret);
-   if (!kernel_ || ret != CL_SUCCESS) {
+   // Le varianti specializzate vengono compilate dallo stesso sorgente alla prima richiesta.
+   if (jit_.enabled())
+      specializer_ = std::make_unique<KernelSpecializer>(context_, device_, kernelSource, jit_);
+
+   // Sceglie la configurazione di lancio (dalla cache o misurando le candidate). Le riduzioni,
+   // le matrici, gli stencil e le SpMV hanno un lancio proprio, che l'autotuner non conosce.
+   if (!tune_cache_.empty() && (is_reduction(kind_) || has_own_launch()))
+      std::cerr << "[WARNING] Gpu_OpenCL_Accelerator: Autotuning is not available for reduction, "
+                   "2D and SpMV kernels, skipped.\n";
+   else if (!tune_cache_.empty())
+      select_launch_config();
+
+   // Crea l'oggetto kernel dei task a tile e quello di ogni buffer set.
+   kernel_ = clCreateKernel(program_, launch_.variant.c_str(), &ret);
+   if (!kernel_ || ret != CL_SUCCESS ||
+       !buffer_manager_->create_kernels(program_, launch_.variant)) {
       std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Failed to create kernel object.\n";
       exit(EXIT_FAILURE);
    }
 
+   // Riduzioni: work-group più grande ammesso dal kernel, potenza di 2 per l'albero in memoria
+   // locale. La combinazione sul device richiede il kernel <kernel>_final nel programma.
+   if (is_reduction(kind_)) {
+      size_t max_local = 0;
+      clGetKernelWorkGroupInfo(kernel_, device_, CL_KERNEL_WORK_GROUP_SIZE, sizeof(max_local),
+                               &max_local, NULL);
+      reduce_local_ = 1;
+      while (reduce_local_ * 2 <= std::min(max_local, REDUCE_LOCAL_MAX))
+         reduce_local_ *= 2;
+
+      if (reduce_on_device_ && kind_ != CpuKernel::Histogram) {
+         cl_kernel probe = clCreateKernel(program_, (kernel_name_ + "_final").c_str(), &ret);
+         if (!probe || ret != CL_SUCCESS) {
+            std::cerr << "[WARNING] Gpu_OpenCL_Accelerator: Kernel '" << kernel_name_
+                      << "_final' not found, partials will be combined on the host.\n";
+            reduce_on_device_ = false;
+         } else {
+            clReleaseKernel(probe);
+         }
+      }
+      std::cerr << "[Gpu_OpenCL_Accelerator] Reduction: work-groups of " << reduce_local_
+                << " work-items, at most " << MAX_REDUCE_GROUPS << " partials combined on the "
+                << (reduce_on_device_ || kind_ == CpuKernel::Histogram ? "device" : "host")
+                << ".\n";
+   }
+
+   // Matrici e stencil lanciano work-group quadrati di GEMM_TILE o STENCIL_TILE di lato,
+   // spmv_csr_vector work-group di SPMV_VECTOR_WIDTH (spmv_csr lascia scegliere al runtime).
+   if (has_own_launch()) {
+      size_t required = STENCIL_TILE * STENCIL_TILE;
+      if (kind_ == CpuKernel::Gemm)
+         required = GEMM_TILE * GEMM_TILE;
+      else if (is_spmv(kind_))
+         required = kind_ == CpuKernel::SpmvCsrVector ? SPMV_VECTOR_WIDTH : 1;
+      size_t max_local = 0;
+      clGetKernelWorkGroupInfo(kernel_, device_, CL_KERNEL_WORK_GROUP_SIZE, sizeof(max_local),
+                               &max_local, NULL);
+      if (max_local < required) {
+         std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Kernel '" << kernel_name_
+                   << "' allows work-groups of " << max_local << " work-items, " << required
+                   << " required.\n";
+         return false;
+      }
+   }
+
+   // Il confronto usa il lancio dei kernel elemento per elemento.
+   if (specializer_ && !is_reduction(kind_) && !has_own_launch())
+      report_specialization();
+
    std::cerr << "[Gpu_OpenCL_Accelerator] Initialization successful.\n";
    return true;
 }
@@ -143,6 +296,8 @@ void Gpu_OpenCL_Accelerator::release_buffer_set(size_t index) {
    buffer_manager_->release_buffer_set(index);
 }
 
+size_t Gpu_OpenCL_Accelerator::buffer_set_count() const { return buffer_manager_->size(); }
+
 /**
  * @brief Stadio 1 (Upload).
  * Fa l'upload dei dati di input A e B dall'host alla device memory.
@@ -157,12 +312,102 @@ void Gpu_OpenCL_Accelerator::send_data_to_device(void *task_context) {
    std::cerr << "[Gpu_OpenCL_Accelerator - START] Processing task " << task->id
              << " with N=" << task->n << "...\n";
 
-   // Se la dimensione richiesta è diversa da quella allocata, rialloca
-   // tutti i buffer del pool e ottieni il set di buffer.
-   size_t required_size_bytes = sizeof(int) * task->n;
-   buffer_manager_->reallocate_buffers_if_needed(required_size_bytes);
+   // I task a tile non usano i buffer del pool: upload, calcolo e download di ogni tile sono
+   // accodati insieme da execute_kernel().
+   if (is_tiled(task))
+      return;
+
+   // Se la dimensione richiesta è maggiore di quella allocata, rialloca
+   // i buffer del set del task e ottieni il set di buffer. Con le riduzioni C contiene i
+   // parziali, che per task piccoli possono superare n int.
+   size_t input_bytes = sizeof(int) * task->n;
+   size_t required_size_bytes = input_bytes;
+   if (is_reduction(kind_))
+      required_size_bytes =
+         std::max({required_size_bytes, reduce_groups(task->n) * reduce_partial_bytes(),
+                   HISTOGRAM_BINS * sizeof(int)});
+   buffer_manager_->reallocate_buffer_set_if_needed(task->buffer_idx, required_size_bytes);
    auto &current_buffers = buffer_manager_->get_buffer_set(task->buffer_idx);
 
+   // Matrici: A e B hanno ciascuna la propria dimensione, il buffer del set le contiene tutte.
+   if (kind_ == CpuKernel::Gemm) {
+      const MatrixDesc &d = task->mat;
+      size_t a_bytes = sizeof(float) * d.a_elems(), b_bytes = sizeof(float) * d.b_elems();
+      buffer_manager_->reallocate_buffer_set_if_needed(
+         task->buffer_idx, std::max({a_bytes, b_bytes, sizeof(float) * d.c_elems()}));
+      auto &set = buffer_manager_->get_buffer_set(task->buffer_idx);
+      OCL_CHECK(ret,
+                clEnqueueWriteBuffer(queue_, set.bufferA, CL_FALSE, 0, a_bytes, task->a, 0,
+                                     NULL, NULL),
+                return);
+      OCL_CHECK(ret,
+                clEnqueueWriteBuffer(queue_, set.bufferB, CL_FALSE, 0, b_bytes, task->b, 0,
+                                     NULL, &task->event),
+                return);
+      bytes_up_ += a_bytes + b_bytes;
+      return;
+   }
+
+   // Stencil: il tile con l'alone va in A, C riceve il primo sweep (stessa dimensione).
+   if (stencil_points(kind_) > 0) {
+      size_t bytes = sizeof(float) * task->grid.in_elems();
+      buffer_manager_->reallocate_buffer_set_if_needed(task->buffer_idx, bytes);
+      auto &set = buffer_manager_->get_buffer_set(task->buffer_idx);
+      OCL_CHECK(ret,
+                clEnqueueWriteBuffer(queue_, set.bufferA, CL_FALSE, 0, bytes, task->a, 0, NULL,
+                                     &task->event),
+                return);
+      bytes_up_ += bytes;
+      return;
+   }
+
+   // SpMV: row_ptr, col_idx e values uno dopo l'altro in A (come li legge il kernel), x in B;
+   // C riceve y. Il buffer del set deve contenere il più grande dei tre.
+   if (is_spmv(kind_)) {
+      const CsrDesc &d = task->csr;
+      const size_t ptr_bytes = sizeof(int) * (d.rows + 1), idx_bytes = sizeof(int) * d.nnz;
+      const size_t x_bytes = sizeof(float) * d.cols;
+      buffer_manager_->reallocate_buffer_set_if_needed(
+         task->buffer_idx, std::max({d.matrix_bytes(), x_bytes, sizeof(float) * d.rows}));
+      auto &set = buffer_manager_->get_buffer_set(task->buffer_idx);
+      OCL_CHECK(ret,
+                clEnqueueWriteBuffer(queue_, set.bufferA, CL_FALSE, 0, ptr_bytes, d.row_ptr, 0,
+                                     NULL, NULL),
+                return);
+      OCL_CHECK(ret,
+                clEnqueueWriteBuffer(queue_, set.bufferA, CL_FALSE, ptr_bytes, idx_bytes,
+                                     d.col_idx, 0, NULL, NULL),
+                return);
+      OCL_CHECK(ret,
+                clEnqueueWriteBuffer(queue_, set.bufferA, CL_FALSE, ptr_bytes + idx_bytes,
+                                     sizeof(float) * d.nnz, d.values, 0, NULL, NULL),
+                return);
+      OCL_CHECK(ret,
+                clEnqueueWriteBuffer(queue_, set.bufferB, CL_FALSE, 0, x_bytes, task->a, 0, NULL,
+                                     &task->event),
+                return);
+      bytes_up_ += d.matrix_bytes() + x_bytes;
+      return;
+   }
+
+   // Le riduzioni leggono solo A; l'istogramma viene accumulato in C, che parte da zero.
+   if (is_reduction(kind_)) {
+      bool histogram = kind_ == CpuKernel::Histogram;
+      OCL_CHECK(ret,
+                clEnqueueWriteBuffer(queue_, current_buffers.bufferA, CL_FALSE, 0, input_bytes,
+                                     task->a, 0, NULL, histogram ? NULL : &task->event),
+                return);
+      if (histogram) {
+         const int zero = 0;
+         OCL_CHECK(ret,
+                   clEnqueueFillBuffer(queue_, current_buffers.bufferC, &zero, sizeof(zero), 0,
+                                       HISTOGRAM_BINS * sizeof(int), 0, NULL, &task->event),
+                   return);
+      }
+      bytes_up_ += input_bytes;
+      return;
+   }
+
    // Scrive i due input sulla device memory.
    OCL_CHECK(ret,
              clEnqueueWriteBuffer(queue_, current_buffers.bufferA, CL_FALSE, 0,
@@ -173,38 +418,64 @@ void Gpu_OpenCL_Accelerator::send_data_to_device(void *task_context) {
                                   required_size_bytes, task->b, 0, NULL,
                                   &task->event),
              return);
+   bytes_up_ += 2 * required_size_bytes;
 }
 
 /**
  * @brief Stadio 2 (Execute).
- * Imposta gli argomenti del kernel e accoda la sua esecuzione, rilasciando
- * l'evento del completamento del trasferimento dati e ottenendo un nuovo evento
- * che rappresenta il completamento del kernel.
+ * Accoda l'esecuzione del kernel del buffer set, rilasciando l'evento del
+ * completamento del trasferimento dati e ottenendo un nuovo evento che
+ * rappresenta il completamento del kernel. I buffer sono già legati al kernel
+ * del set: si imposta solo n, e solo se è cambiato, quindi più producer
+ * possono lanciare kernel in parallelo su set diversi. Con la specializzazione
+ * JIT si usa invece il kernel del set creato dalla variante per n elementi.
  */
 void Gpu_OpenCL_Accelerator::execute_kernel(void *task_context) {
    cl_int ret; // Codice di ritorno delle chiamate OpenCL.
    auto *task = static_cast<Task *>(task_context);
+
+   if (is_tiled(task)) {
+      enqueue_tiled(task);
+      return;
+   }
+
    auto &current_buffers = buffer_manager_->get_buffer_set(task->buffer_idx);
    cl_event previous_event = task->event;
 
-   // Imposta gli argomenti del kernel.
-   OCL_CHECK(
-      ret, clSetKernelArg(kernel_, 0, sizeof(cl_mem), &current_buffers.bufferA),
-      return);
-   OCL_CHECK(
-      ret, clSetKernelArg(kernel_, 1, sizeof(cl_mem), &current_buffers.bufferB),
-      return);
-   OCL_CHECK(
-      ret, clSetKernelArg(kernel_, 2, sizeof(cl_mem), &current_buffers.bufferC),
-      return);
-   OCL_CHECK(ret, clSetKernelArg(kernel_, 3, sizeof(unsigned int), &(task->n)),
-             return);
+   if (kind_ == CpuKernel::Gemm) {
+      enqueue_gemm(task, current_buffers);
+      return;
+   }
+   if (stencil_points(kind_) > 0) {
+      enqueue_stencil(task, current_buffers);
+      return;
+   }
+   if (is_spmv(kind_)) {
+      enqueue_spmv(task, current_buffers);
+      return;
+   }
+
+   unsigned int n = static_cast<unsigned int>(task->n);
+   cl_kernel kernel = specializer_ ? jit_kernel(task->buffer_idx, current_buffers, n) : nullptr;
+   if (!kernel) {
+      kernel = current_buffers.kernel;
+      if (current_buffers.bound_n != n) {
+         OCL_CHECK(ret, clSetKernelArg(kernel, 3, sizeof(unsigned int), &n), return);
+         current_buffers.bound_n = n;
+      }
+   }
 
-   // Accoda l'esecuzione del kernel.
-   size_t global_work_size = task->n;
+   if (is_reduction(kind_)) {
+      enqueue_reduction(task, current_buffers, kernel);
+      return;
+   }
+
+   // Accoda l'esecuzione del kernel con la configurazione di lancio scelta.
+   size_t global_work_size = launch_.global_size(task->n);
+   const size_t *local_work_size = launch_.local_size > 0 ? &launch_.local_size : NULL;
    OCL_CHECK(ret,
-             clEnqueueNDRangeKernel(queue_, kernel_, 1, NULL, &global_work_size,
-                                    NULL, 1, &previous_event, &task->event),
+             clEnqueueNDRangeKernel(queue_, kernel, 1, NULL, &global_work_size,
+                                    local_work_size, 1, &previous_event, &task->event),
              return);
 
    // Rilascia l'evento precedente.
@@ -228,12 +499,55 @@ void Gpu_OpenCL_Accelerator::get_results_from_device(void *task_context,
 
    auto t0 = std::chrono::steady_clock::now();
 
-   // Recupera i risultati dalla device memory alla memoria host.
-   OCL_CHECK(ret,
-             clEnqueueReadBuffer(queue_, current_buffers.bufferC, CL_TRUE, 0,
-                                 required_size_bytes, task->c, 1,
-                                 &previous_event, NULL),
-             return);
+   // Recupera i risultati dalla device memory alla memoria host. Per un task a tile i download
+   // sono già accodati: basta attendere l'ultimo (la coda dei download è in ordine). Per una
+   // riduzione si scaricano solo i parziali, combinati qui, o il risultato già combinato.
+   if (is_tiled(task)) {
+      OCL_CHECK(ret, clWaitForEvents(1, &previous_event), return);
+   } else if (kind_ == CpuKernel::Gemm) {
+      size_t bytes = sizeof(float) * task->mat.c_elems();
+      OCL_CHECK(ret,
+                clEnqueueReadBuffer(queue_, current_buffers.bufferC, CL_TRUE, 0, bytes, task->c,
+                                    1, &previous_event, NULL),
+                return);
+      bytes_down_ += bytes;
+   } else if (stencil_points(kind_) > 0) {
+      // Gli sweep si alternano fra A e C: con un numero pari di sweep il risultato è in A.
+      const GridDesc &g = task->grid;
+      cl_mem result = g.steps % 2 ? current_buffers.bufferC : current_buffers.bufferA;
+      size_t bytes = sizeof(float) * g.out_elems();
+      OCL_CHECK(ret,
+                clEnqueueReadBuffer(queue_, result, CL_TRUE, sizeof(float) * g.halo_top * g.cols,
+                                    bytes, task->c, 1, &previous_event, NULL),
+                return);
+      bytes_down_ += bytes;
+   } else if (is_spmv(kind_)) {
+      size_t bytes = sizeof(float) * task->csr.rows;
+      OCL_CHECK(ret,
+                clEnqueueReadBuffer(queue_, current_buffers.bufferC, CL_TRUE, 0, bytes, task->c,
+                                    1, &previous_event, NULL),
+                return);
+      bytes_down_ += bytes;
+   } else if (is_reduction(kind_)) {
+      bool combine_on_host = !reduce_on_device_ && kind_ != CpuKernel::Histogram;
+      size_t bytes = reduce_download_bytes(task->n);
+      cl_long partials[MAX_REDUCE_GROUPS];
+      OCL_CHECK(ret,
+                clEnqueueReadBuffer(queue_, current_buffers.bufferC, CL_TRUE, 0, bytes,
+                                    combine_on_host ? static_cast<void *>(partials) : task->c,
+                                    1, &previous_event, NULL),
+                return);
+      if (combine_on_host)
+         combine_partials(partials, reduce_groups(task->n), task->c);
+      bytes_down_ += bytes;
+   } else {
+      OCL_CHECK(ret,
+                clEnqueueReadBuffer(queue_, current_buffers.bufferC, CL_TRUE, 0,
+                                    required_size_bytes, task->c, 1,
+                                    &previous_event, NULL),
+                return);
+      bytes_down_ += required_size_bytes;
+   }
 
    // Rilascia l'evento precedente.
    if (previous_event)
@@ -246,4 +560,629 @@ void Gpu_OpenCL_Accelerator::get_results_from_device(void *task_context,
       std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
 
    std::cerr << "[Gpu_OpenCL_Accelerator - END] Task " << task->id << " finished.\n";
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Elementi per tile: quelli richiesti (entro il limite di un buffer), altrimenti un
+ * quarto del buffer più grande allocabile, così i 3 slot (9 buffer) restano ben sotto la memoria
+ * del device.
+ */
+size_t Gpu_OpenCL_Accelerator::effective_tile_elems() const {
+   size_t max_elems = std::max<size_t>(1, max_alloc_bytes_ / sizeof(int));
+   return tile_elems_ > 0 ? std::min(tile_elems_, max_elems) : std::max<size_t>(1, max_elems / 4);
+}
+
+bool Gpu_OpenCL_Accelerator::is_tiled(const Task *task) const {
+   // Le riduzioni producono un risultato per task, non un tratto di C per tile, e le matrici
+   // non si dividono in tratti contigui di elementi.
+   if (is_reduction(kind_) || has_own_launch())
+      return false;
+   return (tile_elems_ > 0 && task->n > tile_elems_) ||
+          sizeof(int) * task->n > max_alloc_bytes_;
+}
+
+/**
+ * @brief Alloca gli slot dei tile alla prima esecuzione a tile, o li rialloca se il tile è
+ * cresciuto. I buffer precedenti vengono rilasciati: OpenCL li distrugge solo al termine dei
+ * comandi già accodati che li usano.
+ */
+bool Gpu_OpenCL_Accelerator::allocate_tile_buffers(size_t tile_bytes) {
+   if (tile_slot_bytes_ >= tile_bytes)
+      return true;
+
+   std::cerr << "  [Gpu_OpenCL_Accelerator - DEBUG] Allocating " << NUM_TILE_SLOTS
+             << " tile slots of " << tile_bytes << " bytes\n";
+
+   cl_int ret;
+   tile_slot_bytes_ = 0;
+   for (auto &slot : tile_slots_) {
+      for (cl_mem *buffer : {&slot.bufferA, &slot.bufferB, &slot.bufferC}) {
+         if (*buffer)
+            clReleaseMemObject(*buffer);
+         *buffer = nullptr;
+      }
+      cl_int ret_a, ret_b, ret_c;
+      slot.bufferA = clCreateBuffer(context_, CL_MEM_READ_ONLY, tile_bytes, NULL, &ret_a);
+      slot.bufferB = clCreateBuffer(context_, CL_MEM_READ_ONLY, tile_bytes, NULL, &ret_b);
+      slot.bufferC = clCreateBuffer(context_, CL_MEM_WRITE_ONLY, tile_bytes, NULL, &ret_c);
+      ret = ret_a != CL_SUCCESS ? ret_a : ret_b != CL_SUCCESS ? ret_b : ret_c;
+      if (ret != CL_SUCCESS) {
+         std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Failed to allocate tile buffers.\n";
+         return false;
+      }
+   }
+   tile_slot_bytes_ = tile_bytes;
+   return true;
+}
+
+/**
+ * @brief Accoda il grafo di eventi di un task a tile. Per ogni tile, sullo slot successivo:
+ * upload di A e B (dopo il download precedente dallo stesso slot), kernel (dopo l'upload) e
+ * download di C (dopo il kernel), ognuno sulla propria coda. L'evento del task è l'ultimo
+ * download. Gli slot sono condivisi fra task consecutivi, che quindi si sovrappongono anche tra
+ * loro.
+ */
+void Gpu_OpenCL_Accelerator::enqueue_tiled(Task *task) {
+   cl_int ret; // Codice di ritorno delle chiamate OpenCL
+
+   // Gli slot e kernel_ sono condivisi fra tutti i task a tile, anche di producer diversi.
+   std::lock_guard<std::mutex> lock(tile_mutex_);
+   size_t tile = effective_tile_elems();
+   if (!allocate_tile_buffers(tile * sizeof(int)))
+      return;
+
+   cl_event last_download = nullptr;
+   for (size_t offset = 0; offset < task->n; offset += tile) {
+      size_t count = std::min(tile, task->n - offset);
+      size_t bytes = count * sizeof(int);
+      size_t s = next_slot_;
+      next_slot_ = (next_slot_ + 1) % NUM_TILE_SLOTS;
+      auto &slot = tile_slots_[s];
+
+      cl_event uploaded, computed, downloaded;
+      cl_uint num_wait = slot_free_[s] ? 1 : 0;
+
+      // Upload: la coda è in ordine, quindi l'evento del secondo copre anche il primo.
+      OCL_CHECK(ret,
+                clEnqueueWriteBuffer(h2d_queue_, slot.bufferA, CL_FALSE, 0, bytes,
+                                     task->a + offset, num_wait,
+                                     num_wait ? &slot_free_[s] : NULL, NULL),
+                return);
+      OCL_CHECK(ret,
+                clEnqueueWriteBuffer(h2d_queue_, slot.bufferB, CL_FALSE, 0, bytes,
+                                     task->b + offset, num_wait,
+                                     num_wait ? &slot_free_[s] : NULL, &uploaded),
+                return);
+      bytes_up_ += 2 * bytes;
+
+      // Calcolo del tile.
+      unsigned int count_arg = static_cast<unsigned int>(count);
+      OCL_CHECK(ret, clSetKernelArg(kernel_, 0, sizeof(cl_mem), &slot.bufferA), return);
+      OCL_CHECK(ret, clSetKernelArg(kernel_, 1, sizeof(cl_mem), &slot.bufferB), return);
+      OCL_CHECK(ret, clSetKernelArg(kernel_, 2, sizeof(cl_mem), &slot.bufferC), return);
+      OCL_CHECK(ret, clSetKernelArg(kernel_, 3, sizeof(unsigned int), &count_arg), return);
+      size_t global_work_size = launch_.global_size(count);
+      const size_t *local_work_size = launch_.local_size > 0 ? &launch_.local_size : NULL;
+      OCL_CHECK(ret,
+                clEnqueueNDRangeKernel(queue_, kernel_, 1, NULL, &global_work_size,
+                                       local_work_size, 1, &uploaded, &computed),
+                return);
+
+      // Download del tile nella sua posizione del vettore di output.
+      OCL_CHECK(ret,
+                clEnqueueReadBuffer(d2h_queue_, slot.bufferC, CL_FALSE, 0, bytes,
+                                    task->c + offset, 1, &computed, &downloaded),
+                return);
+
+      bytes_down_ += bytes;
+
+      clReleaseEvent(uploaded);
+      clReleaseEvent(computed);
+      if (slot_free_[s])
+         clReleaseEvent(slot_free_[s]);
+      slot_free_[s] = downloaded;
+      last_download = downloaded;
+   }
+
+   // Avvia subito le 3 code.
+   clFlush(h2d_queue_);
+   clFlush(queue_);
+   clFlush(d2h_queue_);
+
+   // L'evento del task è rilasciato da get_results_from_device(), quello dello slot al suo riuso.
+   if (last_download)
+      clRetainEvent(last_download);
+   task->event = last_download;
+}
+
+/**
+ * @brief Legge dalla cache la configurazione di lancio del kernel su questo device. Se manca la
+ * cerca con autotune() e la salva, così le esecuzioni successive saltano la ricerca.
+ */
+void Gpu_OpenCL_Accelerator::select_launch_config() {
+   std::string device_name = get_device_name(device_);
+   TuningCache cache(tune_cache_);
+   cache.load();
+
+   if (cache.find(device_name, kernel_name_, launch_)) {
+      std::cerr << "[Gpu_OpenCL_Accelerator] Autotuning: cached configuration for '"
+                << kernel_name_ << "' on '" << device_name << "'.\n";
+   } else {
+      launch_ = autotune();
+      cache.store(device_name, kernel_name_, launch_);
+      cache.save();
+   }
+
+   std::cerr << "[Gpu_OpenCL_Accelerator] Launch configuration: " << launch_.variant << ", "
+             << launch_.vectors_per_item << " x int" << launch_.vector_width
+             << " per work-item, local size "
+             << (launch_.local_size ? std::to_string(launch_.local_size) : "auto") << ".\n";
+}
+
+/**
+ * @brief Misura le configurazioni candidate su un vettore di TUNE_ELEMS elementi e restituisce
+ * la più veloce: il kernel base e le varianti <kernel>_v1/_v4/_v8 (se presenti nel sorgente)
+ * con più elementi per work-item, ognuna con le dimensioni di work-group ammesse dal device. La
+ * vincitrice viene confrontata con il kernel base prima di essere usata.
+ */
+KernelConfig Gpu_OpenCL_Accelerator::autotune() {
+   // Dimensione di tuning: non multipla di 8, per esercitare anche la coda delle varianti.
+   const size_t TUNE_ELEMS = (size_t(1) << 22) - 3;
+   const size_t LOCAL_SIZES[] = {0, 64, 128, 256, 512};
+   const size_t VECTORS_PER_ITEM[] = {1, 4, 16, 64};
+   const size_t VECTOR_WIDTHS[] = {1, 4, 8};
+
+   KernelConfig base;
+   base.variant = kernel_name_;
+
+   size_t n = std::min<size_t>(TUNE_ELEMS, max_alloc_bytes_ / sizeof(int));
+   cl_mem mem[3];
+   if (!create_test_buffers(n, mem)) {
+      std::cerr << "[WARNING] Gpu_OpenCL_Accelerator: Autotuning skipped, cannot allocate "
+                   "buffers.\n";
+      return base;
+   }
+   cl_mem a = mem[0], b = mem[1], c = mem[2];
+
+   // Candidate: il kernel base (un elemento per work-item) e le varianti presenti nel programma.
+   std::vector<KernelConfig> variants{base};
+   for (size_t width : VECTOR_WIDTHS) {
+      KernelConfig cfg;
+      cfg.variant = kernel_name_ + "_v" + std::to_string(width);
+      cfg.vector_width = width;
+      cl_int ret;
+      cl_kernel probe = clCreateKernel(program_, cfg.variant.c_str(), &ret);
+      if (!probe || ret != CL_SUCCESS)
+         continue;
+      clReleaseKernel(probe);
+      for (size_t per_item : VECTORS_PER_ITEM) {
+         cfg.vectors_per_item = per_item;
+         variants.push_back(cfg);
+      }
+   }
+
+   KernelConfig best;
+   double default_ns = 0;
+   size_t tried = 0;
+   for (KernelConfig cfg : variants) {
+      cl_int ret;
+      cl_kernel kernel = clCreateKernel(program_, cfg.variant.c_str(), &ret);
+      if (!kernel || ret != CL_SUCCESS)
+         continue;
+      size_t max_local = 0;
+      clGetKernelWorkGroupInfo(kernel, device_, CL_KERNEL_WORK_GROUP_SIZE, sizeof(max_local),
+                               &max_local, NULL);
+
+      for (size_t local : LOCAL_SIZES) {
+         if (local > max_local)
+            continue;
+         cfg.local_size = local;
+         cfg.ns = benchmark(kernel, cfg, a, b, c, n);
+         if (cfg.ns <= 0)
+            continue;
+         tried++;
+         if (cfg.variant == kernel_name_ && local == 0)
+            default_ns = cfg.ns;
+         if (best.ns <= 0 || cfg.ns < best.ns)
+            best = cfg;
+      }
+      clReleaseKernel(kernel);
+   }
+
+   if (best.ns <= 0 || !same_results(best, a, b, c, n)) {
+      std::cerr << "[WARNING] Gpu_OpenCL_Accelerator: Autotuning found no valid configuration, "
+                   "using the default one.\n";
+      best = base;
+   } else {
+      std::cerr << "[Gpu_OpenCL_Accelerator] Autotuning: " << tried << " configurations, best "
+                << best.ns / 1e6 << " ms per launch (default " << default_ns / 1e6 << " ms).\n";
+   }
+
+   release_test_buffers(mem);
+   return best;
+}
+
+/**
+ * @brief Tempo medio in ns di un lancio del kernel con la configurazione data, dopo un lancio
+ * di riscaldamento. Restituisce 0 se il lancio non è valido sul device.
+ */
+double Gpu_OpenCL_Accelerator::benchmark(cl_kernel kernel, const KernelConfig &cfg, cl_mem a,
+                                         cl_mem b, cl_mem c, size_t n) {
+   const int REPETITIONS = 5;
+   unsigned int n_arg = static_cast<unsigned int>(n);
+   cl_int ret = clSetKernelArg(kernel, 0, sizeof(cl_mem), &a);
+   ret |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &b);
+   ret |= clSetKernelArg(kernel, 2, sizeof(cl_mem), &c);
+   ret |= clSetKernelArg(kernel, 3, sizeof(unsigned int), &n_arg);
+   if (ret != CL_SUCCESS)
+      return 0;
+
+   size_t global_work_size = cfg.global_size(n);
+   const size_t *local_work_size = cfg.local_size > 0 ? &cfg.local_size : NULL;
+   auto launch = [&] {
+      return clEnqueueNDRangeKernel(queue_, kernel, 1, NULL, &global_work_size, local_work_size,
+                                    0, NULL, NULL);
+   };
+
+   if (launch() != CL_SUCCESS || clFinish(queue_) != CL_SUCCESS)
+      return 0;
+
+   auto t0 = std::chrono::steady_clock::now();
+   for (int r = 0; r < REPETITIONS; ++r)
+      if (launch() != CL_SUCCESS)
+         return 0;
+   clFinish(queue_);
+   auto t1 = std::chrono::steady_clock::now();
+
+   return double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) /
+          REPETITIONS;
+}
+
+/**
+ * @brief Verifica che la configurazione dia gli stessi risultati del kernel base.
+ */
+bool Gpu_OpenCL_Accelerator::same_results(const KernelConfig &cfg, cl_mem a, cl_mem b, cl_mem c,
+                                          size_t n) {
+   KernelConfig base;
+   base.variant = kernel_name_;
+   std::vector<int> expected(n), got(n);
+
+   const KernelConfig *runs[] = {&base, &cfg};
+   for (const KernelConfig *run : runs) {
+      cl_int ret;
+      cl_kernel kernel = clCreateKernel(program_, run->variant.c_str(), &ret);
+      if (!kernel || ret != CL_SUCCESS)
+         return false;
+      bool ok = run_and_read(kernel, *run, a, b, c, n, run == &base ? expected : got) > 0;
+      clReleaseKernel(kernel);
+      if (!ok)
+         return false;
+   }
+   return expected == got;
+}
+
+/**
+ * @brief Come benchmark(), poi legge l'output in out. Restituisce 0 se il lancio o la lettura
+ * falliscono.
+ */
+double Gpu_OpenCL_Accelerator::run_and_read(cl_kernel kernel, const KernelConfig &cfg, cl_mem a,
+                                            cl_mem b, cl_mem c, size_t n,
+                                            std::vector<int> &out) {
+   double ns = benchmark(kernel, cfg, a, b, c, n);
+   out.resize(n);
+   if (ns <= 0 || clEnqueueReadBuffer(queue_, c, CL_TRUE, 0, n * sizeof(int), out.data(), 0, NULL,
+                                      NULL) != CL_SUCCESS)
+      return 0;
+   return ns;
+}
+
+/**
+ * @brief Alloca i buffer di prova e scrive gli input: valori piccoli e variabili come quelli dei
+ * task (i polinomi non vanno in overflow), b è a rovesciato.
+ */
+bool Gpu_OpenCL_Accelerator::create_test_buffers(size_t n, cl_mem mem[3]) {
+   size_t bytes = n * sizeof(int);
+   cl_int ret_a, ret_b, ret_c;
+   mem[0] = clCreateBuffer(context_, CL_MEM_READ_ONLY, bytes, NULL, &ret_a);
+   mem[1] = clCreateBuffer(context_, CL_MEM_READ_ONLY, bytes, NULL, &ret_b);
+   mem[2] = clCreateBuffer(context_, CL_MEM_WRITE_ONLY, bytes, NULL, &ret_c);
+   if (ret_a != CL_SUCCESS || ret_b != CL_SUCCESS || ret_c != CL_SUCCESS) {
+      release_test_buffers(mem);
+      return false;
+   }
+
+   std::vector<int> host(n);
+   for (size_t i = 0; i < n; ++i)
+      host[i] = int(i % 201) - 100;
+   clEnqueueWriteBuffer(queue_, mem[0], CL_TRUE, 0, bytes, host.data(), 0, NULL, NULL);
+   std::reverse(host.begin(), host.end());
+   clEnqueueWriteBuffer(queue_, mem[1], CL_TRUE, 0, bytes, host.data(), 0, NULL, NULL);
+   return true;
+}
+
+void Gpu_OpenCL_Accelerator::release_test_buffers(cl_mem mem[3]) {
+   for (int i = 0; i < 3; ++i)
+      if (mem[i])
+         clReleaseMemObject(mem[i]);
+}
+
+/**
+ * @brief Kernel del buffer set creato dalla variante specializzata per n elementi, con tutti gli
+ * argomenti impostati. Come per il kernel del set, i buffer (argomenti 0-2) vengono legati alla
+ * creazione e di nuovo solo se il set li ha riallocati, n (argomento 3) solo quando cambia. Il
+ * kernel è usato solo da chi possiede il set, quindi gli argomenti non vanno protetti; il mutex
+ * protegge solo la mappa dei kernel (i riferimenti a std::map restano validi).
+ */
+cl_kernel Gpu_OpenCL_Accelerator::jit_kernel(size_t buffer_idx, BufferManager::BufferSet &set,
+                                             unsigned int n) {
+   cl_program program = specializer_->program_for(n);
+   if (!program)
+      return nullptr;
+
+   JitKernel *entry;
+   {
+      std::lock_guard<std::mutex> lock(jit_mutex_);
+      entry = &jit_kernels_[{buffer_idx, program}];
+      if (!entry->kernel) {
+         cl_int ret;
+         entry->kernel = clCreateKernel(program, launch_.variant.c_str(), &ret);
+         if (ret != CL_SUCCESS)
+            entry->kernel = nullptr;
+      }
+   }
+   if (!entry->kernel)
+      return nullptr;
+
+   cl_int ret = CL_SUCCESS;
+   if (entry->bound_generation != set.generation) {
+      ret |= clSetKernelArg(entry->kernel, 0, sizeof(cl_mem), &set.bufferA);
+      ret |= clSetKernelArg(entry->kernel, 1, sizeof(cl_mem), &set.bufferB);
+      ret |= clSetKernelArg(entry->kernel, 2, sizeof(cl_mem), &set.bufferC);
+      ret |= clSetKernelArg(entry->kernel, 3, sizeof(unsigned int), &n);
+      entry->bound_generation = ret == CL_SUCCESS ? set.generation : 0;
+      entry->bound_n = n;
+   } else if (entry->bound_n != n) {
+      ret = clSetKernelArg(entry->kernel, 3, sizeof(unsigned int), &n);
+      entry->bound_n = n;
+   }
+   return ret == CL_SUCCESS ? entry->kernel : nullptr;
+}
+
+/**
+ * @brief Misura su REPORT_ELEMS elementi la variante specializzata contro il programma preciso
+ * (compilato senza opzioni) e confronta i risultati: con -cl-fast-relaxed-math o un tipo diverso
+ * i kernel in virgola mobile possono dare risultati diversi, qui quantificati. La variante è
+ * compilata fuori dalla cache: nessun task ha REPORT_ELEMS elementi, quindi non deve occupare
+ * uno dei posti delle varianti per dimensione.
+ */
+void Gpu_OpenCL_Accelerator::report_specialization() {
+   const size_t REPORT_ELEMS = (size_t(1) << 20) - 3;
+   size_t n = std::min<size_t>(REPORT_ELEMS, max_alloc_bytes_ / sizeof(int));
+   std::string options = specializer_->build_options(n);
+
+   cl_mem mem[3];
+   if (!create_test_buffers(n, mem)) {
+      std::cerr << "[WARNING] Gpu_OpenCL_Accelerator: JIT report skipped, cannot allocate "
+                   "buffers.\n";
+      return;
+   }
+
+   cl_int ret;
+   cl_program program = specializer_->build_uncached(n);
+   cl_kernel precise_kernel = clCreateKernel(program_, launch_.variant.c_str(), &ret);
+   cl_kernel jit = program ? clCreateKernel(program, launch_.variant.c_str(), &ret) : nullptr;
+   std::vector<int> expected, got;
+   double precise_ns = 0, jit_ns = 0;
+   if (precise_kernel && jit) {
+      precise_ns = run_and_read(precise_kernel, launch_, mem[0], mem[1], mem[2], n, expected);
+      jit_ns = run_and_read(jit, launch_, mem[0], mem[1], mem[2], n, got);
+   }
+   if (precise_kernel)
+      clReleaseKernel(precise_kernel);
+   if (jit)
+      clReleaseKernel(jit);
+   if (program)
+      clReleaseProgram(program);
+   release_test_buffers(mem);
+
+   if (precise_ns <= 0 || jit_ns <= 0) {
+      std::cerr << "[WARNING] Gpu_OpenCL_Accelerator: JIT variant '" << options
+                << "' could not be measured.\n";
+      return;
+   }
+
+   size_t mismatches = 0;
+   long long max_error = 0;
+   for (size_t i = 0; i < n; ++i) {
+      long long error = std::llabs((long long)expected[i] - got[i]);
+      if (error > 0)
+         mismatches++;
+      max_error = std::max(max_error, error);
+   }
+   std::cerr << "[Gpu_OpenCL_Accelerator] JIT '" << options << "' on " << n << " elements: "
+             << jit_ns / 1e6 << " ms vs " << precise_ns / 1e6 << " ms precise (speedup "
+             << precise_ns / jit_ns << "x), " << mismatches << " different results, max abs "
+             << "error " << max_error << ".\n";
+}
+
+/**
+ * @brief Work-group lanciati da una riduzione su n elementi: uno ogni reduce_local_ elementi, al
+ * più MAX_REDUCE_GROUPS (oltre, ogni work-item accumula più elementi).
+ */
+size_t Gpu_OpenCL_Accelerator::reduce_groups(size_t n) const {
+   size_t groups = (n + reduce_local_ - 1) / reduce_local_;
+   return std::min(MAX_REDUCE_GROUPS, std::max<size_t>(1, groups));
+}
+
+// Dimensione di un parziale: la somma è accumulata a 64 bit.
+size_t Gpu_OpenCL_Accelerator::reduce_partial_bytes() const {
+   return kind_ == CpuKernel::ReduceSum ? sizeof(cl_long) : sizeof(int);
+}
+
+// Byte scaricati da una riduzione: l'istogramma, il risultato combinato sul device o i parziali.
+size_t Gpu_OpenCL_Accelerator::reduce_download_bytes(size_t n) const {
+   if (kind_ == CpuKernel::Histogram)
+      return HISTOGRAM_BINS * sizeof(int);
+   if (reduce_on_device_)
+      return reduce_partial_bytes();
+   return reduce_groups(n) * reduce_partial_bytes();
+}
+
+/**
+ * @brief Accoda una riduzione: il kernel (con gli argomenti già impostati) scrive un parziale per
+ * work-group in C e, con reduce_on_device_, il kernel <kernel>_final del set li combina in C[0]
+ * con un solo work-group. L'istogramma è già combinato dalle atomiche del kernel.
+ */
+void Gpu_OpenCL_Accelerator::enqueue_reduction(Task *task, BufferManager::BufferSet &set,
+                                               cl_kernel kernel) {
+   cl_int ret; // Codice di ritorno delle chiamate OpenCL
+   cl_event previous_event = task->event;
+   size_t groups = reduce_groups(task->n);
+   size_t global_work_size = groups * reduce_local_;
+   OCL_CHECK(ret,
+             clEnqueueNDRangeKernel(queue_, kernel, 1, NULL, &global_work_size, &reduce_local_,
+                                    1, &previous_event, &task->event),
+             return);
+   if (previous_event)
+      clReleaseEvent(previous_event);
+
+   if (!reduce_on_device_ || kind_ == CpuKernel::Histogram)
+      return;
+
+   // Il kernel finale è usato solo da chi possiede il set, come il kernel del set.
+   cl_kernel final_kernel;
+   {
+      std::lock_guard<std::mutex> lock(final_mutex_);
+      cl_kernel &cached = final_kernels_[task->buffer_idx];
+      if (!cached) {
+         cached = clCreateKernel(program_, (kernel_name_ + "_final").c_str(), &ret);
+         if (ret != CL_SUCCESS)
+            cached = nullptr;
+      }
+      final_kernel = cached;
+   }
+   cl_uint count = static_cast<cl_uint>(groups);
+   if (final_kernel) {
+      ret = clSetKernelArg(final_kernel, 0, sizeof(cl_mem), &set.bufferC);
+      ret |= clSetKernelArg(final_kernel, 1, sizeof(cl_uint), &count);
+   }
+   if (!final_kernel || ret != CL_SUCCESS) {
+      std::cerr << "[ERROR] Gpu_OpenCL_Accelerator: Failed to prepare kernel '" << kernel_name_
+                << "_final'.\n";
+      return;
+   }
+
+   cl_event partials_ready = task->event;
+   OCL_CHECK(ret,
+             clEnqueueNDRangeKernel(queue_, final_kernel, 1, NULL, &reduce_local_,
+                                    &reduce_local_, 1, &partials_ready, &task->event),
+             return);
+   clReleaseEvent(partials_ready);
+}
+
+/**
+ * @brief Combina sull'host i parziali scaricati (uno per work-group) e scrive il risultato
+ * all'inizio di c, nello stesso formato dei kernel CPU.
+ */
+void Gpu_OpenCL_Accelerator::combine_partials(const void *partials, size_t groups,
+                                              int *c) const {
+   ReduceResult r;
+   if (kind_ == CpuKernel::ReduceSum) {
+      const cl_long *sums = static_cast<const cl_long *>(partials);
+      for (size_t g = 0; g < groups; ++g)
+         r.sum += sums[g];
+   } else {
+      const int *values = static_cast<const int *>(partials);
+      for (size_t g = 0; g < groups; ++g) {
+         r.min = std::min(r.min, values[g]);
+         r.max = std::max(r.max, values[g]);
+      }
+   }
+   store_reduce(kind_, r, c);
+}
+
+// Matrici, stencil e SpMV hanno il proprio lancio, descritto dal task invece che da n.
+bool Gpu_OpenCL_Accelerator::has_own_launch() const {
+   return kind_ == CpuKernel::Gemm || stencil_points(kind_) > 0 || is_spmv(kind_);
+}
+
+/**
+ * @brief Accoda la moltiplicazione di matrici: imposta le dimensioni del descrittore (gli
+ * argomenti 0-2 sono già legati ai buffer del set) e lancia un work-item per elemento di C, con
+ * la griglia arrotondata a multipli di GEMM_TILE (i work-item fuori da C non scrivono).
+ */
+void Gpu_OpenCL_Accelerator::enqueue_gemm(Task *task, BufferManager::BufferSet &set) {
+   cl_int ret; // Codice di ritorno delle chiamate OpenCL
+   cl_event previous_event = task->event;
+   const MatrixDesc &d = task->mat;
+   const cl_uint dims[6] = {static_cast<cl_uint>(d.m),   static_cast<cl_uint>(d.n),
+                            static_cast<cl_uint>(d.k),   static_cast<cl_uint>(d.lda),
+                            static_cast<cl_uint>(d.ldb), static_cast<cl_uint>(d.ldc)};
+   for (cl_uint i = 0; i < 6; ++i)
+      OCL_CHECK(ret, clSetKernelArg(set.kernel, 3 + i, sizeof(cl_uint), &dims[i]), return);
+
+   const size_t global_work_size[2] = {(d.n + GEMM_TILE - 1) / GEMM_TILE * GEMM_TILE,
+                                       (d.m + GEMM_TILE - 1) / GEMM_TILE * GEMM_TILE};
+   const size_t local_work_size[2] = {GEMM_TILE, GEMM_TILE};
+   OCL_CHECK(ret,
+             clEnqueueNDRangeKernel(queue_, set.kernel, 2, NULL, global_work_size,
+                                    local_work_size, 1, &previous_event, &task->event),
+             return);
+   if (previous_event)
+      clReleaseEvent(previous_event);
+}
+
+/**
+ * @brief Esegue gli sweep di un task stencil sul device: ogni sweep legge il buffer scritto dal
+ * precedente (A e C si alternano come input e output), quindi la griglia non torna sull'host fra
+ * uno sweep e l'altro. Un work-item per cella del tile, alone compreso.
+ */
+void Gpu_OpenCL_Accelerator::enqueue_stencil(Task *task, BufferManager::BufferSet &set) {
+   cl_int ret; // Codice di ritorno delle chiamate OpenCL
+   const GridDesc &g = task->grid;
+   const cl_uint rows = static_cast<cl_uint>(g.rows), cols = static_cast<cl_uint>(g.cols);
+   OCL_CHECK(ret, clSetKernelArg(set.kernel, 3, sizeof(cl_uint), &rows), return);
+   OCL_CHECK(ret, clSetKernelArg(set.kernel, 4, sizeof(cl_uint), &cols), return);
+
+   const size_t global_work_size[2] = {(g.cols + STENCIL_TILE - 1) / STENCIL_TILE * STENCIL_TILE,
+                                       (g.rows + STENCIL_TILE - 1) / STENCIL_TILE * STENCIL_TILE};
+   const size_t local_work_size[2] = {STENCIL_TILE, STENCIL_TILE};
+   cl_mem src = set.bufferA, dst = set.bufferC;
+   for (size_t s = 0; s < g.steps; ++s) {
+      OCL_CHECK(ret, clSetKernelArg(set.kernel, 0, sizeof(cl_mem), &src), return);
+      OCL_CHECK(ret, clSetKernelArg(set.kernel, 2, sizeof(cl_mem), &dst), return);
+      cl_event previous_event = task->event;
+      OCL_CHECK(ret,
+                clEnqueueNDRangeKernel(queue_, set.kernel, 2, NULL, global_work_size,
+                                       local_work_size, 1, &previous_event, &task->event),
+                return);
+      if (previous_event)
+         clReleaseEvent(previous_event);
+      std::swap(src, dst);
+   }
+}
+
+/**
+ * @brief Accoda una SpMV: imposta righe ed elementi non nulli (gli argomenti 0-2 sono già legati
+ * ai buffer del set) e lancia un work-item per riga (spmv_csr, work-group scelto dal runtime) o
+ * un work-group di SPMV_VECTOR_WIDTH work-item per riga (spmv_csr_vector).
+ */
+void Gpu_OpenCL_Accelerator::enqueue_spmv(Task *task, BufferManager::BufferSet &set) {
+   cl_int ret; // Codice di ritorno delle chiamate OpenCL
+   cl_event previous_event = task->event;
+   const CsrDesc &d = task->csr;
+   const cl_uint rows = static_cast<cl_uint>(d.rows), nnz = static_cast<cl_uint>(d.nnz);
+   OCL_CHECK(ret, clSetKernelArg(set.kernel, 3, sizeof(cl_uint), &rows), return);
+   OCL_CHECK(ret, clSetKernelArg(set.kernel, 4, sizeof(cl_uint), &nnz), return);
+
+   const bool vector = kind_ == CpuKernel::SpmvCsrVector;
+   const size_t global_work_size = vector ? d.rows * SPMV_VECTOR_WIDTH : d.rows;
+   const size_t local_work_size = SPMV_VECTOR_WIDTH;
+   OCL_CHECK(ret,
+             clEnqueueNDRangeKernel(queue_, set.kernel, 1, NULL, &global_work_size,
+                                    vector ? &local_work_size : NULL, 1, &previous_event,
+                                    &task->event),
+             return);
+   if (previous_event)
+      clReleaseEvent(previous_event);
+}
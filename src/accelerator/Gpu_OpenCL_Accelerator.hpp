@@ -1,8 +1,16 @@
 #pragma once
 
+#include "../cpu_runner/CpuKernels.hpp"
+#include "../profiling/TuningCache.hpp"
 #include "BufferManager.hpp"
 #include "IAccelerator.hpp"
+#include "KernelSpecializer.hpp"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #ifdef __APPLE__
 #include <OpenCL/opencl.h>
@@ -18,11 +26,51 @@
  * funzioni qui dichiarate send_data_to_device() e execute_kernel().
  * - Il thread Consumer esegue lo stadio di Download, utilizzando la
  * funzione qui dichiarata get_results_from_device().
+ *
+ * I task troppo grandi per un buffer del device (CL_DEVICE_MAX_MEM_ALLOC_SIZE), o con più di
+ * tile_elems elementi se specificato, vengono eseguiti a tile: il task attraversa il device a
+ * pezzi, usando 3 slot di buffer a rotazione e 3 code (upload, calcolo, download), così l'upload
+ * del tile k+1, il calcolo del tile k e il download del tile k-1 si sovrappongono.
+ *
+ * Con l'autotuning (tune_cache non vuoto) initialize() sceglie la configurazione di lancio del
+ * kernel (variante con vettori int4/int8, elementi per work-item, dimensione del work-group)
+ * misurando le candidate sul device, e la salva nella cache per device e kernel: le esecuzioni
+ * successive la rileggono senza ripetere la ricerca.
+ *
+ * Con la specializzazione JIT (JitOptions) i task usano varianti del programma compilate con
+ * costanti e flag di build dedicati (dimensione del task, tipo dei calcoli, math veloce), create
+ * alla prima richiesta da KernelSpecializer. initialize() confronta tempo e risultati della
+ * variante con quelli del programma preciso.
+ *
+ * Le riduzioni (reduce_sum, reduce_min, reduce_max, histogram) sono gerarchiche: il kernel riduce
+ * ogni work-group in memoria locale e scrive un parziale per gruppo (al più MAX_REDUCE_GROUPS),
+ * poi i parziali vengono combinati sull'host o, con reduce_on_device, da un secondo kernel
+ * <kernel>_final a un solo work-group. Viene caricato solo a e scaricati solo i parziali (o il
+ * risultato), quindi il trasferimento non cresce più con n in uscita. Il distruttore riporta i
+ * byte trasferiti nelle due direzioni.
+ *
+ * La moltiplicazione di matrici (gemm) usa il descrittore del task (Task::mat): carica A e B,
+ * lancia una griglia 2D di work-group GEMM_TILE x GEMM_TILE (un work-item per elemento di C) e
+ * scarica C. Gli stencil (stencil5, stencil9) usano il descrittore Task::grid: il tile con
+ * l'alone viene caricato una volta, gli steps sweep si alternano fra i buffer A e C del set
+ * senza tornare all'host e alla fine vengono scaricate solo le righe del tile. Le SpMV (spmv_csr,
+ * spmv_csr_vector) usano il descrittore Task::csr: row_ptr, col_idx e values vengono caricati uno
+ * dopo l'altro nel buffer A, x in B, e y viene scaricato da C; spmv_csr lancia un work-item per
+ * riga, spmv_csr_vector un work-group di SPMV_VECTOR_WIDTH work-item per riga. Questi kernel
+ * hanno un lancio proprio: non vengono mai eseguiti a tile né con autotuning o specializzazione
+ * JIT.
  */
 class Gpu_OpenCL_Accelerator : public IAccelerator {
  public:
-   Gpu_OpenCL_Accelerator(const std::string &kernel_path,
-                  const std::string &kernel_name);
+   // Se device è nullptr, initialize() usa la prima GPU della prima piattaforma. Se tile_elems
+   // è > 0 i task con più elementi vengono eseguiti a tile di quella dimensione. Se tune_cache
+   // non è vuoto abilita l'autotuning, con le configurazioni salvate in quel file. jit sceglie
+   // le varianti specializzate del programma (nessuna di default). reduce_on_device combina
+   // sul device i parziali delle riduzioni (altrimenti li combina l'host).
+   Gpu_OpenCL_Accelerator(const std::string &kernel_path, const std::string &kernel_name,
+                          cl_device_id device = nullptr, size_t tile_elems = 0,
+                          const std::string &tune_cache = "",
+                          const JitOptions &jit = JitOptions(), bool reduce_on_device = false);
    ~Gpu_OpenCL_Accelerator() override;
 
    // Esegue tutte le operazioni di setup una volta sola (creare contesto,
@@ -32,6 +80,11 @@ class Gpu_OpenCL_Accelerator : public IAccelerator {
    // Metodi per l'acquisizione e il rilascio dei buffer.
    size_t acquire_buffer_set() override;
    void release_buffer_set(size_t index) override;
+   size_t buffer_set_count() const override;
+   // I task a tile usano gli slot dei tile, non un set del pool.
+   bool uses_buffer_set(const void *task_context) const override {
+      return !is_tiled(static_cast<const Task *>(task_context));
+   }
 
    // Metoodi utili per i thread della pipeline interna.
    void send_data_to_device(void *task_context) override;
@@ -40,10 +93,90 @@ class Gpu_OpenCL_Accelerator : public IAccelerator {
                                 long long &computed_ns) override;
 
  private:
+   // Esecuzione a tile dei task più grandi di un tile.
+   size_t effective_tile_elems() const;
+   bool is_tiled(const Task *task) const;
+   bool allocate_tile_buffers(size_t tile_bytes);
+   void enqueue_tiled(Task *task);
+
+   // Autotuning della configurazione di lancio (launch_).
+   void select_launch_config();
+   KernelConfig autotune();
+   double benchmark(cl_kernel kernel, const KernelConfig &cfg, cl_mem a, cl_mem b, cl_mem c,
+                    size_t n);
+   bool same_results(const KernelConfig &cfg, cl_mem a, cl_mem b, cl_mem c, size_t n);
+   double run_and_read(cl_kernel kernel, const KernelConfig &cfg, cl_mem a, cl_mem b, cl_mem c,
+                       size_t n, std::vector<int> &out);
+
+   // Buffer di prova (a, b con input come quelli dei task, c per l'output) per le misure.
+   bool create_test_buffers(size_t n, cl_mem mem[3]);
+   void release_test_buffers(cl_mem mem[3]);
+
+   // Specializzazione JIT: kernel della variante per n elementi legato ai buffer del set
+   // (nullptr se la variante non è disponibile) e confronto con il programma preciso.
+   cl_kernel jit_kernel(size_t buffer_idx, BufferManager::BufferSet &set, unsigned int n);
+   void report_specialization();
+
+   // Riduzioni: work-group lanciati per n elementi, byte dei parziali (o del risultato) da
+   // scaricare, lancio dei kernel e combinazione dei parziali sull'host.
+   size_t reduce_groups(size_t n) const;
+   size_t reduce_partial_bytes() const;
+   size_t reduce_download_bytes(size_t n) const;
+   void enqueue_reduction(Task *task, BufferManager::BufferSet &set, cl_kernel kernel);
+   void combine_partials(const void *partials, size_t groups, int *c) const;
+
+   // Kernel con un lancio proprio descritto dal task (gemm, stencil e SpMV), argomenti del
+   // descrittore e lanci.
+   bool has_own_launch() const;
+   void enqueue_gemm(Task *task, BufferManager::BufferSet &set);
+   void enqueue_stencil(Task *task, BufferManager::BufferSet &set);
+   void enqueue_spmv(Task *task, BufferManager::BufferSet &set);
+
+   cl_device_id device_{nullptr};    // Il device OpenCL (scelto qui o dal chiamante)
    cl_context context_{nullptr};     // Il contesto OpenCL
    cl_command_queue queue_{nullptr}; // La coda di comandi OpenCL
    cl_program program_{nullptr};     // Il programma OpenCL (kernel compilato)
-   cl_kernel kernel_{nullptr};       // Il kernel OpenCL (func da eseguire)
+   cl_kernel kernel_{nullptr};       // Il kernel dei task a tile (i buffer set hanno il proprio)
+
+   // Configurazione di lancio del kernel (di default il kernel base, un elemento per work-item,
+   // work-group scelto dal runtime) e cache dell'autotuner (vuota = autotuning disabilitato).
+   KernelConfig launch_;
+   std::string tune_cache_;
+
+   // Specializzazione JIT: varianti compilate e kernel creati da ciascuna per ogni buffer set.
+   // Come il kernel del set, ha i buffer legati una volta (di nuovo solo se il set li
+   // rialloca) e n impostato solo quando cambia.
+   struct JitKernel {
+      cl_kernel kernel{nullptr};
+      unsigned int bound_generation{0}; // Generazione dei buffer del set legati (0 = nessuna)
+      unsigned int bound_n{0};          // Ultimo valore dell'argomento n (3) impostato
+   };
+   JitOptions jit_;
+   std::unique_ptr<KernelSpecializer> specializer_;
+   std::map<std::pair<size_t, cl_program>, JitKernel> jit_kernels_;
+   std::mutex jit_mutex_;
+
+   // Riduzioni: dimensione del work-group (potenza di 2, al più REDUCE_LOCAL_MAX come nei .cl),
+   // combinazione finale sul device e kernel <kernel>_final di ogni buffer set.
+   static constexpr size_t REDUCE_LOCAL_MAX = 256;
+   static constexpr size_t MAX_REDUCE_GROUPS = 1024;
+   CpuKernel kind_;
+   bool reduce_on_device_;
+   size_t reduce_local_{0};
+   std::map<size_t, cl_kernel> final_kernels_;
+   std::mutex final_mutex_;
+
+   // Lato dei work-group della moltiplicazione di matrici e degli stencil (come GEMM_TILE di
+   // gemm.cl e STENCIL_TILE di stencil5.cl e stencil9.cl).
+   static constexpr size_t GEMM_TILE = 16;
+   static constexpr size_t STENCIL_TILE = 16;
+
+   // Work-item per riga di spmv_csr_vector (come SPMV_VECTOR_WIDTH di spmv_csr_vector.cl).
+   static constexpr size_t SPMV_VECTOR_WIDTH = 32;
+
+   // Byte trasferiti verso il device e dal device.
+   std::atomic<unsigned long long> bytes_up_{0};
+   std::atomic<unsigned long long> bytes_down_{0};
 
    // Incapsula la logica per l'acquisizione, il rilascio e la riallocazione dei
    // buffer di memoria sul device.
@@ -51,4 +184,16 @@ class Gpu_OpenCL_Accelerator : public IAccelerator {
 
    std::string kernel_path_;
    std::string kernel_name_;
+
+   // Dati per l'esecuzione a tile.
+   static constexpr size_t NUM_TILE_SLOTS = 3;
+   size_t tile_elems_{0};                // Elementi per tile richiesti (0 = automatico)
+   cl_ulong max_alloc_bytes_{0};         // Dimensione massima di un buffer sul device
+   cl_command_queue h2d_queue_{nullptr}; // Coda degli upload dei tile
+   cl_command_queue d2h_queue_{nullptr}; // Coda dei download dei tile
+   BufferManager::BufferSet tile_slots_[NUM_TILE_SLOTS];
+   cl_event slot_free_[NUM_TILE_SLOTS]{}; // Ultimo download di ogni slot
+   size_t tile_slot_bytes_{0};
+   size_t next_slot_{0};
+   std::mutex tile_mutex_; // Serializza l'accodamento dei task a tile
 };
\ No newline at end of file
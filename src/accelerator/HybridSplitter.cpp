@@ -0,0 +1,153 @@
+#include "HybridSplitter.hpp"
+#include <algorithm>
+#include <iostream>
+
+HybridSplitter::HybridSplitter(const std::string &kernel_name, double initial_acc_ratio)
+    : kernel_name_(kernel_name), kernel_(parse_cpu_kernel(kernel_name)),
+      acc_ratio_(std::clamp(initial_acc_ratio, MIN_SHARE, 1.0 - MIN_SHARE)) {}
+
+int HybridSplitter::svc_init() {
+   if (kernel_ == CpuKernel::Unknown) {
+      std::cerr << "[ERROR] HybridSplitter: No CPU implementation for kernel '" << kernel_name_
+                << "'.\n";
+      return -1;
+   }
+   // Una riduzione divisa in due darebbe due risultati parziali da combinare: non supportata.
+   if (is_reduction(kernel_)) {
+      std::cerr << "[ERROR] HybridSplitter: Reduction kernel '" << kernel_name_
+                << "' cannot be split between CPU and accelerator.\n";
+      return -1;
+   }
+   for (Join &join : joins_) {
+      join.owner = this;
+      free_joins_.push(&join);
+   }
+   cpuTh_ = std::thread(&HybridSplitter::cpuLoop, this);
+   return 0;
+}
+
+/**
+ * @brief Divide il task e inoltra le due parti senza attenderle: la coda al nodo acceleratore,
+ * la testa al thread CPU interno.
+ */
+void *HybridSplitter::svc(void *t) {
+   auto *task = static_cast<Task *>(t);
+   size_t n = task->n;
+   size_t n_acc = std::min(n, static_cast<size_t>(acc_ratio_ * n));
+   size_t n_cpu = n - n_acc;
+
+   std::cerr << "[HybridSplitter] Task " << task->id << ": " << n_cpu << " elements on CPU, "
+             << n_acc << " on accelerator.\n";
+
+   Join *join = free_joins_.pop();
+   join->parent = task;
+   join->n_cpu = n_cpu;
+   join->n_acc = n_acc;
+   join->cpu_ns = 0;
+   join->acc_ns = 0;
+   join->pending = (n_acc > 0) + (n_cpu > 0);
+   if (join->pending == 0) {
+      complete(join);
+      return FF_GO_ON;
+   }
+
+   // Parte acceleratore: sotto-task sulla coda dei vettori, inviato subito al nodo successivo.
+   if (n_acc > 0) {
+      Task *sub_task = sub_tasks_.acquire();
+      sub_task->a = task->a + n_cpu;
+      sub_task->b = task->b + n_cpu;
+      sub_task->c = task->c + n_cpu;
+      sub_task->n = n_acc;
+      sub_task->id = task->id;
+      sub_task->on_complete = &HybridSplitter::on_acc_part_done;
+      sub_task->on_complete_ctx = join;
+      join->acc_sent = std::chrono::steady_clock::now();
+      ff_send_out(sub_task);
+   }
+
+   // Parte CPU: la testa dei vettori, calcolata dal thread interno.
+   if (n_cpu > 0)
+      cpuQ_.push(join);
+   return FF_GO_ON;
+}
+
+/**
+ * @brief Ferma il thread CPU dopo le parti già accodate. Le parti acceleratore ancora in volo
+ * vengono completate dal consumer di ff_node_acc_t.
+ */
+void HybridSplitter::svc_end() {
+   cpuQ_.push(nullptr);
+   if (cpuTh_.joinable())
+      cpuTh_.join();
+}
+
+void HybridSplitter::cpuLoop() {
+   while (Join *join = cpuQ_.pop()) {
+      Task *task = join->parent;
+      auto t0 = std::chrono::steady_clock::now();
+      pf_.parallel_for_idx(0, join->n_cpu, 1, 0, [&](const long begin, const long end, const int) {
+         run_cpu_kernel(kernel_, task->a, task->b, task->c, begin, end);
+      });
+      join->cpu_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - t0)
+                        .count();
+      part_done(join);
+   }
+}
+
+void HybridSplitter::on_acc_part_done(Task *, void *ctx) {
+   auto *join = static_cast<Join *>(ctx);
+   HybridSplitter *self = join->owner;
+   auto end = std::chrono::steady_clock::now();
+   {
+      std::lock_guard<std::mutex> lock(self->stats_mutex_);
+      join->acc_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        end - std::max(join->acc_sent, self->last_acc_end_))
+                        .count();
+      self->last_acc_end_ = end;
+   }
+   self->part_done(join);
+}
+
+void HybridSplitter::part_done(Join *join) {
+   if (join->pending.fetch_sub(1) == 1)
+      complete(join);
+}
+
+/**
+ * @brief Completa il task di join (entrambe le parti sono terminate): aggiorna la frazione e le
+ * statistiche, rilascia il task e rimette il record fra quelli liberi.
+ */
+void HybridSplitter::complete(Join *join) {
+   auto now = std::chrono::steady_clock::now();
+   {
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      cpu_ns_ += join->cpu_ns;
+      acc_ns_ += join->acc_ns;
+
+      // Frazione che avrebbe fatto finire insieme le due parti, dai throughput misurati.
+      if (join->n_acc > 0 && join->n_cpu > 0 && join->cpu_ns > 0 && join->acc_ns > 0) {
+         double thr_cpu = double(join->n_cpu) / join->cpu_ns;
+         double thr_acc = double(join->n_acc) / join->acc_ns;
+         double target = thr_acc / (thr_acc + thr_cpu);
+         acc_ratio_ = std::clamp(RATIO_ALPHA * target + (1 - RATIO_ALPHA) * acc_ratio_,
+                                 MIN_SHARE, 1.0 - MIN_SHARE);
+      }
+
+      if (tasks_completed_ == 0)
+         first_completion_ = now;
+      last_completion_ = now;
+      tasks_completed_++;
+   }
+   release_task(join->parent);
+   join->parent = nullptr;
+   free_joins_.push(join);
+}
+
+long long HybridSplitter::inter_completion_ns() const {
+   if (tasks_completed_ < 2)
+      return 0;
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(last_completion_ -
+                                                               first_completion_)
+      .count();
+}
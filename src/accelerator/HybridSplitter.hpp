@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../../include/ff_includes.hpp"
+#include "../common/BlockingQueue.hpp"
+#include "../common/TaskPool.hpp"
+#include "../cpu_runner/CpuKernels.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Nodo FastFlow che esegue ogni Task in modo ibrido, dividendo il suo intervallo di indici
+ * fra CPU e acceleratore.
+ *
+ * Va messo in pipeline prima di ff_node_acc_t (Emitter -> HybridSplitter -> ff_node_acc_t). Per
+ * ogni task invia al nodo acceleratore un sotto-task con la coda [n_cpu, n) dei vettori e passa
+ * la testa [0, n_cpu) a un thread interno, che la calcola sull'host con ParallelFor. svc non
+ * attende le due parti: il task successivo viene diviso subito, così CPU e acceleratore restano
+ * occupati anche fra un task e l'altro. Entrambe le parti scrivono nello stesso vettore di output;
+ * l'ultima che termina (join a valle, su un record Join) completa il task e lo rilascia.
+ *
+ * La frazione assegnata all'acceleratore si adatta a ogni task: dai tempi di servizio misurati si
+ * ricavano i throughput (elementi/s) delle due parti e la frazione tende a quella che le farebbe
+ * finire insieme, thr_acc / (thr_acc + thr_cpu).
+ */
+class HybridSplitter : public ff_node {
+ public:
+   /**
+    * @param kernel_name Kernel da eseguire (anche nella forma krnl_* dei kernel FPGA).
+    * @param initial_acc_ratio Frazione iniziale degli elementi assegnata all'acceleratore.
+    */
+   HybridSplitter(const std::string &kernel_name, double initial_acc_ratio);
+
+   // Statistiche lette dal main a fine esecuzione.
+   size_t tasks_completed() const { return tasks_completed_; }
+   double acc_ratio() const { return acc_ratio_; }
+   long long cpu_ns() const { return cpu_ns_; }
+   long long acc_ns() const { return acc_ns_; }
+   // Tempo fra il primo e l'ultimo task completato per intero (0 con meno di due task).
+   long long inter_completion_ns() const;
+
+ protected:
+   int svc_init() override;
+   void *svc(void *t) override;
+   void svc_end() override;
+
+ private:
+   // Stato di un task diviso, in attesa che terminino entrambe le parti.
+   struct Join {
+      HybridSplitter *owner = nullptr;
+      Task *parent = nullptr;
+      size_t n_cpu = 0;
+      size_t n_acc = 0;
+      std::atomic<int> pending{0}; // Parti ancora in corso
+      long long cpu_ns = 0;        // Tempo di calcolo della parte CPU
+      long long acc_ns = 0;        // Tempo di servizio della parte acceleratore
+      std::chrono::steady_clock::time_point acc_sent;
+   };
+
+   // Loop del thread interno che calcola le parti CPU.
+   void cpuLoop();
+
+   // Callback del sotto-task, invocata dal consumer di ff_node_acc_t.
+   static void on_acc_part_done(Task *sub_task, void *ctx);
+
+   // Segna come terminata una parte di join; l'ultima completa il task.
+   void part_done(Join *join);
+   void complete(Join *join);
+
+   // Frazione minima lasciata a ciascuna parte, così entrambe continuano a essere misurate.
+   static constexpr double MIN_SHARE = 0.02;
+   // Peso della nuova stima nella media mobile della frazione.
+   static constexpr double RATIO_ALPHA = 0.5;
+   // Task divisi in volo: oltre questo limite svc attende che uno venga completato.
+   static constexpr size_t MAX_IN_FLIGHT = 8;
+
+   std::string kernel_name_;
+   CpuKernel kernel_;
+   ParallelFor pf_;
+
+   // Sotto-task per la parte acceleratore, uno per task in volo, riciclati a ogni task.
+   TaskPool sub_tasks_{MAX_IN_FLIGHT};
+
+   // Record di join preallocati e quelli liberi: pop blocca quando sono tutti in volo.
+   Join joins_[MAX_IN_FLIGHT];
+   BlockingQueue<Join *> free_joins_;
+
+   // Parti CPU da calcolare; nullptr ferma il thread.
+   BlockingQueue<Join *> cpuQ_;
+   std::thread cpuTh_;
+
+   std::atomic<double> acc_ratio_;
+   std::atomic<size_t> tasks_completed_{0};
+
+   // Statistiche aggiornate dal thread CPU e dal consumer di ff_node_acc_t.
+   std::mutex stats_mutex_;
+   long long cpu_ns_{0}; // Tempo totale della parte CPU
+   long long acc_ns_{0}; // Tempo di servizio totale della parte acceleratore
+   // Fine dell'ultima parte acceleratore: le parti si accodano sul device, quindi il servizio di
+   // una parte inizia al più presto quando termina la precedente.
+   std::chrono::steady_clock::time_point last_acc_end_;
+   std::chrono::steady_clock::time_point first_completion_, last_completion_;
+};
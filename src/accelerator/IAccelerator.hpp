@@ -29,12 +29,36 @@ class IAccelerator {
     */
    virtual size_t acquire_buffer_set() = 0;
 
+   /**
+    * @brief Come acquire_buffer_set(), sapendo quale task userà il set. Gli acceleratori
+    * condivisi fra più tenant lo usano per addebitare il task prima di scegliere il prossimo.
+    */
+   virtual size_t acquire_buffer_set_for(const void *task_context) {
+      (void)task_context;
+      return acquire_buffer_set();
+   }
+
    /**
     * @brief Rilascia un set di buffer nel pool del device.
     * @param index L'indice del set da rilasciare.
     */
    virtual void release_buffer_set(size_t index) = 0;
 
+   /**
+    * @brief Numero di buffer set del pool (valido dopo initialize()), cioè quanti task possono
+    * essere sul device contemporaneamente.
+    */
+   virtual size_t buffer_set_count() const = 0;
+
+   /**
+    * @brief Indica se il task ha bisogno di un buffer set del pool. Gli acceleratori che
+    * eseguono alcuni task con buffer propri (es. a tile) restituiscono false per questi.
+    */
+   virtual bool uses_buffer_set(const void *task_context) const {
+      (void)task_context;
+      return true;
+   }
+
    /**
     * @brief Stadio 1 - Upload: Invia i dati di input dall'host al device.
     * @param task_context Puntatore a un oggetto Task che contiene i dati e lo
@@ -0,0 +1,89 @@
+#include "KernelSpecializer.hpp"
+#include <iostream>
+#include <vector>
+
+KernelSpecializer::KernelSpecializer(cl_context context, cl_device_id device,
+                                     const std::string &source, const JitOptions &options)
+    : context_(context), device_(device), source_(source), options_(options),
+      common_options_(options.defines) {
+   if (options_.real_type != "float") {
+      common_options_ += std::string(common_options_.empty() ? "" : " ") + "-DREAL_T=" +
+                         options_.real_type;
+      if (options_.real_type == "double")
+         common_options_ += " -DUSE_FP64";
+   }
+   if (options_.fast_math)
+      common_options_ += std::string(common_options_.empty() ? "" : " ") +
+                         "-cl-fast-relaxed-math -cl-mad-enable";
+   if (options_.heavy_iters > 0)
+      common_options_ += std::string(common_options_.empty() ? "" : " ") +
+                         "-DHEAVY_ITERS=" + std::to_string(options_.heavy_iters);
+}
+
+KernelSpecializer::~KernelSpecializer() {
+   for (auto &entry : programs_)
+      if (entry.second)
+         clReleaseProgram(entry.second);
+}
+
+std::string KernelSpecializer::build_options(size_t n) const {
+   if (!options_.by_size)
+      return common_options_;
+   return common_options_ + (common_options_.empty() ? "" : " ") + "-DSPEC_N=" +
+          std::to_string(n) + "u";
+}
+
+cl_program KernelSpecializer::program_for(size_t n) {
+   std::lock_guard<std::mutex> lock(mutex_);
+
+   std::string options = build_options(n);
+   auto it = programs_.find(options);
+   if (it != programs_.end())
+      return it->second;
+
+   // Troppe dimensioni diverse: non vale la pena compilare altre varianti.
+   if (options_.by_size && size_variants_ >= MAX_SIZE_VARIANTS) {
+      options = common_options_;
+      it = programs_.find(options);
+      if (it != programs_.end())
+         return it->second;
+   } else if (options_.by_size) {
+      size_variants_++;
+   }
+
+   // Anche un fallimento resta in cache (nullptr), così non viene ritentato a ogni task.
+   cl_program program = build(options);
+   programs_[options] = program;
+   return program;
+}
+
+/**
+ * @brief Compila il sorgente con le opzioni date. Restituisce nullptr (stampando il log di
+ * compilazione) se fallisce.
+ */
+cl_program KernelSpecializer::build(const std::string &options) {
+   cl_int ret;
+   const char *source_str = source_.c_str();
+   size_t source_size = source_.length();
+   cl_program program = clCreateProgramWithSource(context_, 1, &source_str, &source_size, &ret);
+   if (!program || ret != CL_SUCCESS) {
+      std::cerr << "[ERROR] KernelSpecializer: Failed to create program.\n";
+      return nullptr;
+   }
+
+   ret = clBuildProgram(program, 1, &device_, options.c_str(), NULL, NULL);
+   if (ret != CL_SUCCESS) {
+      size_t log_size = 0;
+      clGetProgramBuildInfo(program, device_, CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
+      std::vector<char> log(log_size + 1, '\0');
+      clGetProgramBuildInfo(program, device_, CL_PROGRAM_BUILD_LOG, log_size, log.data(), NULL);
+      std::cerr << "[ERROR] KernelSpecializer: Build with options '" << options
+                << "' failed:\n"
+                << log.data() << "\n";
+      clReleaseProgram(program);
+      return nullptr;
+   }
+
+   std::cerr << "[KernelSpecializer] Built variant with options '" << options << "'.\n";
+   return program;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+/**
+ * @brief Opzioni della specializzazione JIT dei kernel OpenCL.
+ */
+struct JitOptions {
+   bool by_size = false;            // Una variante per dimensione dei task (-DSPEC_N)
+   bool fast_math = false;          // -cl-fast-relaxed-math -cl-mad-enable
+   std::string real_type = "float"; // Tipo dei calcoli in virgola mobile (-DREAL_T)
+   int heavy_iters = 0;             // Iterazioni di heavy_compute (-DHEAVY_ITERS, 0 = sorgente)
+   std::string defines;             // -D del programma, in ogni variante (es. REDUCE_OP)
+
+   bool enabled() const { return by_size || fast_math || real_type != "float"; }
+};
+
+/**
+ * @brief Compila varianti specializzate di un programma OpenCL con opzioni di build diverse
+ * (costanti -D e flag di ottimizzazione) e le tiene in cache per stringa di opzioni.
+ *
+ * Con by_size il numero di elementi del task diventa una costante di compilazione (SPEC_N), così
+ * il compilatore del device può eliminare i controlli sui bordi e srotolare i cicli. Le varianti
+ * per dimensione sono al più MAX_SIZE_VARIANTS: le dimensioni successive usano la variante
+ * generica, compilata con le sole opzioni comuni. program_for() è thread-safe: la prima
+ * richiesta di una variante la compila, le altre la trovano in cache.
+ */
+class KernelSpecializer {
+ public:
+   KernelSpecializer(cl_context context, cl_device_id device, const std::string &source,
+                     const JitOptions &options);
+   ~KernelSpecializer();
+
+   // Programma da usare per un task di n elementi (nullptr se la compilazione fallisce).
+   cl_program program_for(size_t n);
+
+   // Opzioni di build della variante per n elementi.
+   std::string build_options(size_t n) const;
+
+   // Compila la variante per n elementi fuori dalla cache, senza occupare uno dei
+   // MAX_SIZE_VARIANTS posti (es. per le misure). Il chiamante rilascia il programma.
+   cl_program build_uncached(size_t n) { return build(build_options(n)); }
+
+   static constexpr size_t MAX_SIZE_VARIANTS = 16;
+
+   // Anteposto a ogni sorgente OpenCL: N_ELEMS è la costante SPEC_N nelle varianti per
+   // dimensione, altrimenti l'argomento n del kernel. #line mantiene i numeri di riga del file.
+   static constexpr const char *N_ELEMS_PROLOGUE =
+      "#ifdef SPEC_N\n#define N_ELEMS SPEC_N\n#else\n#define N_ELEMS n\n#endif\n#line 1\n";
+
+ private:
+   cl_program build(const std::string &options);
+
+   cl_context context_;
+   cl_device_id device_;
+   std::string source_;
+   JitOptions options_;
+   std::string common_options_; // Opzioni comuni a tutte le varianti
+
+   std::map<std::string, cl_program> programs_; // Varianti compilate, per opzioni di build
+   size_t size_variants_{0};
+   std::mutex mutex_;
+};
@@ -0,0 +1,49 @@
+#include "LoadAwareScheduler.hpp"
+#include <limits>
+
+LoadAwareScheduler::LoadAwareScheduler(LoadBoard *board, size_t max_outstanding,
+                                       bool wait_for_best)
+    : board_(board), max_outstanding_(max_outstanding), wait_for_best_(wait_for_best) {}
+
+/**
+ * @brief Inoltra il task al worker scelto. Il contatore dei task in sospeso viene incrementato
+ * prima dell'invio e decrementato dal consumer del worker al completamento. Con wait_for_best,
+ * se il worker più conveniente è saturo si attende che completi un task invece di ripiegare su
+ * uno più lento.
+ */
+Task *LoadAwareScheduler::svc(Task *task) {
+   board_->wait_for_free_slot(max_outstanding_);
+
+   size_t worker = select_worker();
+   if (wait_for_best_)
+      board_->wait_for_free_slot(worker, max_outstanding_);
+   board_->record_dispatch(worker);
+   ff_send_out_to(task, static_cast<int>(worker));
+   return GO_ON;
+}
+
+size_t LoadAwareScheduler::select_worker() const {
+   size_t best = 0;
+   double best_cost = std::numeric_limits<double>::max();
+   size_t best_outstanding = std::numeric_limits<size_t>::max();
+
+   for (size_t i = 0; i < board_->size(); ++i) {
+      size_t outstanding = board_->worker(i).outstanding.load();
+      long long service_ns = board_->worker(i).ewma_service_ns.load();
+
+      // Worker saturo: non può ricevere altri task finché non ne completa uno. Con il modello di
+      // costo lo si può attendere, se è già misurato (altrimenti non si sa quando si libererà).
+      if (outstanding >= max_outstanding_ && (!wait_for_best_ || service_ns == 0))
+         continue;
+
+      // Device non ancora misurato: costo nullo, a parità vince quello meno carico.
+      double cost = (service_ns == 0) ? 0.0 : double(outstanding + 1) * double(service_ns);
+
+      if (cost < best_cost || (cost == best_cost && outstanding < best_outstanding)) {
+         best = i;
+         best_cost = cost;
+         best_outstanding = outstanding;
+      }
+   }
+   return best;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../../include/ff_includes.hpp"
+#include "../common/LoadBoard.hpp"
+#include "../common/Task.hpp"
+
+/**
+ * @brief Emitter della farm multi-device: assegna ogni Task al worker (un ff_node_acc_t per
+ * device) con il minor lavoro in sospeso, pesato con il tempo di servizio misurato del device.
+ *
+ * Il costo stimato di un worker è (task in sospeso + 1) * tempo di servizio medio, cioè il tempo
+ * dopo cui il worker completerebbe il nuovo task. Un device veloce riceve quindi più task di uno
+ * lento, a differenza del round-robin. Finché un worker non ha completato nessun task il suo
+ * tempo di servizio è ignoto e viene preferito, così ogni device viene misurato subito.
+ *
+ * Il tempo di servizio può essere inizializzato da un modello di costo (LoadBoard::seed_service_ns),
+ * come nella modalità 'auto': in quel caso (wait_for_best) ogni task va al worker che si prevede
+ * lo completi prima, anche se questo significa attendere che un worker veloce si liberi. Senza
+ * modello i worker saturi vengono saltati.
+ */
+class LoadAwareScheduler : public ff_monode_t<Task> {
+ public:
+   /**
+    * @param board Stato di carico condiviso con i worker.
+    * @param max_outstanding Task in volo massimi per worker prima che lo scheduler si fermi ad
+    * attendere un completamento.
+    * @param wait_for_best Attende il worker migliore anche se saturo (modello di costo calibrato).
+    */
+   LoadAwareScheduler(LoadBoard *board, size_t max_outstanding, bool wait_for_best = false);
+
+   Task *svc(Task *task) override;
+
+ private:
+   // Sceglie il worker con il minor tempo di completamento stimato.
+   size_t select_worker() const;
+
+   LoadBoard *board_;
+   size_t max_outstanding_;
+   bool wait_for_best_;
+};
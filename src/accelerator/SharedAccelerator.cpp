@@ -0,0 +1,116 @@
+#include "SharedAccelerator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+/**
+ * @brief Implementazione del servizio che condivide un acceleratore fra più tenant.
+ */
+
+// Byte spostati fra host e device da un task: dal descrittore per matrici, griglie (alone
+// compreso) e CSR, altrimenti i vettori di input e i risultati del kernel.
+static size_t task_bytes(const Task *task, CpuKernel kernel) {
+   if (task->mat.valid())
+      return sizeof(float) * (task->mat.a_elems() + task->mat.b_elems() + task->mat.c_elems());
+   if (task->grid.valid())
+      return sizeof(float) * (task->grid.in_elems() + task->grid.out_elems());
+   if (task->csr.valid())
+      return task->csr.matrix_bytes() + sizeof(float) * (task->csr.cols + task->csr.rows);
+   return sizeof(int) * (input_vectors(kernel) * task->n + result_elems(kernel, task->n));
+}
+
+SharedAccelerator::SharedAccelerator(IAccelerator *device, const std::string &kernel_name)
+    : device_(device), kernel_(parse_cpu_kernel(kernel_name)) {}
+
+SharedAccelerator::~SharedAccelerator() {
+   std::cerr << "[SharedAccelerator] Destroyed (" << tenants_.size() << " tenants).\n";
+}
+
+std::unique_ptr<IAccelerator> SharedAccelerator::make_tenant(const std::string &name,
+                                                             double weight) {
+   std::lock_guard<std::mutex> lock(fq_mutex_);
+
+   auto tenant = std::make_unique<Tenant>();
+   tenant->stats.name = name;
+   tenant->stats.weight = weight > 0 ? weight : 1.0;
+   tenants_.push_back(std::move(tenant));
+
+   std::cerr << "[SharedAccelerator] Tenant '" << name << "' attached with weight "
+             << tenants_.back()->stats.weight << ".\n";
+   return std::make_unique<TenantAccelerator>(this, tenants_.size() - 1);
+}
+
+bool SharedAccelerator::initialize() {
+   std::lock_guard<std::mutex> lock(init_mutex_);
+   if (!init_done_) {
+      init_ok_ = device_->initialize();
+      init_done_ = true;
+   }
+   return init_ok_;
+}
+
+double SharedAccelerator::start_tag(const Tenant &t) const {
+   // Un tenant rimasto inattivo riparte dal tempo virtuale corrente, senza credito accumulato.
+   return std::max(t.finish_tag, virtual_time_);
+}
+
+bool SharedAccelerator::is_next(size_t tenant) const {
+   const double own = start_tag(*tenants_[tenant]);
+   for (size_t i = 0; i < tenants_.size(); ++i) {
+      const Tenant &other = *tenants_[i];
+      if (i == tenant || other.waiting == 0)
+         continue;
+      const double tag = start_tag(other);
+      if (tag < own || (tag == own && i < tenant))
+         return false;
+   }
+   return true;
+}
+
+/**
+ * @brief Acquisisce un buffer set per il task del tenant. Fra i tenant in attesa procede solo
+ * quello con il minor tempo virtuale di inizio, che poi attende un buffer set libero dal device.
+ * Un tenant può avere più producer in attesa: condividono il suo tempo virtuale e passano uno
+ * alla volta. Il costo del task viene addebitato quando il tenant viene scelto, con il mutex
+ * acquisito, così la scelta successiva vede già il tempo virtuale aggiornato.
+ */
+size_t SharedAccelerator::acquire(size_t tenant, const Task *task) {
+   auto t0 = std::chrono::steady_clock::now();
+   Tenant &t = *tenants_[tenant];
+   const double cost = task ? double(task_bytes(task, kernel_)) / t.stats.weight : 0;
+   std::unique_lock<std::mutex> lock(fq_mutex_);
+
+   t.waiting++;
+   fq_cond_.wait(lock, [&] { return !acquiring_ && is_next(tenant); });
+   t.waiting--;
+   acquiring_ = true;
+   virtual_time_ = start_tag(t);
+   t.finish_tag = virtual_time_ + cost;
+   lock.unlock();
+
+   size_t index = device_->acquire_buffer_set();
+
+   lock.lock();
+   acquiring_ = false;
+   lock.unlock();
+   fq_cond_.notify_all();
+
+   t.stats.wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - t0)
+                         .count();
+   return index;
+}
+
+// Conta il task nelle statistiche del tenant e inoltra l'upload al device.
+void SharedAccelerator::send(size_t tenant, Task *task) {
+   Tenant &t = *tenants_[tenant];
+   t.stats.tasks++;
+   t.stats.bytes += task_bytes(task, kernel_);
+
+   device_->send_data_to_device(task);
+}
+
+void SharedAccelerator::get_results(size_t tenant, Task *task, long long &computed_ns) {
+   device_->get_results_from_device(task, computed_ns);
+   tenants_[tenant]->stats.computed_ns += computed_ns;
+}
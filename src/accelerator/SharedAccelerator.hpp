@@ -0,0 +1,127 @@
+#pragma once
+
+#include "../cpu_runner/CpuKernels.hpp"
+#include "IAccelerator.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Servizio che condivide un solo acceleratore fra più tenant (nodi ff_node_acc_t o
+ * pipeline indipendenti): un solo contesto, un solo programma compilato e un solo pool di buffer,
+ * quelli dell'acceleratore incapsulato.
+ *
+ * Ogni tenant vede il device attraverso un TenantAccelerator (make_tenant) e ha un peso. Quando
+ * più tenant attendono un buffer set, il prossimo va a quello con il minor tempo virtuale di
+ * inizio (Start-time Fair Queuing): ogni task costa al tenant byte / peso di tempo virtuale, con i
+ * byte spostati dal kernel (vettori, risultati delle riduzioni, matrici, griglie o CSR),
+ * addebitati insieme all'assegnazione del buffer set. Con tutti i tenant in attesa la banda del
+ * device si divide quindi in proporzione ai pesi, e un tenant che torna attivo dopo una pausa non
+ * accumula credito.
+ *
+ * Upload e lanci dei tenant non vengono serializzati: ogni buffer set ha il proprio kernel e viene
+ * riallocato da solo, quindi producer diversi non condividono stato mutabile.
+ */
+class SharedAccelerator {
+ public:
+   // Statistiche di un tenant, lette a fine esecuzione.
+   struct TenantStats {
+      std::string name;
+      double weight{1.0};
+      std::atomic<size_t> tasks{0};          // Task inviati al device
+      std::atomic<size_t> bytes{0};          // Byte spostati (input + output)
+      std::atomic<long long> wait_ns{0};     // Attesa totale di un buffer set
+      std::atomic<long long> computed_ns{0}; // Tempo di calcolo riportato dal device
+   };
+
+   // L'acceleratore viene inizializzato una sola volta, dal primo tenant che lo richiede.
+   SharedAccelerator(IAccelerator *device, const std::string &kernel_name);
+   ~SharedAccelerator();
+
+   /**
+    * @brief Registra un tenant e restituisce il suo accesso al device. I tenant vanno registrati
+    * prima di avviare le pipeline, e il servizio deve restare in vita finché sono in uso.
+    */
+   std::unique_ptr<IAccelerator> make_tenant(const std::string &name, double weight);
+
+   size_t num_tenants() const { return tenants_.size(); }
+   const TenantStats &tenant_stats(size_t tenant) const { return tenants_[tenant]->stats; }
+
+ private:
+   friend class TenantAccelerator;
+
+   struct Tenant {
+      TenantStats stats;
+      double finish_tag{0}; // Tempo virtuale a cui il tenant ha consumato la sua quota
+      size_t waiting{0};    // Producer del tenant in attesa di un buffer set
+   };
+
+   // Metodi usati dai TenantAccelerator.
+   bool initialize();
+   size_t acquire(size_t tenant, const Task *task);
+   void send(size_t tenant, Task *task);
+   void get_results(size_t tenant, Task *task, long long &computed_ns);
+
+   // Tempo virtuale di inizio della prossima richiesta del tenant (con il mutex acquisito).
+   double start_tag(const Tenant &t) const;
+   // Vero se 'tenant' è il primo in attesa secondo il fair queuing (con il mutex acquisito).
+   bool is_next(size_t tenant) const;
+
+   IAccelerator *device_;
+   CpuKernel kernel_;
+   std::vector<std::unique_ptr<Tenant>> tenants_;
+
+   // Inizializzazione unica del device condiviso.
+   std::mutex init_mutex_;
+   bool init_done_{false};
+   bool init_ok_{false};
+
+   // Fair queuing dei buffer set.
+   std::mutex fq_mutex_;
+   std::condition_variable fq_cond_;
+   double virtual_time_{0};
+   bool acquiring_{false}; // Un tenant è già in attesa di un buffer set dal device
+};
+
+/**
+ * @brief Accesso di un tenant a un SharedAccelerator, con la stessa interfaccia di un acceleratore
+ * dedicato: può essere passato a un ff_node_acc_t senza modifiche.
+ */
+class TenantAccelerator : public IAccelerator {
+ public:
+   TenantAccelerator(SharedAccelerator *service, size_t tenant)
+       : service_(service), tenant_(tenant) {}
+
+   // Il device condiviso viene inizializzato solo dal primo tenant.
+   bool initialize() override { return service_->initialize(); }
+
+   // Senza il task l'acquisizione non viene addebitata: ff_node_acc_t usa quella con il task.
+   size_t acquire_buffer_set() override { return service_->acquire(tenant_, nullptr); }
+   size_t acquire_buffer_set_for(const void *task_context) override {
+      return service_->acquire(tenant_, static_cast<const Task *>(task_context));
+   }
+   void release_buffer_set(size_t index) override { service_->device_->release_buffer_set(index); }
+   // Il pool è condiviso: ogni tenant può occupare al più tutti i set del device.
+   size_t buffer_set_count() const override { return service_->device_->buffer_set_count(); }
+   bool uses_buffer_set(const void *task_context) const override {
+      return service_->device_->uses_buffer_set(task_context);
+   }
+
+   void send_data_to_device(void *task_context) override {
+      service_->send(tenant_, static_cast<Task *>(task_context));
+   }
+   void execute_kernel(void *task_context) override {
+      service_->device_->execute_kernel(task_context);
+   }
+   void get_results_from_device(void *task_context, long long &computed_ns) override {
+      service_->get_results(tenant_, static_cast<Task *>(task_context), computed_ns);
+   }
+
+ private:
+   SharedAccelerator *service_;
+   size_t tenant_;
+};
@@ -0,0 +1,220 @@
+#include "SimulatedAccelerator.hpp"
+#include "../common/Task.hpp"
+#include "../cpu_runner/CpuGemm.hpp"
+#include "../cpu_runner/CpuSpmv.hpp"
+#include "../cpu_runner/CpuStencil.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+/**
+ * @brief Implementazione della classe SimulatedAccelerator, device software per provare la
+ * pipeline e la farm di acceleratori senza hardware dedicato.
+ */
+
+// Indice speciale che ferma il thread del device.
+static const size_t STOP_DEVICE = static_cast<size_t>(-1);
+
+SimulatedAccelerator::SimulatedAccelerator(const std::string &kernel_name, double speed)
+    : kernel_(parse_cpu_kernel(kernel_name)), kernel_name_(kernel_name),
+      speed_(speed > 0 ? speed : 1.0) {}
+
+/**
+ * @brief Il distruttore ferma il thread del device e attende la sua terminazione.
+ */
+SimulatedAccelerator::~SimulatedAccelerator() {
+   if (deviceTh_.joinable()) {
+      launchQ_.push(STOP_DEVICE);
+      deviceTh_.join();
+   }
+
+   std::cerr << "[SimulatedAccelerator] Transferred " << bytes_up_.load() << " bytes up, "
+             << bytes_down_.load() << " bytes down.\n";
+   std::cerr << "[SimulatedAccelerator] Destroyed.\n";
+}
+
+bool SimulatedAccelerator::initialize() {
+   if (kernel_ == CpuKernel::Unknown) {
+      std::cerr << "[ERROR] SimulatedAccelerator: Unknown kernel name '" << kernel_name_ << "'.\n"
+                << "    --> Supported kernels are: 'vecAdd', 'polynomial_op', "
+                   "'heavy_compute_kernel', 'heavy_compute_fast', 'deep_pipeline_calculation', "
+                   "'reduce_sum', 'reduce_min', 'reduce_max', 'histogram', 'gemm', 'stencil5', "
+                   "'stencil9', 'spmv_csr', 'spmv_csr_vector'.\n";
+      return false;
+   }
+
+   buffer_pool_ = std::vector<BufferSet>(POOL_SIZE);
+   for (size_t i = 0; i < POOL_SIZE; ++i)
+      free_buffer_indices_.push(i);
+
+   deviceTh_ = std::thread(&SimulatedAccelerator::deviceLoop, this);
+
+   std::cerr << "[SimulatedAccelerator] Initialization successful (speed=" << speed_ << ").\n";
+   return true;
+}
+
+size_t SimulatedAccelerator::acquire_buffer_set() {
+   std::unique_lock<std::mutex> lock(pool_mutex_);
+
+   // Attende finché non c'è un buffer libero.
+   buffer_available_cond_.wait(lock, [this] { return !free_buffer_indices_.empty(); });
+
+   size_t index = free_buffer_indices_.front();
+   free_buffer_indices_.pop();
+   return index;
+}
+
+void SimulatedAccelerator::release_buffer_set(size_t index) {
+   {
+      std::lock_guard<std::mutex> lock(pool_mutex_);
+      free_buffer_indices_.push(index);
+   }
+   buffer_available_cond_.notify_one();
+}
+
+size_t SimulatedAccelerator::buffer_set_count() const { return POOL_SIZE; }
+
+/**
+ * @brief Stadio 1 (Upload). Copia gli input nel buffer set "del device".
+ */
+void SimulatedAccelerator::send_data_to_device(void *task_context) {
+   auto *task = static_cast<Task *>(task_context);
+   auto &current_buffers = buffer_pool_[task->buffer_idx];
+
+   std::cerr << "[SimulatedAccelerator - START] Processing task " << task->id
+             << " with N=" << task->n << "...\n";
+
+   // Le matrici float arrivano come byte dietro i puntatori int del task.
+   current_buffers.mat = task->mat;
+   if (task->mat.valid()) {
+      current_buffers.ma.resize(task->mat.a_elems());
+      current_buffers.mb.resize(task->mat.b_elems());
+      current_buffers.mc.resize(task->mat.c_elems());
+      std::memcpy(current_buffers.ma.data(), task->a, sizeof(float) * current_buffers.ma.size());
+      std::memcpy(current_buffers.mb.data(), task->b, sizeof(float) * current_buffers.mb.size());
+      bytes_up_ += sizeof(float) * (current_buffers.ma.size() + current_buffers.mb.size());
+      return;
+   }
+
+   // Stencil: il tile con l'alone resta sul device per tutti gli sweep, mb contiene i due
+   // buffer del ping-pong e mc il risultato (alone compreso).
+   current_buffers.grid = task->grid;
+   if (task->grid.valid()) {
+      const size_t elems = task->grid.in_elems();
+      current_buffers.ma.resize(elems);
+      current_buffers.mb.resize(2 * elems);
+      current_buffers.mc.resize(elems);
+      std::memcpy(current_buffers.ma.data(), task->a, sizeof(float) * elems);
+      bytes_up_ += sizeof(float) * elems;
+      return;
+   }
+
+   // SpMV: row_ptr in a, col_idx in b, values in ma, x in mb e y in mc.
+   current_buffers.csr = task->csr;
+   if (task->csr.valid()) {
+      const CsrDesc &d = task->csr;
+      current_buffers.a.assign(d.row_ptr, d.row_ptr + d.rows + 1);
+      current_buffers.b.assign(d.col_idx, d.col_idx + d.nnz);
+      current_buffers.ma.assign(d.values, d.values + d.nnz);
+      current_buffers.mb.resize(d.cols);
+      current_buffers.mc.resize(d.rows);
+      std::memcpy(current_buffers.mb.data(), task->a, sizeof(float) * d.cols);
+      bytes_up_ += d.matrix_bytes() + sizeof(float) * d.cols;
+      return;
+   }
+
+   // Le riduzioni leggono solo a e scrivono solo il risultato ridotto.
+   current_buffers.a.resize(task->n);
+   current_buffers.b.resize(input_vectors(kernel_) > 1 ? task->n : 0);
+   current_buffers.c.resize(result_elems(kernel_, task->n));
+   std::memcpy(current_buffers.a.data(), task->a, sizeof(int) * task->n);
+   if (!current_buffers.b.empty())
+      std::memcpy(current_buffers.b.data(), task->b, sizeof(int) * task->n);
+   bytes_up_ += sizeof(int) * (current_buffers.a.size() + current_buffers.b.size());
+}
+
+/**
+ * @brief Stadio 2 (Execute). Accoda il kernel al thread del device senza attenderlo.
+ */
+void SimulatedAccelerator::execute_kernel(void *task_context) {
+   auto *task = static_cast<Task *>(task_context);
+   auto &current_buffers = buffer_pool_[task->buffer_idx];
+
+   {
+      std::lock_guard<std::mutex> lock(done_mutex_);
+      current_buffers.done = false;
+   }
+   launchQ_.push(task->buffer_idx);
+}
+
+/**
+ * @brief Stadio 3 (Download). Attende la fine del kernel e copia il risultato sull'host.
+ */
+void SimulatedAccelerator::get_results_from_device(void *task_context, long long &computed_ns) {
+   auto *task = static_cast<Task *>(task_context);
+   auto &current_buffers = buffer_pool_[task->buffer_idx];
+
+   {
+      std::unique_lock<std::mutex> lock(done_mutex_);
+      done_cond_.wait(lock, [&] { return current_buffers.done; });
+      computed_ns = current_buffers.compute_ns;
+   }
+   if (current_buffers.mat.valid() || current_buffers.csr.valid()) {
+      std::memcpy(task->c, current_buffers.mc.data(), sizeof(float) * current_buffers.mc.size());
+      bytes_down_ += sizeof(float) * current_buffers.mc.size();
+   } else if (current_buffers.grid.valid()) {
+      const GridDesc &g = current_buffers.grid;
+      std::memcpy(task->c, current_buffers.mc.data() + g.halo_top * g.cols,
+                  sizeof(float) * g.out_elems());
+      bytes_down_ += sizeof(float) * g.out_elems();
+   } else {
+      std::memcpy(task->c, current_buffers.c.data(), sizeof(int) * current_buffers.c.size());
+      bytes_down_ += sizeof(int) * current_buffers.c.size();
+   }
+
+   std::cerr << "[SimulatedAccelerator - END] Task " << task->id << " finished.\n";
+}
+
+/**
+ * @brief Esegue i kernel uno alla volta, come una coda di comandi in-order. Un device più lento
+ * (speed < 1) viene simulato allungando il tempo di calcolo misurato.
+ */
+void SimulatedAccelerator::deviceLoop() {
+   while (true) {
+      size_t index = launchQ_.pop();
+      if (index == STOP_DEVICE)
+         break;
+
+      auto &buffers = buffer_pool_[index];
+      auto t0 = std::chrono::steady_clock::now();
+      if (buffers.mat.valid())
+         gemm_rows(buffers.mat, buffers.ma.data(), buffers.mb.data(), buffers.mc.data(), 0,
+                   buffers.mat.m);
+      else if (buffers.grid.valid())
+         stencil_steps(buffers.grid, buffers.ma.data(), buffers.mc.data(), buffers.mb.data(),
+                       [&](const float *src, float *dst, size_t row_begin, size_t row_end) {
+                          stencil_rows(buffers.grid, src, dst, row_begin, row_end);
+                       });
+      else if (buffers.csr.valid()) {
+         CsrDesc device = buffers.csr;
+         device.row_ptr = buffers.a.data();
+         device.col_idx = buffers.b.data();
+         device.values = buffers.ma.data();
+         spmv_rows(device, buffers.mb.data(), buffers.mc.data(), 0, device.rows);
+      } else
+         run_cpu_kernel(kernel_, buffers.a.data(), buffers.b.data(), buffers.c.data(), 0,
+                        buffers.a.size());
+      auto t1 = std::chrono::steady_clock::now();
+
+      if (speed_ < 1.0)
+         std::this_thread::sleep_for((t1 - t0) * (1.0 / speed_ - 1.0));
+
+      auto t2 = std::chrono::steady_clock::now();
+      {
+         std::lock_guard<std::mutex> lock(done_mutex_);
+         buffers.compute_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t0).count();
+         buffers.done = true;
+      }
+      done_cond_.notify_all();
+   }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../common/BlockingQueue.hpp"
+#include "../common/CsrDesc.hpp"
+#include "../common/GridDesc.hpp"
+#include "../common/MatrixDesc.hpp"
+#include "../common/RingBuffer.hpp"
+#include "../cpu_runner/CpuKernels.hpp"
+#include "IAccelerator.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Implementazione di IAccelerator che simula un device usando la memoria e un thread
+ * dell'host.
+ *
+ * Riproduce il comportamento di un device OpenCL con coda in-order: i buffer set sono copie in
+ * memoria host, i kernel vengono eseguiti uno alla volta da un thread dedicato ("il device") e il
+ * download attende il completamento del kernel. Il parametro speed rallenta artificialmente il
+ * device (speed = 0.5 -> tempo di calcolo doppio), così da poter provare su qualsiasi macchina la
+ * farm multi-device con device eterogenei.
+ *
+ * Con le riduzioni (reduce_sum, histogram, ...) il "device" riceve solo il vettore a e restituisce
+ * solo il risultato ridotto; il distruttore riporta i byte trasferiti nelle due direzioni. I task
+ * a matrici (gemm) trasferiscono le matrici A, B e C del descrittore del task. I task stencil
+ * caricano il tile con l'alone, eseguono tutti gli sweep sul device e scaricano solo le righe
+ * del tile. I task SpMV caricano gli array CSR della matrice e x, e scaricano y.
+ */
+class SimulatedAccelerator : public IAccelerator {
+ public:
+   SimulatedAccelerator(const std::string &kernel_name, double speed = 1.0);
+   ~SimulatedAccelerator() override;
+
+   // Valida il kernel e avvia il thread che simula il device.
+   bool initialize() override;
+
+   // Metodi per l'acquisizione e il rilascio dei buffer.
+   size_t acquire_buffer_set() override;
+   void release_buffer_set(size_t index) override;
+   size_t buffer_set_count() const override;
+
+   // Metodi utili per i thread della pipeline interna.
+   void send_data_to_device(void *task_context) override;
+   void execute_kernel(void *task_context) override;
+   void get_results_from_device(void *task_context, long long &computed_ns) override;
+
+ private:
+   // Set di buffer "sul device", 2 per input e 1 per l'output.
+   struct BufferSet {
+      std::vector<int> a, b, c;
+      MatrixDesc mat;                // Descrittore del task a matrici (non valido per i vettori)
+      GridDesc grid;                 // Descrittore del task stencil (non valido per i vettori)
+      CsrDesc csr;                   // Descrittore del task SpMV (non valido per i vettori)
+      std::vector<float> ma, mb, mc; // Buffer dei task a matrici, stencil e SpMV
+      bool done{false};              // Settato dal device a fine kernel (sotto done_mutex_)
+      long long compute_ns{0};       // Tempo di calcolo del kernel
+   };
+
+   // Loop del thread che simula il device: esegue i kernel nell'ordine di accodamento.
+   void deviceLoop();
+
+   CpuKernel kernel_;
+   std::string kernel_name_;
+   double speed_;
+
+   // Dati per il pool di buffer e per la gestione della concorrenza.
+   const size_t POOL_SIZE = 3;
+   std::vector<BufferSet> buffer_pool_;
+   RingBuffer<size_t> free_buffer_indices_;
+   std::mutex pool_mutex_;
+   std::condition_variable buffer_available_cond_;
+
+   // Notifica del completamento dei kernel (senza allocare una promise per ogni task).
+   std::mutex done_mutex_;
+   std::condition_variable done_cond_;
+
+   // Byte "trasferiti" verso il device e dal device.
+   std::atomic<unsigned long long> bytes_up_{0};
+   std::atomic<unsigned long long> bytes_down_{0};
+
+   // Coda dei kernel da eseguire (indici dei buffer set) e thread del device.
+   BlockingQueue<size_t> launchQ_;
+   std::thread deviceTh_;
+};
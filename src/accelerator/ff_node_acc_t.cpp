@@ -1,4 +1,7 @@
 #include "ff_node_acc_t.hpp"
+#include "../common/AllocCounter.hpp"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 /**
@@ -15,6 +18,23 @@
 static char sentinel_obj;
 void *const ff_node_acc_t::SENTINEL = &sentinel_obj;
 
+// Chiave della sentinella in inQ_: esce dopo tutti i task, qualunque sia la politica.
+static const auto LAST_KEY = std::chrono::steady_clock::time_point::max();
+
+// Intervallo con cui i thread di work stealing ispezionano la coda di ingresso.
+static constexpr auto STEAL_POLL_INTERVAL = std::chrono::microseconds(100);
+
+// Peso del nuovo campione nelle medie mobili dei tempi per elemento.
+static constexpr double EWMA_ALPHA = 0.2;
+
+static void update_ewma(std::atomic<double> &avg, double sample) {
+   double prev = avg.load();
+   avg.store(prev == 0 ? sample : EWMA_ALPHA * sample + (1 - EWMA_ALPHA) * prev);
+}
+
+// Byte spostati fra host e device da un task: 2 vettori di input e 1 di output.
+static size_t task_bytes(const Task *task) { return 3 * sizeof(int) * task->n; }
+
 /**
  * @brief Costruttore del nodo.
  *
@@ -26,6 +46,16 @@ ff_node_acc_t::ff_node_acc_t(IAccelerator *acc, StatsCollector *stats)
 
 ff_node_acc_t::~ff_node_acc_t() = default;
 
+void ff_node_acc_t::enable_cpu_stealing(const std::string &kernel_name, size_t workers) {
+   steal_kernel_ = parse_cpu_kernel(kernel_name);
+   num_stealers_ = workers;
+}
+
+void ff_node_acc_t::enable_batching(size_t max_bytes, std::chrono::microseconds max_latency) {
+   batch_max_bytes_ = max_bytes;
+   batch_max_latency_ = max_latency;
+}
+
 /**
  * @brief Metodo di inizializzazione del nodo
  */
@@ -40,11 +70,40 @@ int ff_node_acc_t::svc_init() {
       return -1;
    }
 
-   // Avvia i due thread.
-   producerTh_ = std::thread(&ff_node_acc_t::producerLoop, this);
+   if (num_stealers_ > 0 && steal_kernel_ == CpuKernel::Unknown) {
+      std::cerr << "[ERROR] Accelerator Node: No CPU implementation for work stealing.\n";
+      return -1;
+   }
+
+   if (batch_max_bytes_ > 0) {
+      // I batch vengono creati una volta sola e riciclati, con i loro buffer di staging già della
+      // dimensione massima: a regime la costruzione di un batch non alloca. Ne servono uno per
+      // buffer set più uno per ogni producer (in costruzione o in attesa di un set).
+      size_t max_elems = batch_max_bytes_ / (3 * sizeof(int));
+      const size_t max_batches = accelerator_->buffer_set_count() + num_producers_;
+      for (size_t i = batches_.size(); i < max_batches; ++i) {
+         auto batch = std::make_unique<Batch>();
+         batch->a.resize(max_elems);
+         batch->b.resize(max_elems);
+         batch->c.resize(max_elems);
+         batch->members.reserve(BATCH_MEMBERS_RESERVE);
+         free_batches_.push(batch.get());
+         batches_.push_back(std::move(batch));
+      }
+   }
+
+   // Avvia i thread producer e il consumer.
+   for (size_t i = 0; i < num_producers_; ++i)
+      producerThs_.emplace_back(&ff_node_acc_t::producerLoop, this);
    consumerTh_ = std::thread(&ff_node_acc_t::consumerLoop, this);
+   for (size_t i = 0; i < num_stealers_; ++i)
+      stealerThs_.emplace_back(&ff_node_acc_t::stealerLoop, this);
+   if (num_stealers_ > 0)
+      std::cerr << "[Accelerator Node] CPU work stealing enabled with " << num_stealers_
+                << " threads.\n";
 
-   std::cerr << "[Accelerator Node] Internal 2-stage pipeline started.\n\n";
+   std::cerr << "[Accelerator Node] Internal 2-stage pipeline started (" << num_producers_
+             << " producer threads).\n\n";
    return 0;
 }
 
@@ -56,14 +115,16 @@ int ff_node_acc_t::svc_init() {
 void *ff_node_acc_t::svc(void *task) {
    // Se il task è un EOS, propaga la sentinella alla pipeline interna.
    if (task == FF_EOS) {
-      inQ_.push(SENTINEL);
+      for (size_t i = 0; i < num_producers_; ++i)
+         inQ_.push(SENTINEL, LAST_KEY);
       return FF_EOS;
    }
 
    // Ora di arrivo del task nel nodo.
-   static_cast<Task *>(task)->arrival_time = std::chrono::steady_clock::now();
+   auto *t = static_cast<Task *>(task);
+   t->arrival_time = std::chrono::steady_clock::now();
 
-   inQ_.push(task);
+   inQ_.push(t, schedule_key(t, sched_policy_, aging_));
    return FF_GO_ON;
 }
 
@@ -72,19 +133,33 @@ void *ff_node_acc_t::svc(void *task) {
  */
 void ff_node_acc_t::producerLoop() {
    while (true) {
-      // Attende un task dalla coda di input.
+      // Attende un task dalla coda di input. Il buffer set viene acquisito solo dopo, così un
+      // producer inattivo non tiene occupato un set che servirebbe agli altri.
       void *ptr = inQ_.pop();
 
-      // Se riceve la sentinella, la propaga e termina.
+      // Se riceve la sentinella (una per producer), la propaga e termina.
       if (ptr == SENTINEL) {
          readyQ_.push(SENTINEL);
          break;
       }
 
       auto *task = static_cast<Task *>(ptr);
+      in_flight_++;
 
-      // Acquisisce un buffer set, invia i dati sul device e avvia il kernel.
-      task->buffer_idx = accelerator_->acquire_buffer_set();
+      // Un task piccolo (ne entrano almeno 2 nel budget) apre un batch.
+      if (batch_max_bytes_ > 0 && 2 * task_bytes(task) <= batch_max_bytes_)
+         task = build_batch(task);
+
+      // Mentre il producer attende un buffer set libero il device è saturo e i task rimasti in
+      // coda possono andare alla CPU. I task che non usano il pool (es. a tile) non lo attendono.
+      task->buffer_idx = NO_BUFFER_SET;
+      if (accelerator_->uses_buffer_set(task)) {
+         producers_waiting_++;
+         task->buffer_idx = accelerator_->acquire_buffer_set_for(task);
+         producers_waiting_--;
+      }
+
+      // Invia i dati sul device e avvia il kernel.
       accelerator_->send_data_to_device(task);
       accelerator_->execute_kernel(task);
 
@@ -96,16 +171,27 @@ void ff_node_acc_t::producerLoop() {
  * @brief Loop per il 2° stadio della pipeline: Consumer (Download).
  */
 void ff_node_acc_t::consumerLoop() {
-   // Memorizza l'ora di completamento del task precedente.
+   // Memorizza l'ora di completamento del task precedente sul device.
    std::chrono::steady_clock::time_point last_completion_time;
    bool first_task = true;
+   size_t producers_done = 0;
 
    while (true) {
       // Prende un task pronto dalla coda.
       void *ptr = readyQ_.pop();
 
+      // Ogni producer invia la sua sentinella: si termina solo dopo l'ultima.
+      if (ptr == SENTINEL && ++producers_done < num_producers_)
+         continue;
+
       if (ptr == SENTINEL) {
-         // La pipeline è vuota. Comunica il conteggio finale.
+         // La pipeline è vuota: tutti i task rimasti sono già stati presi dai thread di work
+         // stealing, che vengono fermati e attesi prima di comunicare il conteggio finale.
+         stop_stealing_ = true;
+         for (auto &th : stealerThs_)
+            if (th.joinable())
+               th.join();
+         stats_->heap_allocs_at_end = heap_allocation_count();
          stats_->count_promise.set_value(stats_->tasks_processed.load());
          break;
       }
@@ -118,41 +204,213 @@ void ff_node_acc_t::consumerLoop() {
 
       auto end_time = std::chrono::steady_clock::now();
 
-      // Calcola il tempo nel nodo per questo task.
-      auto inNode_duration =
-         std::chrono::duration_cast<std::chrono::nanoseconds>(
-            end_time - task->arrival_time);
-
-      // Calcola il tempo dall'ultimo completamento.
-      if (!first_task) {
-         auto inter_completion_duration =
-            std::chrono::duration_cast<std::chrono::nanoseconds>(
-               end_time - last_completion_time);
-         stats_->inter_completion_time_ns += inter_completion_duration.count();
+      // Tempo di servizio del device: se il task è arrivato a device libero conta dal suo arrivo,
+      // altrimenti dal completamento precedente. Usato dallo scheduler della farm e dal work
+      // stealing.
+      auto service_start = (!first_task && last_completion_time > task->arrival_time)
+                              ? last_completion_time
+                              : task->arrival_time;
+      long long service_ns =
+         std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - service_start).count();
+      first_task = false;
+      last_completion_time = end_time;
+
+      if (task->n > 0)
+         update_ewma(dev_ns_per_elem_, double(service_ns) / task->n);
+
+      if (task->buffer_idx != NO_BUFFER_SET)
+         accelerator_->release_buffer_set(task->buffer_idx);
+      in_flight_--;
+
+      if (task->batch) {
+         // Lo scheduler della farm conta i task inviati: un completamento per ogni task del batch,
+         // con il tempo di servizio diviso in proporzione agli elementi.
+         auto *batch = static_cast<Batch *>(task->batch);
+         if (load_board_)
+            for (Task *member : batch->members)
+               load_board_->record_completion(worker_index_, service_ns * (long long)member->n /
+                                                                (long long)task->n);
+         scatter_batch(batch, end_time, current_task_ns);
       } else {
-         first_task = false;
+         if (load_board_)
+            load_board_->record_completion(worker_index_, service_ns);
+         complete_task(task, end_time, current_task_ns);
       }
-      last_completion_time = end_time;
+   }
+}
+
+/**
+ * @brief Aggiunge al batch i task che seguono 'first' finché entrano nel budget di byte, senza
+ * attendere oltre la latenza massima concessa al primo task. I dati di input vengono copiati
+ * contigui nei buffer di staging del batch, che vengono solo ingranditi.
+ */
+Task *ff_node_acc_t::build_batch(Task *first) {
+   Batch *batch = free_batches_.pop();
+   batch->members.clear();
+   batch->members.push_back(first);
+
+   size_t bytes = task_bytes(first);
+   auto deadline = first->arrival_time + batch_max_latency_;
+   auto fits = [&](void *ptr) {
+      return ptr != SENTINEL && bytes + task_bytes(static_cast<Task *>(ptr)) <= batch_max_bytes_;
+   };
+
+   void *ptr = nullptr;
+   while (inQ_.pop_if_until(ptr, fits, deadline)) {
+      batch->members.push_back(static_cast<Task *>(ptr));
+      bytes += task_bytes(static_cast<Task *>(ptr));
+   }
+
+   // Nessun altro task in tempo: il primo va al device da solo.
+   if (batch->members.size() == 1) {
+      free_batches_.push(batch);
+      return first;
+   }
 
-      // Aggiorna le statistiche.
-      stats_->computed_ns += current_task_ns;
-      stats_->total_InNode_time_ns += inNode_duration.count();
-      stats_->tasks_processed++;
+   size_t total_n = 0;
+   for (Task *member : batch->members)
+      total_n += member->n;
+   if (batch->a.size() < total_n) {
+      batch->a.resize(total_n);
+      batch->b.resize(total_n);
+      batch->c.resize(total_n);
+   }
+
+   size_t offset = 0;
+   for (Task *member : batch->members) {
+      std::memcpy(batch->a.data() + offset, member->a, member->n * sizeof(int));
+      std::memcpy(batch->b.data() + offset, member->b, member->n * sizeof(int));
+      offset += member->n;
+   }
+
+   batch->task = Task{};
+   batch->task.a = batch->a.data();
+   batch->task.b = batch->b.data();
+   batch->task.c = batch->c.data();
+   batch->task.n = total_n;
+   batch->task.id = first->id;
+   batch->task.arrival_time = first->arrival_time;
+   batch->task.batch = batch;
+   stats_->batches++;
+   return &batch->task;
+}
+
+void ff_node_acc_t::scatter_batch(Batch *batch, std::chrono::steady_clock::time_point end_time,
+                                  long long computed_ns) {
+   size_t total_n = std::max<size_t>(1, batch->task.n);
+   size_t offset = 0;
+
+   for (Task *member : batch->members) {
+      std::memcpy(member->c, batch->c.data() + offset, member->n * sizeof(int));
+      offset += member->n;
+      complete_task(member, end_time, computed_ns * (long long)member->n / (long long)total_n);
+   }
+   free_batches_.push(batch);
+}
+
+/**
+ * @brief Loop dei thread di work stealing: prendono dalla testa di inQ_ i task che conviene
+ * eseguire sulla CPU e li calcolano per intero su un core.
+ */
+void ff_node_acc_t::stealerLoop() {
+   auto steal_filter = [this](void *ptr) {
+      return ptr != SENTINEL && should_steal();
+   };
+
+   while (!stop_stealing_) {
+      void *ptr = nullptr;
+      if (!inQ_.try_pop_if(ptr, steal_filter)) {
+         std::this_thread::sleep_for(STEAL_POLL_INTERVAL);
+         continue;
+      }
+
+      auto *task = static_cast<Task *>(ptr);
+      auto t0 = std::chrono::steady_clock::now();
+      run_cpu_kernel(steal_kernel_, task->a, task->b, task->c, 0, task->n);
+      auto end_time = std::chrono::steady_clock::now();
+
+      long long cpu_ns =
+         std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - t0).count();
+      if (task->n > 0)
+         update_ewma(cpu_ns_per_elem_, double(cpu_ns) / task->n);
 
-      accelerator_->release_buffer_set(task->buffer_idx);
-      delete task;
+      stats_->tasks_on_cpu++;
+      complete_task(task, end_time, cpu_ns);
    }
 }
 
+/**
+ * @brief Confronta il completamento stimato del task sul device, dietro ai task già in volo, con
+ * quello stimato su un core. Finché il costo sulla CPU non è misurato si ruba solo quando il
+ * device è saturo.
+ */
+bool ff_node_acc_t::should_steal() const {
+   double dev = dev_ns_per_elem_.load();
+   double cpu = cpu_ns_per_elem_.load();
+
+   if (cpu == 0 || dev == 0)
+      return producers_waiting_.load() > 0;
+
+   return double(in_flight_.load() + 1) * dev > cpu;
+}
+
+/**
+ * @brief Aggiorna le statistiche del nodo per un task completato, sul device o sulla CPU.
+ */
+void ff_node_acc_t::complete_task(Task *task, std::chrono::steady_clock::time_point end_time,
+                                  long long computed_ns) {
+   {
+      std::lock_guard<std::mutex> lock(completion_mutex_);
+
+      // Calcola il tempo dall'ultimo completamento. Con il work stealing i completamenti
+      // possono arrivare qui fuori ordine: conta solo l'avanzamento dell'ultimo.
+      if (first_completion_) {
+         first_completion_ = false;
+         last_completion_time_ = end_time;
+      } else if (end_time > last_completion_time_) {
+         stats_->inter_completion_time_ns +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end_time -
+                                                                 last_completion_time_)
+               .count();
+         last_completion_time_ = end_time;
+      }
+      stats_->record_completion_time(end_time);
+
+      // Tempo nel nodo per questo task.
+      long long inNode_ns =
+         std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - task->arrival_time)
+            .count();
+      stats_->total_InNode_time_ns += inNode_ns;
+      stats_->latency_samples_ns.push_back(inNode_ns);
+
+      size_t cls = std::min(task->priority, MAX_PRIORITY_CLASSES - 1);
+      stats_->class_latency_samples_ns[cls].push_back(inNode_ns);
+      if (task->has_deadline()) {
+         stats_->class_deadline_tasks[cls]++;
+         if (end_time > task->deadline)
+            stats_->class_deadline_misses[cls]++;
+      }
+      stats_->computed_ns += computed_ns;
+      if (++stats_->tasks_processed == StatsCollector::ALLOC_WARMUP_TASKS)
+         stats_->heap_allocs_at_warmup = heap_allocation_count();
+   }
+
+   if (task->on_complete)
+      task->on_complete(task, task->on_complete_ctx);
+   release_task(task);
+}
+
 /**
  * @brief Metodo di terminazione, chiamato da FF. Invia la sentinella ai
  * thread interni e attende la loro terminazione.
  */
 void ff_node_acc_t::svc_end() {
-   inQ_.push(SENTINEL);
+   for (size_t i = 0; i < num_producers_; ++i)
+      inQ_.push(SENTINEL, LAST_KEY);
 
-   if (producerTh_.joinable())
-      producerTh_.join();
+   for (auto &th : producerThs_)
+      if (th.joinable())
+         th.join();
    if (consumerTh_.joinable())
       consumerTh_.join();
 
@@ -2,13 +2,21 @@
 
 #include "../../include/ff_includes.hpp"
 #include "../common/BlockingQueue.hpp"
+#include "../common/PriorityBlockingQueue.hpp"
+#include "../common/SchedPolicy.hpp"
 #include "../common/StatsCollector.hpp"
-#include "../common/Task.hpp"
+#include "../common/TaskPool.hpp"
+#include "../common/LoadBoard.hpp"
+#include "../cpu_runner/CpuKernels.hpp"
 #include "IAccelerator.hpp"
 #include <atomic>
+#include <chrono>
 #include <future>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 
 /**
  * @brief Nodo FastFlow che orchestra l'offloading su un acceleratore.
@@ -21,12 +29,60 @@
  * Permette di sovrapporre le operazioni di I/O con il calcolo, nella pipeline
  * il task 'n' è in esecuzione, mentre i dati per 'n+1' vengono caricati e i
  * risultati di 'n-1' vengono scaricati.
+ *
+ * Il primo stadio può usare più thread (set_producers): ogni producer lavora
+ * su un buffer set diverso, che ha il proprio kernel con gli argomenti già
+ * legati, quindi upload e lanci non condividono stato mutabile.
+ *
+ * Opzionalmente (enable_cpu_stealing) alcuni thread CPU prendono task interi
+ * da inQ_ quando il device è saturo o quando la CPU li completerebbe prima.
+ *
+ * I task in attesa in inQ_ escono secondo la politica di scheduling (FIFO di
+ * default, vedi enable_scheduling).
  */
 class ff_node_acc_t : public ff_node {
  public:
    explicit ff_node_acc_t(IAccelerator *acc, StatsCollector *stats);
    ~ff_node_acc_t() override;
 
+   // Collega il nodo, come worker 'index', allo stato di carico letto dallo scheduler della
+   // farm multi-device.
+   void set_load_board(LoadBoard *board, size_t index) {
+      load_board_ = board;
+      worker_index_ = index;
+   }
+
+   /**
+    * @brief Abilita il work stealing: 'workers' thread CPU prendono task interi dalla coda di
+    * ingresso quando il producer è bloccato in attesa di un buffer set libero, oppure quando il
+    * tempo stimato di completamento sul device supera quello stimato sulla CPU.
+    * Va chiamata prima dell'avvio della pipeline.
+    * @param kernel_name Kernel da eseguire sulla CPU (anche nella forma krnl_*).
+    */
+   void enable_cpu_stealing(const std::string &kernel_name, size_t workers);
+
+   /**
+    * @brief Abilita il batching: il producer impacchetta task piccoli consecutivi in un unico
+    * upload, un solo lancio del kernel sull'intervallo concatenato e un solo download, poi il
+    * consumer ridistribuisce i risultati ai singoli task. Un batch si chiude quando il task
+    * successivo non entra in max_bytes (input + output) o quando il primo task ha atteso
+    * max_latency. Va chiamata prima dell'avvio della pipeline.
+    */
+   void enable_batching(size_t max_bytes, std::chrono::microseconds max_latency);
+
+   // Numero di thread producer (upload + lancio), almeno 1. Va chiamata prima dell'avvio della
+   // pipeline.
+   void set_producers(size_t producers) { num_producers_ = producers > 0 ? producers : 1; }
+
+   /**
+    * @brief Imposta l'ordine in cui il producer prende i task in attesa: per scadenza (EDF) o per
+    * classe di priorità con aging (vedi SchedPolicy). Va chiamata prima dell'avvio della pipeline.
+    */
+   void enable_scheduling(SchedPolicy policy, std::chrono::microseconds aging) {
+      sched_policy_ = policy;
+      aging_ = aging;
+   }
+
  protected:
    int svc_init() override;
    void *svc(void *t) override;
@@ -41,14 +97,69 @@ class ff_node_acc_t : public ff_node {
    void producerLoop();
    void consumerLoop();
 
+   // Loop dei thread CPU di work stealing.
+   void stealerLoop();
+
+   // Batch di task piccoli: il task inviato all'acceleratore lavora sui buffer di staging.
+   struct Batch {
+      Task task{};
+      std::vector<int> a, b, c;
+      std::vector<Task *> members;
+   };
+
+   // Raccoglie in un batch i task piccoli che seguono 'first' in inQ_. Ritorna il task da
+   // inviare al device: quello del batch, oppure 'first' se non è arrivato nessun altro task.
+   Task *build_batch(Task *first);
+
+   // Copia i risultati del batch nei singoli task e li completa.
+   void scatter_batch(Batch *batch, std::chrono::steady_clock::time_point end_time,
+                      long long computed_ns);
+
+   // Vero se conviene eseguire il prossimo task sulla CPU invece di lasciarlo al device.
+   bool should_steal() const;
+
+   // Aggiorna le statistiche condivise e chiude il task. Chiamata sia dal consumer sia dai thread
+   // di work stealing.
+   void complete_task(Task *task, std::chrono::steady_clock::time_point end_time,
+                      long long computed_ns);
+
    // Puntatori all'acceleratore e all'oggetto per le statistiche.
    IAccelerator *accelerator_;
    StatsCollector *stats_;
+   LoadBoard *load_board_{nullptr}; // Solo se il nodo è un worker della farm multi-device
+   size_t worker_index_{0};
 
-   // Code per i task in ingresso dalla pipeline FF e per i task pronti per
-   // il download dal device all'host.
-   BlockingQueue<void *> inQ_;
+   // Code per i task in ingresso dalla pipeline FF (ordinata secondo la politica di scheduling)
+   // e per i task pronti per il download dal device all'host.
+   PriorityBlockingQueue<void *> inQ_;
    BlockingQueue<void *> readyQ_;
+   SchedPolicy sched_policy_{SchedPolicy::Fifo};
+   std::chrono::microseconds aging_{0};
+
+   size_t num_producers_{1};
+   std::vector<std::thread> producerThs_;
+   std::thread consumerTh_;
+
+   // Work stealing sulla CPU (disabilitato se non ci sono thread).
+   CpuKernel steal_kernel_{CpuKernel::Unknown};
+   size_t num_stealers_{0};
+   std::vector<std::thread> stealerThs_;
+   std::atomic<bool> stop_stealing_{false};
+   std::atomic<size_t> producers_waiting_{0};  // Producer in attesa di un buffer set libero
+   std::atomic<size_t> in_flight_{0};          // Task presi dal producer e non ancora completati
+   std::atomic<double> dev_ns_per_elem_{0};    // Media mobile del tempo di servizio del device
+   std::atomic<double> cpu_ns_per_elem_{0};    // Media mobile del tempo di un task su un core
+
+   // Batching (disabilitato se max_bytes è 0). I batch riciclati sono dimensionati in svc_init
+   // sul numero di buffer set del device.
+   static constexpr size_t BATCH_MEMBERS_RESERVE = 256; // Task per batch senza riallocazioni
+   size_t batch_max_bytes_{0};
+   std::chrono::microseconds batch_max_latency_{0};
+   std::vector<std::unique_ptr<Batch>> batches_;
+   BlockingQueue<Batch *> free_batches_;
 
-   std::thread producerTh_, consumerTh_;
+   // Stato dei completamenti, condiviso fra consumer e thread di work stealing.
+   std::mutex completion_mutex_;
+   std::chrono::steady_clock::time_point last_completion_time_;
+   bool first_completion_{true};
 };
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "AllocCounter.hpp"
+
+#ifdef TESI_ALLOC_COUNTER
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> allocation_count{0};
+
+static void *counted_alloc(size_t size) {
+   allocation_count.fetch_add(1, std::memory_order_relaxed);
+   if (void *ptr = std::malloc(size > 0 ? size : 1))
+      return ptr;
+   throw std::bad_alloc();
+}
+
+static void *counted_aligned_alloc(size_t size, std::align_val_t alignment) {
+   allocation_count.fetch_add(1, std::memory_order_relaxed);
+   size_t align = static_cast<size_t>(alignment);
+   // aligned_alloc richiede una dimensione multipla dell'allineamento.
+   size_t rounded = ((size > 0 ? size : 1) + align - 1) / align * align;
+   if (void *ptr = std::aligned_alloc(align, rounded))
+      return ptr;
+   throw std::bad_alloc();
+}
+
+void *operator new(size_t size) { return counted_alloc(size); }
+void *operator new[](size_t size) { return counted_alloc(size); }
+void *operator new(size_t size, std::align_val_t al) { return counted_aligned_alloc(size, al); }
+void *operator new[](size_t size, std::align_val_t al) { return counted_aligned_alloc(size, al); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+size_t heap_allocation_count() { return allocation_count.load(std::memory_order_relaxed); }
+
+#else
+
+size_t heap_allocation_count() { return 0; }
+
+#endif
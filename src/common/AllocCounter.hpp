@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Numero di allocazioni sull'heap (chiamate a operator new) dall'avvio del programma.
+ *
+ * Il conteggio è attivo solo nelle build con l'opzione CMake TESI_ALLOC_COUNTER, che sostituisce
+ * gli operatori new/delete globali; nelle altre build ritorna sempre 0. Serve a verificare che a
+ * regime la pipeline non allochi memoria.
+ */
+size_t heap_allocation_count();
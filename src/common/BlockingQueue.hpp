@@ -1,14 +1,17 @@
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
+
+#include "RingBuffer.hpp"
 
 /**
  * @brief Coda bloccante e thread-safe per la comunicazione tra stadi.
  *
  * Mette i thread consumer a dormire quando la coda è vuota e li risveglia
- * quando un nuovo elemento è disponibile, evitando l'attesa attiva.
+ * quando un nuovo elemento è disponibile, evitando l'attesa attiva. Gli
+ * elementi sono in un RingBuffer, così a regime push e pop non allocano.
  */
 template <typename T> class BlockingQueue {
  public:
@@ -31,8 +34,44 @@ template <typename T> class BlockingQueue {
       return item;
    }
 
+   /**
+    * @brief Estrae il primo elemento solo se la coda non è vuota e pred(elemento) è vero.
+    * Non blocca e non consuma notifiche, quindi può essere usata da thread che ispezionano la
+    * coda in polling senza togliere il risveglio al consumer principale.
+    * @return true se l'elemento è stato estratto in 'out'.
+    */
+   template <typename Pred> bool try_pop_if(T &out, Pred pred) {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (queue_.empty() || !pred(queue_.front()))
+         return false;
+
+      out = std::move(queue_.front());
+      queue_.pop();
+      return true;
+   }
+
+   /**
+    * @brief Come try_pop_if, ma se la coda è vuota attende un elemento fino a 'deadline'.
+    * @return true se l'elemento è stato estratto in 'out', false se la coda è rimasta vuota fino
+    * alla scadenza o se il primo elemento non soddisfa pred.
+    */
+   template <typename Pred, typename Clock, typename Duration>
+   bool pop_if_until(T &out, Pred pred, const std::chrono::time_point<Clock, Duration> &deadline) {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      if (!notEmptyCondition_.wait_until(lock, deadline, [this] { return !queue_.empty(); }))
+         return false;
+      if (!pred(queue_.front()))
+         return false;
+
+      out = std::move(queue_.front());
+      queue_.pop();
+      return true;
+   }
+
  private:
-   std::queue<T> queue_;
+   RingBuffer<T> queue_;
    std::mutex mutex_;
    std::condition_variable notEmptyCondition_;
 };
\ No newline at end of file
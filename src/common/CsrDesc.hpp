@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Descrittore di un task SpMV (y = A x) con A sparsa rows x cols in formato CSR: gli
+ * elementi non nulli della riga r sono values[row_ptr[r] .. row_ptr[r + 1]), nelle colonne
+ * col_idx[...] corrispondenti. Gli array della matrice sono argomenti del task in aggiunta a x
+ * (Task::a) e y (Task::c), entrambi float. rows = 0 indica un task su vettori.
+ */
+struct CsrDesc {
+   size_t rows{0}, cols{0}, nnz{0};
+   const int *row_ptr{nullptr};  // rows + 1 elementi
+   const int *col_idx{nullptr};  // nnz elementi
+   const float *values{nullptr}; // nnz elementi
+
+   bool valid() const { return rows > 0; }
+
+   // Byte degli array della matrice.
+   size_t matrix_bytes() const {
+      return sizeof(int) * (rows + 1 + nnz) + sizeof(float) * nnz;
+   }
+
+   // Operazioni in virgola mobile (una moltiplicazione e una somma per elemento non nullo).
+   double flops() const { return 2.0 * double(nnz); }
+
+   // Traffico minimo di una moltiplicazione: la matrice, x una volta e y.
+   double min_bytes() const { return double(matrix_bytes() + sizeof(float) * (cols + rows)); }
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Descrittore di un task stencil 2D: un tile di righe di una griglia float (per righe,
+ * cols elementi per riga), con le righe di alone (halo) sopra e sotto che il task legge ma non
+ * produce. Il task esegue steps iterazioni (sweep) dello stencil a points punti (5 o 9) e scrive
+ * solo le righe del tile. rows = 0 indica un task su vettori.
+ *
+ * L'alone è profondo quanto le iterazioni: a ogni sweep le righe al bordo del buffer non hanno
+ * vicini aggiornati e l'errore avanza di una riga, quindi dopo steps sweep le righe del tile
+ * sono ancora esatte. Ai bordi della griglia l'alone manca e le celle di bordo restano fisse.
+ */
+struct GridDesc {
+   size_t rows{0};        // Righe del buffer del task, alone compreso
+   size_t cols{0};        // Celle per riga
+   size_t halo_top{0};    // Righe di alone sopra il tile
+   size_t halo_bottom{0}; // Righe di alone sotto il tile
+   size_t steps{0};       // Sweep eseguiti dal task
+   size_t points{5};      // Punti dello stencil (5 o 9)
+   size_t first_row{0};   // Prima riga del tile nella griglia
+
+   bool valid() const { return rows > 0; }
+
+   // Celle lette dal task e celle prodotte (righe del tile).
+   size_t in_elems() const { return rows * cols; }
+   size_t out_rows() const { return rows - halo_top - halo_bottom; }
+   size_t out_elems() const { return out_rows() * cols; }
+
+   // Celle utili aggiornate dal task (senza il ricalcolo dell'alone).
+   double cell_updates() const { return double(out_elems()) * double(steps); }
+};
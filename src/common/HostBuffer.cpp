@@ -0,0 +1,98 @@
+#include "HostBuffer.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+static std::atomic<bool> huge_pages_enabled{true};
+static std::atomic<size_t> hugetlb_count{0}, transparent_count{0}, small_pages_count{0};
+
+void set_host_huge_pages(bool enabled) { huge_pages_enabled = enabled; }
+
+HostBufferStats host_buffer_stats() {
+   return {hugetlb_count.load(), transparent_count.load(), small_pages_count.load()};
+}
+
+// Dimensione di una allocazione grande: multiplo di HUGE_PAGE_BYTES (munmap richiede la stessa).
+static size_t huge_length(size_t bytes) {
+   return (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+}
+
+#ifdef __linux__
+/**
+ * @brief Mappa length byte allineati a HUGE_PAGE_BYTES: mappa HUGE_PAGE_BYTES in più e rilascia
+ * la parte iniziale e finale non allineata. Solo le pagine da 2 MB allineate possono diventare
+ * transparent huge pages.
+ */
+static void *map_aligned(size_t length) {
+   const size_t padded = length + HUGE_PAGE_BYTES;
+   void *raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (raw == MAP_FAILED)
+      return nullptr;
+   const uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+   const uintptr_t aligned = (begin + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+   if (aligned > begin)
+      munmap(raw, aligned - begin);
+   if (begin + padded > aligned + length)
+      munmap(reinterpret_cast<void *>(aligned + length), begin + padded - (aligned + length));
+   return reinterpret_cast<void *>(aligned);
+}
+#endif
+
+void *host_buffer_allocate(size_t bytes) {
+   if (bytes < HUGE_PAGE_BYTES) {
+      void *ptr = nullptr;
+      if (posix_memalign(&ptr, HOST_CACHE_LINE, bytes > 0 ? bytes : HOST_CACHE_LINE) != 0)
+         throw std::bad_alloc();
+      return ptr;
+   }
+
+   const size_t length = huge_length(bytes);
+#ifdef __linux__
+   const bool huge = huge_pages_enabled.load();
+#ifdef MAP_HUGETLB
+   if (huge) {
+      void *ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (ptr != MAP_FAILED) {
+         hugetlb_count++;
+         return ptr;
+      }
+   }
+#endif
+   void *ptr = map_aligned(length);
+   if (!ptr)
+      throw std::bad_alloc();
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+   if (madvise(ptr, length, huge ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) == 0 && huge) {
+      transparent_count++;
+      return ptr;
+   }
+#endif
+   small_pages_count++;
+   return ptr;
+#else
+   void *ptr = nullptr;
+   if (posix_memalign(&ptr, HOST_CACHE_LINE, length) != 0)
+      throw std::bad_alloc();
+   small_pages_count++;
+   return ptr;
+#endif
+}
+
+void host_buffer_free(void *ptr, size_t bytes) {
+   if (!ptr)
+      return;
+#ifdef __linux__
+   if (bytes >= HUGE_PAGE_BYTES) {
+      munmap(ptr, huge_length(bytes));
+      return;
+   }
+#else
+   (void)bytes;
+#endif
+   std::free(ptr);
+}
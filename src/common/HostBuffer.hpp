@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Allocatore dei vettori host grandi (dati dei task dei runner CPU e dell'Emitter) su
+ * pagine da 2 MB.
+ *
+ * Con pagine da 4 KB un vettore di qualche decina di MB occupa migliaia di voci del TLB e i
+ * kernel che lo scorrono a banda piena pagano un miss ogni 4 KB. Da HUGE_PAGE_BYTES in su
+ * l'allocatore prova, in ordine:
+ * 1. mmap con MAP_HUGETLB (pagine riservate in /proc/sys/vm/nr_hugepages);
+ * 2. mmap allineato a 2 MB con madvise(MADV_HUGEPAGE) (transparent huge pages, se il kernel le
+ *    concede).
+ * Con le huge page disabilitate (set_host_huge_pages(false)) la zona allineata viene marcata
+ * MADV_NOHUGEPAGE, così il confronto usa davvero pagine da 4 KB. Le allocazioni più piccole e
+ * quelle fuori da Linux usano posix_memalign, allineate alla linea di cache.
+ */
+constexpr size_t HUGE_PAGE_BYTES = size_t(2) << 20;
+constexpr size_t HOST_CACHE_LINE = 64;
+
+// Abilita o disabilita le huge page per le allocazioni successive (default: abilitate).
+void set_host_huge_pages(bool enabled);
+
+// Allocazioni grandi fatte finora, per tipo di pagina.
+struct HostBufferStats {
+   size_t hugetlb{0};     // Pagine riservate (MAP_HUGETLB)
+   size_t transparent{0}; // Transparent huge pages richieste con madvise
+   size_t small_pages{0}; // Pagine da 4 KB (huge page disabilitate o non disponibili)
+};
+HostBufferStats host_buffer_stats();
+
+// Alloca e libera bytes byte (la dimensione passata a host_buffer_free deve essere la stessa).
+void *host_buffer_allocate(size_t bytes);
+void host_buffer_free(void *ptr, size_t bytes);
+
+// Allocatore per std::vector basato su host_buffer_allocate().
+template <typename T> struct HugePageAllocator {
+   using value_type = T;
+
+   HugePageAllocator() = default;
+   template <typename U> HugePageAllocator(const HugePageAllocator<U> &) {}
+
+   T *allocate(size_t n) { return static_cast<T *>(host_buffer_allocate(n * sizeof(T))); }
+   void deallocate(T *ptr, size_t n) { host_buffer_free(ptr, n * sizeof(T)); }
+
+   template <typename U> bool operator==(const HugePageAllocator<U> &) const { return true; }
+   template <typename U> bool operator!=(const HugePageAllocator<U> &) const { return false; }
+};
+
+// Vettore host con l'allocatore a huge page.
+template <typename T> using HostVector = std::vector<T, HugePageAllocator<T>>;
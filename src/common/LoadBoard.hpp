@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Stato di carico dei worker della farm di acceleratori, condiviso fra lo scheduler (che
+ * incrementa i task in sospeso di un worker quando gli invia un task) e i nodi worker (che li
+ * decrementano al completamento e aggiornano il tempo di servizio misurato del loro device).
+ */
+class LoadBoard {
+ public:
+   struct WorkerLoad {
+      std::atomic<size_t> outstanding{0};        // Task inviati e non ancora completati
+      std::atomic<long long> ewma_service_ns{0}; // Media mobile del tempo di servizio
+      std::atomic<size_t> tasks_done{0};         // Task completati dal worker
+   };
+
+   explicit LoadBoard(size_t num_workers) : workers_(num_workers) {}
+
+   size_t size() const { return workers_.size(); }
+   WorkerLoad &worker(size_t index) { return workers_[index]; }
+   const WorkerLoad &worker(size_t index) const { return workers_[index]; }
+
+   // Chiamata dallo scheduler quando invia un task al worker.
+   void record_dispatch(size_t index) { workers_[index].outstanding++; }
+
+   // Imposta una stima iniziale del tempo di servizio (es. dal modello di costo), poi raffinata
+   // dalle misure dei completamenti.
+   void seed_service_ns(size_t index, long long service_ns) {
+      workers_[index].ewma_service_ns.store(service_ns);
+   }
+
+   /**
+    * @brief Chiamata dal worker a ogni completamento con il tempo di servizio del task.
+    * Aggiorna la media mobile esponenziale e risveglia lo scheduler se era in attesa.
+    */
+   void record_completion(size_t index, long long service_ns) {
+      auto &w = workers_[index];
+      long long prev = w.ewma_service_ns.load();
+      long long next =
+         (prev == 0) ? service_ns
+                     : static_cast<long long>(EWMA_ALPHA * service_ns + (1 - EWMA_ALPHA) * prev);
+      w.ewma_service_ns.store(next);
+      w.tasks_done++;
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         w.outstanding--;
+      }
+      slot_freed_cond_.notify_one();
+   }
+
+   /**
+    * @brief Attende (senza attesa attiva) che almeno un worker abbia meno di max_outstanding
+    * task in sospeso. Limitare i task in volo mantiene la scelta dello scheduler basata su
+    * misure recenti invece di distribuire subito tutto lo stream.
+    */
+   void wait_for_free_slot(size_t max_outstanding) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      slot_freed_cond_.wait(lock, [&] {
+         for (auto &w : workers_)
+            if (w.outstanding.load() < max_outstanding)
+               return true;
+         return false;
+      });
+   }
+
+   // Come sopra, ma attende che si liberi un posto proprio sul worker 'index'.
+   void wait_for_free_slot(size_t index, size_t max_outstanding) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      slot_freed_cond_.wait(
+         lock, [&] { return workers_[index].outstanding.load() < max_outstanding; });
+   }
+
+ private:
+   // Peso del nuovo campione nella media mobile.
+   static constexpr double EWMA_ALPHA = 0.2;
+
+   std::vector<WorkerLoad> workers_;
+   std::mutex mutex_;
+   std::condition_variable slot_freed_cond_;
+};
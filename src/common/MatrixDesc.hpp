@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Descrittore di un task a matrici (GEMM: C = A x B), con le matrici float memorizzate per
+ * righe: A è m x k, B è k x n, C è m x n. Le leading dimension (lda, ldb, ldc) sono le distanze in
+ * elementi fra due righe consecutive, quindi le matrici possono essere sottomatrici di matrici
+ * più grandi. m = 0 indica un task su vettori.
+ */
+struct MatrixDesc {
+   size_t m{0}, n{0}, k{0};
+   size_t lda{0}, ldb{0}, ldc{0};
+
+   bool valid() const { return m > 0; }
+
+   // Elementi occupati da ciascuna matrice.
+   size_t a_elems() const { return (m - 1) * lda + k; }
+   size_t b_elems() const { return (k - 1) * ldb + n; }
+   size_t c_elems() const { return (m - 1) * ldc + n; }
+
+   // Operazioni in virgola mobile di una moltiplicazione (una moltiplicazione e una somma per
+   // ogni termine dei prodotti scalari).
+   double flops() const { return 2.0 * double(m) * double(n) * double(k); }
+
+   // Matrici quadrate side x side, senza padding fra le righe.
+   static MatrixDesc square(size_t side) { return {side, side, side, side, side, side}; }
+};
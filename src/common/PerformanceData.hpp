@@ -1,5 +1,7 @@
 #pragma once
 #include <cstddef>
+#include <string>
+#include <vector>
 
 /**
  * @brief Struttura per contenere le metriche di performance calcolate.
@@ -11,4 +13,35 @@ struct PerformanceData {
    double avg_overhead_ms = 0.0;
    double throughput = 0.0;
    double elapsed_s = 0.0;
-};
\ No newline at end of file
+};
+
+/**
+ * @brief Metriche di un singolo device della farm multi-device.
+ */
+struct DeviceMetrics {
+   std::string name;       // Nome del device
+   size_t tasks = 0;       // Task completati dal device
+   PerformanceData metrics;
+};
+
+/**
+ * @brief Metriche di un tenant di un acceleratore condiviso (SharedAccelerator).
+ */
+struct TenantMetrics {
+   std::string name;                      // Nome del tenant
+   double weight = 1.0;                   // Peso nel fair queuing
+   size_t tasks = 0;                      // Task completati dal tenant
+   double device_share = 0.0;             // Frazione dei byte trasferiti dal device
+   double avg_wait_ms = 0.0;              // Attesa media di un buffer set
+   double finish_s = 0.0;                 // Istante in cui il tenant ha terminato i suoi task
+   std::vector<long long> latency_samples_ns; // Tempo nel nodo dei singoli task
+};
+
+/**
+ * @brief Picchi del backend per il modello roofline, misurati all'avvio. 0 = non misurato.
+ */
+struct RooflinePeaks {
+   std::string source;       // Backend e sonde usate
+   double bandwidth_gbs = 0; // Banda massima della memoria (GB/s)
+   double compute_gops = 0;  // Operazioni al secondo massime (GOP/s)
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Coda bloccante e thread-safe come BlockingQueue, ma gli elementi escono in ordine di
+ * chiave crescente (a parità di chiave in ordine di inserimento) invece che in ordine FIFO.
+ *
+ * La chiave è un istante: la scadenza del task (EDF) o una scadenza virtuale calcolata dalla
+ * politica di scheduling. Gli elementi sono in un min-heap su un vettore che viene solo
+ * ingrandito, così a regime push e pop non allocano.
+ */
+template <typename T> class PriorityBlockingQueue {
+ public:
+   using Key = std::chrono::steady_clock::time_point;
+
+   explicit PriorityBlockingQueue(size_t initial_capacity = 256) {
+      heap_.reserve(initial_capacity);
+   }
+
+   void push(T value, Key key) {
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         heap_.push_back(Entry{key, next_seq_++, std::move(value)});
+         std::push_heap(heap_.begin(), heap_.end(), Later{});
+      }
+
+      notEmptyCondition_.notify_one();
+   }
+
+   T pop() {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      notEmptyCondition_.wait(lock, [this] { return !heap_.empty(); });
+
+      return take_front();
+   }
+
+   /**
+    * @brief Estrae l'elemento con chiave minima solo se la coda non è vuota e pred(elemento) è
+    * vero. Non blocca e non consuma notifiche (vedi BlockingQueue::try_pop_if).
+    * @return true se l'elemento è stato estratto in 'out'.
+    */
+   template <typename Pred> bool try_pop_if(T &out, Pred pred) {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (heap_.empty() || !pred(heap_.front().value))
+         return false;
+
+      out = take_front();
+      return true;
+   }
+
+   /**
+    * @brief Come try_pop_if, ma se la coda è vuota attende un elemento fino a 'deadline'.
+    * @return true se l'elemento è stato estratto in 'out', false se la coda è rimasta vuota fino
+    * alla scadenza o se l'elemento con chiave minima non soddisfa pred.
+    */
+   template <typename Pred, typename Clock, typename Duration>
+   bool pop_if_until(T &out, Pred pred, const std::chrono::time_point<Clock, Duration> &deadline) {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      if (!notEmptyCondition_.wait_until(lock, deadline, [this] { return !heap_.empty(); }))
+         return false;
+      if (!pred(heap_.front().value))
+         return false;
+
+      out = take_front();
+      return true;
+   }
+
+ private:
+   struct Entry {
+      Key key;
+      size_t seq; // Ordine di inserimento, per rompere le parità
+      T value;
+   };
+
+   // Ordine dell'heap: in cima l'elemento con chiave minima e, a parità, il più vecchio.
+   struct Later {
+      bool operator()(const Entry &x, const Entry &y) const {
+         return x.key != y.key ? x.key > y.key : x.seq > y.seq;
+      }
+   };
+
+   // Estrae l'elemento in cima all'heap. Da chiamare con il mutex acquisito e l'heap non vuoto.
+   T take_front() {
+      std::pop_heap(heap_.begin(), heap_.end(), Later{});
+      T item = std::move(heap_.back().value);
+      heap_.pop_back();
+      return item;
+   }
+
+   std::vector<Entry> heap_;
+   size_t next_seq_{0};
+   std::mutex mutex_;
+   std::condition_variable notEmptyCondition_;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Coda FIFO (non thread-safe) su un buffer circolare, con la stessa interfaccia di
+ * std::queue per push/front/pop/empty.
+ *
+ * A differenza di std::queue (basata su std::deque), che alloca e libera blocchi man mano che gli
+ * elementi scorrono, qui la memoria viene allocata solo quando la coda supera la capacità
+ * raggiunta in precedenza (raddoppiandola). A regime push e pop non allocano mai.
+ *
+ * La capacità non è fissa perché non tutte le code hanno un limite noto alla costruzione: la
+ * readyQ_ del nodo acceleratore contiene anche i task a tile (che non occupano buffer set) e le
+ * sentinelle. Le code con un limite noto (es. gli indici liberi dei buffer set) vengono create
+ * con quella capacità e non crescono mai.
+ */
+template <typename T> class RingBuffer {
+ public:
+   explicit RingBuffer(size_t initial_capacity = 16)
+       : slots_(initial_capacity > 0 ? initial_capacity : 1) {}
+
+   void push(T value) {
+      if (size_ == slots_.size())
+         grow();
+      slots_[(head_ + size_) % slots_.size()] = std::move(value);
+      ++size_;
+   }
+
+   T &front() { return slots_[head_]; }
+
+   void pop() {
+      head_ = (head_ + 1) % slots_.size();
+      --size_;
+   }
+
+   bool empty() const { return size_ == 0; }
+   size_t size() const { return size_; }
+
+ private:
+   // Raddoppia la capacità, ricompattando gli elementi dall'inizio del nuovo buffer.
+   void grow() {
+      std::vector<T> bigger(2 * slots_.size());
+      for (size_t i = 0; i < size_; ++i)
+         bigger[i] = std::move(slots_[(head_ + i) % slots_.size()]);
+      slots_.swap(bigger);
+      head_ = 0;
+   }
+
+   std::vector<T> slots_;
+   size_t head_{0}; // Indice del primo elemento
+   size_t size_{0}; // Elementi presenti
+};
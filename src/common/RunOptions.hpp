@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Opzioni facoltative passate da command line nella forma `--chiave=valore`, dopo gli
+ * argomenti posizionali [N] [NUM_TASKS] [DEVICE] [KERNEL].
+ */
+struct RunOptions {
+   // Numero di device da usare in parallelo (farm di nodi ff_node_acc_t). 0 = tutti quelli
+   // trovati, 1 = pipeline classica con un solo device.
+   size_t num_devices = 1;
+
+   // Tipo di device OpenCL da cercare per 'gpu_opencl': "gpu" (default), "cpu" (es. POCL),
+   // "accelerator" o "all".
+   std::string cl_device_type = "gpu";
+
+   // Se > 0, partiziona il primo device OpenCL in questo numero di sub-device equivalenti
+   // (clCreateSubDevices), utile per provare la farm su un solo device (es. POCL).
+   size_t sub_devices = 0;
+
+   // Velocità relative dei device simulati ('sim'), es. "1,0.5,0.25". Se vuoto tutti a 1.
+   std::vector<double> sim_speeds;
+
+   // Esecuzione ibrida: ogni task viene diviso fra CPU e acceleratore.
+   bool hybrid = false;
+   // Frazione iniziale degli elementi di un task assegnata all'acceleratore (poi adattiva).
+   double hybrid_acc_ratio = 0.5;
+
+   // Thread CPU che rubano task interi al nodo acceleratore quando il device è saturo.
+   // 0 = work stealing disabilitato.
+   size_t steal_workers = 0;
+
+   // Thread producer (upload + lancio del kernel) del nodo acceleratore.
+   size_t producers = 1;
+
+   // Batching dei task piccoli nel nodo acceleratore: byte massimi di un batch (input + output,
+   // 0 = disabilitato) e latenza massima aggiunta al primo task del batch.
+   size_t batch_bytes = 0;
+   size_t batch_latency_us = 200;
+
+   // Elementi per tile dell'esecuzione a tile su 'gpu_opencl': i task più grandi attraversano il
+   // device a pezzi. 0 = solo i task che non entrano in un buffer del device.
+   size_t tile_elems = 0;
+
+   // Autotuning del lancio dei kernel su 'gpu_opencl' (work-group, elementi per work-item,
+   // vettori int4/int8), con le configurazioni salvate per device e kernel in tune_cache.
+   bool autotune = false;
+   std::string tune_cache = "tesi_tuning.db";
+
+   // Specializzazione JIT dei kernel su 'gpu_opencl': una variante compilata per ogni dimensione
+   // dei task, math veloce (-cl-fast-relaxed-math) e tipo dei calcoli in virgola mobile.
+   bool jit = false;
+   bool jit_fast_math = false;
+   std::string jit_type = "float";
+
+   // Riduzioni su 'gpu_opencl': i parziali dei work-group vengono combinati sul device da un
+   // secondo kernel (solo il risultato viene scaricato) invece che sull'host.
+   bool reduce_on_device = false;
+
+   // Stencil 2D (stencil5, stencil9) su una griglia N x N: sweep eseguiti da ogni task senza
+   // tornare all'host e righe per tile (0 = un task per l'intera griglia). Con i tile ogni task
+   // legge anche stencil_steps righe di alone sopra e sotto.
+   size_t stencil_steps = 1;
+   size_t stencil_rows = 0;
+
+   // SpMV (spmv_csr, spmv_csr_vector) su una matrice sparsa N x N generata: elementi non nulli
+   // per riga in media e skew della lunghezza delle righe (0 = righe uguali, più alto = poche
+   // righe molto lunghe, vedi spmv_generate()).
+   size_t spmv_nnz = 16;
+   double spmv_skew = 0.0;
+
+   // Compute unit del kernel FPGA da usare (0 = tutte quelle presenti nel binario .xclbin).
+   size_t fpga_cus = 0;
+
+   // Trasferimenti FPGA: migrazione dei buffer su memoria host allineata (default) o
+   // scritture/letture separate ("--fpga-transfer=write"), per confrontarne il throughput.
+   bool fpga_migrate = true;
+
+   // Vettori host dei runner CPU e dell'Emitter su huge page da 2 MB (vedi HostBuffer.hpp) e
+   // store non temporali dei kernel limitati dalla banda sulla CPU: "auto" (se l'output supera
+   // la LLC), "on" o "off" (vedi CpuStream.hpp).
+   bool huge_pages = true;
+   std::string nt_stores = "auto";
+
+   // Report roofline: byte e operazioni dei task rispetto ai picchi di banda e di calcolo del
+   // backend, misurati all'avvio ('cpu_ff', 'cpu_omp' e 'gpu_opencl' a device singolo).
+   bool roofline = false;
+
+   // Contatori hardware (perf_event_open) attorno ai task di 'cpu_ff' e 'cpu_omp'.
+   bool perf_counters = false;
+
+   // Modalità 'microbench': dimensione massima dei trasferimenti misurati e file JSON dei
+   // risultati (vedi MicroBench.hpp).
+   size_t microbench_max_bytes = size_t(1) << 30;
+   std::string microbench_json = "tesi_microbench.json";
+
+   // Scheduling dei task in attesa nel nodo acceleratore: "fifo", "edf" o "priority" (classi
+   // con aging: una classe in più equivale a aging_us microsecondi di attesa in più).
+   std::string sched = "fifo";
+   size_t aging_us = 50000;
+
+   // Traffico misto: se interactive_every > 0 un task ogni interactive_every è interattivo
+   // (classe 0, interactive_n elementi, 0 = N/100, scadenza facoltativa dopo deadline_us
+   // microsecondi) e gli altri sono batch (classe 1, N elementi, senza scadenza).
+   size_t interactive_every = 0;
+   size_t interactive_n = 0;
+   size_t deadline_us = 0;
+
+   // Pesi dei tenant che condividono un solo acceleratore, es. "1,2": una pipeline per tenant,
+   // tutte sullo stesso device. Se vuoto nessuna condivisione.
+   std::vector<double> tenant_weights;
+
+   // Modalità 'auto': database dei profili dei backend, ricalibrazione forzata e backend candidati.
+   std::string profile_db = "tesi_profile.db";
+   bool calibrate = false;
+   std::vector<std::string> auto_backends = {"cpu_ff", "gpu_opencl", "fpga"};
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Task.hpp"
+#include <chrono>
+#include <string>
+
+/**
+ * @brief Politica con cui il nodo ff_node_acc_t sceglie il prossimo task dalla coda di ingresso.
+ * - Fifo: ordine di arrivo.
+ * - Edf (Earliest Deadline First): prima il task con la scadenza più vicina. I task senza scadenza
+ *   ricevono quella virtuale di Priority, così non restano fermi per sempre.
+ * - Priority: prima la classe più alta, con aging: un task di classe p equivale a uno di classe 0
+ *   arrivato p * aging più tardi, quindi dopo aver atteso p * aging supera i nuovi arrivi di
+ *   classe 0 e non può subire starvation.
+ */
+enum class SchedPolicy { Fifo, Edf, Priority, Unknown };
+
+inline SchedPolicy parse_sched_policy(const std::string &name) {
+   if (name == "fifo")
+      return SchedPolicy::Fifo;
+   if (name == "edf")
+      return SchedPolicy::Edf;
+   if (name == "priority")
+      return SchedPolicy::Priority;
+   return SchedPolicy::Unknown;
+}
+
+/**
+ * @brief Chiave di ordinamento del task nella coda di ingresso (la più piccola esce per prima).
+ * Con l'aging lineare la chiave di Priority non cambia nel tempo: basta calcolarla all'arrivo.
+ */
+inline std::chrono::steady_clock::time_point schedule_key(const Task *task, SchedPolicy policy,
+                                                          std::chrono::microseconds aging) {
+   if (policy == SchedPolicy::Fifo)
+      return task->arrival_time;
+   if (policy == SchedPolicy::Edf && task->has_deadline())
+      return task->deadline;
+   return task->arrival_time + aging * (long long)task->priority;
+}
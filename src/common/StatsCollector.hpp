@@ -1,7 +1,10 @@
 #pragma once
 
+#include "Task.hpp"
 #include <atomic>
+#include <chrono>
 #include <future>
+#include <vector>
 
 /**
  * @brief Struttura usata per raccogliere risultati generati dai thread interni al nodo FF e
@@ -13,4 +16,37 @@ struct StatsCollector {
    std::atomic<long long> computed_ns{0};
    std::atomic<long long> total_InNode_time_ns{0};
    std::atomic<long long> inter_completion_time_ns{0};
+   std::atomic<size_t> tasks_on_cpu{0}; // Task eseguiti sulla CPU per work stealing
+   std::atomic<size_t> batches{0};      // Lanci sul device che contenevano più task
+
+   // Primo e ultimo completamento (ns dall'epoca di steady_clock, 0 = nessuno): con più nodi
+   // (farm, tenant) il tempo fra i completamenti aggregato va dal primo all'ultimo di tutti.
+   std::atomic<long long> first_completion_ns{0};
+   std::atomic<long long> last_completion_ns{0};
+
+   // Registra un completamento. Chiamata da un solo thread alla volta per collector.
+   void record_completion_time(std::chrono::steady_clock::time_point t) {
+      long long ns =
+         std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+      if (first_completion_ns == 0 || ns < first_completion_ns)
+         first_completion_ns = ns;
+      if (ns > last_completion_ns)
+         last_completion_ns = ns;
+   }
+
+   // Tempo nel nodo di ogni task, per i percentili di latenza. Scritto solo dal thread che
+   // registra i completamenti (sotto il suo mutex), letto a fine esecuzione.
+   std::vector<long long> latency_samples_ns;
+
+   // Gli stessi campioni divisi per classe di priorità, con i task che avevano una scadenza e
+   // quelli completati dopo la scadenza. Scritti sotto lo stesso mutex.
+   std::vector<long long> class_latency_samples_ns[MAX_PRIORITY_CLASSES];
+   size_t class_deadline_tasks[MAX_PRIORITY_CLASSES]{};
+   size_t class_deadline_misses[MAX_PRIORITY_CLASSES]{};
+
+   // Allocazioni sull'heap (solo build TESI_ALLOC_COUNTER) dopo i primi task di riscaldamento e a
+   // fine esecuzione: la differenza sono le allocazioni a regime.
+   static constexpr size_t ALLOC_WARMUP_TASKS = 10;
+   std::atomic<size_t> heap_allocs_at_warmup{0};
+   std::atomic<size_t> heap_allocs_at_end{0};
 };
\ No newline at end of file
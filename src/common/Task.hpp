@@ -1,4 +1,7 @@
 #pragma once
+#include "CsrDesc.hpp"
+#include "GridDesc.hpp"
+#include "MatrixDesc.hpp"
 #include <chrono>
 #include <cstddef>
 
@@ -8,6 +11,14 @@
 #include <CL/cl.h>
 #endif
 
+class TaskPool;
+
+// Classi di priorità distinte nelle statistiche (le classi successive confluiscono nell'ultima).
+constexpr size_t MAX_PRIORITY_CLASSES = 4;
+
+// Valore di buffer_idx per i task che non occupano un buffer set (es. task a tile).
+constexpr size_t NO_BUFFER_SET = static_cast<size_t>(-1);
+
 /**
  * Struttura che rappresenta un singolo task di calcolo.
  */
@@ -26,4 +37,38 @@ struct Task {
 
    // Tempo di arrivo del task nel nodo.
    std::chrono::steady_clock::time_point arrival_time;
+
+   // Classe di priorità (0 = la più alta) e scadenza assoluta facoltativa, usate dalla politica
+   // di scheduling del nodo ff_node_acc_t e dalle statistiche per classe.
+   size_t priority{0};
+   std::chrono::steady_clock::time_point deadline{};
+
+   bool has_deadline() const { return deadline != std::chrono::steady_clock::time_point{}; }
+
+   // Callback facoltativa invocata dal nodo ff_node_acc_t quando i risultati del task sono
+   // sull'host, prima di distruggere il task (es. per l'esecuzione ibrida CPU+acceleratore).
+   void (*on_complete)(Task *task, void *ctx){nullptr};
+   void *on_complete_ctx{nullptr};
+
+   // Se il task rappresenta un batch di task piccoli impacchettati da ff_node_acc_t, punta al
+   // batch (i suoi vettori sono i buffer di staging del batch).
+   void *batch{nullptr};
+
+   // Task a matrici (es. gemm): a, b e c puntano a matrici float descritte da mat, e n è il
+   // numero di elementi di C. Se mat non è valido il task è su vettori.
+   MatrixDesc mat{};
+
+   // Task stencil (stencil5, stencil9): a punta al buffer del task (alone compreso) e c alla
+   // prima riga del tile nella griglia di output, float descritte da grid; n è il numero di
+   // celle del tile. Se grid non è valido il task non è uno stencil.
+   GridDesc grid{};
+
+   // Task SpMV (spmv_csr, spmv_csr_vector): y = A x con A descritta da csr (i suoi array sono
+   // argomenti in più del task), a punta a x e c a y, float; n è il numero di righe. Se csr non
+   // è valido il task non è una SpMV.
+   CsrDesc csr{};
+
+   // Pool da cui proviene il task (nullptr se allocato con new): chi lo completa lo rilascia
+   // con release_task().
+   TaskPool *owner{nullptr};
 };
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "Task.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Dimensione di una linea di cache, per evitare il false sharing fra thread.
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Pool di Task preallocati, riciclati dal consumer (che li rilascia a fine elaborazione)
+ * al producer (che li riprende per i task successivi), senza allocazioni sull'heap a regime.
+ *
+ * I Task liberi sono in una coda MPMC lock-free a capacità fissa (algoritmo di D. Vyukov): ogni
+ * cella ha un numero di sequenza che dice se è pronta per essere scritta o letta, e produttori e
+ * consumatori avanzano i propri indici con una compare-and-swap. Task, celle e indici sono
+ * allineati alla linea di cache, così thread diversi non si contendono la stessa linea.
+ *
+ * Il pool limita anche i task in volo: se è vuoto acquire() si addormenta su una condition
+ * variable finché un task non viene rilasciato, come le BlockingQueue fra gli stadi. Il mutex
+ * serve solo in questo caso: release() lo prende solo se qualcuno è in attesa.
+ */
+class TaskPool {
+ public:
+   // La capacità viene arrotondata alla potenza di 2 successiva.
+   explicit TaskPool(size_t capacity) {
+      size_t rounded = 1;
+      while (rounded < capacity)
+         rounded <<= 1;
+      mask_ = rounded - 1;
+
+      slots_ = std::make_unique<Slot[]>(rounded);
+      cells_ = std::make_unique<Cell[]>(rounded);
+      for (size_t i = 0; i < rounded; ++i)
+         cells_[i].sequence.store(i, std::memory_order_relaxed);
+
+      // All'inizio tutti i Task sono liberi.
+      for (size_t i = 0; i < rounded; ++i)
+         push(&slots_[i].task);
+   }
+
+   TaskPool(const TaskPool &) = delete;
+   TaskPool &operator=(const TaskPool &) = delete;
+
+   /**
+    * @brief Prende un Task libero, azzerato e con owner impostato a questo pool. Se il pool è
+    * vuoto attende che un task venga rilasciato.
+    */
+   Task *acquire() {
+      Task *task = nullptr;
+      if (!pop(task)) {
+         std::unique_lock<std::mutex> lock(mutex_);
+         waiters_.fetch_add(1);
+         // La fence ordina l'annuncio dell'attesa prima del nuovo tentativo, speculare a quella
+         // di release(): o pop() vede il task rilasciato o release() vede l'attesa e notifica.
+         std::atomic_thread_fence(std::memory_order_seq_cst);
+         released_cond_.wait(lock, [&] { return pop(task); });
+         waiters_.fetch_sub(1);
+      }
+
+      *task = Task{};
+      task->owner = this;
+      return task;
+   }
+
+   // Restituisce un Task al pool. Può essere chiamata da qualsiasi thread.
+   void release(Task *task) {
+      push(task);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiters_.load(std::memory_order_relaxed) > 0) {
+         // Con il mutex la notifica non può cadere fra il controllo e l'attesa di acquire().
+         std::lock_guard<std::mutex> lock(mutex_);
+         released_cond_.notify_one();
+      }
+   }
+
+ private:
+   struct alignas(CACHE_LINE_SIZE) Slot {
+      Task task;
+   };
+
+   struct alignas(CACHE_LINE_SIZE) Cell {
+      std::atomic<size_t> sequence;
+      Task *task{nullptr};
+   };
+
+   // Inserisce un task. Non fallisce mai: nel pool rientrano solo i suoi task.
+   void push(Task *task) {
+      size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+      while (true) {
+         Cell &cell = cells_[pos & mask_];
+         size_t seq = cell.sequence.load(std::memory_order_acquire);
+         intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+         if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+               cell.task = task;
+               cell.sequence.store(pos + 1, std::memory_order_release);
+               return;
+            }
+         } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+         }
+      }
+   }
+
+   // Estrae un task libero. Ritorna false se il pool è vuoto.
+   bool pop(Task *&task) {
+      size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+      while (true) {
+         Cell &cell = cells_[pos & mask_];
+         size_t seq = cell.sequence.load(std::memory_order_acquire);
+         intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+         if (diff == 0) {
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+               task = cell.task;
+               cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+               return true;
+            }
+         } else if (diff < 0) {
+            return false;
+         } else {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+         }
+      }
+   }
+
+   std::unique_ptr<Slot[]> slots_;
+   std::unique_ptr<Cell[]> cells_;
+   size_t mask_{0};
+
+   alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueue_pos_{0};
+   alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeue_pos_{0};
+
+   // Attesa di acquire() a pool vuoto.
+   alignas(CACHE_LINE_SIZE) std::atomic<size_t> waiters_{0};
+   std::mutex mutex_;
+   std::condition_variable released_cond_;
+};
+
+/**
+ * @brief Rilascia un Task a fine elaborazione: lo restituisce al suo pool se ne ha uno,
+ * altrimenti lo distrugge.
+ */
+inline void release_task(Task *task) {
+   if (task->owner)
+      task->owner->release(task);
+   else
+      delete task;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+/**
+ * @brief Picco di calcolo della CPU per il modello roofline: FMA in float su FMA_LANES
+ * accumulatori indipendenti, 8 registri vettoriali della larghezza disponibile. Sono abbastanza
+ * catene per coprire la latenza delle unità vettoriali, senza superare i 16 registri di SSE e AVX.
+ *
+ * Il ciclo sugli accumulatori è srotolato del tutto: restano nei registri e il compilatore li
+ * vettorizza (SIMD), quindi la misura dipende solo dalle unità aritmetiche e dai flag di
+ * compilazione (con -mfma ogni x * m + add diventa una sola istruzione FMA). Il lavoro è diviso
+ * in FMA_UNITS_PER_THREAD unità per core, con la stessa funzione for_range delle misure di banda
+ * (vedi stream_peak()).
+ */
+#if defined(__AVX512F__)
+constexpr size_t FMA_LANES = 128; // Accumulatori float indipendenti per unità
+#elif defined(__AVX__)
+constexpr size_t FMA_LANES = 64;
+#else
+constexpr size_t FMA_LANES = 32;
+#endif
+constexpr size_t FMA_ITERS = size_t(1) << 16; // Iterazioni di un'unità
+constexpr size_t FMA_UNITS_PER_THREAD = 16;   // Unità per core
+constexpr int FMA_REPEATS = 3;                // Misure (vale la migliore)
+
+#if defined(__clang__)
+#define FMA_PEAK_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define FMA_PEAK_UNROLL _Pragma("GCC unroll 128")
+#else
+#define FMA_PEAK_UNROLL
+#endif
+
+// Operazioni in virgola mobile di un'unità (una FMA conta come 2).
+inline double fma_unit_flops() { return 2.0 * double(FMA_LANES) * double(FMA_ITERS); }
+
+// Esegue un'unità e ne restituisce la somma, così il compilatore non può eliminarla.
+inline float fma_unit(size_t seed) {
+   float acc[FMA_LANES];
+   for (size_t k = 0; k < FMA_LANES; ++k)
+      acc[k] = float((seed + k) % 97) * 1e-3f;
+   const float m = 0.9999999f, add = 1e-7f;
+   for (size_t it = 0; it < FMA_ITERS; ++it) {
+      FMA_PEAK_UNROLL
+      for (size_t k = 0; k < FMA_LANES; ++k)
+         acc[k] = acc[k] * m + add;
+   }
+   float sum = 0.0f;
+   for (size_t k = 0; k < FMA_LANES; ++k)
+      sum += acc[k];
+   return sum;
+}
+
+/**
+ * @brief Misura il picco di calcolo in GFLOP/s. for_range(len, body) divide [0, len) fra i
+ * thread del runner e chiama body(begin, end) su ogni parte.
+ */
+template <typename ForRangeFn> double fma_peak(ForRangeFn &&for_range) {
+   const size_t units =
+      FMA_UNITS_PER_THREAD * std::max<size_t>(1, std::thread::hardware_concurrency());
+   volatile float sink = 0.0f;
+   long long best_ns = 0;
+   for (int rep = 0; rep < FMA_REPEATS; ++rep) {
+      auto t0 = std::chrono::steady_clock::now();
+      for_range(units, [&](size_t begin, size_t end) {
+         float sum = 0.0f;
+         for (size_t u = begin; u < end; ++u)
+            sum += fma_unit(u);
+         if (sum == -1.0f) // Mai vero: tiene vivo il risultato senza sincronizzare i thread
+            sink = sum;
+      });
+      auto t1 = std::chrono::steady_clock::now();
+      long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+      if (best_ns == 0 || ns < best_ns)
+         best_ns = ns;
+   }
+   return fma_unit_flops() * double(units) / double(std::max(1LL, best_ns));
+}
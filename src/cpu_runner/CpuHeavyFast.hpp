@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * @brief Variante veloce di heavy_compute_kernel (heavy_compute_fast), in float a precisione
+ * ridotta.
+ *
+ * Il kernel di riferimento somma sin(a + j) * cos(b - j) per j = 0 .. HEAVY_ITERS - 1. Gli
+ * argomenti avanzano esattamente di +1 e -1 a ogni iterazione, quindi dalle formule di addizione
+ *
+ *    sin(x + 1) = sin x cos 1 + cos x sin 1      cos(y - 1) = cos y cos 1 + sin y sin 1
+ *    cos(x + 1) = cos x cos 1 - sin x sin 1      sin(y - 1) = sin y cos 1 - cos y sin 1
+ *
+ * le coppie (sin, cos) avanzano con una rotazione fissa: seno e coseno si calcolano solo per
+ * j = 0 e ogni iterazione costa 8 moltiplicazioni e 4 somme invece di due funzioni
+ * trascendenti. L'errore di arrotondamento della rotazione cresce linearmente con j, quindi
+ * quello del risultato con HEAVY_ITERS² (vedi heavy_fast_error_bound()).
+ *
+ * Sulla CPU gli elementi vengono elaborati a blocchi di HEAVY_FAST_BLOCK: il ciclo sugli elementi
+ * del blocco è interno a quello su j, a passo 1, ed è vettorizzato (SIMD).
+ *
+ * Gli input vengono convertiti in float, esatto solo fino a HEAVY_FAST_EXACT_INPUT (2^24): oltre,
+ * l'argomento di partenza è già arrotondato di qualche unità e il limite d'errore non vale più
+ * (con b = 2 i succede da N > 2^23).
+ */
+constexpr int HEAVY_ITERS = 200;                  // Iterazioni per elemento (riferimento e fast)
+constexpr size_t HEAVY_FAST_BLOCK = 256;          // Elementi per blocco (5 array float in L1)
+constexpr size_t HEAVY_FAST_CHECK_SAMPLES = 4096; // Elementi confrontati con il riferimento
+constexpr int HEAVY_FAST_EXACT_INPUT = 1 << 24;   // Input massimo (in modulo) esatto in float
+
+#ifdef _OPENMP
+#define HEAVY_FAST_SIMD _Pragma("omp simd")
+#else
+#define HEAVY_FAST_SIMD
+#endif
+
+/**
+ * @brief Calcola c[i] per i in [begin, end) con la ricorrenza.
+ */
+inline void heavy_compute_fast_range(const int *a, const int *b, int *c, size_t begin,
+                                     size_t end) {
+   const float s1 = std::sin(1.0f), c1 = std::cos(1.0f);
+   float sa[HEAVY_FAST_BLOCK], ca[HEAVY_FAST_BLOCK], sb[HEAVY_FAST_BLOCK], cb[HEAVY_FAST_BLOCK];
+   float acc[HEAVY_FAST_BLOCK];
+
+   for (size_t base = begin; base < end; base += HEAVY_FAST_BLOCK) {
+      const size_t len = std::min(HEAVY_FAST_BLOCK, end - base);
+      for (size_t k = 0; k < len; ++k) {
+         const float val_a = float(a[base + k]), val_b = float(b[base + k]);
+         sa[k] = std::sin(val_a);
+         ca[k] = std::cos(val_a);
+         sb[k] = std::sin(val_b);
+         cb[k] = std::cos(val_b);
+         acc[k] = 0.0f;
+      }
+
+      for (int j = 0; j < HEAVY_ITERS; ++j) {
+         HEAVY_FAST_SIMD
+         for (size_t k = 0; k < len; ++k) {
+            acc[k] += sa[k] * cb[k];
+            const float next_sa = sa[k] * c1 + ca[k] * s1;
+            ca[k] = ca[k] * c1 - sa[k] * s1;
+            sa[k] = next_sa;
+            const float next_sb = sb[k] * c1 - cb[k] * s1;
+            cb[k] = cb[k] * c1 + sb[k] * s1;
+            sb[k] = next_sb;
+         }
+      }
+
+      for (size_t k = 0; k < len; ++k)
+         c[base + k] = (int)acc[k];
+   }
+}
+
+// Risultato del riferimento (double, seno e coseno a ogni iterazione) prima della conversione.
+inline double heavy_reference_value(int a, int b) {
+   double result = 0.0;
+   for (int j = 0; j < HEAVY_ITERS; ++j)
+      result += std::sin(double(a) + j) * std::cos(double(b) - j);
+   return result;
+}
+
+/**
+ * @brief Limite dell'errore assoluto della ricorrenza rispetto al riferimento. A ogni passo la
+ * rotazione (prodotti, somma e cos 1, sin 1 arrotondati) sposta seno e coseno di al più circa
+ * 2 FLT_EPSILON, quindi il termine j sbaglia di circa 4 j FLT_EPSILON: sommati sulle HEAVY_ITERS
+ * iterazioni fanno 2 HEAVY_ITERS² FLT_EPSILON, a cui si aggiunge l'arrotondamento
+ * dell'accumulatore (|acc| <= HEAVY_ITERS, HEAVY_ITERS² FLT_EPSILON / 2 al più).
+ */
+inline double heavy_fast_error_bound() {
+   return 3.0 * double(HEAVY_ITERS) * double(HEAVY_ITERS) * double(FLT_EPSILON);
+}
+
+// Confronto di un campione dell'output c del backend con il riferimento.
+struct HeavyFastCheck {
+   double max_error{0};    // Errore assoluto massimo di c (int) rispetto al riferimento reale
+   size_t mismatches{0};   // Elementi di c diversi dal riferimento convertito a int
+   size_t out_of_bound{0}; // Elementi di c non spiegati da un errore entro il limite
+   size_t checked{0};      // Elementi confrontati
+   size_t skipped{0};      // Elementi campionati con input oltre HEAVY_FAST_EXACT_INPUT
+};
+
+/**
+ * @brief Indica se il valore reale exact, sbagliato di al più bound, può essere convertito
+ * (troncando verso zero) nell'intero c: [exact - bound, exact + bound] deve toccare gli x con
+ * (int)x == c, cioè [c, c + 1) per c > 0, (c - 1, c] per c < 0 e (-1, 1) per c = 0.
+ */
+inline bool heavy_fast_explained(int c, double exact, double bound) {
+   const double lo = c > 0 ? double(c) : double(c) - 1.0;
+   const double hi = c < 0 ? double(c) : double(c) + 1.0;
+   return exact + bound > lo && exact - bound < hi;
+}
+
+/**
+ * @brief Confronta al più HEAVY_FAST_CHECK_SAMPLES elementi (equidistanti) dell'output c del
+ * backend con il riferimento. c è già convertito a int, quindi l'errore misurato include il
+ * troncamento (meno di 1) e un elemento può differire di 1 dal riferimento quando il valore
+ * reale è vicino a un intero; un elemento è fuori limite se nessun valore entro
+ * heavy_fast_error_bound() dal riferimento dà c. Gli elementi con input oltre
+ * HEAVY_FAST_EXACT_INPUT non vengono confrontati.
+ */
+inline HeavyFastCheck heavy_fast_check(const int *a, const int *b, const int *c, size_t n) {
+   HeavyFastCheck r;
+   const double bound = heavy_fast_error_bound();
+   const size_t stride =
+      std::max<size_t>(1, (n + HEAVY_FAST_CHECK_SAMPLES - 1) / HEAVY_FAST_CHECK_SAMPLES);
+   for (size_t i = 0; i < n; i += stride) {
+      if (std::abs(a[i]) > HEAVY_FAST_EXACT_INPUT || std::abs(b[i]) > HEAVY_FAST_EXACT_INPUT) {
+         r.skipped++;
+         continue;
+      }
+      const double exact = heavy_reference_value(a[i], b[i]);
+      r.max_error = std::max(r.max_error, std::fabs(double(c[i]) - exact));
+      r.mismatches += c[i] != (int)exact;
+      r.out_of_bound += !heavy_fast_explained(c[i], exact, bound);
+      r.checked++;
+   }
+   return r;
+}
+
+// Stampa il confronto, preceduto da tag (es. "[CPU OpenMP]").
+inline void print_heavy_fast_check(const char *tag, const HeavyFastCheck &r) {
+   std::cout << tag << " heavy_compute_fast max abs error of c (sampled, int output): "
+             << r.max_error << " (bound " << heavy_fast_error_bound() << " + truncation), "
+             << r.mismatches << " / " << r.checked << " results differ after int conversion, "
+             << r.out_of_bound << " outside the bound\n";
+   if (r.skipped > 0)
+      std::cout << tag << " " << r.skipped << " sampled elements with inputs above 2^24 not "
+                << "checked (not exact in float, the bound does not apply)\n";
+}
@@ -0,0 +1,369 @@
+#pragma once
+
+#include "CpuHeavyFast.hpp"
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Versioni host dei kernel disponibili per GPU e FPGA, usate da chi deve calcolare su CPU
+ * una parte (o la totalità) di un Task destinato a un acceleratore (device simulati, esecuzione
+ * ibrida, ...). Accetta sia i nomi dei kernel GPU/CPU sia quelli dei kernel FPGA (krnl_*).
+ */
+enum class CpuKernel {
+   VecAdd,
+   PolynomialOp,
+   HeavyCompute,
+   HeavyComputeFast,
+   DeepPipeline,
+   ReduceSum,
+   ReduceMin,
+   ReduceMax,
+   Histogram,
+   Gemm,
+   Stencil5,
+   Stencil9,
+   SpmvCsr,
+   SpmvCsrVector,
+   Unknown
+};
+
+// I kernel FPGA "_wide" (porte da 512 bit) calcolano lo stesso kernel della versione stretta.
+inline CpuKernel parse_cpu_kernel(const std::string &kernel_name) {
+   if (kernel_name == "vecAdd" || kernel_name == "krnl_vadd" || kernel_name == "krnl_vadd_wide")
+      return CpuKernel::VecAdd;
+   if (kernel_name == "polynomial_op" || kernel_name == "krnl_polynomial_op" ||
+       kernel_name == "krnl_polynomial_op_wide")
+      return CpuKernel::PolynomialOp;
+   if (kernel_name == "heavy_compute_kernel" || kernel_name == "krnl_heavy_compute")
+      return CpuKernel::HeavyCompute;
+   if (kernel_name == "heavy_compute_fast" || kernel_name == "krnl_heavy_compute_fast")
+      return CpuKernel::HeavyComputeFast;
+   if (kernel_name == "deep_pipeline_calculation" ||
+       kernel_name == "krnl_deep_pipeline_calculation" ||
+       kernel_name == "krnl_deep_pipeline_calculation_wide")
+      return CpuKernel::DeepPipeline;
+   if (kernel_name == "reduce_sum")
+      return CpuKernel::ReduceSum;
+   if (kernel_name == "reduce_min")
+      return CpuKernel::ReduceMin;
+   if (kernel_name == "reduce_max")
+      return CpuKernel::ReduceMax;
+   if (kernel_name == "histogram")
+      return CpuKernel::Histogram;
+   if (kernel_name == "gemm")
+      return CpuKernel::Gemm;
+   if (kernel_name == "stencil5")
+      return CpuKernel::Stencil5;
+   if (kernel_name == "stencil9")
+      return CpuKernel::Stencil9;
+   if (kernel_name == "spmv_csr")
+      return CpuKernel::SpmvCsr;
+   if (kernel_name == "spmv_csr_vector")
+      return CpuKernel::SpmvCsrVector;
+   return CpuKernel::Unknown;
+}
+
+// Nome canonico (quello dei kernel GPU/CPU) di un kernel, es. per le chiavi del profilo dei device.
+inline const char *cpu_kernel_name(CpuKernel kernel) {
+   switch (kernel) {
+   case CpuKernel::VecAdd:
+      return "vecAdd";
+   case CpuKernel::PolynomialOp:
+      return "polynomial_op";
+   case CpuKernel::HeavyCompute:
+      return "heavy_compute_kernel";
+   case CpuKernel::HeavyComputeFast:
+      return "heavy_compute_fast";
+   case CpuKernel::DeepPipeline:
+      return "deep_pipeline_calculation";
+   case CpuKernel::ReduceSum:
+      return "reduce_sum";
+   case CpuKernel::ReduceMin:
+      return "reduce_min";
+   case CpuKernel::ReduceMax:
+      return "reduce_max";
+   case CpuKernel::Histogram:
+      return "histogram";
+   case CpuKernel::Gemm:
+      return "gemm";
+   case CpuKernel::Stencil5:
+      return "stencil5";
+   case CpuKernel::Stencil9:
+      return "stencil9";
+   case CpuKernel::SpmvCsr:
+      return "spmv_csr";
+   case CpuKernel::SpmvCsrVector:
+      return "spmv_csr_vector";
+   default:
+      return "unknown";
+   }
+}
+
+/**
+ * @brief Le riduzioni aggregano il vettore a in pochi valori invece di produrre n risultati (b non
+ * viene usato). Il risultato va all'inizio di c:
+ * - reduce_sum: somma a 64 bit in c[0..1];
+ * - reduce_min, reduce_max: c[0];
+ * - histogram: HISTOGRAM_BINS contatori in c[0..HISTOGRAM_BINS), il bin di un valore è il suo
+ *   byte basso.
+ */
+constexpr size_t HISTOGRAM_BINS = 256;
+
+inline bool is_reduction(CpuKernel kernel) {
+   return kernel == CpuKernel::ReduceSum || kernel == CpuKernel::ReduceMin ||
+          kernel == CpuKernel::ReduceMax || kernel == CpuKernel::Histogram;
+}
+
+// Elementi di c scritti da un task di n elementi.
+inline size_t result_elems(CpuKernel kernel, size_t n) {
+   switch (kernel) {
+   case CpuKernel::ReduceSum:
+      return sizeof(long long) / sizeof(int);
+   case CpuKernel::ReduceMin:
+   case CpuKernel::ReduceMax:
+      return 1;
+   case CpuKernel::Histogram:
+      return HISTOGRAM_BINS;
+   default:
+      return n;
+   }
+}
+
+// Punti degli stencil 2D (0 per gli altri kernel), vedi CpuStencil.hpp.
+inline size_t stencil_points(CpuKernel kernel) {
+   return kernel == CpuKernel::Stencil5 ? 5 : kernel == CpuKernel::Stencil9 ? 9 : 0;
+}
+
+// Moltiplicazione matrice sparsa - vettore (CSR): le due varianti differiscono solo sulla GPU
+// (una riga per work-item o per work-group), sulla CPU il calcolo è lo stesso (CpuSpmv.hpp).
+inline bool is_spmv(CpuKernel kernel) {
+   return kernel == CpuKernel::SpmvCsr || kernel == CpuKernel::SpmvCsrVector;
+}
+
+// Vettori di input letti dal kernel: le riduzioni leggono solo a.
+inline size_t input_vectors(CpuKernel kernel) { return is_reduction(kernel) ? 1 : 2; }
+
+/**
+ * @brief Costo di un elemento per il modello roofline: byte letti e scritti in memoria e
+ * operazioni aritmetiche (intere o in virgola mobile, seno e coseno contano come una
+ * operazione). Il risultato delle riduzioni è trascurabile. Matrici, griglie e matrici sparse
+ * dipendono dal descrittore del task (MatrixDesc::flops(), CsrDesc::flops(), ...): qui costano 0.
+ */
+struct KernelCost {
+   double bytes{0}; // Byte per elemento
+   double ops{0};   // Operazioni per elemento
+};
+
+inline KernelCost kernel_cost(CpuKernel kernel) {
+   const double io = 3 * sizeof(int); // a e b letti, c scritto
+   switch (kernel) {
+   case CpuKernel::VecAdd:
+      return {io, 1};
+   case CpuKernel::PolynomialOp:
+      return {io, 12}; // 5 potenze, 4 coefficienti, 3 somme
+   case CpuKernel::HeavyCompute:
+      return {io, 6.0 * HEAVY_ITERS}; // Per iterazione: 2 argomenti, sin, cos, prodotto, somma
+   case CpuKernel::HeavyComputeFast:
+      return {io, 14.0 * HEAVY_ITERS}; // Per iterazione: rotazioni (8 x, 4 +), prodotto, somma
+   case CpuKernel::DeepPipeline:
+      return {io, 9};
+   case CpuKernel::ReduceSum:
+   case CpuKernel::ReduceMin:
+   case CpuKernel::ReduceMax:
+      return {sizeof(int), 1};
+   case CpuKernel::Histogram:
+      return {sizeof(int), 2}; // Bin e incremento
+   default:
+      return {};
+   }
+}
+
+// Risultato (parziale o totale) di una riduzione.
+struct ReduceResult {
+   long long sum = 0;
+   int min = INT_MAX;
+   int max = INT_MIN;
+   std::array<int, HISTOGRAM_BINS> histogram{};
+};
+
+/**
+ * @brief Accumula in r gli elementi a[begin, end). Come in run_cpu_kernel() lo switch è fuori dal
+ * ciclo e l'accumulatore è una variabile locale, così i cicli restano vettorizzabili.
+ */
+inline void reduce_range(CpuKernel kernel, const int *a, size_t begin, size_t end,
+                         ReduceResult &r) {
+   switch (kernel) {
+   case CpuKernel::ReduceSum: {
+      long long sum = 0;
+      for (size_t i = begin; i < end; ++i)
+         sum += a[i];
+      r.sum += sum;
+      break;
+   }
+   case CpuKernel::ReduceMin: {
+      int min = r.min;
+      for (size_t i = begin; i < end; ++i)
+         min = a[i] < min ? a[i] : min;
+      r.min = min;
+      break;
+   }
+   case CpuKernel::ReduceMax: {
+      int max = r.max;
+      for (size_t i = begin; i < end; ++i)
+         max = a[i] > max ? a[i] : max;
+      r.max = max;
+      break;
+   }
+   case CpuKernel::Histogram:
+      for (size_t i = begin; i < end; ++i)
+         r.histogram[static_cast<unsigned int>(a[i]) & (HISTOGRAM_BINS - 1)]++;
+      break;
+   default:
+      break;
+   }
+}
+
+// Combina due risultati parziali della stessa riduzione.
+inline void merge_reduce(CpuKernel kernel, ReduceResult &into, const ReduceResult &from) {
+   into.sum += from.sum;
+   into.min = from.min < into.min ? from.min : into.min;
+   into.max = from.max > into.max ? from.max : into.max;
+   if (kernel == CpuKernel::Histogram)
+      for (size_t k = 0; k < HISTOGRAM_BINS; ++k)
+         into.histogram[k] += from.histogram[k];
+}
+
+// Scrive il risultato all'inizio di c, nel formato descritto sopra.
+inline void store_reduce(CpuKernel kernel, const ReduceResult &r, int *c) {
+   switch (kernel) {
+   case CpuKernel::ReduceSum:
+      std::memcpy(c, &r.sum, sizeof(r.sum));
+      break;
+   case CpuKernel::ReduceMin:
+      c[0] = r.min;
+      break;
+   case CpuKernel::ReduceMax:
+      c[0] = r.max;
+      break;
+   case CpuKernel::Histogram:
+      std::memcpy(c, r.histogram.data(), sizeof(int) * HISTOGRAM_BINS);
+      break;
+   default:
+      break;
+   }
+}
+
+/**
+ * @brief Calcola c[i] per ogni i in [begin, end) con il kernel indicato. Lo switch è fuori dal
+ * ciclo, così ogni ramo resta un loop semplice e vettorizzabile.
+ */
+inline void run_cpu_kernel(CpuKernel kernel, const int *a, const int *b, int *c, size_t begin,
+                           size_t end) {
+   switch (kernel) {
+   case CpuKernel::VecAdd:
+      for (size_t i = begin; i < end; ++i)
+         c[i] = a[i] + b[i];
+      break;
+
+   case CpuKernel::PolynomialOp:
+      for (size_t i = begin; i < end; ++i) {
+         long long val_a = a[i];
+         long long val_b = b[i];
+
+         long long a2 = val_a * val_a;
+         long long a3 = a2 * val_a;
+         long long b2 = val_b * val_b;
+         long long b4 = b2 * b2;
+         long long b5 = b4 * val_b;
+
+         c[i] = (int)((2 * a2) + (3 * a3) - (4 * b2) + (5 * b5));
+      }
+      break;
+
+   case CpuKernel::HeavyCompute:
+      for (size_t i = begin; i < end; ++i) {
+         double val_a = (double)a[i];
+         double val_b = (double)b[i];
+         double result = 0.0;
+
+         for (int j = 0; j < HEAVY_ITERS; ++j)
+            result += std::sin(val_a + j) * std::cos(val_b - j);
+
+         c[i] = (int)result;
+      }
+      break;
+
+   // Variante a precisione ridotta con la ricorrenza di seno e coseno (CpuHeavyFast.hpp).
+   case CpuKernel::HeavyComputeFast:
+      heavy_compute_fast_range(a, b, c, begin, end);
+      break;
+
+   case CpuKernel::DeepPipeline:
+      for (size_t i = begin; i < end; ++i) {
+         long long val_a = a[i];
+         long long val_b = b[i];
+
+         long long result_s1 = (val_a * 3) - val_b;
+         long long result_s2 = result_s1 * (result_s1 + 5);
+         long long abs_val_a = (val_a < 0) ? -val_a : val_a;
+         long long result_s3 = result_s2 / (abs_val_a + 1);
+
+         c[i] = (int)(result_s3 + (val_b * 7));
+      }
+      break;
+
+   // Una riduzione scrive il risultato dell'intervallo all'inizio di c: [begin, end) deve essere
+   // l'intero task (per dividerlo fra più thread vedi run_cpu_kernel_parallel()).
+   case CpuKernel::ReduceSum:
+   case CpuKernel::ReduceMin:
+   case CpuKernel::ReduceMax:
+   case CpuKernel::Histogram: {
+      ReduceResult r;
+      reduce_range(kernel, a, begin, end, r);
+      store_reduce(kernel, r, c);
+      break;
+   }
+
+   // Matrici, griglie e matrici sparse richiedono il descrittore del task: vedi CpuGemm.hpp,
+   // CpuStencil.hpp e CpuSpmv.hpp.
+   case CpuKernel::Gemm:
+   case CpuKernel::Stencil5:
+   case CpuKernel::Stencil9:
+   case CpuKernel::SpmvCsr:
+   case CpuKernel::SpmvCsrVector:
+   case CpuKernel::Unknown:
+      break;
+   }
+}
+
+/**
+ * @brief Esegue un task di n elementi su tutti i core con il ParallelFor di FastFlow. I kernel
+ * elemento per elemento dividono l'intervallo fra i worker; per le riduzioni ogni worker riduce
+ * il proprio intervallo in un risultato locale, e i risultati locali (uno per worker) vengono
+ * combinati prima di scrivere c.
+ */
+template <typename ParallelForT>
+void run_cpu_kernel_parallel(ParallelForT &pf, CpuKernel kernel, const int *a, const int *b,
+                             int *c, size_t n) {
+   if (!is_reduction(kernel)) {
+      pf.parallel_for_idx(0, n, 1, 0, [&](const long begin, const long end, const int) {
+         run_cpu_kernel(kernel, a, b, c, begin, end);
+      });
+      return;
+   }
+
+   ReduceResult total;
+   std::mutex total_mutex;
+   pf.parallel_for_idx(0, n, 1, 0, [&](const long begin, const long end, const int) {
+      ReduceResult partial;
+      reduce_range(kernel, a, begin, end, partial);
+      std::lock_guard<std::mutex> lock(total_mutex);
+      merge_reduce(kernel, total, partial);
+   });
+   store_reduce(kernel, total, c);
+}
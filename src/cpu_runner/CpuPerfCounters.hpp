@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Contatori hardware (perf_event_open) dei runner CPU.
+ *
+ * Per ogni thread del processo viene aperto un gruppo di contatori (cicli, istruzioni, miss
+ * della LLC, branch mispredetti, miss del dTLB) letto con una sola read(): i valori dei gruppi
+ * vengono sommati, quindi i conteggi sono aggregati su tutti i worker. I thread vengono cercati
+ * in /proc/self/task all'apertura, per cui il runner deve prima avviare i propri worker (un ciclo
+ * parallelo vuoto). Si contano solo gli eventi in user space (exclude_kernel), permessi con
+ * perf_event_paranoid <= 2.
+ *
+ * Se il processore ha meno contatori degli eventi richiesti, il kernel li alterna nel tempo
+ * (multiplexing): i valori vengono scalati con time_enabled / time_running. Gli eventi che il
+ * processore non supporta vengono saltati; senza cicli (es. VM senza PMU virtuale) i contatori
+ * restano disattivati.
+ */
+enum PerfEvent {
+   PerfCycles,
+   PerfInstructions,
+   PerfLlcMisses,
+   PerfBranchMisses,
+   PerfDtlbMisses,
+   NUM_PERF_EVENTS
+};
+
+// Valori (scalati) degli eventi; available indica gli eventi aperti su almeno un thread.
+struct PerfSample {
+   double values[NUM_PERF_EVENTS]{};
+   bool available[NUM_PERF_EVENTS]{};
+
+   PerfSample operator-(const PerfSample &o) const {
+      PerfSample d = *this;
+      for (int e = 0; e < NUM_PERF_EVENTS; ++e)
+         d.values[e] -= o.values[e];
+      return d;
+   }
+   PerfSample &operator+=(const PerfSample &o) {
+      for (int e = 0; e < NUM_PERF_EVENTS; ++e) {
+         values[e] += o.values[e];
+         available[e] = available[e] || o.available[e];
+      }
+      return *this;
+   }
+   // Eventi ogni mille istruzioni (MPKI per i miss), 0 se non disponibili.
+   double per_kilo_instr(PerfEvent e) const {
+      return available[e] && values[PerfInstructions] > 0
+                ? 1000.0 * values[e] / values[PerfInstructions]
+                : 0;
+   }
+   double ipc() const {
+      return values[PerfCycles] > 0 ? values[PerfInstructions] / values[PerfCycles] : 0;
+   }
+};
+
+class PerfCounters {
+ public:
+   PerfCounters() = default;
+   PerfCounters(const PerfCounters &) = delete;
+   PerfCounters &operator=(const PerfCounters &) = delete;
+   ~PerfCounters() { close(); }
+
+   /**
+    * @brief Apre un gruppo di contatori per ogni thread del processo. Restituisce false (con un
+    * avviso) se non è stato possibile aprirne nessuno.
+    */
+   bool open(const char *tag) {
+#ifdef __linux__
+      DIR *dir = opendir("/proc/self/task");
+      if (!dir) {
+         std::cerr << "[WARNING] " << tag << " Perf counters: cannot list /proc/self/task.\n";
+         return false;
+      }
+      int error = 0;
+      while (dirent *entry = readdir(dir)) {
+         if (entry->d_name[0] == '.')
+            continue;
+         Group g;
+         if (openGroup(static_cast<pid_t>(std::stol(entry->d_name)), g, error))
+            groups_.push_back(g);
+      }
+      closedir(dir);
+      if (groups_.empty()) {
+         std::cerr << "[WARNING] " << tag << " Perf counters unavailable (perf_event_open: "
+                   << std::strerror(error)
+                   << "). Check /proc/sys/kernel/perf_event_paranoid and the PMU of the "
+                      "machine.\n";
+         return false;
+      }
+      std::cout << tag << " Perf counters on " << groups_.size() << " threads.\n";
+      return true;
+#else
+      std::cerr << "[WARNING] " << tag << " Perf counters are only supported on Linux.\n";
+      return false;
+#endif
+   }
+
+   // Somma dei contatori di tutti i thread dall'apertura.
+   PerfSample read() const {
+      PerfSample s;
+#ifdef __linux__
+      for (const Group &g : groups_) {
+         // Formato di PERF_FORMAT_GROUP: nr, time_enabled, time_running, valori.
+         uint64_t buf[3 + NUM_PERF_EVENTS];
+         if (::read(g.fds[0], buf, sizeof(buf)) < ssize_t(3 * sizeof(uint64_t)))
+            continue;
+         const double scale = buf[2] > 0 ? double(buf[1]) / double(buf[2]) : 0.0;
+         for (uint64_t k = 0; k < buf[0] && k < g.events.size(); ++k) {
+            s.values[g.events[k]] += double(buf[3 + k]) * scale;
+            s.available[g.events[k]] = true;
+         }
+      }
+#endif
+      return s;
+   }
+
+   void close() {
+#ifdef __linux__
+      for (Group &g : groups_)
+         for (int fd : g.fds)
+            ::close(fd);
+#endif
+      groups_.clear();
+   }
+
+ private:
+   // Descrittori dei contatori di un thread (il primo è il leader) e loro eventi, in ordine.
+   struct Group {
+      std::vector<int> fds;
+      std::vector<PerfEvent> events;
+   };
+   std::vector<Group> groups_;
+
+#ifdef __linux__
+   static bool openGroup(pid_t tid, Group &g, int &error) {
+      static const struct {
+         PerfEvent event;
+         uint32_t type;
+         uint64_t config;
+      } EVENTS[NUM_PERF_EVENTS] = {
+         {PerfCycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+         {PerfInstructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+         {PerfLlcMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+         {PerfBranchMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+         {PerfDtlbMisses, PERF_TYPE_HW_CACHE,
+          PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+      };
+      for (const auto &ev : EVENTS) {
+         perf_event_attr attr;
+         std::memset(&attr, 0, sizeof(attr));
+         attr.size = sizeof(attr);
+         attr.type = ev.type;
+         attr.config = ev.config;
+         attr.exclude_kernel = 1;
+         attr.exclude_hv = 1;
+         attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                            PERF_FORMAT_TOTAL_TIME_RUNNING;
+         const int leader = g.fds.empty() ? -1 : g.fds[0];
+         const int fd =
+            static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, leader, 0));
+         if (fd < 0) {
+            error = errno;
+            if (leader < 0)
+               return false; // Senza cicli il gruppo non serve
+            continue;
+         }
+         g.fds.push_back(fd);
+         g.events.push_back(ev.event);
+      }
+      return true;
+   }
+#endif
+};
+
+// IPC e miss ogni mille istruzioni (MPKI) di s, "n/a" per gli eventi non disponibili.
+inline std::string perf_derived(const PerfSample &s) {
+   std::ostringstream os;
+   os << std::fixed << std::setprecision(2) << "IPC " << s.ipc();
+   const std::pair<const char *, PerfEvent> rates[] = {
+      {"LLC", PerfLlcMisses}, {"branch", PerfBranchMisses}, {"dTLB", PerfDtlbMisses}};
+   for (const auto &r : rates) {
+      os << ", " << r.first << " MPKI ";
+      if (s.available[r.second])
+         os << s.per_kilo_instr(r.second);
+      else
+         os << "n/a";
+   }
+   return os.str();
+}
+
+// Stampa le metriche derivate di un task, preceduto da tag (es. "[CPU OpenMP - PERF]").
+inline void print_perf_task(const char *tag, size_t task_num, const PerfSample &d) {
+   std::cerr << tag << " Task " << task_num << ": " << perf_derived(d) << "\n";
+}
+
+// Stampa i contatori di tasks task: totale, media per task e metriche derivate.
+inline void print_perf_summary(const char *tag, const PerfSample &total, size_t tasks) {
+   static const char *NAMES[NUM_PERF_EVENTS] = {"cycles", "instructions", "LLC misses",
+                                                "branch misses", "dTLB misses"};
+   if (tasks == 0)
+      return;
+   std::cout << "\n" << tag << " Hardware counters (all threads, user space):\n"
+             << std::fixed << std::setprecision(0);
+   for (int e = 0; e < NUM_PERF_EVENTS; ++e) {
+      std::cout << "  " << std::left << std::setw(14) << NAMES[e] << std::right;
+      if (total.available[e])
+         std::cout << std::setw(18) << total.values[e] << " total, " << std::setw(16)
+                   << total.values[e] / double(tasks) << " per task\n";
+      else
+         std::cout << std::setw(18) << "n/a" << "\n";
+   }
+   std::cout << "  " << perf_derived(total) << "\n";
+   std::cout.unsetf(std::ios::fixed);
+   std::cout << std::setprecision(6);
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "../common/CsrDesc.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Moltiplicazione matrice sparsa - vettore (CSR, vedi CsrDesc) sulla CPU e generatore delle
+ * matrici di prova.
+ *
+ * Gli accessi a x seguono col_idx, quindi sono irregolari e poco prevedibili per la cache. Per
+ * bilanciare il carico i thread non si dividono le righe in parti uguali, ma in parti con lo
+ * stesso numero di elementi non nulli (ricerca binaria su row_ptr): con righe di lunghezza molto
+ * diversa le parti a righe uguali possono differire di ordini di grandezza. Le parti sono
+ * SPMV_PARTS_PER_WORKER per worker, assegnate dinamicamente. Una riga non viene mai divisa.
+ */
+constexpr size_t SPMV_PARTS_PER_WORKER = 4;
+
+// Calcola y[r] per le righe [row_begin, row_end).
+inline void spmv_rows(const CsrDesc &d, const float *x, float *y, size_t row_begin,
+                      size_t row_end) {
+   for (size_t r = row_begin; r < row_end; ++r) {
+      float sum = 0.0f;
+      for (int j = d.row_ptr[r]; j < d.row_ptr[r + 1]; ++j)
+         sum += d.values[j] * x[d.col_idx[j]];
+      y[r] = sum;
+   }
+}
+
+// Numero di parti in cui dividere le righe: SPMV_PARTS_PER_WORKER per core, al più una per riga.
+inline size_t spmv_parts(const CsrDesc &d) {
+   size_t workers = std::max(1u, std::thread::hardware_concurrency());
+   return std::max<size_t>(1, std::min(d.rows, SPMV_PARTS_PER_WORKER * workers));
+}
+
+// Confini (parts + 1 righe) di parts parti con circa nnz / parts elementi non nulli ciascuna.
+inline std::vector<size_t> spmv_partition(const CsrDesc &d, size_t parts) {
+   std::vector<size_t> bounds(parts + 1, d.rows);
+   bounds[0] = 0;
+   for (size_t p = 1; p < parts; ++p) {
+      const long long target = static_cast<long long>(d.nnz * p / parts);
+      bounds[p] = std::lower_bound(d.row_ptr, d.row_ptr + d.rows + 1, target) - d.row_ptr;
+   }
+   return bounds;
+}
+
+// Confini di parts parti con lo stesso numero di righe (per confronto).
+inline std::vector<size_t> spmv_row_partition(const CsrDesc &d, size_t parts) {
+   std::vector<size_t> bounds(parts + 1);
+   for (size_t p = 0; p <= parts; ++p)
+      bounds[p] = d.rows * p / parts;
+   return bounds;
+}
+
+// Squilibrio di una divisione: elementi non nulli della parte più carica rispetto alla media.
+inline double spmv_imbalance(const CsrDesc &d, const std::vector<size_t> &bounds) {
+   const size_t parts = bounds.size() - 1;
+   if (d.nnz == 0)
+      return 1.0;
+   int max_nnz = 0;
+   for (size_t p = 0; p < parts; ++p)
+      max_nnz = std::max(max_nnz, d.row_ptr[bounds[p + 1]] - d.row_ptr[bounds[p]]);
+   return max_nnz / (double(d.nnz) / double(parts));
+}
+
+/**
+ * @brief Esegue y = A x con il ParallelFor di FastFlow: le parti di bounds vengono assegnate
+ * dinamicamente ai worker.
+ */
+template <typename ParallelForT>
+void spmv_parallel(ParallelForT &pf, const CsrDesc &d, const std::vector<size_t> &bounds,
+                   const float *x, float *y) {
+   const long parts = static_cast<long>(bounds.size() - 1);
+   pf.parallel_for_idx(0, parts, 1, 1, [&](const long begin, const long end, const int) {
+      spmv_rows(d, x, y, bounds[begin], bounds[end]);
+   });
+}
+
+// --- Matrici di prova ---
+
+// Matrice CSR con i propri array; desc() la descrive per i task.
+struct CsrMatrix {
+   size_t rows{0}, cols{0};
+   std::vector<int> row_ptr, col_idx;
+   std::vector<float> values;
+
+   CsrDesc desc() const {
+      return {rows, cols, col_idx.size(), row_ptr.data(), col_idx.data(), values.data()};
+   }
+};
+
+/**
+ * @brief Genera una matrice rows x cols con in media avg_nnz elementi non nulli per riga. La
+ * lunghezza della riga r è proporzionale a (r + 1)^-skew: skew = 0 dà righe uguali, valori più
+ * alti concentrano gli elementi nelle prime righe (legge di potenza, come i gradi di un grafo
+ * reale). Le colonne di ogni riga sono casuali e ordinate, i valori fra -1 e 1; il seme fisso
+ * rende le esecuzioni confrontabili.
+ */
+inline CsrMatrix spmv_generate(size_t rows, size_t cols, size_t avg_nnz, double skew) {
+   CsrMatrix m;
+   m.rows = rows;
+   m.cols = cols;
+   m.row_ptr.assign(rows + 1, 0);
+
+   double weight_sum = 0;
+   for (size_t r = 0; r < rows; ++r)
+      weight_sum += std::pow(double(r + 1), -skew);
+   const double scale = double(avg_nnz) * double(rows) / weight_sum;
+
+   std::mt19937 rng(42);
+   std::uniform_int_distribution<int> col_dist(0, static_cast<int>(cols) - 1);
+   std::uniform_real_distribution<float> value_dist(-1.0f, 1.0f);
+   std::vector<int> row_cols;
+   for (size_t r = 0; r < rows; ++r) {
+      size_t len = static_cast<size_t>(std::llround(std::pow(double(r + 1), -skew) * scale));
+      len = std::min(cols, std::max<size_t>(1, len));
+
+      row_cols.clear();
+      if (2 * len >= cols) {
+         for (size_t c = 0; c < cols; ++c)
+            if (c * len / cols != (c + 1) * len / cols)
+               row_cols.push_back(static_cast<int>(c));
+      } else {
+         for (size_t k = 0; k < len; ++k)
+            row_cols.push_back(col_dist(rng));
+         std::sort(row_cols.begin(), row_cols.end());
+         row_cols.erase(std::unique(row_cols.begin(), row_cols.end()), row_cols.end());
+      }
+      for (int c : row_cols) {
+         m.col_idx.push_back(c);
+         m.values.push_back(value_dist(rng));
+      }
+      m.row_ptr[r + 1] = static_cast<int>(m.col_idx.size());
+   }
+   return m;
+}
+
+// Valori di prova di x.
+inline void spmv_fill_x(size_t cols, float *x) {
+   for (size_t i = 0; i < cols; ++i)
+      x[i] = float(int(i % 7) - 3) / 3.0f;
+}
+
+// Elementi non nulli della riga più lunga.
+inline size_t spmv_max_row_nnz(const CsrDesc &d) {
+   int max_len = 0;
+   for (size_t r = 0; r < d.rows; ++r)
+      max_len = std::max(max_len, d.row_ptr[r + 1] - d.row_ptr[r]);
+   return static_cast<size_t>(max_len);
+}
+
+/**
+ * @brief Ricalcola y in double e restituisce il massimo errore relativo (rispetto alla somma dei
+ * valori assoluti dei termini di ogni riga).
+ */
+inline double spmv_max_error(const CsrDesc &d, const float *x, const float *y) {
+   double max_error = 0;
+   for (size_t r = 0; r < d.rows; ++r) {
+      double exact = 0, magnitude = 0;
+      for (int j = d.row_ptr[r]; j < d.row_ptr[r + 1]; ++j) {
+         double term = double(d.values[j]) * double(x[d.col_idx[j]]);
+         exact += term;
+         magnitude += std::fabs(term);
+      }
+      if (magnitude > 0)
+         max_error = std::max(max_error, std::fabs(exact - y[r]) / magnitude);
+   }
+   return max_error;
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "../common/GridDesc.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Stencil 2D sulla CPU (float, griglie per righe, vedi GridDesc).
+ *
+ * - 5 punti: media della cella e dei 4 vicini (Jacobi);
+ * - 9 punti: filtro gaussiano 3 x 3 (pesi 4 al centro, 2 ai lati, 1 agli angoli, diviso 16).
+ *
+ * Le celle sul bordo del buffer vengono copiate. Ogni riga dipende solo da 3 righe dell'input,
+ * quindi le righe di uno sweep si calcolano in parallelo; il ciclo sulle colonne scorre 3 righe
+ * con passo 1 ed è vettorizzato (SIMD). Gli sweep si alternano fra due buffer (ping-pong) e
+ * l'ultimo scrive direttamente le righe del tile nell'output.
+ */
+constexpr size_t STENCIL_ROWS_PER_CHUNK = 16; // Righe per unità di lavoro dei thread
+constexpr size_t STENCIL_CHECK_MAX_SIDE = 2048; // Lato massimo delle griglie verificate
+
+#ifdef _OPENMP
+#define STENCIL_SIMD _Pragma("omp simd")
+#else
+#define STENCIL_SIMD
+#endif
+
+/**
+ * @brief Calcola le righe [row_begin, row_end) del buffer del task da in a out (stessa
+ * disposizione, g.rows x g.cols).
+ */
+inline void stencil_rows(const GridDesc &g, const float *in, float *out, size_t row_begin,
+                         size_t row_end) {
+   const size_t cols = g.cols;
+   for (size_t r = row_begin; r < row_end; ++r) {
+      const float *mid = in + r * cols;
+      float *o = out + r * cols;
+      if (r == 0 || r + 1 == g.rows || cols < 3) {
+         std::copy(mid, mid + cols, o);
+         continue;
+      }
+      const float *up = mid - cols, *down = mid + cols;
+      o[0] = mid[0];
+      o[cols - 1] = mid[cols - 1];
+      if (g.points == 5) {
+         STENCIL_SIMD
+         for (size_t j = 1; j < cols - 1; ++j)
+            o[j] = 0.2f * (mid[j] + mid[j - 1] + mid[j + 1] + up[j] + down[j]);
+      } else {
+         STENCIL_SIMD
+         for (size_t j = 1; j < cols - 1; ++j)
+            o[j] = 0.0625f * (4.0f * mid[j] +
+                              2.0f * (up[j] + down[j] + mid[j - 1] + mid[j + 1]) +
+                              (up[j - 1] + up[j + 1] + down[j - 1] + down[j + 1]));
+      }
+   }
+}
+
+/**
+ * @brief Esegue gli sweep del task. in è il buffer del task (alone compreso), out punta alla
+ * riga del buffer corrispondente alla prima riga di in (le righe del tile sono da halo_top in
+ * poi), scratch contiene 2 buffer del task. sweep(src, dst, row_begin, row_end) calcola un
+ * intervallo di righe, anche in parallelo.
+ */
+template <typename SweepFn>
+void stencil_steps(const GridDesc &g, const float *in, float *out, float *scratch,
+                   SweepFn &&sweep) {
+   const float *src = in;
+   for (size_t s = 0; s < g.steps; ++s) {
+      const bool last = s + 1 == g.steps;
+      float *dst = last ? out : scratch + (s % 2) * g.in_elems();
+      sweep(src, dst, last ? g.halo_top : 0, last ? g.rows - g.halo_bottom : g.rows);
+      src = dst;
+   }
+}
+
+/**
+ * @brief Esegue il task con il ParallelFor di FastFlow: ogni sweep distribuisce le righe ai worker
+ * a blocchi di STENCIL_ROWS_PER_CHUNK.
+ */
+template <typename ParallelForT>
+void stencil_parallel(ParallelForT &pf, const GridDesc &g, const float *in, float *out,
+                      float *scratch) {
+   auto sweep = [&](const float *src, float *dst, size_t first, size_t last) {
+      const long chunks =
+         static_cast<long>((last - first + STENCIL_ROWS_PER_CHUNK - 1) / STENCIL_ROWS_PER_CHUNK);
+      pf.parallel_for_idx(0, chunks, 1, 1, [&](const long begin, const long end, const int) {
+         size_t row_begin = first + static_cast<size_t>(begin) * STENCIL_ROWS_PER_CHUNK;
+         size_t row_end = first + static_cast<size_t>(end) * STENCIL_ROWS_PER_CHUNK;
+         stencil_rows(g, src, dst, row_begin, std::min(last, row_end));
+      });
+   };
+   stencil_steps(g, in, out, scratch, sweep);
+}
+
+// --- Griglia e tile dei task ---
+
+// Tile di tile_rows righe di una griglia side x side (tile_rows = 0: un tile solo).
+inline size_t stencil_tiles(size_t side, size_t tile_rows) {
+   return tile_rows == 0 || tile_rows >= side ? 1 : (side + tile_rows - 1) / tile_rows;
+}
+
+/**
+ * @brief Descrittore del tile t: tile_rows righe (l'ultimo può averne meno) con steps righe di
+ * alone sopra e sotto, limitate alla griglia.
+ */
+inline GridDesc stencil_tile(size_t side, size_t tile_rows, size_t steps, size_t points,
+                             size_t t) {
+   const size_t rows_per_tile = tile_rows == 0 ? side : std::min(tile_rows, side);
+   GridDesc g;
+   g.cols = side;
+   g.steps = steps;
+   g.points = points;
+   g.first_row = std::min(side, (t % stencil_tiles(side, tile_rows)) * rows_per_tile);
+   const size_t last_row = std::min(side, g.first_row + rows_per_tile);
+   g.halo_top = std::min(steps, g.first_row);
+   g.halo_bottom = std::min(steps, side - last_row);
+   g.rows = last_row - g.first_row + g.halo_top + g.halo_bottom;
+   return g;
+}
+
+// Celle del buffer più grande fra quelli dei tile (alone compreso).
+inline size_t stencil_max_tile_elems(size_t side, size_t tile_rows, size_t steps) {
+   size_t max_elems = 0;
+   for (size_t t = 0; t < stencil_tiles(side, tile_rows); ++t)
+      max_elems = std::max(max_elems, stencil_tile(side, tile_rows, steps, 5, t).in_elems());
+   return max_elems;
+}
+
+// Righe della griglia di output scritte dai primi num_tasks task (dall'inizio della griglia).
+inline size_t stencil_covered_rows(size_t side, size_t tile_rows, size_t num_tasks) {
+   if (num_tasks == 0)
+      return 0;
+   if (num_tasks >= stencil_tiles(side, tile_rows))
+      return side;
+   GridDesc last = stencil_tile(side, tile_rows, 1, 5, num_tasks - 1);
+   return last.first_row + last.out_rows();
+}
+
+// Celle utili aggiornate da num_tasks task, che scorrono i tile in ordine.
+inline double stencil_total_cells(size_t side, size_t tile_rows, size_t steps,
+                                  size_t num_tasks) {
+   double cells = 0;
+   for (size_t t = 0; t < num_tasks; ++t)
+      cells += stencil_tile(side, tile_rows, steps, 5, t).cell_updates();
+   return cells;
+}
+
+// Valori iniziali della griglia: piccoli e variabili.
+inline void stencil_fill_grid(size_t side, float *grid) {
+   for (size_t i = 0; i < side; ++i)
+      for (size_t j = 0; j < side; ++j)
+         grid[i * side + j] = float((i * 7 + j * 13) % 101) / 100.0f;
+}
+
+/**
+ * @brief Ricalcola sequenzialmente steps sweep dell'intera griglia e restituisce la massima
+ * differenza assoluta con le prime check_rows righe di out (i valori sono fra 0 e 1). Il
+ * riferimento occupa 3 copie della griglia: oltre STENCIL_CHECK_MAX_SIDE restituisce -1.
+ */
+inline double stencil_max_error(size_t side, size_t steps, size_t points, const float *in,
+                                const float *out, size_t check_rows) {
+   if (side > STENCIL_CHECK_MAX_SIDE)
+      return -1;
+   GridDesc whole{side, side, 0, 0, steps, points, 0};
+   std::vector<float> ref(whole.in_elems()), scratch(2 * whole.in_elems());
+   stencil_steps(whole, in, ref.data(), scratch.data(),
+                 [&](const float *src, float *dst, size_t row_begin, size_t row_end) {
+                    stencil_rows(whole, src, dst, row_begin, row_end);
+                 });
+   double max_error = 0;
+   for (size_t i = 0; i < std::min(check_rows, side) * side; ++i)
+      max_error = std::max(max_error, double(std::fabs(ref[i] - out[i])));
+   return max_error;
+}
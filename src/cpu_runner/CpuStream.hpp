@@ -0,0 +1,167 @@
+#pragma once
+
+#include "../common/HostBuffer.hpp"
+#include "CpuKernels.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Store non temporali (streaming) per i kernel limitati dalla banda di memoria e picco di
+ * banda STREAM della macchina.
+ *
+ * Con gli store normali ogni linea di c viene prima letta in cache (read-for-ownership) e poi
+ * riscritta: vecAdd muove 16 byte per elemento invece di 12. Gli store non temporali scrivono la
+ * linea intera direttamente in memoria, senza leggerla e senza sporcare la cache, ma se c entra
+ * nell'ultimo livello di cache (LLC) il task successivo la rilegge dalla DRAM: in modalità "auto"
+ * si usano quindi solo quando l'output supera la LLC.
+ *
+ * I kernel calcolano a blocchi di NT_BLOCK_ELEMS elementi in un buffer in L1 (lo stesso codice di
+ * run_cpu_kernel()), copiato poi in c con _mm_stream_si128 da un indirizzo allineato a 16 byte.
+ * Senza SSE2 (es. ARM) gli store restano normali.
+ */
+constexpr size_t NT_BLOCK_ELEMS = 1024;                // Elementi per blocco (4 KB in L1)
+constexpr size_t LLC_DEFAULT_BYTES = size_t(32) << 20; // LLC se il sistema non la riporta
+constexpr size_t STREAM_MAX_ELEMS = size_t(32) << 20;  // Elementi massimi per array STREAM
+constexpr int STREAM_REPEATS = 5;                      // Misure STREAM (vale la migliore)
+
+// Store dei kernel limitati dalla banda: "auto" (non temporali se l'output supera la LLC), "on",
+// "off".
+enum class NtStores { Auto, On, Off, Unknown };
+
+inline NtStores parse_nt_stores(const std::string &name) {
+   if (name == "auto")
+      return NtStores::Auto;
+   if (name == "on")
+      return NtStores::On;
+   if (name == "off")
+      return NtStores::Off;
+   return NtStores::Unknown;
+}
+
+// Dimensione dell'ultimo livello di cache (L3, altrimenti L2) in byte.
+inline size_t llc_bytes() {
+#if defined(_SC_LEVEL3_CACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+   long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+   if (l3 > 0)
+      return static_cast<size_t>(l3);
+   long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+   if (l2 > 0)
+      return static_cast<size_t>(l2);
+#endif
+   return LLC_DEFAULT_BYTES;
+}
+
+// Kernel con pochi calcoli per elemento: il tempo è quello del trasferimento di a, b e c.
+inline bool is_memory_bound(CpuKernel kernel) {
+   return kernel == CpuKernel::VecAdd || kernel == CpuKernel::PolynomialOp;
+}
+
+// Byte letti e scritti per elemento dai kernel limitati dalla banda (a, b e c).
+inline double stream_bytes_per_elem() { return 3.0 * sizeof(int); }
+
+// Vero se il kernel deve scrivere c (n elementi) con store non temporali.
+inline bool use_nt_stores(CpuKernel kernel, size_t n, NtStores mode) {
+   if (!is_memory_bound(kernel) || mode == NtStores::Off)
+      return false;
+   return mode == NtStores::On || n * sizeof(int) > llc_bytes();
+}
+
+// Stampa il tipo di store scelto per c (n elementi), preceduto da tag (es. "[CPU OpenMP]").
+inline void print_store_mode(const char *tag, bool nt, size_t n) {
+   std::cout << tag << " Stores: " << (nt ? "non-temporal" : "regular") << " (output "
+             << double(n * sizeof(int)) / double(1 << 20) << " MB, LLC "
+             << double(llc_bytes()) / double(1 << 20) << " MB)\n";
+}
+
+/**
+ * @brief Come run_cpu_kernel(), ma scrive c[begin, end) con store non temporali. Il chiamante
+ * che divide c fra più thread chiama la funzione su ogni parte: lo sfence finale rende visibili
+ * gli store del thread prima della fine del ciclo parallelo.
+ */
+inline void run_cpu_kernel_nt(CpuKernel kernel, const int *a, const int *b, int *c,
+                              size_t begin, size_t end) {
+#ifdef __SSE2__
+   size_t i = begin;
+   // Testa scalare fino al primo elemento di c allineato a 16 byte.
+   while (i < end && reinterpret_cast<uintptr_t>(c + i) % 16 != 0)
+      ++i;
+   run_cpu_kernel(kernel, a, b, c, begin, i);
+
+   alignas(64) int block[NT_BLOCK_ELEMS];
+   while (end - i >= 4) {
+      const size_t len = std::min(NT_BLOCK_ELEMS, (end - i) / 4 * 4);
+      run_cpu_kernel(kernel, a + i, b + i, block, 0, len);
+      for (size_t k = 0; k < len; k += 4)
+         _mm_stream_si128(reinterpret_cast<__m128i *>(c + i + k),
+                          _mm_load_si128(reinterpret_cast<const __m128i *>(block + k)));
+      i += len;
+   }
+
+   // Coda scalare (meno di 4 elementi).
+   run_cpu_kernel(kernel, a, b, c, i, end);
+   _mm_sfence();
+#else
+   run_cpu_kernel(kernel, a, b, c, begin, end);
+#endif
+}
+
+// --- Picco di banda STREAM ---
+
+// Banda migliore del kernel STREAM "add" (c = a + b) con store normali e non temporali.
+struct StreamPeak {
+   size_t elems{0};       // Elementi per array
+   double regular_gbs{0}; // GB/s con store normali
+   double nt_gbs{0};      // GB/s con store non temporali
+};
+
+// Elementi per array di STREAM: almeno 4 volte la LLC (e almeno n), al più STREAM_MAX_ELEMS.
+inline size_t stream_elems(size_t n) {
+   return std::min(STREAM_MAX_ELEMS, std::max(n, 4 * llc_bytes() / sizeof(int)));
+}
+
+/**
+ * @brief Misura il picco di banda con il kernel "add" di STREAM su array di stream_elems(n) int
+ * (12 byte per elemento, la read-for-ownership degli store normali non conta). for_range(len,
+ * body) divide [0, len) fra i thread del runner e chiama body(begin, end) su ogni parte: la
+ * misura usa gli stessi thread, la stessa divisione e le stesse pagine dei task.
+ */
+template <typename ForRangeFn> StreamPeak stream_peak(size_t n, ForRangeFn &&for_range) {
+   StreamPeak peak;
+   peak.elems = stream_elems(n);
+   HostVector<int> a(peak.elems), b(peak.elems), c(peak.elems);
+   for_range(peak.elems, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+         a[i] = int(i);
+         b[i] = int(2 * i);
+         c[i] = 0;
+      }
+   });
+
+   const double bytes = stream_bytes_per_elem() * double(peak.elems);
+   for (const bool nt : {false, true}) {
+      long long best_ns = 0;
+      for (int rep = 0; rep < STREAM_REPEATS; ++rep) {
+         auto t0 = std::chrono::steady_clock::now();
+         for_range(peak.elems, [&](size_t begin, size_t end) {
+            if (nt)
+               run_cpu_kernel_nt(CpuKernel::VecAdd, a.data(), b.data(), c.data(), begin, end);
+            else
+               run_cpu_kernel(CpuKernel::VecAdd, a.data(), b.data(), c.data(), begin, end);
+         });
+         auto t1 = std::chrono::steady_clock::now();
+         long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+         if (best_ns == 0 || ns < best_ns)
+            best_ns = ns;
+      }
+      (nt ? peak.nt_gbs : peak.regular_gbs) = bytes / double(std::max(1LL, best_ns));
+   }
+   return peak;
+}
@@ -0,0 +1,50 @@
+#include "CpuWorkerNode.hpp"
+#include <iostream>
+
+CpuWorkerNode::CpuWorkerNode(const std::string &kernel_name, StatsCollector *stats)
+    : kernel_name_(kernel_name), kernel_(parse_cpu_kernel(kernel_name)), stats_(stats) {}
+
+int CpuWorkerNode::svc_init() {
+   if (kernel_ == CpuKernel::Unknown) {
+      std::cerr << "[ERROR] CpuWorkerNode: Unknown kernel name '" << kernel_name_ << "'.\n";
+      return -1;
+   }
+   return 0;
+}
+
+/**
+ * @brief Esegue il task su tutti i core e aggiorna statistiche e stato di carico.
+ */
+void *CpuWorkerNode::svc(void *t) {
+   auto *task = static_cast<Task *>(t);
+   auto start_time = std::chrono::steady_clock::now();
+
+   run_cpu_kernel_parallel(pf_, kernel_, task->a, task->b, task->c, task->n);
+
+   auto end_time = std::chrono::steady_clock::now();
+   long long task_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+
+   // Il worker esegue un task alla volta: il tempo di servizio è quello di calcolo.
+   if (load_board_)
+      load_board_->record_completion(worker_index_, task_ns);
+
+   if (!first_task_)
+      stats_->inter_completion_time_ns +=
+         std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - last_completion_time_)
+            .count();
+   first_task_ = false;
+   last_completion_time_ = end_time;
+   stats_->record_completion_time(end_time);
+
+   stats_->computed_ns += task_ns;
+   stats_->total_InNode_time_ns += task_ns;
+   stats_->tasks_processed++;
+
+   if (task->on_complete)
+      task->on_complete(task, task->on_complete_ctx);
+   release_task(task);
+   return FF_GO_ON;
+}
+
+void CpuWorkerNode::svc_end() { stats_->count_promise.set_value(stats_->tasks_processed.load()); }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../../include/ff_includes.hpp"
+#include "../common/LoadBoard.hpp"
+#include "../common/StatsCollector.hpp"
+#include "../common/TaskPool.hpp"
+#include "CpuKernels.hpp"
+#include <chrono>
+#include <string>
+
+/**
+ * @brief Worker della farm che esegue i Task sulla CPU, su tutti i core con il parallel_for di
+ * FastFlow. Si comporta come un ff_node_acc_t verso lo scheduler (LoadBoard) e verso le
+ * statistiche (StatsCollector), così la modalità 'auto' può mettere CPU e acceleratori nella
+ * stessa farm.
+ */
+class CpuWorkerNode : public ff_node {
+ public:
+   CpuWorkerNode(const std::string &kernel_name, StatsCollector *stats);
+
+   // Collega il nodo, come worker 'index', allo stato di carico letto dallo scheduler.
+   void set_load_board(LoadBoard *board, size_t index) {
+      load_board_ = board;
+      worker_index_ = index;
+   }
+
+ protected:
+   int svc_init() override;
+   void *svc(void *t) override;
+   void svc_end() override;
+
+ private:
+   std::string kernel_name_;
+   CpuKernel kernel_;
+   StatsCollector *stats_;
+   LoadBoard *load_board_{nullptr};
+   size_t worker_index_{0};
+   ParallelFor pf_;
+
+   std::chrono::steady_clock::time_point last_completion_time_;
+   bool first_task_{true};
+};
@@ -1,34 +1,160 @@
 #include "Cpu_FF_Runner.hpp"
+#include "CpuComputePeak.hpp"
+#include "CpuGemm.hpp"
+#include "CpuKernels.hpp"
+#include "CpuPerfCounters.hpp"
+#include "CpuSpmv.hpp"
+#include "CpuStencil.hpp"
+#include "CpuStream.hpp"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <vector>
 
+/**
+ * @brief Esegue NUM_TASKS moltiplicazioni di matrici quadrate side x side, a blocchi di righe di C
+ * distribuiti fra i worker del parallel_for di FastFlow, e verifica un campione del risultato.
+ */
+static long long executeCpu_FF_Gemm(size_t side, size_t NUM_TASKS, size_t &tasks_completed) {
+   MatrixDesc d = MatrixDesc::square(side);
+   std::vector<float> a(d.a_elems()), b(d.b_elems()), c(d.c_elems());
+   gemm_fill_inputs(d, a.data(), b.data());
+
+   ParallelFor pf;
+   tasks_completed = 0;
+   auto t0 = std::chrono::steady_clock::now();
+
+   for (size_t task_num = 0; task_num < NUM_TASKS; ++task_num) {
+      std::cerr << "[CPU Parallel FF - START] Processing task " << task_num + 1
+                << " with M=N=K=" << side << "...\n";
+      gemm_parallel(pf, d, a.data(), b.data(), c.data());
+      std::cerr << "[CPU Parallel FF - END] Task " << task_num + 1 << " finished.\n";
+      tasks_completed++;
+   }
+
+   auto t1 = std::chrono::steady_clock::now();
+   std::cout << "[CPU Parallel FF] GEMM max relative error (sampled): "
+             << gemm_max_error(d, a.data(), b.data(), c.data()) << "\n";
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
+/**
+ * @brief Esegue NUM_TASKS task stencil su una griglia side x side: il task k calcola steps sweep
+ * del tile k (modulo il numero di tile), con le righe di ogni sweep distribuite fra i worker del
+ * parallel_for di FastFlow, e verifica le righe scritte.
+ */
+long long executeCpu_FF_Stencil(size_t side, size_t NUM_TASKS, const std::string &kernel_name,
+                                size_t steps, size_t tile_rows, size_t &tasks_completed) {
+   const size_t points = stencil_points(parse_cpu_kernel(kernel_name));
+   std::vector<float> in(side * side), out(side * side);
+   std::vector<float> scratch(2 * stencil_max_tile_elems(side, tile_rows, steps));
+   stencil_fill_grid(side, in.data());
+
+   ParallelFor pf;
+   tasks_completed = 0;
+   auto t0 = std::chrono::steady_clock::now();
+
+   for (size_t task_num = 0; task_num < NUM_TASKS; ++task_num) {
+      GridDesc g = stencil_tile(side, tile_rows, steps, points, task_num);
+      std::cerr << "[CPU Parallel FF - START] Processing task " << task_num + 1 << " with "
+                << g.out_rows() << " x " << side << " cells, " << steps << " sweeps...\n";
+      const size_t base = (g.first_row - g.halo_top) * side;
+      stencil_parallel(pf, g, in.data() + base, out.data() + base, scratch.data());
+      std::cerr << "[CPU Parallel FF - END] Task " << task_num + 1 << " finished.\n";
+      tasks_completed++;
+   }
+
+   auto t1 = std::chrono::steady_clock::now();
+   double error = stencil_max_error(side, steps, points, in.data(), out.data(),
+                                    stencil_covered_rows(side, tile_rows, tasks_completed));
+   if (error >= 0)
+      std::cout << "[CPU Parallel FF] Stencil max error vs sequential sweeps: " << error << "\n";
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
+/**
+ * @brief Esegue NUM_TASKS SpMV con la matrice CSR d: le parti con lo stesso numero di
+ * elementi non nulli vengono assegnate dinamicamente ai worker del parallel_for di FastFlow.
+ * Stampa lo squilibrio della divisione rispetto a quella per righe e verifica y.
+ */
+long long executeCpu_FF_Spmv(const CsrDesc &d, size_t NUM_TASKS, size_t &tasks_completed) {
+   std::vector<float> x(d.cols), y(d.rows);
+   spmv_fill_x(d.cols, x.data());
+
+   const size_t parts = spmv_parts(d);
+   const std::vector<size_t> bounds = spmv_partition(d, parts);
+   std::cout << "[CPU Parallel FF] SpMV matrix: " << d.nnz << " nonzeros, longest row "
+             << spmv_max_row_nnz(d) << ", imbalance over " << parts << " parts "
+             << spmv_imbalance(d, bounds) << " (nnz split) vs "
+             << spmv_imbalance(d, spmv_row_partition(d, parts)) << " (row split)\n";
+
+   ParallelFor pf;
+   tasks_completed = 0;
+   auto t0 = std::chrono::steady_clock::now();
+
+   for (size_t task_num = 0; task_num < NUM_TASKS; ++task_num) {
+      std::cerr << "[CPU Parallel FF - START] Processing task " << task_num + 1 << " with "
+                << d.nnz << " nonzeros...\n";
+      spmv_parallel(pf, d, bounds, x.data(), y.data());
+      std::cerr << "[CPU Parallel FF - END] Task " << task_num + 1 << " finished.\n";
+      tasks_completed++;
+   }
+
+   auto t1 = std::chrono::steady_clock::now();
+   std::cout << "[CPU Parallel FF] SpMV max relative error: "
+             << spmv_max_error(d, x.data(), y.data()) << "\n";
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
 /**
  * @brief Esegue i task di un calcolo specificato da command line in parallelo su tutti i core della
  * CPU utilizzando il parallel_for di FastFlow.
  */
 long long executeCpu_FF_Tasks(size_t N, size_t NUM_TASKS, const std::string &kernel_name,
-                              size_t &tasks_completed) {
+                              size_t &tasks_completed, const std::string &nt_stores,
+                              bool perf_counters) {
 
    // Validazione del kernel.
-   if (kernel_name != "vecAdd" && kernel_name != "polynomial_op" &&
-       kernel_name != "heavy_compute_kernel") {
-      std::cerr
-         << "[ERROR] CPU Parallel FF: Unknown kernel name '" << kernel_name << "'.\n"
-         << "    --> Supported kernels are: 'vecAdd', 'polynomial_op', 'heavy_compute_kernel'.\n";
+   const CpuKernel kernel = parse_cpu_kernel(kernel_name);
+   if (kernel != CpuKernel::VecAdd && kernel != CpuKernel::PolynomialOp &&
+       kernel != CpuKernel::HeavyCompute && kernel != CpuKernel::HeavyComputeFast &&
+       !is_reduction(kernel) && kernel != CpuKernel::Gemm) {
+      std::cerr << "[ERROR] CPU Parallel FF: Unknown kernel name '" << kernel_name << "'.\n"
+                << "    --> Supported kernels are: 'vecAdd', 'polynomial_op', "
+                   "'heavy_compute_kernel', 'heavy_compute_fast', 'reduce_sum', 'reduce_min', "
+                   "'reduce_max', 'histogram', 'gemm'.\n";
       exit(EXIT_FAILURE);
    }
 
    std::cout << "[CPU Parallel FF] Running tasks in PARALLEL on all CPU cores with FastFlow.\n\n";
 
-   // Inizializzazione dei dati.
-   std::vector<int> a(N), b(N), c(N);
+   // Moltiplicazione di matrici: N è il lato delle matrici quadrate.
+   if (kernel == CpuKernel::Gemm)
+      return executeCpu_FF_Gemm(N, NUM_TASKS, tasks_completed);
+
+   // Inizializzazione dei dati (su huge page, vedi HostBuffer.hpp).
+   HostVector<int> a(N), b(N), c(std::max(N, result_elems(kernel, N)));
    for (size_t i = 0; i < N; ++i) {
       a[i] = int(i);
       b[i] = int(2 * i);
    }
 
+   // Kernel limitati dalla banda: store non temporali se c non entra nella LLC (o se richiesti).
+   const bool nt = use_nt_stores(kernel, N, parse_nt_stores(nt_stores));
+   if (is_memory_bound(kernel))
+      print_store_mode("[CPU Parallel FF]", nt, N);
+
    ParallelFor pf;
+
+   // Contatori hardware (vedi CpuPerfCounters.hpp), aperti dopo l'avvio dei worker.
+   PerfCounters perf;
+   PerfSample perf_total;
+   bool use_perf = false;
+   if (perf_counters) {
+      pf.parallel_for_idx(0, N, 1, 0, [](const long, const long, const int) {});
+      use_perf = perf.open("[CPU Parallel FF]");
+   }
+
    tasks_completed = 0;
    auto t0 = std::chrono::steady_clock::now();
 
@@ -36,47 +162,40 @@ long long executeCpu_FF_Tasks(size_t N, size_t NUM_TASKS, const std::string &ker
    for (size_t task_num = 0; task_num < NUM_TASKS; ++task_num) {
       std::cerr << "[CPU Parallel FF - START] Processing task " << task_num + 1 << " with N=" << N
                 << "...\n";
-
-      // Parallelizza il calcolo usando dell'operazione polinomiale usando ff_parallel_for
-      // che gestisce il parallelismo a dati su CPU.
-      pf.parallel_for(0, N, 1, 0, [&](const long i) {
-         if (kernel_name == "vecAdd") {
-            // --------------------------------------------------------------
-            // SOMMA VETTORIALE
-            // --------------------------------------------------------------
-            c[i] = a[i] + b[i];
-
-         } else if (kernel_name == "polynomial_op") {
-            // --------------------------------------------------------------
-            // OPERAZIONE POLINOMIALE (Calcolo 2a² + 3a³ - 4b² + 5b⁵)
-            // --------------------------------------------------------------
-            long long val_a = a[i];
-            long long val_b = b[i];
-
-            long long a2 = val_a * val_a;
-            long long a3 = a2 * val_a;
-            long long b2 = val_b * val_b;
-            long long b4 = b2 * b2;
-            long long b5 = b4 * val_b;
-
-            long long result = (2 * a2) + (3 * a3) - (4 * b2) + (5 * b5);
-            c[i] = (int)result;
-
-         } else if (kernel_name == "heavy_compute_kernel") {
-            // --------------------------------------------------------------
-            // COMPUTAZIONE MOLTO PESANTE (for interno e fz. trigonometriche)
-            // --------------------------------------------------------------
-            double val_a = (double)a[i];
-            double val_b = (double)b[i];
-            double result = 0.0;
-
-            for (int j = 0; j < 200; ++j)
-               result += std::sin(val_a + j) * std::cos(val_b - j);
-
-            c[i] = (int)result;
-         }
-      });
-
+      const PerfSample perf_before = use_perf ? perf.read() : PerfSample();
+
+      if (is_reduction(kernel)) {
+         // Riduzione: ogni worker accumula un risultato locale, i risultati locali vengono
+         // combinati alla fine (vedi CpuKernels.hpp).
+         run_cpu_kernel_parallel(pf, kernel, a.data(), b.data(), c.data(), N);
+      } else if (kernel == CpuKernel::HeavyComputeFast) {
+         // Ricorrenza di seno e coseno: ogni worker elabora blocchi interi, vettorizzati.
+         pf.parallel_for_idx(0, N, 1, HEAVY_FAST_BLOCK,
+                             [&](const long begin, const long end, const int) {
+                                heavy_compute_fast_range(a.data(), b.data(), c.data(), begin,
+                                                         end);
+                             });
+      } else if (is_memory_bound(kernel)) {
+         // Limitati dalla banda: ogni worker una parte contigua di c, con gli store non
+         // temporali scritta senza leggerla.
+         pf.parallel_for_idx(0, N, 1, 0, [&](const long begin, const long end, const int) {
+            if (nt)
+               run_cpu_kernel_nt(kernel, a.data(), b.data(), c.data(), begin, end);
+            else
+               run_cpu_kernel(kernel, a.data(), b.data(), c.data(), begin, end);
+         });
+      } else {
+         // Limitati dal calcolo (heavy_compute_kernel): ogni worker una parte contigua.
+         pf.parallel_for_idx(0, N, 1, 0, [&](const long begin, const long end, const int) {
+            run_cpu_kernel(kernel, a.data(), b.data(), c.data(), begin, end);
+         });
+      }
+
+      if (use_perf) {
+         const PerfSample perf_task = perf.read() - perf_before;
+         perf_total += perf_task;
+         print_perf_task("[CPU Parallel FF - PERF]", task_num + 1, perf_task);
+      }
       std::cerr << "[CPU Parallel FF - END] Task " << task_num + 1 << " finished.\n";
 
       tasks_completed++;
@@ -84,5 +203,39 @@ long long executeCpu_FF_Tasks(size_t N, size_t NUM_TASKS, const std::string &ker
 
    // Ritorna il tempo totale di esecuzione dal primo all'ultimo task.
    auto t1 = std::chrono::steady_clock::now();
+   if (use_perf)
+      print_perf_summary("[CPU Parallel FF]", perf_total, tasks_completed);
+   if (kernel == CpuKernel::HeavyComputeFast && tasks_completed > 0)
+      print_heavy_fast_check("[CPU Parallel FF]",
+                             heavy_fast_check(a.data(), b.data(), c.data(), N));
    return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Divide [0, len) fra i worker di pf per le misure dei picchi (stream_peak(), fma_peak()).
+ */
+static auto ffForRange(ParallelFor &pf) {
+   return [&pf](size_t len, auto &&body) {
+      pf.parallel_for_idx(0, static_cast<long>(len), 1, 0,
+                          [&](const long begin, const long end, const int) { body(begin, end); });
+   };
+}
+
+/**
+ * @brief Misura il picco di banda STREAM (vedi stream_peak()) con i worker del parallel_for di
+ * FastFlow.
+ */
+void measureCpu_FF_StreamPeak(size_t N, double &peak_gbs, double &peak_nt_gbs) {
+   ParallelFor pf;
+   StreamPeak peak = stream_peak(N, ffForRange(pf));
+   peak_gbs = peak.regular_gbs;
+   peak_nt_gbs = peak.nt_gbs;
+}
+
+/**
+ * @brief Misura il picco di calcolo (vedi fma_peak()) con i worker del parallel_for di FastFlow.
+ */
+double measureCpu_FF_FmaPeak() {
+   ParallelFor pf;
+   return fma_peak(ffForRange(pf));
+}
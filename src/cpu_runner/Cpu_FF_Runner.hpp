@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../../include/ff_includes.hpp"
+#include "../common/CsrDesc.hpp"
 #include <cstddef>
+#include <string>
 
 /**
  * @brief Esegue i task di un'operazione polinomiale complessa (2a² + 3a³ - 4b² + 5b⁵) in parallelo
@@ -12,7 +14,38 @@
  * @param kernel_name Il nome del kernel da eseguire ("vecAdd", "polynomial_op" o
  * "heavy_compute_kernel").
  * @param tasks_completed Il numero dei task effettivamente completati.
+ * @param nt_stores Store dei kernel limitati dalla banda ("auto", "on", "off", vedi
+ * CpuStream.hpp).
+ * @param perf_counters Misura con i contatori hardware i task (vedi CpuPerfCounters.hpp) e ne
+ * stampa IPC e miss.
  * @return elapsed_ns (tempo totale per completare tutti i task in nanosecondi).
  */
 long long executeCpu_FF_Tasks(size_t N, size_t NUM_TASKS, const std::string &kernel_name,
-                              size_t &tasks_completed);
\ No newline at end of file
+                              size_t &tasks_completed, const std::string &nt_stores = "auto",
+                              bool perf_counters = false);
+/**
+ * @brief Esegue NUM_TASKS task stencil ("stencil5" o "stencil9") su una griglia float side x side
+ * con il parallel_for di FastFlow. Ogni task calcola steps sweep di un tile di tile_rows righe
+ * (0 = l'intera griglia), in ordine ciclico sui tile.
+ * @return elapsed_ns (tempo totale per completare tutti i task in nanosecondi).
+ */
+long long executeCpu_FF_Stencil(size_t side, size_t NUM_TASKS, const std::string &kernel_name,
+                                size_t steps, size_t tile_rows, size_t &tasks_completed);
+/**
+ * @brief Esegue NUM_TASKS moltiplicazioni y = A x con la matrice sparsa d (CSR, vedi
+ * spmv_generate()) con il parallel_for di FastFlow, con le righe divise fra i thread per numero di
+ * elementi non nulli.
+ * @return elapsed_ns (tempo totale per completare tutti i task in nanosecondi).
+ */
+long long executeCpu_FF_Spmv(const CsrDesc &d, size_t NUM_TASKS, size_t &tasks_completed);
+/**
+ * @brief Misura il picco di banda della memoria (kernel "add" di STREAM su array di almeno N
+ * elementi) con il parallel_for di FastFlow, con store normali (peak_gbs) e non temporali
+ * (peak_nt_gbs), in GB/s.
+ */
+void measureCpu_FF_StreamPeak(size_t N, double &peak_gbs, double &peak_nt_gbs);
+/**
+ * @brief Misura il picco di calcolo della CPU (FMA in float su tutti i core, vedi
+ * CpuComputePeak.hpp) con il parallel_for di FastFlow, in GFLOP/s.
+ */
+double measureCpu_FF_FmaPeak();
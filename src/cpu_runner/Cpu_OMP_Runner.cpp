@@ -1,35 +1,206 @@
 #include "Cpu_OMP_Runner.hpp"
+#include "CpuComputePeak.hpp"
+#include "CpuGemm.hpp"
+#include "CpuKernels.hpp"
+#include "CpuPerfCounters.hpp"
+#include "CpuSpmv.hpp"
+#include "CpuStencil.hpp"
+#include "CpuStream.hpp"
+#include <algorithm>
 #include <chrono>
-#include <cmath>
+#include <functional>
 #include <iostream>
 #include <omp.h>
 #include <vector>
 
+/**
+ * @brief Riduce a[0, N) in c con le clausole reduction di OpenMP: ogni thread accumula una copia
+ * privata dell'accumulatore, combinate da OpenMP alla fine del ciclo.
+ */
+static void reduceOmp(CpuKernel kernel, const int *a, size_t N, int *c) {
+   ReduceResult r;
+   const long n = static_cast<long>(N);
+   if (kernel == CpuKernel::ReduceSum) {
+      long long sum = 0;
+#pragma omp parallel for reduction(+ : sum)
+      for (long i = 0; i < n; ++i)
+         sum += a[i];
+      r.sum = sum;
+   } else if (kernel == CpuKernel::ReduceMin) {
+      int min = INT_MAX;
+#pragma omp parallel for reduction(min : min)
+      for (long i = 0; i < n; ++i)
+         min = a[i] < min ? a[i] : min;
+      r.min = min;
+   } else if (kernel == CpuKernel::ReduceMax) {
+      int max = INT_MIN;
+#pragma omp parallel for reduction(max : max)
+      for (long i = 0; i < n; ++i)
+         max = a[i] > max ? a[i] : max;
+      r.max = max;
+   } else if (kernel == CpuKernel::Histogram) {
+      int *hist = r.histogram.data();
+#pragma omp parallel for reduction(+ : hist[:HISTOGRAM_BINS])
+      for (long i = 0; i < n; ++i)
+         hist[static_cast<unsigned int>(a[i]) & (HISTOGRAM_BINS - 1)]++;
+   }
+   store_reduce(kernel, r, c);
+}
+
+/**
+ * @brief Esegue NUM_TASKS moltiplicazioni di matrici quadrate side x side, a blocchi di righe di C
+ * distribuiti dinamicamente fra i thread OpenMP, e verifica un campione del risultato.
+ */
+static long long executeCpu_OMP_Gemm(size_t side, size_t NUM_TASKS, size_t &tasks_completed) {
+   MatrixDesc d = MatrixDesc::square(side);
+   std::vector<float> a(d.a_elems()), b(d.b_elems()), c(d.c_elems());
+   gemm_fill_inputs(d, a.data(), b.data());
+
+   const long chunks = static_cast<long>((d.m + GEMM_ROWS_PER_CHUNK - 1) / GEMM_ROWS_PER_CHUNK);
+   tasks_completed = 0;
+   auto t0 = std::chrono::steady_clock::now();
+
+   for (size_t task_num = 0; task_num < NUM_TASKS; ++task_num) {
+      std::cerr << "[CPU OpenMP - START] Processing task " << task_num + 1
+                << " with M=N=K=" << side << "...\n";
+#pragma omp parallel for schedule(dynamic)
+      for (long chunk = 0; chunk < chunks; ++chunk)
+         gemm_rows(d, a.data(), b.data(), c.data(), chunk * GEMM_ROWS_PER_CHUNK,
+                   std::min(d.m, (chunk + 1) * GEMM_ROWS_PER_CHUNK));
+      std::cerr << "[CPU OpenMP - END] Task " << task_num + 1 << " finished.\n";
+      tasks_completed++;
+   }
+
+   auto t1 = std::chrono::steady_clock::now();
+   std::cout << "[CPU OpenMP] GEMM max relative error (sampled): "
+             << gemm_max_error(d, a.data(), b.data(), c.data()) << "\n";
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
+/**
+ * @brief Esegue NUM_TASKS task stencil su una griglia side x side: il task k calcola steps sweep
+ * del tile k (modulo il numero di tile), con le righe di ogni sweep divise fra i thread OpenMP, e
+ * verifica le righe scritte.
+ */
+long long executeCpu_OMP_Stencil(size_t side, size_t NUM_TASKS, const std::string &kernel_name,
+                                 size_t steps, size_t tile_rows, size_t &tasks_completed) {
+   const size_t points = stencil_points(parse_cpu_kernel(kernel_name));
+   std::vector<float> in(side * side), out(side * side);
+   std::vector<float> scratch(2 * stencil_max_tile_elems(side, tile_rows, steps));
+   stencil_fill_grid(side, in.data());
+
+   tasks_completed = 0;
+   auto t0 = std::chrono::steady_clock::now();
+
+   for (size_t task_num = 0; task_num < NUM_TASKS; ++task_num) {
+      GridDesc g = stencil_tile(side, tile_rows, steps, points, task_num);
+      std::cerr << "[CPU OpenMP - START] Processing task " << task_num + 1 << " with "
+                << g.out_rows() << " x " << side << " cells, " << steps << " sweeps...\n";
+      const size_t base = (g.first_row - g.halo_top) * side;
+      stencil_steps(g, in.data() + base, out.data() + base, scratch.data(),
+                    [&](const float *src, float *dst, size_t first, size_t last) {
+                       const long row_begin = static_cast<long>(first);
+                       const long row_end = static_cast<long>(last);
+#pragma omp parallel for schedule(static)
+                       for (long r = row_begin; r < row_end; ++r)
+                          stencil_rows(g, src, dst, r, r + 1);
+                    });
+      std::cerr << "[CPU OpenMP - END] Task " << task_num + 1 << " finished.\n";
+      tasks_completed++;
+   }
+
+   auto t1 = std::chrono::steady_clock::now();
+   double error = stencil_max_error(side, steps, points, in.data(), out.data(),
+                                    stencil_covered_rows(side, tile_rows, tasks_completed));
+   if (error >= 0)
+      std::cout << "[CPU OpenMP] Stencil max error vs sequential sweeps: " << error << "\n";
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
+/**
+ * @brief Esegue NUM_TASKS SpMV con la matrice CSR d: le parti con lo stesso numero di
+ * elementi non nulli vengono assegnate dinamicamente ai thread OpenMP. Stampa lo squilibrio della
+ * divisione rispetto a quella per righe e verifica y.
+ */
+long long executeCpu_OMP_Spmv(const CsrDesc &d, size_t NUM_TASKS, size_t &tasks_completed) {
+   std::vector<float> x(d.cols), y(d.rows);
+   spmv_fill_x(d.cols, x.data());
+
+   const size_t parts = spmv_parts(d);
+   const std::vector<size_t> bounds = spmv_partition(d, parts);
+   std::cout << "[CPU OpenMP] SpMV matrix: " << d.nnz << " nonzeros, longest row "
+             << spmv_max_row_nnz(d) << ", imbalance over " << parts << " parts "
+             << spmv_imbalance(d, bounds) << " (nnz split) vs "
+             << spmv_imbalance(d, spmv_row_partition(d, parts)) << " (row split)\n";
+
+   tasks_completed = 0;
+   auto t0 = std::chrono::steady_clock::now();
+
+   for (size_t task_num = 0; task_num < NUM_TASKS; ++task_num) {
+      std::cerr << "[CPU OpenMP - START] Processing task " << task_num + 1 << " with " << d.nnz
+                << " nonzeros...\n";
+#pragma omp parallel for schedule(dynamic)
+      for (long p = 0; p < static_cast<long>(parts); ++p)
+         spmv_rows(d, x.data(), y.data(), bounds[p], bounds[p + 1]);
+      std::cerr << "[CPU OpenMP - END] Task " << task_num + 1 << " finished.\n";
+      tasks_completed++;
+   }
+
+   auto t1 = std::chrono::steady_clock::now();
+   std::cout << "[CPU OpenMP] SpMV max relative error: "
+             << spmv_max_error(d, x.data(), y.data()) << "\n";
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
 /**
  * @brief Esegue i task di un calcolo specificato da command line in parallelo su tutti i core della
  * CPU utilizzando le direttive OpenMP.
  */
 long long executeCpu_OMP_Tasks(size_t N, size_t NUM_TASKS, const std::string &kernel_name,
-                               size_t &tasks_completed) {
+                               size_t &tasks_completed, const std::string &nt_stores,
+                               bool perf_counters) {
 
    // Validazione del kernel.
-   if (kernel_name != "vecAdd" && kernel_name != "polynomial_op" &&
-       kernel_name != "heavy_compute_kernel") {
-      std::cerr
-         << "[ERROR] CPU Parallel OMP: Unknown kernel name '" << kernel_name << "'.\n"
-         << "    --> Supported kernels are: 'vecAdd', 'polynomial_op', 'heavy_compute_kernel'.\n";
+   const CpuKernel kernel = parse_cpu_kernel(kernel_name);
+   if (kernel != CpuKernel::VecAdd && kernel != CpuKernel::PolynomialOp &&
+       kernel != CpuKernel::HeavyCompute && kernel != CpuKernel::HeavyComputeFast &&
+       !is_reduction(kernel) && kernel != CpuKernel::Gemm) {
+      std::cerr << "[ERROR] CPU Parallel OMP: Unknown kernel name '" << kernel_name << "'.\n"
+                << "    --> Supported kernels are: 'vecAdd', 'polynomial_op', "
+                   "'heavy_compute_kernel', 'heavy_compute_fast', 'reduce_sum', 'reduce_min', "
+                   "'reduce_max', 'histogram', 'gemm'.\n";
       exit(EXIT_FAILURE);
    }
 
    std::cout << "[CPU OpenMP] Running tasks in PARALLEL on all CPU cores with OpenMP.\n\n";
 
-   // Inizializzazione dei dati.
-   std::vector<int> a(N), b(N), c(N);
+   // Moltiplicazione di matrici: N è il lato delle matrici quadrate.
+   if (kernel == CpuKernel::Gemm)
+      return executeCpu_OMP_Gemm(N, NUM_TASKS, tasks_completed);
+
+   // Inizializzazione dei dati (su huge page, vedi HostBuffer.hpp).
+   HostVector<int> a(N), b(N), c(std::max(N, result_elems(kernel, N)));
    for (size_t i = 0; i < N; ++i) {
       a[i] = int(i);
       b[i] = int(2 * i);
    }
 
+   // Kernel limitati dalla banda: store non temporali se c non entra nella LLC (o se richiesti).
+   const bool nt = use_nt_stores(kernel, N, parse_nt_stores(nt_stores));
+   if (is_memory_bound(kernel))
+      print_store_mode("[CPU OpenMP]", nt, N);
+
+   // Contatori hardware (vedi CpuPerfCounters.hpp), aperti dopo l'avvio dei thread.
+   PerfCounters perf;
+   PerfSample perf_total;
+   bool use_perf = false;
+   if (perf_counters) {
+#pragma omp parallel
+      {
+      }
+      use_perf = perf.open("[CPU OpenMP]");
+   }
+
    tasks_completed = 0;
    auto t0 = std::chrono::steady_clock::now();
 
@@ -37,52 +208,79 @@ long long executeCpu_OMP_Tasks(size_t N, size_t NUM_TASKS, const std::string &ke
    for (size_t task_num = 0; task_num < NUM_TASKS; ++task_num) {
       std::cerr << "[CPU OpenMP - START] Processing task " << task_num + 1 << " with N=" << N
                 << "...\n";
+      const PerfSample perf_before = use_perf ? perf.read() : PerfSample();
 
-// Dice al compilatore di parallelizzare il ciclo for distribuendolo tra i thread disponibili.
-#pragma omp parallel for
-      for (long i = 0; i < N; ++i) {
-         if (kernel_name == "vecAdd") {
-            // --------------------------------------------------------------
-            // SOMMA VETTORIALE
-            // --------------------------------------------------------------
-            c[i] = a[i] + b[i];
-
-         } else if (kernel_name == "polynomial_op") {
-            // --------------------------------------------------------------
-            // OPERAZIONE POLINOMIALE (Calcolo 2a² + 3a³ - 4b² + 5b⁵)
-            // --------------------------------------------------------------
-            long long val_a = a[i];
-            long long val_b = b[i];
-
-            long long a2 = val_a * val_a;
-            long long a3 = a2 * val_a;
-            long long b2 = val_b * val_b;
-            long long b4 = b2 * b2;
-            long long b5 = b4 * val_b;
-
-            long long result = (2 * a2) + (3 * a3) - (4 * b2) + (5 * b5);
-            c[i] = (int)result;
-
-         } else if (kernel_name == "heavy_compute_kernel") {
-            // --------------------------------------------------------------
-            // COMPUTAZIONE MOLTO PESANTE (for interno e fz. trigonometriche)
-            // --------------------------------------------------------------
-            double val_a = (double)a[i];
-            double val_b = (double)b[i];
-            double result = 0.0;
-
-            for (int j = 0; j < 200; ++j)
-               result += std::sin(val_a + j) * std::cos(val_b - j);
-
-            c[i] = (int)result;
+      if (is_reduction(kernel)) {
+         reduceOmp(kernel, a.data(), N, c.data());
+      } else if (kernel == CpuKernel::HeavyComputeFast) {
+         // Ricorrenza di seno e coseno: ogni thread elabora blocchi interi, vettorizzati.
+         const long blocks = static_cast<long>((N + HEAVY_FAST_BLOCK - 1) / HEAVY_FAST_BLOCK);
+#pragma omp parallel for schedule(static)
+         for (long blk = 0; blk < blocks; ++blk)
+            heavy_compute_fast_range(a.data(), b.data(), c.data(), blk * HEAVY_FAST_BLOCK,
+                                     std::min(N, (blk + 1) * HEAVY_FAST_BLOCK));
+      } else if (is_memory_bound(kernel)) {
+         // Limitati dalla banda: ogni thread una parte contigua di c, con gli store non temporali
+         // scritta senza leggerla.
+#pragma omp parallel
+         {
+            const size_t threads = omp_get_num_threads(), t = omp_get_thread_num();
+            const size_t begin = N * t / threads, end = N * (t + 1) / threads;
+            if (nt)
+               run_cpu_kernel_nt(kernel, a.data(), b.data(), c.data(), begin, end);
+            else
+               run_cpu_kernel(kernel, a.data(), b.data(), c.data(), begin, end);
+         }
+      } else {
+         // Limitati dal calcolo (heavy_compute_kernel): ogni thread una parte contigua.
+#pragma omp parallel
+         {
+            const size_t threads = omp_get_num_threads(), t = omp_get_thread_num();
+            run_cpu_kernel(kernel, a.data(), b.data(), c.data(), N * t / threads,
+                           N * (t + 1) / threads);
          }
       }
 
+      if (use_perf) {
+         const PerfSample perf_task = perf.read() - perf_before;
+         perf_total += perf_task;
+         print_perf_task("[CPU OpenMP - PERF]", task_num + 1, perf_task);
+      }
       std::cerr << "[CPU OpenMP - END] Task " << task_num + 1 << " finished.\n";
       tasks_completed++;
    }
 
    // Calcola il tempo totale di esecuzione e lo ritorna.
    auto t1 = std::chrono::steady_clock::now();
+   if (use_perf)
+      print_perf_summary("[CPU OpenMP]", perf_total, tasks_completed);
+   if (kernel == CpuKernel::HeavyComputeFast && tasks_completed > 0)
+      print_heavy_fast_check("[CPU OpenMP]", heavy_fast_check(a.data(), b.data(), c.data(), N));
    return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Divide [0, len) fra i thread OpenMP, una parte contigua per thread, per le misure dei
+ * picchi (stream_peak(), fma_peak()).
+ */
+static void ompForRange(size_t len, const std::function<void(size_t, size_t)> &body) {
+#pragma omp parallel
+   {
+      const size_t threads = omp_get_num_threads(), t = omp_get_thread_num();
+      body(len * t / threads, len * (t + 1) / threads);
+   }
+}
+
+/**
+ * @brief Misura il picco di banda STREAM (vedi stream_peak()) con i thread OpenMP.
+ */
+void measureCpu_OMP_StreamPeak(size_t N, double &peak_gbs, double &peak_nt_gbs) {
+   StreamPeak peak = stream_peak(N, ompForRange);
+   peak_gbs = peak.regular_gbs;
+   peak_nt_gbs = peak.nt_gbs;
+}
+
+/**
+ * @brief Misura il picco di calcolo (vedi fma_peak()) con i thread OpenMP.
+ */
+double measureCpu_OMP_FmaPeak() { return fma_peak(ompForRange); }
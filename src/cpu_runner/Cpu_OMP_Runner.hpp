@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../common/CsrDesc.hpp"
 #include <cstddef>
 #include <string>
 
@@ -11,7 +12,38 @@
  * @param kernel_name Il nome del kernel da eseguire ("vecAdd", "polynomial_op" o
  * "heavy_compute_kernel").
  * @param tasks_completed Riferimento per memorizzare il numero di task completati.
+ * @param nt_stores Store dei kernel limitati dalla banda ("auto", "on", "off", vedi
+ * CpuStream.hpp).
+ * @param perf_counters Misura con i contatori hardware i task (vedi CpuPerfCounters.hpp) e ne
+ * stampa IPC e miss.
  * @return long long Il tempo totale trascorso in nanosecondi.
  */
 long long executeCpu_OMP_Tasks(size_t N, size_t NUM_TASKS, const std::string &kernel_name,
-                               size_t &tasks_completed);
\ No newline at end of file
+                               size_t &tasks_completed, const std::string &nt_stores = "auto",
+                               bool perf_counters = false);
+/**
+ * @brief Esegue NUM_TASKS task stencil ("stencil5" o "stencil9") su una griglia float side x side
+ * con le direttive OpenMP. Ogni task calcola steps sweep di un tile di tile_rows righe (0 =
+ * l'intera griglia), in ordine ciclico sui tile.
+ * @return long long Il tempo totale trascorso in nanosecondi.
+ */
+long long executeCpu_OMP_Stencil(size_t side, size_t NUM_TASKS, const std::string &kernel_name,
+                                 size_t steps, size_t tile_rows, size_t &tasks_completed);
+/**
+ * @brief Esegue NUM_TASKS moltiplicazioni y = A x con la matrice sparsa d (CSR, vedi
+ * spmv_generate()) con le direttive OpenMP, con le righe divise fra i thread per numero di
+ * elementi non nulli.
+ * @return long long Il tempo totale trascorso in nanosecondi.
+ */
+long long executeCpu_OMP_Spmv(const CsrDesc &d, size_t NUM_TASKS, size_t &tasks_completed);
+/**
+ * @brief Misura il picco di banda della memoria (kernel "add" di STREAM su array di almeno N
+ * elementi) con i thread OpenMP, con store normali (peak_gbs) e non temporali (peak_nt_gbs), in
+ * GB/s.
+ */
+void measureCpu_OMP_StreamPeak(size_t N, double &peak_gbs, double &peak_nt_gbs);
+/**
+ * @brief Misura il picco di calcolo della CPU (FMA in float su tutti i core, vedi
+ * CpuComputePeak.hpp) con i thread OpenMP, in GFLOP/s.
+ */
+double measureCpu_OMP_FmaPeak();
@@ -0,0 +1,79 @@
+#include "DslBench.hpp"
+#include "../cpu_runner/CpuKernels.hpp"
+#include "DslKernels.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/**
+ * @brief Tempo medio in ns di una passata di run su NUM_TASKS ripetizioni, dopo una di
+ * riscaldamento.
+ */
+template <class F>
+static double time_passes(size_t NUM_TASKS, F &&run) {
+   run();
+   auto t0 = std::chrono::steady_clock::now();
+   for (size_t t = 0; t < NUM_TASKS; ++t)
+      run();
+   auto t1 = std::chrono::steady_clock::now();
+   return double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) /
+          NUM_TASKS;
+}
+
+void runDslBenchmark(size_t N, size_t NUM_TASKS, const std::string &kernel_name) {
+   std::vector<std::string> kernels;
+   if (!kernel_name.empty()) {
+      if (!dsl::has_kernel(kernel_name)) {
+         std::cerr << "[ERROR] DSL: Unknown kernel name '" << kernel_name << "'.\n"
+                   << "    --> Supported kernels are: 'polynomial_op', "
+                      "'deep_pipeline_calculation'.\n";
+         exit(EXIT_FAILURE);
+      }
+      kernels.push_back(kernel_name);
+   } else {
+      kernels = {"polynomial_op", "deep_pipeline_calculation"};
+   }
+
+   // Input piccoli e variabili, come quelli dei task (i polinomi non vanno in overflow).
+   std::vector<int> a(N), b(N), expected(N), got(N);
+   for (size_t i = 0; i < N; ++i) {
+      a[i] = int(i % 201) - 100;
+      b[i] = int((i * 7) % 201) - 100;
+   }
+   std::vector<dsl::value_t> tmp;
+
+   for (const std::string &name : kernels) {
+      CpuKernel hand_written = parse_cpu_kernel(name);
+
+      double hand_ns = time_passes(NUM_TASKS, [&] {
+         run_cpu_kernel(hand_written, a.data(), b.data(), expected.data(), 0, N);
+      });
+      double fused_ns = time_passes(NUM_TASKS, [&] {
+         dsl::run_kernel(name, a.data(), b.data(), got.data(), 0, N);
+      });
+      bool fused_ok = got == expected;
+      double unfused_ns = time_passes(NUM_TASKS, [&] {
+         dsl::run_kernel_unfused(name, a.data(), b.data(), got.data(), 0, N, tmp);
+      });
+      bool unfused_ok = got == expected;
+
+      // Byte letti e scritti dalla versione fusa: a, b e c.
+      double bytes = 3.0 * sizeof(int) * N;
+      auto row = [&](const char *label, double ns, bool ok) {
+         std::cout << "  " << std::left << std::setw(14) << label << std::right << std::fixed
+                   << std::setprecision(3) << std::setw(10) << ns / 1e6 << " ms  "
+                   << std::setw(8) << std::setprecision(2) << bytes / ns << " GB/s  "
+                   << std::setw(6) << hand_ns / ns << "x  " << (ok ? "OK" : "MISMATCH") << "\n";
+      };
+
+      std::cout << "\n[DSL] " << name << " (N=" << N << ", " << NUM_TASKS
+                << " passes, 1 thread):\n";
+      row("hand-written", hand_ns, true);
+      row("dsl fused", fused_ns, fused_ok);
+      row("dsl unfused", unfused_ns, unfused_ok);
+
+      std::cerr << "[DSL] Generated OpenCL source for '" << name << "':\n"
+                << dsl::kernel_source(name) << "\n";
+   }
+}
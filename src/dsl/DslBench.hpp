@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Confronta i kernel della DSL con quelli scritti a mano sulla CPU (un thread): per ogni
+ * kernel misura NUM_TASKS passate su N elementi della versione scritta a mano, di quella della
+ * DSL fusa e di quella senza fusione (una passata per stadio), verifica che i risultati siano
+ * uguali e stampa il sorgente OpenCL generato. Se kernel_name è vuoto confronta tutti i kernel
+ * della DSL.
+ */
+void runDslBenchmark(size_t N, size_t NUM_TASKS, const std::string &kernel_name);
@@ -0,0 +1,39 @@
+#include "DslKernels.hpp"
+
+namespace dsl {
+
+bool has_kernel(const std::string &name) {
+   return name == "polynomial_op" || name == "deep_pipeline_calculation";
+}
+
+std::string kernel_source(const std::string &name) {
+   if (name == "polynomial_op")
+      return opencl_source(name, polynomial_op, "int");
+   if (name == "deep_pipeline_calculation")
+      return opencl_source(name, deep_pipeline_calculation, "long");
+   return "";
+}
+
+bool run_kernel(const std::string &name, const int *a, const int *b, int *c, size_t begin,
+                size_t end) {
+   if (name == "polynomial_op")
+      run_fused(polynomial_op, a, b, c, begin, end);
+   else if (name == "deep_pipeline_calculation")
+      run_fused(deep_pipeline_calculation, a, b, c, begin, end);
+   else
+      return false;
+   return true;
+}
+
+bool run_kernel_unfused(const std::string &name, const int *a, const int *b, int *c,
+                        size_t begin, size_t end, std::vector<value_t> &tmp) {
+   if (name == "polynomial_op")
+      run_unfused(polynomial_op, a, b, c, begin, end, tmp);
+   else if (name == "deep_pipeline_calculation")
+      run_unfused(deep_pipeline_calculation, a, b, c, begin, end, tmp);
+   else
+      return false;
+   return true;
+}
+
+} // namespace dsl
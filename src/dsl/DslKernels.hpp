@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ElementwiseExpr.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Kernel riscritti con la DSL di ElementwiseExpr.hpp. Ogni kernel ha una sola definizione,
+ * da cui vengono il ciclo CPU e il sorgente OpenCL, e dà gli stessi risultati della versione
+ * scritta a mano con lo stesso nome. Le definizioni sono constexpr, così nei cicli CPU le costanti
+ * sono note al compilatore come in quelli scritti a mano.
+ */
+namespace dsl {
+
+// 2a² + 3a³ - 4b² + 5b⁵, raccolto come a²(2 + 3a) + b²(5b³ - 4): con a² e b² fra parentesi
+// il compilatore li calcola una volta sola. Un solo stadio con +, - e *: in OpenCL basta int.
+inline constexpr auto polynomial_op =
+   chain((A * A) * (2 + 3 * A) + (B * B) * (5 * (B * B) * B - 4));
+
+// I 4 stadi del kernel FPGA, fusi in una passata. Lo stadio 3 divide: in OpenCL serve long.
+inline constexpr auto deep_pipeline_calculation = chain(A * 3 - B,        // Stage 1
+                                                        P * (P + 5),      // Stage 2
+                                                        P / (abs(A) + 1), // Stage 3
+                                                        P + B * 7);       // Stage 4
+
+// Nomi dei kernel disponibili nella DSL.
+bool has_kernel(const std::string &name);
+
+// Sorgente OpenCL del kernel (vuoto se non esiste).
+std::string kernel_source(const std::string &name);
+
+// Calcola c[i] per ogni i in [begin, end) in una passata. Ritorna false se il kernel non esiste.
+bool run_kernel(const std::string &name, const int *a, const int *b, int *c, size_t begin,
+                size_t end);
+
+// Come run_kernel(), con una passata sulla memoria per stadio (riferimento senza fusione).
+bool run_kernel_unfused(const std::string &name, const int *a, const int *b, int *c,
+                        size_t begin, size_t end, std::vector<value_t> &tmp);
+
+} // namespace dsl
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief DSL a expression template per le operazioni elemento per elemento sui vettori dei task.
+ *
+ * Un'operazione si scrive una volta sola come espressione C++ sugli input A e B (gli elementi
+ * a[i] e b[i]) e da quella definizione si ottengono sia il ciclo CPU (l'espressione viene
+ * espansa inline dal compilatore, quindi il ciclo resta vettorizzabile) sia il sorgente OpenCL C
+ * del kernel, generato a runtime.
+ *
+ * Una catena (chain) mette in fila più operazioni: ogni stadio vede il risultato dello stadio
+ * precedente come P. La catena viene fusa in un solo kernel, con una sola passata sulla memoria:
+ * i risultati intermedi restano in registro invece di essere scritti e riletti fra uno stadio e
+ * l'altro. Sulla CPU i calcoli intermedi sono a 64 bit, come nei kernel scritti a mano; il
+ * risultato finale viene troncato a int.
+ *
+ *    auto k = dsl::chain(A * 3 - B, P * (P + 5));
+ *    dsl::run_fused(k, a, b, c, 0, n);
+ *    std::string src = dsl::opencl_source("mio_kernel", k, "long");
+ */
+namespace dsl {
+
+using value_t = long long; // Tipo dei calcoli sulla CPU
+
+// Base di tutti i nodi dell'espressione, per limitare gli operatori ai tipi della DSL.
+struct Expr {};
+
+template <class T>
+constexpr bool is_expr_v = std::is_base_of<Expr, std::decay_t<T>>::value;
+
+// --- Foglie ---
+
+// Elemento corrente del primo input (a[i]).
+struct InputA : Expr {
+   value_t eval(value_t a, value_t, value_t) const { return a; }
+   void emit(std::ostream &os, const std::string &) const { os << "va"; }
+};
+
+// Elemento corrente del secondo input (b[i]).
+struct InputB : Expr {
+   value_t eval(value_t, value_t b, value_t) const { return b; }
+   void emit(std::ostream &os, const std::string &) const { os << "vb"; }
+};
+
+// Risultato dello stadio precedente della catena (0 nel primo stadio).
+struct Previous : Expr {
+   value_t eval(value_t, value_t, value_t p) const { return p; }
+   void emit(std::ostream &os, const std::string &prev) const { os << prev; }
+};
+
+struct Const : Expr {
+   value_t value;
+   constexpr explicit Const(value_t v) : value(v) {}
+   value_t eval(value_t, value_t, value_t) const { return value; }
+   void emit(std::ostream &os, const std::string &) const { os << value; }
+};
+
+inline constexpr InputA A{};
+inline constexpr InputB B{};
+inline constexpr Previous P{};
+
+// --- Operatori ---
+
+struct AddOp {
+   static value_t apply(value_t x, value_t y) { return x + y; }
+   static constexpr const char *symbol = " + ";
+};
+struct SubOp {
+   static value_t apply(value_t x, value_t y) { return x - y; }
+   static constexpr const char *symbol = " - ";
+};
+struct MulOp {
+   static value_t apply(value_t x, value_t y) { return x * y; }
+   static constexpr const char *symbol = " * ";
+};
+struct DivOp {
+   static value_t apply(value_t x, value_t y) { return x / y; }
+   static constexpr const char *symbol = " / ";
+};
+
+template <class Op, class L, class R>
+struct Binary : Expr {
+   L lhs;
+   R rhs;
+   constexpr Binary(L l, R r) : lhs(l), rhs(r) {}
+   value_t eval(value_t a, value_t b, value_t p) const {
+      return Op::apply(lhs.eval(a, b, p), rhs.eval(a, b, p));
+   }
+   void emit(std::ostream &os, const std::string &prev) const {
+      os << '(';
+      lhs.emit(os, prev);
+      os << Op::symbol;
+      rhs.emit(os, prev);
+      os << ')';
+   }
+};
+
+template <class E>
+struct Abs : Expr {
+   E arg;
+   constexpr explicit Abs(E e) : arg(e) {}
+   value_t eval(value_t a, value_t b, value_t p) const {
+      value_t x = arg.eval(a, b, p);
+      return x < 0 ? -x : x;
+   }
+   // Come nei kernel scritti a mano: abs() di OpenCL restituisce un tipo unsigned.
+   void emit(std::ostream &os, const std::string &prev) const {
+      std::ostringstream x;
+      arg.emit(x, prev);
+      os << "((" << x.str() << " < 0) ? -" << x.str() << " : " << x.str() << ')';
+   }
+};
+
+// Le costanti intere diventano nodi Const.
+template <class T>
+constexpr auto as_expr(const T &v) {
+   if constexpr (is_expr_v<T>)
+      return v;
+   else
+      return Const(static_cast<value_t>(v));
+}
+
+template <class T>
+using expr_t = decltype(as_expr(std::declval<T>()));
+
+template <class Op, class L, class R>
+using binary_t = Binary<Op, expr_t<L>, expr_t<R>>;
+
+// Gli operatori esistono solo se almeno un operando è un'espressione della DSL e l'altro è
+// un'espressione o un intero.
+template <class T>
+constexpr bool is_operand_v = is_expr_v<T> || std::is_integral<std::decay_t<T>>::value;
+
+template <class L, class R>
+using enable_expr_t =
+   std::enable_if_t<(is_expr_v<L> || is_expr_v<R>) && is_operand_v<L> && is_operand_v<R>>;
+
+template <class L, class R, class = enable_expr_t<L, R>>
+constexpr binary_t<AddOp, L, R> operator+(const L &l, const R &r) {
+   return {as_expr(l), as_expr(r)};
+}
+template <class L, class R, class = enable_expr_t<L, R>>
+constexpr binary_t<SubOp, L, R> operator-(const L &l, const R &r) {
+   return {as_expr(l), as_expr(r)};
+}
+template <class L, class R, class = enable_expr_t<L, R>>
+constexpr binary_t<MulOp, L, R> operator*(const L &l, const R &r) {
+   return {as_expr(l), as_expr(r)};
+}
+template <class L, class R, class = enable_expr_t<L, R>>
+constexpr binary_t<DivOp, L, R> operator/(const L &l, const R &r) {
+   return {as_expr(l), as_expr(r)};
+}
+
+template <class E, class = std::enable_if_t<is_expr_v<E>>>
+constexpr Abs<E> abs(const E &e) {
+   return Abs<E>(e);
+}
+
+// --- Catene di stadi ---
+
+template <class... Stages>
+struct Chain {
+   std::tuple<Stages...> stages;
+
+   static constexpr size_t size() { return sizeof...(Stages); }
+
+   // Valore finale di un elemento, con tutti gli stadi fusi.
+   value_t eval(value_t a, value_t b) const {
+      value_t p = 0;
+      std::apply([&](const auto &...s) { ((p = s.eval(a, b, p)), ...); }, stages);
+      return p;
+   }
+
+   // Chiama f(indice, stadio) per ogni stadio, in ordine.
+   template <class F>
+   void for_each_stage(F &&f) const {
+      for_each_stage(f, std::index_sequence_for<Stages...>());
+   }
+
+ private:
+   template <class F, size_t... I>
+   void for_each_stage(F &f, std::index_sequence<I...>) const {
+      (f(I, std::get<I>(stages)), ...);
+   }
+};
+
+template <class... Stages>
+constexpr Chain<expr_t<Stages>...> chain(const Stages &...stages) {
+   return {std::make_tuple(as_expr(stages)...)};
+}
+
+// --- Backend CPU ---
+
+/**
+ * @brief Calcola c[i] per ogni i in [begin, end) con una sola passata: tutti gli stadi della
+ * catena vengono espansi nel corpo del ciclo.
+ */
+template <class C>
+void run_fused(const C &k, const int *a, const int *b, int *c, size_t begin, size_t end) {
+   for (size_t i = begin; i < end; ++i)
+      c[i] = static_cast<int>(k.eval(a[i], b[i]));
+}
+
+/**
+ * @brief Come run_fused(), ma con una passata sulla memoria per stadio, come comporre operazioni
+ * scritte separatamente: ogni stadio legge e scrive i risultati intermedi in tmp. Serve come
+ * riferimento per misurare il guadagno della fusione.
+ */
+template <class C>
+void run_unfused(const C &k, const int *a, const int *b, int *c, size_t begin, size_t end,
+                 std::vector<value_t> &tmp) {
+   tmp.assign(end - begin, 0);
+   k.for_each_stage([&](size_t, const auto &stage) {
+      for (size_t i = begin; i < end; ++i)
+         tmp[i - begin] = stage.eval(a[i], b[i], tmp[i - begin]);
+   });
+   for (size_t i = begin; i < end; ++i)
+      c[i] = static_cast<int>(tmp[i - begin]);
+}
+
+// --- Backend OpenCL ---
+
+/**
+ * @brief Genera il sorgente OpenCL C di un kernel con la stessa firma di quelli scritti a mano
+ * (a, b, c, n), un work-item per elemento. Ogni stadio diventa una variabile p<k> di tipo
+ * cl_type: "int" basta se la catena usa solo +, - e * (il risultato troncato a 32 bit è lo
+ * stesso), con divisioni serve "long" per avere gli stessi risultati della CPU.
+ */
+template <class C>
+std::string opencl_source(const std::string &name, const C &k, const std::string &cl_type) {
+   std::ostringstream os;
+   os << "// Generato dalla DSL (src/dsl/ElementwiseExpr.hpp), stadi fusi in una passata: "
+      << C::size() << "\n"
+      << "// N_ELEMS: vedi KernelSpecializer::N_ELEMS_PROLOGUE\n\n"
+      << "__kernel void " << name << "(__global const int* a,\n"
+      << "                     __global const int* b,\n"
+      << "                     __global int* c,\n"
+      << "                     const unsigned int n) {\n"
+      << "    const uint i = get_global_id(0);\n"
+      << "    if (i < N_ELEMS) {\n"
+      << "        const " << cl_type << " va = a[i];\n"
+      << "        const " << cl_type << " vb = b[i];\n";
+
+   std::string prev = "0";
+   k.for_each_stage([&](size_t s, const auto &stage) {
+      std::string var = "p" + std::to_string(s);
+      os << "        const " << cl_type << ' ' << var << " = ";
+      stage.emit(os, prev);
+      os << ";\n";
+      prev = var;
+   });
+
+   os << "        c[i] = (int)" << prev << ";\n"
+      << "    }\n"
+      << "}\n";
+   return os.str();
+}
+
+} // namespace dsl
@@ -1,6 +1,12 @@
 #include "Helpers.hpp"
+#include "../common/CsrDesc.hpp"
+#include "../common/HostBuffer.hpp"
+#include "../common/MatrixDesc.hpp"
+#include "../common/SchedPolicy.hpp"
 #include <algorithm>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 /**
  * Helper interno per estrarre il nome del file da un percorso, senza
@@ -11,6 +17,10 @@ static std::string extractKernelName(const std::string &path) {
    if (path.empty())
       return "";
 
+   // Kernel generati dalla DSL (es. "dsl:polynomial_op" per 'gpu_opencl').
+   if (path.rfind("dsl:", 0) == 0)
+      return path.substr(4);
+
    size_t last_slash_pos = path.find_last_of("/\\");
    std::string filename =
       (last_slash_pos == std::string::npos) ? path : path.substr(last_slash_pos + 1);
@@ -22,28 +32,175 @@ static std::string extractKernelName(const std::string &path) {
    return filename.substr(0, dot_pos);
 }
 
+/**
+ * Helper interno per dividere una lista "a,b,c" nei suoi elementi non vuoti.
+ */
+static std::vector<std::string> parseStringList(const std::string &list) {
+   std::vector<std::string> values;
+   size_t start = 0;
+   while (start <= list.size()) {
+      size_t comma = list.find(',', start);
+      if (comma == std::string::npos)
+         comma = list.size();
+      if (comma > start)
+         values.push_back(list.substr(start, comma - start));
+      start = comma + 1;
+   }
+   return values;
+}
+
+/**
+ * Helper interno per convertire una lista "1,0.5,0.25" in un vettore di double.
+ */
+static std::vector<double> parseDoubleList(const std::string &list) {
+   std::vector<double> values;
+   for (const std::string &item : parseStringList(list))
+      values.push_back(std::stod(item));
+   return values;
+}
+
+/**
+ * Helper interno per le opzioni facoltative nella forma --chiave=valore.
+ * @return false se l'opzione non è riconosciuta.
+ */
+static bool parseOption(const std::string &arg, RunOptions &opts) {
+   size_t eq = arg.find('=');
+   std::string key = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+   std::string value = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+
+   if (key == "devices")
+      opts.num_devices = (value == "all") ? 0 : std::stoull(value);
+   else if (key == "cl-device-type")
+      opts.cl_device_type = value;
+   else if (key == "sub-devices")
+      opts.sub_devices = std::stoull(value);
+   else if (key == "sim-speeds")
+      opts.sim_speeds = parseDoubleList(value);
+   else if (key == "hybrid")
+      opts.hybrid = true;
+   else if (key == "hybrid-ratio")
+      opts.hybrid_acc_ratio = std::stod(value);
+   else if (key == "cpu-steal") {
+      // "auto": tutti i core meno due (emitter e nodo acceleratore), almeno uno.
+      const unsigned hc = std::thread::hardware_concurrency();
+      opts.steal_workers = (value == "auto") ? (hc > 2 ? hc - 2 : 1) : std::stoull(value);
+   } else if (key == "producers")
+      opts.producers = std::stoull(value);
+   else if (key == "batch-bytes")
+      opts.batch_bytes = std::stoull(value);
+   else if (key == "batch-latency-us")
+      opts.batch_latency_us = std::stoull(value);
+   else if (key == "tile-elems")
+      opts.tile_elems = std::stoull(value);
+   else if (key == "autotune")
+      opts.autotune = true;
+   else if (key == "tune-cache")
+      opts.tune_cache = value;
+   else if (key == "jit")
+      opts.jit = true;
+   else if (key == "jit-fast-math")
+      opts.jit_fast_math = true;
+   else if (key == "jit-type") {
+      if (value != "float" && value != "double")
+         return false;
+      opts.jit_type = value;
+   } else if (key == "reduce-final") {
+      if (value != "host" && value != "device")
+         return false;
+      opts.reduce_on_device = value == "device";
+   } else if (key == "stencil-steps")
+      opts.stencil_steps = std::stoull(value);
+   else if (key == "stencil-rows")
+      opts.stencil_rows = std::stoull(value);
+   else if (key == "spmv-nnz")
+      opts.spmv_nnz = std::stoull(value);
+   else if (key == "spmv-skew")
+      opts.spmv_skew = std::stod(value);
+   else if (key == "fpga-cus")
+      opts.fpga_cus = std::stoull(value);
+   else if (key == "fpga-transfer") {
+      if (value != "migrate" && value != "write")
+         return false;
+      opts.fpga_migrate = value == "migrate";
+   } else if (key == "huge-pages") {
+      if (value != "on" && value != "off")
+         return false;
+      opts.huge_pages = value == "on";
+   } else if (key == "roofline")
+      opts.roofline = true;
+   else if (key == "perf-counters")
+      opts.perf_counters = true;
+   else if (key == "microbench-max-bytes")
+      opts.microbench_max_bytes = std::stoull(value);
+   else if (key == "microbench-json")
+      opts.microbench_json = value;
+   else if (key == "nt-stores") {
+      if (value != "auto" && value != "on" && value != "off")
+         return false;
+      opts.nt_stores = value;
+   } else if (key == "sched") {
+      if (parse_sched_policy(value) == SchedPolicy::Unknown)
+         return false;
+      opts.sched = value;
+   } else if (key == "aging-us")
+      opts.aging_us = std::stoull(value);
+   else if (key == "interactive-every")
+      opts.interactive_every = std::stoull(value);
+   else if (key == "interactive-n")
+      opts.interactive_n = std::stoull(value);
+   else if (key == "deadline-us")
+      opts.deadline_us = std::stoull(value);
+   else if (key == "tenants")
+      opts.tenant_weights = parseDoubleList(value);
+   else if (key == "profile-db")
+      opts.profile_db = value;
+   else if (key == "calibrate")
+      opts.calibrate = true;
+   else if (key == "auto-backends")
+      opts.auto_backends = parseStringList(value);
+   else
+      return false;
+   return true;
+}
+
 /**
  * Helper per il parsing degli argomenti della riga di comando.
  */
 void parse_args(int argc, char *argv[], size_t &N, size_t &NUM_TASKS, std::string &device_type,
-                std::string &kernel_path, std::string &kernel_name) {
+                std::string &kernel_path, std::string &kernel_name, RunOptions &opts) {
    if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
       print_usage(argv[0]);
       exit(0);
    }
 
-   if (argc > 5)
-      std::cerr << "[WARNING] Too many arguments provided. Ignoring extras.\n";
+   // Separa gli argomenti posizionali dalle opzioni --chiave=valore.
+   std::vector<std::string> positional;
 
    try {
-      if (argc > 1)
-         N = std::stoull(argv[1]);
-      if (argc > 2)
-         NUM_TASKS = std::stoull(argv[2]);
-      if (argc > 3)
-         device_type = argv[3];
-      if (argc > 4)
-         kernel_path = argv[4];
+      for (int i = 1; i < argc; ++i) {
+         std::string arg = argv[i];
+         if (arg.rfind("--", 0) != 0) {
+            positional.push_back(arg);
+            continue;
+         }
+         if (!parseOption(arg, opts)) {
+            std::cerr << "[ERROR] Unknown option '" << arg << "'.\n\n";
+            print_usage(argv[0]);
+            exit(-1);
+         }
+      }
+
+      if (positional.size() > 4)
+         std::cerr << "[WARNING] Too many arguments provided. Ignoring extras.\n";
+
+      if (positional.size() > 0)
+         N = std::stoull(positional[0]);
+      if (positional.size() > 1)
+         NUM_TASKS = std::stoull(positional[1]);
+      if (positional.size() > 2)
+         device_type = positional[2];
+      if (positional.size() > 3)
+         kernel_path = positional[3];
    } catch (const std::invalid_argument &e) {
       std::cerr << "[ERROR] Invalid numeric argument provided.\n\n";
       print_usage(argv[0]);
@@ -68,8 +225,10 @@ void parse_args(int argc, char *argv[], size_t &N, size_t &NUM_TASKS, std::strin
    if (device_type == "gpu_opencl" || device_type == "fpga" || device_type == "gpu_metal")
       kernel_name = extractKernelName(kernel_path);
 
-   // Per CPU, se non specifico un kernel imposta polynomial_op, altrimenti lo estrae dal nome.
-   if (kernel_path.empty() && (device_type == "cpu_ff" || device_type == "cpu_omp"))
+   // Per CPU (e device simulati), se non specifico un kernel imposta polynomial_op, altrimenti lo
+   // estrae dal nome.
+   if (kernel_path.empty() && (device_type == "cpu_ff" || device_type == "cpu_omp" ||
+                               device_type == "sim" || device_type == "auto"))
       kernel_name = "polynomial_op";
    else
       kernel_name = extractKernelName(kernel_path);
@@ -83,8 +242,9 @@ void print_configuration(size_t N, size_t NUM_TASKS, const std::string &device_t
    std::cout << "\nConfiguration: N=" << N << ", NUM_TASKS=" << NUM_TASKS
              << ", Device=" << device_type;
 
-   if (device_type == "cpu_ff" || device_type == "cpu_omp")
-      std::cout << ", Kernel=" << kernel_name;
+   if (device_type == "cpu_ff" || device_type == "cpu_omp" || device_type == "sim" ||
+       device_type == "auto" || device_type == "dsl")
+      std::cout << ", Kernel=" << (kernel_name.empty() ? "all" : kernel_name);
 
    if (device_type == "gpu_opencl" || device_type == "gpu_metal" || device_type == "fpga")
       std::cout << ", Using " << kernel_path;
@@ -96,16 +256,94 @@ void print_configuration(size_t N, size_t NUM_TASKS, const std::string &device_t
  * Helper per stampare le istruzioni d'uso.
  */
 void print_usage(const char *prog_name) {
-   std::cerr << "Usage: " << prog_name << " [N] [NUM_TASKS] [DEVICE] [KERNEL]\n"
+   std::cerr << "Usage: " << prog_name
+             << " [N] [NUM_TASKS] [DEVICE] [KERNEL] [--OPTION=VALUE...]\n"
              << "  N            : Size of the vectors (default: 1,000,000)\n"
              << "  NUM_TASKS    : Number of tasks to run (default: 20)\n"
-             << "  DEVICE       : 'cpu_ff', 'cpu_omp', 'gpu_opencl', 'gpu_metal' or 'fpga' "
-                "(default: 'cpu_ff').\n"
+             << "  DEVICE       : 'cpu_ff', 'cpu_omp', 'gpu_opencl', 'gpu_metal', 'fpga', 'sim', "
+                "'auto', 'dsl'\n"
+             << "                 or 'microbench' (default: 'cpu_ff').\n"
              << "  KERNEL  : Path to the kernel file for accelerators (.cl, .xclbin, .metal)\n"
-             << "                 or kernel name for CPU ('vecAdd', 'polynomial_op', etc.)\n"
+             << "                 or kernel name for CPU, 'sim' and 'auto' ('vecAdd', "
+                "'polynomial_op', etc.)\n"
+             << "                 'dsl:NAME' uses the DSL-generated source on 'gpu_opencl'; "
+                "'dsl' compares\n"
+             << "                 the DSL kernels with the hand-written ones on the CPU\n"
+             << "                 'microbench' measures OpenCL transfer bandwidth and launch "
+                "latency\n"
+             << "                 'gemm' (gemm.cl on 'gpu_opencl') multiplies N x N float "
+                "matrices\n"
+             << "                 'stencil5', 'stencil9' run 5/9-point stencils on an N x N "
+                "float grid\n"
+             << "                 'spmv_csr', 'spmv_csr_vector' multiply a sparse N x N CSR "
+                "matrix by a vector\n"
+             << "                 'heavy_compute_fast' is heavy_compute_kernel with sin/cos "
+                "recurrences (reduced precision)\n"
+             << "\nOptions:\n"
+             << "  --devices=K|all     : Farm of K accelerator nodes (one per device, default: 1)\n"
+             << "  --cl-device-type=T  : OpenCL device type for 'gpu_opencl': gpu, cpu, "
+                "accelerator, all\n"
+             << "  --sub-devices=K     : Split the first OpenCL device into K sub-devices\n"
+             << "  --sim-speeds=S1,... : Relative speeds of the simulated devices ('sim')\n"
+             << "  --hybrid            : Split every task between CPU and accelerator\n"
+             << "  --hybrid-ratio=R    : Initial accelerator share of each task (default: 0.5)\n"
+             << "  --cpu-steal=K|auto  : CPU threads stealing whole tasks when the device is full\n"
+             << "  --producers=P       : Producer threads (upload + launch) of the accelerator node\n"
+             << "  --batch-bytes=B     : Pack small tasks into device launches of up to B bytes\n"
+             << "  --batch-latency-us=U: Max latency added by batching to a task (default: 200)\n"
+             << "  --tile-elems=T      : Stream 'gpu_opencl' tasks larger than T elements in tiles\n"
+             << "  --autotune          : Tune 'gpu_opencl' launches (work-group, vectors), cached\n"
+             << "  --tune-cache=PATH   : Autotuning cache (default: tesi_tuning.db)\n"
+             << "  --jit               : Compile a 'gpu_opencl' kernel variant per task size\n"
+             << "  --jit-fast-math     : Build 'gpu_opencl' kernels with -cl-fast-relaxed-math\n"
+             << "  --jit-type=T        : Floating-point type of 'gpu_opencl' kernels: float, "
+                "double\n"
+             << "  --reduce-final=W    : Combine 'gpu_opencl' reduction partials on: host "
+                "(default), device\n"
+             << "  --stencil-steps=S   : Stencil sweeps per task, kept on the device (default: 1)\n"
+             << "  --stencil-rows=R    : Stencil grid rows per task, with halo (default: whole "
+                "grid)\n"
+             << "  --spmv-nnz=K        : Average nonzeros per row of the SpMV matrix "
+                "(default: 16)\n"
+             << "  --spmv-skew=S       : Row length skew of the SpMV matrix, 0 = uniform "
+                "(default: 0)\n"
+             << "  --fpga-cus=K        : FPGA compute units to use (default: all in the .xclbin)\n"
+             << "  --fpga-transfer=M   : FPGA transfers: migrate (default, aligned host buffers)"
+                " or write\n"
+             << "  --huge-pages=M      : Host vectors on 2 MB pages: on (default), off\n"
+             << "  --roofline          : Report GB/s and GOP/s against measured peaks\n"
+             << "  --perf-counters     : Report IPC and cache/branch/TLB misses of 'cpu_ff', "
+                "'cpu_omp' tasks\n"
+             << "  --microbench-max-bytes=B: Largest transfer of 'microbench' (default: 1 GB)\n"
+             << "  --microbench-json=PATH: Results of 'microbench' (default: "
+                "tesi_microbench.json)\n"
+             << "  --nt-stores=M       : Non-temporal stores of vecAdd/polynomial_op on the CPU: "
+                "auto (default, output > LLC), on, off\n"
+             << "  --sched=P           : Order of waiting tasks: fifo (default), edf, priority\n"
+             << "  --aging-us=U        : Wait worth one priority class (default: 50000)\n"
+             << "  --interactive-every=K: Make every K-th task interactive (class 0, small)\n"
+             << "  --interactive-n=M   : Elements of an interactive task (default: N/100)\n"
+             << "  --deadline-us=D     : Deadline of interactive tasks, from their creation\n"
+             << "  --tenants=W1,W2,..  : One pipeline per tenant sharing the device, with weights\n"
+             << "  --auto-backends=B,..: Backends considered by 'auto' (default: "
+                "cpu_ff,gpu_opencl,fpga)\n"
+             << "  --profile-db=PATH   : Profile database of 'auto' (default: tesi_profile.db)\n"
+             << "  --calibrate         : Re-measure all backends of 'auto' and update the database\n"
              << "\nExample (GPU): " << prog_name
              << " 16777216 100 gpu_opencl kernels/gpu/heavy_compute_kernel.cl\n"
-             << "Example (CPU): " << prog_name << " 16777216 100 cpu_ff vecAdd\n";
+             << "Example (CPU): " << prog_name << " 16777216 100 cpu_ff vecAdd\n"
+             << "Example (farm): " << prog_name
+             << " 1000000 100 sim polynomial_op --devices=3 --sim-speeds=1,0.5,0.25\n"
+             << "Example (auto): " << prog_name << " 10000 100 auto vecAdd\n"
+             << "Example (reduction): " << prog_name
+             << " 16777216 100 gpu_opencl kernels/gpu/reduce_sum.cl --reduce-final=device\n"
+             << "Example (GEMM): " << prog_name << " 2048 10 gpu_opencl kernels/gpu/gemm.cl\n"
+             << "Example (stencil): " << prog_name
+             << " 8192 64 gpu_opencl kernels/gpu/stencil5.cl --stencil-rows=1024 "
+                "--stencil-steps=8\n"
+             << "Example (SpMV): " << prog_name
+             << " 1000000 20 gpu_opencl kernels/gpu/spmv_csr_vector.cl --spmv-skew=1\n"
+             << "Example (microbench): " << prog_name << " 1048576 20 microbench\n";
 }
 
 /**
@@ -198,3 +436,234 @@ void print_metrics(size_t N, size_t NUM_TASKS, const std::string &device_type,
                 << (final_count == NUM_TASKS ? " (SUCCESS)" : " (FAILURE)") << "\n"
                 << "------------------------------------------------------------------\n";
 }
+
+/**
+ * Helper per stampare le metriche dei singoli device della farm.
+ */
+void print_device_metrics(const std::vector<DeviceMetrics> &per_device) {
+   std::cout << "PER-DEVICE METRICS\n";
+   for (size_t i = 0; i < per_device.size(); ++i) {
+      const auto &d = per_device[i];
+      std::cout << "  [" << i << "] " << d.name << ": " << d.tasks << " tasks, Avg Service Time "
+                << d.metrics.avg_service_time_ms << " ms/task, Avg In_Node Time "
+                << d.metrics.avg_InNode_time_ms << " ms/task, Avg Pure Compute Time "
+                << d.metrics.avg_computed_ms << " ms/task\n";
+   }
+   std::cout << "------------------------------------------------------------------\n";
+}
+
+/**
+ * Helper per stampare le metriche della moltiplicazione di matrici.
+ */
+void print_gemm_metrics(size_t side, size_t final_count, long long elapsed_ns,
+                        long long computed_ns) {
+   if (final_count == 0 || elapsed_ns <= 0)
+      return;
+
+   double flops = MatrixDesc::square(side).flops() * double(final_count);
+   std::cout << "GEMM (M=N=K=" << side << ", " << flops / final_count / 1e9
+             << " GFLOP per task)\n"
+             << "  Throughput: " << flops / double(elapsed_ns) << " GFLOP/s\n";
+   if (computed_ns > 0)
+      std::cout << "  Compute only: " << flops / double(computed_ns) << " GFLOP/s\n"
+                << "   (Sul tempo di calcolo misurato dall'acceleratore)\n";
+   std::cout << "------------------------------------------------------------------\n";
+}
+
+/**
+ * Helper per stampare le metriche specifiche dell'esecuzione ibrida.
+ */
+void print_hybrid_metrics(double final_acc_ratio, long long cpu_ns, long long acc_ns,
+                          size_t final_count) {
+   if (final_count == 0)
+      return;
+
+   std::cout << "HYBRID SPLIT\n"
+             << "  Final accelerator share: " << final_acc_ratio * 100 << " %\n"
+             << "  Avg CPU part time: " << (cpu_ns / final_count) / 1.0e6 << " ms/task\n"
+             << "  Avg accelerator part time: " << (acc_ns / final_count) / 1.0e6
+             << " ms/task\n"
+             << "------------------------------------------------------------------\n";
+}
+
+/**
+ * Helper per stampare il modello di costo della modalità 'auto' per la dimensione N.
+ */
+void print_cost_model(const std::vector<std::string> &backends,
+                      const std::vector<BackendProfile> &profiles, size_t N) {
+   std::cout << "COST MODEL (N=" << N << ")\n";
+   for (size_t i = 0; i < backends.size(); ++i) {
+      const BackendProfile &p = profiles[i];
+      std::cout << "  " << backends[i] << ": startup " << p.startup_ns / 1e3 << " us, ";
+      if (p.bandwidth_gbs() > 0)
+         std::cout << "transfer " << p.bandwidth_gbs() << " GB/s, ";
+      std::cout << "compute " << p.compute_ns_per_elem << " ns/elem -> predicted "
+                << p.predict_ns(N) / 1e6 << " ms/task\n";
+   }
+   std::cout << "------------------------------------------------------------------\n";
+}
+
+/**
+ * Helper interno: ordina i campioni e stampa p50, p99 e massimo in ms.
+ */
+static void printPercentiles(std::vector<long long> &samples_ns) {
+   std::sort(samples_ns.begin(), samples_ns.end());
+   auto percentile_ms = [&](double q) {
+      size_t index = static_cast<size_t>(q * (samples_ns.size() - 1) + 0.5);
+      return samples_ns[index] / 1.0e6;
+   };
+
+   std::cout << "p50: " << percentile_ms(0.50) << " ms, p99: " << percentile_ms(0.99)
+             << " ms, max: " << samples_ns.back() / 1.0e6 << " ms";
+}
+
+/**
+ * Helper per stampare i percentili del tempo nel nodo dei singoli task.
+ */
+void print_latency_metrics(std::vector<long long> samples_ns) {
+   if (samples_ns.empty())
+      return;
+
+   std::cout << "LATENCY (In_Node Time per task)\n  ";
+   printPercentiles(samples_ns);
+   std::cout << "\n------------------------------------------------------------------\n";
+}
+
+void print_tenant_metrics(std::vector<TenantMetrics> &tenants) {
+   std::cout << "PER-TENANT METRICS (shared accelerator)\n";
+   for (size_t i = 0; i < tenants.size(); ++i) {
+      auto &t = tenants[i];
+      std::cout << "  [" << i << "] " << t.name << " (weight " << t.weight << "): " << t.tasks
+                << " tasks, device share " << t.device_share * 100 << " %, avg wait "
+                << t.avg_wait_ms << " ms/task, finished at " << t.finish_s << " s\n";
+      if (!t.latency_samples_ns.empty()) {
+         std::cout << "      latency ";
+         printPercentiles(t.latency_samples_ns);
+         std::cout << "\n";
+      }
+   }
+   std::cout << "------------------------------------------------------------------\n";
+}
+
+void print_class_latency_metrics(StatsCollector &stats) {
+   size_t classes_used = 0;
+   bool any_deadline = false;
+   for (size_t k = 0; k < MAX_PRIORITY_CLASSES; ++k) {
+      classes_used += !stats.class_latency_samples_ns[k].empty();
+      any_deadline |= stats.class_deadline_tasks[k] > 0;
+   }
+   if (classes_used < 2 && !any_deadline)
+      return;
+
+   std::cout << "LATENCY PER PRIORITY CLASS (0 = highest)\n";
+   for (size_t k = 0; k < MAX_PRIORITY_CLASSES; ++k) {
+      auto &samples = stats.class_latency_samples_ns[k];
+      if (samples.empty())
+         continue;
+
+      std::cout << "  Class " << k << " (" << samples.size() << " tasks): ";
+      printPercentiles(samples);
+      if (stats.class_deadline_tasks[k] > 0)
+         std::cout << ", deadline misses: " << stats.class_deadline_misses[k] << " / "
+                   << stats.class_deadline_tasks[k];
+      std::cout << "\n";
+   }
+   std::cout << "------------------------------------------------------------------\n";
+}
+
+/**
+ * Helper per stampare le metriche degli stencil.
+ */
+void print_stencil_metrics(double cells, long long elapsed_ns, long long computed_ns) {
+   if (cells <= 0 || elapsed_ns <= 0)
+      return;
+
+   const double bytes_per_cell = 2 * sizeof(float);
+   std::cout << "Stencil (" << cells / 1e6 << " M cell updates)\n"
+             << "  Throughput: " << cells / double(elapsed_ns) * 1e3 << " Mcells/s, "
+             << cells * bytes_per_cell / double(elapsed_ns) << " GB/s\n";
+   if (computed_ns > 0)
+      std::cout << "  Compute only: " << cells / double(computed_ns) * 1e3 << " Mcells/s, "
+                << cells * bytes_per_cell / double(computed_ns) << " GB/s\n"
+                << "   (Sul tempo di calcolo misurato dall'acceleratore)\n";
+   std::cout << "------------------------------------------------------------------\n";
+}
+
+/**
+ * Helper per stampare la banda dei kernel limitati dalla memoria sulla CPU.
+ */
+void print_bandwidth_metrics(double bytes, long long elapsed_ns, double peak_gbs,
+                             double peak_nt_gbs) {
+   if (elapsed_ns <= 0)
+      return;
+
+   const double gbs = bytes / double(elapsed_ns);
+   const double peak = std::max(peak_gbs, peak_nt_gbs);
+   const HostBufferStats pages = host_buffer_stats();
+   std::cout << "Memory bandwidth\n"
+             << "  Achieved: " << gbs << " GB/s";
+   if (peak > 0)
+      std::cout << " (" << 100.0 * gbs / peak << "% of STREAM peak)";
+   std::cout << "\n  STREAM add peak: " << peak_gbs << " GB/s (regular stores), " << peak_nt_gbs
+             << " GB/s (non-temporal stores)\n"
+             << "  Large host buffers: " << pages.hugetlb << " hugetlb, " << pages.transparent
+             << " transparent huge pages, " << pages.small_pages << " 4 KB pages\n"
+             << "------------------------------------------------------------------\n";
+}
+
+/**
+ * Helper per stampare la posizione dell'esecuzione nel modello roofline.
+ */
+void print_roofline_metrics(const RooflinePeaks &peaks, double bytes, double ops,
+                            long long elapsed_ns, long long computed_ns) {
+   if (bytes <= 0 || ops <= 0 || elapsed_ns <= 0)
+      return;
+
+   // Sull'acceleratore la posizione usa il tempo di calcolo (senza trasferimenti), se misurato.
+   const long long ns = computed_ns > 0 ? computed_ns : elapsed_ns;
+   const double intensity = ops / bytes;
+   const double gbs = bytes / double(ns), gops = ops / double(ns);
+   std::cout << "Roofline\n"
+             << "  Work: " << bytes / 1e9 << " GB, " << ops / 1e9
+             << " GOP (arithmetic intensity " << intensity << " op/byte)\n"
+             << "  Achieved: " << bytes / double(elapsed_ns) << " GB/s, "
+             << ops / double(elapsed_ns) << " GOP/s\n";
+   if (computed_ns > 0)
+      std::cout << "  Compute only: " << gbs << " GB/s, " << gops << " GOP/s\n"
+                << "   (Sul tempo di calcolo misurato dall'acceleratore)\n";
+
+   if (peaks.bandwidth_gbs <= 0 || peaks.compute_gops <= 0) {
+      std::cout << "  Peaks: not measured for this backend\n"
+                << "------------------------------------------------------------------\n";
+      return;
+   }
+   const double ridge = peaks.compute_gops / peaks.bandwidth_gbs;
+   const double roof = std::min(peaks.compute_gops, intensity * peaks.bandwidth_gbs);
+   std::cout << "  Peaks (" << peaks.source << "): " << peaks.bandwidth_gbs << " GB/s, "
+             << peaks.compute_gops << " GOP/s, ridge point " << ridge << " op/byte\n"
+             << "  Position: " << (intensity < ridge ? "memory-bound" : "compute-bound")
+             << ", roof " << roof << " GOP/s, achieved " << 100.0 * gops / roof
+             << "% of roof (" << 100.0 * gbs / peaks.bandwidth_gbs << "% of bandwidth, "
+             << 100.0 * gops / peaks.compute_gops << "% of compute)\n"
+             << "------------------------------------------------------------------\n";
+}
+
+/**
+ * Helper per stampare le metriche delle SpMV.
+ */
+void print_spmv_metrics(const CsrDesc &d, size_t final_count, long long elapsed_ns,
+                        long long computed_ns) {
+   if (final_count == 0 || elapsed_ns <= 0)
+      return;
+
+   const double flops = d.flops() * double(final_count);
+   const double bytes = d.min_bytes() * double(final_count);
+   std::cout << "SpMV (" << d.rows << " x " << d.cols << ", " << d.nnz << " nonzeros)\n"
+             << "  Throughput: " << flops / double(elapsed_ns) << " GFLOP/s, "
+             << bytes / double(elapsed_ns) << " GB/s\n";
+   if (computed_ns > 0)
+      std::cout << "  Compute only: " << flops / double(computed_ns) << " GFLOP/s, "
+                << bytes / double(computed_ns) << " GB/s\n"
+                << "   (Sul tempo di calcolo misurato dall'acceleratore)\n";
+   std::cout << "------------------------------------------------------------------\n";
+}
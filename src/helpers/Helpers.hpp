@@ -1,8 +1,12 @@
 #pragma once
 
 #include "../common/PerformanceData.hpp"
+#include "../common/RunOptions.hpp"
+#include "../common/StatsCollector.hpp"
+#include "../profiling/ProfileDB.hpp"
 #include <cstddef>
 #include <string>
+#include <vector>
 
 // Stampa la configurazione attuale della computazione.
 void print_configuration(size_t N, size_t NUM_TASKS, const std::string &device_type,
@@ -10,7 +14,7 @@ void print_configuration(size_t N, size_t NUM_TASKS, const std::string &device_t
 
 // Helper per il parsing degli argomenti della riga di comando.
 void parse_args(int argc, char *argv[], size_t &N, size_t &NUM_TASKS, std::string &device_type,
-                std::string &kernel_path, std::string &kernel_name);
+                std::string &kernel_path, std::string &kernel_name, RunOptions &opts);
 
 // Stampa le istruzioni d'uso.
 void print_usage(const char *prog_name);
@@ -28,4 +32,77 @@ PerformanceData calculate_metrics(long long elapsed_ns, long long computed_ns,
  */
 void print_metrics(size_t N, size_t NUM_TASKS, const std::string &device_type,
                    const std::string &kernel_name, const PerformanceData &metrics,
-                   size_t final_count);
\ No newline at end of file
+                   size_t final_count);
+
+/**
+ * @brief Stampa le metriche di ogni device della farm multi-device.
+ */
+void print_device_metrics(const std::vector<DeviceMetrics> &per_device);
+
+/**
+ * @brief Stampa le metriche di ogni tenant di un acceleratore condiviso. Ordina i campioni.
+ */
+void print_tenant_metrics(std::vector<TenantMetrics> &tenants);
+
+/**
+ * @brief Stampa le prestazioni in GFLOP/s delle moltiplicazioni di matrici side x side: sul tempo
+ * totale e, se misurato, sul solo tempo di calcolo dell'acceleratore.
+ */
+void print_gemm_metrics(size_t side, size_t final_count, long long elapsed_ns,
+                        long long computed_ns);
+
+/**
+ * @brief Stampa le prestazioni degli stencil: celle aggiornate al secondo e banda equivalente
+ * (una lettura e una scrittura float per cella aggiornata), sul tempo totale e sul tempo di
+ * calcolo dell'acceleratore se misurato.
+ */
+void print_stencil_metrics(double cells, long long elapsed_ns, long long computed_ns);
+
+/**
+ * @brief Stampa la banda ottenuta dai kernel limitati dalla memoria sulla CPU (bytes letti e
+ * scritti in elapsed_ns) rispetto al picco STREAM con store normali e non temporali, e il tipo di
+ * pagine dei vettori host grandi.
+ */
+void print_bandwidth_metrics(double bytes, long long elapsed_ns, double peak_gbs,
+                             double peak_nt_gbs);
+
+/**
+ * @brief Stampa la posizione dell'esecuzione nel modello roofline: intensità aritmetica (ops /
+ * bytes dei task completati), GB/s e GOP/s ottenuti (sul tempo di calcolo dell'acceleratore se
+ * misurato) e frazione del tetto min(picco di calcolo, intensità x picco di banda).
+ */
+void print_roofline_metrics(const RooflinePeaks &peaks, double bytes, double ops,
+                            long long elapsed_ns, long long computed_ns);
+
+struct CsrDesc;
+
+/**
+ * @brief Stampa le prestazioni delle SpMV (final_count moltiplicazioni con la matrice descritta
+ * da d): GFLOP/s e banda sul traffico minimo (matrice, x una volta e y).
+ */
+void print_spmv_metrics(const CsrDesc &d, size_t final_count, long long elapsed_ns,
+                        long long computed_ns);
+
+/**
+ * @brief Stampa la frazione finale e i tempi medi delle due parti dell'esecuzione ibrida.
+ */
+void print_hybrid_metrics(double final_acc_ratio, long long cpu_ns, long long acc_ns,
+                          size_t final_count);
+
+/**
+ * @brief Stampa, per ogni backend della modalità 'auto', il profilo misurato e il tempo previsto
+ * per un task di N elementi.
+ */
+void print_cost_model(const std::vector<std::string> &backends,
+                      const std::vector<BackendProfile> &profiles, size_t N);
+
+/**
+ * @brief Stampa p50, p99 e massimo del tempo nel nodo dei singoli task.
+ */
+void print_latency_metrics(std::vector<long long> samples_ns);
+
+/**
+ * @brief Stampa gli stessi percentili per ogni classe di priorità, con le scadenze mancate. Non
+ * stampa nulla se tutti i task sono della stessa classe e senza scadenza. Ordina i campioni.
+ */
+void print_class_latency_metrics(StatsCollector &stats);
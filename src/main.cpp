@@ -1,17 +1,39 @@
 #include "../../include/ff_includes.hpp"
+#include "accelerator/DeviceDiscovery.hpp"
+#include "accelerator/Gpu_OpenCL_Accelerator.hpp"
+#include "accelerator/HybridSplitter.hpp"
+#include "accelerator/LoadAwareScheduler.hpp"
+#include "accelerator/SharedAccelerator.hpp"
+#include "accelerator/SimulatedAccelerator.hpp"
 #include "accelerator/ff_node_acc_t.hpp"
+#include "common/AllocCounter.hpp"
+#include "common/HostBuffer.hpp"
+#include "common/TaskPool.hpp"
+#include "cpu_runner/CpuGemm.hpp"
+#include "cpu_runner/CpuSpmv.hpp"
+#include "cpu_runner/CpuStencil.hpp"
+#include "cpu_runner/CpuStream.hpp"
+#include "cpu_runner/CpuWorkerNode.hpp"
 #include "cpu_runner/Cpu_FF_Runner.hpp"
+#include "dsl/DslBench.hpp"
 #include "helpers/Helpers.hpp"
+#include "profiling/Calibrator.hpp"
+#include "profiling/DevicePeaks.hpp"
+#include "profiling/MicroBench.hpp"
+#include "profiling/ProfileDB.hpp"
+#include <algorithm>
 #include <chrono>
+#include <climits>
+#include <fstream>
 #include <future>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifdef __APPLE__
 #include "accelerator/Gpu_Metal_Accelerator.hpp"
-#include "accelerator/Gpu_OpenCL_Accelerator.hpp"
 #else
 #include "accelerator/FpgaAccelerator.hpp"
 #include "cpu_runner/Cpu_OMP_Runner.hpp"
@@ -21,8 +43,9 @@
  * @brief Nodo sorgente della pipeline FastFlow.
  *
  * Il nodo Emitter genera i Task da far processare al nodo ff_node_acc_t.
- * Inizializza i dati di input una sola volta, poi crea dinamicamente un nuovo
- * oggetto Task per ogni richiesta dalla pipeline.
+ * Inizializza i dati di input una sola volta, poi per ogni richiesta dalla
+ * pipeline prende un Task dal suo TaskPool (i nodi a valle lo rilasciano a fine
+ * elaborazione), senza allocazioni sull'heap a regime.
  *
  * !! Stiamo eseguendo i task in parallelo sull'acceleratore, ma stiamo serializzando la
  * !! finalizzazione e il download, e ciò ci permette di riutilizzare lo stesso buffer di output.
@@ -52,6 +75,79 @@ class Emitter : public ff_node {
       n_ = n;
    }
 
+   /**
+    * @brief Genera moltiplicazioni di matrici (gemm) float side x side al posto dei vettori. I
+    * puntatori dei task restano int*: le matrici attraversano la pipeline come byte e i kernel
+    * le rileggono come float.
+    */
+   void set_matrices(size_t side) {
+      mat_ = MatrixDesc::square(side);
+      ma_.resize(mat_.a_elems());
+      mb_.resize(mat_.b_elems());
+      mc_.resize(mat_.c_elems());
+      gemm_fill_inputs(mat_, ma_.data(), mb_.data());
+
+      a_ptr_ = reinterpret_cast<int *>(ma_.data());
+      b_ptr_ = reinterpret_cast<int *>(mb_.data());
+      c_ptr_ = reinterpret_cast<int *>(mc_.data());
+      n_ = mat_.c_elems();
+   }
+
+   // Errore massimo (campionato) del C dei task a matrici.
+   double gemm_error() const { return gemm_max_error(mat_, ma_.data(), mb_.data(), mc_.data()); }
+
+   // Confronto (campionato) del c dei task heavy_compute_fast con il riferimento.
+   HeavyFastCheck heavy_fast_error() const {
+      return heavy_fast_check(a.data(), b.data(), c.data(), n_);
+   }
+
+   /**
+    * @brief Genera task stencil su una griglia float side x side: il task k è il tile k (modulo
+    * il numero di tile) di tile_rows righe, con steps sweep e steps righe di alone. I task
+    * leggono la griglia di input e scrivono ciascuno le proprie righe della griglia di output.
+    */
+   void set_grid(size_t side, size_t tile_rows, size_t steps, size_t points) {
+      grid_side_ = side;
+      grid_tile_rows_ = tile_rows;
+      grid_steps_ = steps;
+      grid_points_ = points;
+      grid_in_.resize(side * side);
+      grid_out_.assign(side * side, 0.0f);
+      stencil_fill_grid(side, grid_in_.data());
+   }
+
+   // Errore massimo delle righe scritte dai primi completed task (-1 se la griglia è troppo
+   // grande per il riferimento).
+   double stencil_error(size_t completed) const {
+      return stencil_max_error(grid_side_, grid_steps_, grid_points_, grid_in_.data(),
+                               grid_out_.data(),
+                               stencil_covered_rows(grid_side_, grid_tile_rows_, completed));
+   }
+
+   /**
+    * @brief Genera task SpMV con la matrice d (i cui array restano del chiamante): ogni task
+    * calcola y = A x, con x e y float di proprietà dell'Emitter.
+    */
+   void set_sparse(const CsrDesc &d) {
+      csr_ = d;
+      sx_.resize(d.cols);
+      sy_.assign(d.rows, 0.0f);
+      spmv_fill_x(d.cols, sx_.data());
+   }
+
+   // Errore relativo massimo di y.
+   double spmv_error() const { return spmv_max_error(csr_, sx_.data(), sy_.data()); }
+
+   /**
+    * @brief Genera traffico misto: un task ogni 'every' è interattivo (classe 0, 'n' elementi,
+    * scadenza 'deadline' dopo la creazione se non nulla), gli altri sono batch (classe 1).
+    */
+   void set_interactive_traffic(size_t every, size_t n, std::chrono::microseconds deadline) {
+      interactive_every_ = every;
+      interactive_n_ = std::min(std::max<size_t>(n, 1), n_);
+      interactive_deadline_ = deadline;
+   }
+
    /**
     * @brief Genera un nuovo Task fino al raggiungimento del numero totale.
     * @return Un puntatore a un nuovo Task, o FF_EOS al termine.
@@ -59,7 +155,41 @@ class Emitter : public ff_node {
    void *svc(void *) override {
       if (tasks_sent < tasks_to_send) {
          tasks_sent++;
-         return new Task{a_ptr_, b_ptr_, c_ptr_, n_, tasks_sent};
+         Task *task = task_pool_.acquire();
+         task->a = a_ptr_;
+         task->b = b_ptr_;
+         task->c = c_ptr_;
+         task->n = n_;
+         task->mat = mat_;
+         task->id = tasks_sent;
+
+         if (grid_points_ > 0) {
+            GridDesc &g = task->grid;
+            g = stencil_tile(grid_side_, grid_tile_rows_, grid_steps_, grid_points_,
+                             tasks_sent - 1);
+            float *in = grid_in_.data() + (g.first_row - g.halo_top) * grid_side_;
+            task->a = task->b = reinterpret_cast<int *>(in);
+            task->c = reinterpret_cast<int *>(grid_out_.data() + g.first_row * grid_side_);
+            task->n = g.out_elems();
+         }
+
+         if (csr_.valid()) {
+            task->csr = csr_;
+            task->a = task->b = reinterpret_cast<int *>(sx_.data());
+            task->c = reinterpret_cast<int *>(sy_.data());
+            task->n = csr_.rows;
+         }
+
+         if (interactive_every_ > 0) {
+            bool interactive = tasks_sent % interactive_every_ == 0;
+            task->priority = interactive ? 0 : 1;
+            if (interactive) {
+               task->n = interactive_n_;
+               if (interactive_deadline_.count() > 0)
+                  task->deadline = std::chrono::steady_clock::now() + interactive_deadline_;
+            }
+         }
+         return task;
       }
 
       // Una volta inviati tutti i task -> fine stream.
@@ -69,19 +199,63 @@ class Emitter : public ff_node {
  private:
    size_t tasks_to_send;          // Numero totale di task da inviare
    size_t tasks_sent;             // Numero di task già inviati
-   std::vector<int> a, b, c;      // Vettori di input/output
+   HostVector<int> a, b, c;       // Vettori di input/output (su huge page)
    int *a_ptr_, *b_ptr_, *c_ptr_; // Puntatori ai dati di input/output
    size_t n_;                     // Dimensione dei vettori
+
+   // Task a matrici (disabilitati se mat_ non è valido).
+   MatrixDesc mat_;
+   std::vector<float> ma_, mb_, mc_;
+
+   // Task stencil (disabilitati se grid_points_ è 0).
+   size_t grid_side_{0}, grid_tile_rows_{0}, grid_steps_{0}, grid_points_{0};
+   std::vector<float> grid_in_, grid_out_;
+
+   // Task SpMV (disabilitati se csr_ non è valido).
+   CsrDesc csr_;
+   std::vector<float> sx_, sy_;
+
+   // Traffico misto (disabilitato se interactive_every_ è 0).
+   size_t interactive_every_{0};
+   size_t interactive_n_{0};
+   std::chrono::microseconds interactive_deadline_{0};
+
+   // Task in volo massimi: abbastanza per riempire i batch e le code dei nodi a valle.
+   static constexpr size_t TASK_POOL_SIZE = 256;
+   TaskPool task_pool_{TASK_POOL_SIZE};
 };
 
+#ifdef TESI_ALLOC_COUNTER
+/**
+ * @brief Stampa le allocazioni sull'heap del regime, fra i conteggi presi dopo i primi
+ * ALLOC_WARMUP_TASKS task e alla fine. Nelle build di debug il percorso dei task (TaskPool, code,
+ * batch, statistiche) deve restare senza allocazioni: una regressione fa fallire l'esecuzione.
+ */
+void checkSteadyStateAllocs(size_t allocs_at_warmup, size_t allocs_at_end) {
+   size_t steady_allocs = allocs_at_end - allocs_at_warmup;
+   std::cout << "[Main] Heap allocations in steady state (after the first "
+             << StatsCollector::ALLOC_WARMUP_TASKS << " tasks): " << steady_allocs << "\n";
+#ifndef NDEBUG
+   if (steady_allocs > 0) {
+      std::cerr << "[FATAL] Main: The steady state is not allocation-free.\n";
+      exit(EXIT_FAILURE);
+   }
+#endif
+}
+#endif
+
 /**
  * @brief Orchestra l'intera pipeline FastFlow per l'offloading su un
  * acceleratore. Crea i due nodi della pipeline FF (Emitter, ff_node_acc_t).
  * Riceve l'acceleratore già inizializzato. Avvia la pipeline. Misura e
  * raccoglie i tempi di esecuzione (computed ed elapsed) e il numero di task
- * completati.
+ * completati. Dalle opzioni imposta nel nodo i thread producer, il work stealing sulla CPU, il
+ * batching e la politica di scheduling, e nell'Emitter il traffico misto interattivo/batch.
+ * Con le SpMV i task usano la matrice csr.
  */
 void runAcceleratorPipeline(size_t N, size_t NUM_TASKS, IAccelerator *accelerator,
+                            const std::string &kernel_name, const RunOptions &opts,
+                            const CsrDesc &csr,
                             long long &elapsed_ns, long long &computed_ns,
                             long long &total_InNode_time_ns, long long &inter_completion_time_ns,
                             size_t &final_count) {
@@ -94,7 +268,28 @@ void runAcceleratorPipeline(size_t N, size_t NUM_TASKS, IAccelerator *accelerato
    // il cui secondo nodo incapsula una pipeline interna a 2 thread (producer,
    // consumer).
    Emitter emitter(N, NUM_TASKS);
+   if (parse_cpu_kernel(kernel_name) == CpuKernel::Gemm)
+      emitter.set_matrices(N);
+   if (size_t points = stencil_points(parse_cpu_kernel(kernel_name)))
+      emitter.set_grid(N, opts.stencil_rows, opts.stencil_steps, points);
+   if (csr.valid())
+      emitter.set_sparse(csr);
+   if (opts.interactive_every > 0)
+      emitter.set_interactive_traffic(opts.interactive_every,
+                                      opts.interactive_n > 0 ? opts.interactive_n : N / 100,
+                                      std::chrono::microseconds(opts.deadline_us));
+   stats.latency_samples_ns.reserve(NUM_TASKS);
+   for (auto &samples : stats.class_latency_samples_ns)
+      samples.reserve(NUM_TASKS);
    ff_node_acc_t accNode(accelerator, &stats);
+   accNode.set_producers(opts.producers);
+   accNode.enable_scheduling(parse_sched_policy(opts.sched),
+                             std::chrono::microseconds(opts.aging_us));
+   if (opts.steal_workers > 0)
+      accNode.enable_cpu_stealing(kernel_name, opts.steal_workers);
+   if (opts.batch_bytes > 0)
+      accNode.enable_batching(opts.batch_bytes,
+                              std::chrono::microseconds(opts.batch_latency_us));
    ff_Pipe<> pipe(&emitter, &accNode);
 
    std::cout << "[Main] Starting FF pipeline execution...\n";
@@ -114,6 +309,774 @@ void runAcceleratorPipeline(size_t N, size_t NUM_TASKS, IAccelerator *accelerato
    computed_ns = stats.computed_ns.load();
    total_InNode_time_ns = stats.total_InNode_time_ns.load();
    inter_completion_time_ns = stats.inter_completion_time_ns.load();
+
+   if (opts.steal_workers > 0)
+      std::cout << "[Main] Tasks executed on CPU by work stealing: " << stats.tasks_on_cpu.load()
+                << " / " << final_count << "\n";
+   if (opts.batch_bytes > 0)
+      std::cout << "[Main] Batched device launches: " << stats.batches.load() << "\n";
+   if (final_count > 0 && parse_cpu_kernel(kernel_name) == CpuKernel::Gemm)
+      std::cout << "[Main] GEMM max relative error (sampled): " << emitter.gemm_error() << "\n";
+   if (stencil_points(parse_cpu_kernel(kernel_name)) > 0) {
+      double error = emitter.stencil_error(final_count);
+      if (error >= 0)
+         std::cout << "[Main] Stencil max error vs sequential sweeps: " << error << "\n";
+   }
+   if (final_count > 0 && csr.valid())
+      std::cout << "[Main] SpMV max relative error: " << emitter.spmv_error() << "\n";
+   if (final_count > 0 && parse_cpu_kernel(kernel_name) == CpuKernel::HeavyComputeFast)
+      print_heavy_fast_check("[Main]", emitter.heavy_fast_error());
+   print_latency_metrics(stats.latency_samples_ns);
+   print_class_latency_metrics(stats);
+
+#ifdef TESI_ALLOC_COUNTER
+   if (final_count > StatsCollector::ALLOC_WARMUP_TASKS)
+      checkSteadyStateAllocs(stats.heap_allocs_at_warmup, stats.heap_allocs_at_end);
+#endif
+}
+
+/**
+ * @brief Variante ibrida di runAcceleratorPipeline: la pipeline è Emitter -> HybridSplitter ->
+ * ff_node_acc_t. Ogni task viene diviso fra CPU e acceleratore; il conteggio finale è quello dei
+ * task completati per intero dallo splitter.
+ */
+void runHybridPipeline(size_t N, size_t NUM_TASKS, IAccelerator *accelerator,
+                       const std::string &kernel_name, double initial_acc_ratio,
+                       long long &elapsed_ns, long long &computed_ns,
+                       long long &total_InNode_time_ns, long long &inter_completion_time_ns,
+                       size_t &final_count) {
+
+   StatsCollector stats;
+   std::future<size_t> count_future = stats.count_promise.get_future();
+
+   Emitter emitter(N, NUM_TASKS);
+   HybridSplitter splitter(kernel_name, initial_acc_ratio);
+   ff_node_acc_t accNode(accelerator, &stats);
+   ff_Pipe<> pipe(&emitter, &splitter, &accNode);
+
+   std::cout << "[Main] Starting FF hybrid pipeline execution...\n";
+   auto t0 = std::chrono::steady_clock::now();
+
+   if (pipe.run_and_wait_end() < 0) {
+      std::cerr << "[ERROR] Main: Pipeline execution failed.\n";
+      exit(EXIT_FAILURE);
+   }
+   auto t1 = std::chrono::steady_clock::now();
+   std::cout << "[Main] FF hybrid pipeline execution finished.\n";
+
+   // Il nodo acceleratore conta solo le parti che ha ricevuto; i task completati sono quelli
+   // dello splitter.
+   count_future.get();
+   final_count = splitter.tasks_completed();
+   elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+   computed_ns = stats.computed_ns.load();
+   total_InNode_time_ns = stats.total_InNode_time_ns.load();
+   inter_completion_time_ns = splitter.inter_completion_ns();
+
+   print_hybrid_metrics(splitter.acc_ratio(), splitter.cpu_ns(), splitter.acc_ns(), final_count);
+   if (final_count > 0 && parse_cpu_kernel(kernel_name) == CpuKernel::HeavyComputeFast)
+      print_heavy_fast_check("[Main]", emitter.heavy_fast_error());
+}
+
+/**
+ * @brief Tempo fra i completamenti aggregato di più nodi, misurato come nella pipeline singola:
+ * la somma degli intervalli fra completamenti consecutivi di tutti i nodi, cioè il tempo dal
+ * primo all'ultimo completamento.
+ */
+long long mergedInterCompletionNs(const std::vector<std::unique_ptr<StatsCollector>> &stats) {
+   long long first = 0, last = 0;
+   for (const auto &s : stats) {
+      long long f = s->first_completion_ns.load();
+      if (f > 0 && (first == 0 || f < first))
+         first = f;
+      last = std::max(last, s->last_completion_ns.load());
+   }
+   return last - first;
+}
+
+/**
+ * @brief Variante multi-device di runAcceleratorPipeline: la pipeline è Emitter -> farm, dove la
+ * farm ha come emitter il LoadAwareScheduler e come worker un ff_node_acc_t per ogni
+ * acceleratore. Raccoglie le statistiche di ogni device e quelle aggregate.
+ *
+ * Per la modalità 'auto': se cpu_worker_kernel non è vuoto aggiunge in coda un CpuWorkerNode
+ * (il suo nome è l'ultimo di device_names), e seed_service_ns inizializza i tempi di servizio dei
+ * worker con quelli previsti dal modello di costo.
+ */
+void runAcceleratorFarm(size_t N, size_t NUM_TASKS, const std::vector<IAccelerator *> &accelerators,
+                        const std::vector<std::string> &device_names, long long &elapsed_ns,
+                        long long &computed_ns, long long &total_InNode_time_ns,
+                        long long &inter_completion_time_ns, size_t &final_count,
+                        std::vector<DeviceMetrics> &per_device,
+                        const std::string &cpu_worker_kernel = "",
+                        const std::vector<long long> &seed_service_ns = {}) {
+
+   // Task in volo massimi per device: uno per buffer set più uno in attesa nella coda di input,
+   // così il device non resta mai senza lavoro ma lo scheduler decide su misure recenti.
+   const size_t MAX_OUTSTANDING_PER_DEVICE = 4;
+
+   size_t num_devices = accelerators.size() + (cpu_worker_kernel.empty() ? 0 : 1);
+   LoadBoard board(num_devices);
+   std::vector<std::unique_ptr<StatsCollector>> stats;
+   std::vector<std::unique_ptr<ff_node_acc_t>> nodes;
+   std::unique_ptr<CpuWorkerNode> cpu_node;
+   std::vector<std::future<size_t>> count_futures;
+   std::vector<ff_node *> workers;
+
+   for (size_t i = 0; i < num_devices; ++i) {
+      stats.push_back(std::make_unique<StatsCollector>());
+      // Come nella pipeline singola, i campioni di latenza non riallocano durante l'esecuzione:
+      // ogni worker può ricevere tutti i task.
+      stats[i]->latency_samples_ns.reserve(NUM_TASKS);
+      for (auto &samples : stats[i]->class_latency_samples_ns)
+         samples.reserve(NUM_TASKS);
+      count_futures.push_back(stats[i]->count_promise.get_future());
+      if (i < seed_service_ns.size())
+         board.seed_service_ns(i, seed_service_ns[i]);
+   }
+
+   for (size_t i = 0; i < accelerators.size(); ++i) {
+      nodes.push_back(std::make_unique<ff_node_acc_t>(accelerators[i], stats[i].get()));
+      nodes[i]->set_load_board(&board, i);
+      workers.push_back(nodes[i].get());
+   }
+
+   if (!cpu_worker_kernel.empty()) {
+      cpu_node = std::make_unique<CpuWorkerNode>(cpu_worker_kernel, stats.back().get());
+      cpu_node->set_load_board(&board, num_devices - 1);
+      workers.push_back(cpu_node.get());
+   }
+
+   Emitter emitter(N, NUM_TASKS);
+   // Solo con i tempi previsti dal modello di costo calibrato conviene attendere il worker
+   // migliore anche se saturo.
+   LoadAwareScheduler scheduler(&board, MAX_OUTSTANDING_PER_DEVICE, !seed_service_ns.empty());
+   ff_farm farm;
+   farm.add_emitter(&scheduler);
+   farm.add_workers(workers);
+   farm.remove_collector();
+   ff_Pipe<> pipe(&emitter, &farm);
+
+   std::cout << "[Main] Starting FF farm execution on " << num_devices << " devices...\n";
+   auto t0 = std::chrono::steady_clock::now();
+
+   if (pipe.run_and_wait_end() < 0) {
+      std::cerr << "[ERROR] Main: Farm execution failed.\n";
+      exit(EXIT_FAILURE);
+   }
+   auto t1 = std::chrono::steady_clock::now();
+   std::cout << "[Main] FF Farm execution finished.\n";
+
+   // Raccolta dei risultati per device e aggregati.
+   elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+   computed_ns = total_InNode_time_ns = inter_completion_time_ns = 0;
+   final_count = 0;
+   per_device.clear();
+
+   for (size_t i = 0; i < num_devices; ++i) {
+      size_t count = count_futures[i].get();
+      PerformanceData device_metrics = calculate_metrics(
+         elapsed_ns, stats[i]->computed_ns.load(), stats[i]->total_InNode_time_ns.load(),
+         stats[i]->inter_completion_time_ns.load(), count);
+      per_device.push_back({device_names[i], count, device_metrics});
+
+      final_count += count;
+      computed_ns += stats[i]->computed_ns.load();
+      total_InNode_time_ns += stats[i]->total_InNode_time_ns.load();
+   }
+
+   // I completamenti dei device (o sub-device) sono interlacciati: contano gli intervalli fra
+   // completamenti consecutivi di tutta la farm.
+   inter_completion_time_ns = mergedInterCompletionNs(stats);
+
+#ifdef TESI_ALLOC_COUNTER
+   // Il contatore è globale: il regime della farm va dall'ultimo nodo acceleratore che lo
+   // raggiunge all'ultimo che termina, e richiede che tutti superino i task di riscaldamento.
+   size_t allocs_at_warmup = 0, allocs_at_end = 0;
+   bool warmed_up = !accelerators.empty();
+   for (size_t i = 0; i < accelerators.size(); ++i) {
+      warmed_up = warmed_up && per_device[i].tasks > StatsCollector::ALLOC_WARMUP_TASKS;
+      allocs_at_warmup = std::max(allocs_at_warmup, stats[i]->heap_allocs_at_warmup.load());
+      allocs_at_end = std::max(allocs_at_end, stats[i]->heap_allocs_at_end.load());
+   }
+   if (warmed_up)
+      checkSteadyStateAllocs(allocs_at_warmup, allocs_at_end);
+#endif
+}
+
+/**
+ * @brief Variante multi-tenant di runAcceleratorPipeline: una pipeline (Emitter -> ff_node_acc_t)
+ * per ogni peso in opts.tenant_weights, ognuna con NUM_TASKS task, eseguite in parallelo sullo
+ * stesso acceleratore attraverso un SharedAccelerator (un solo contesto, programma e pool di
+ * buffer). Come nella pipeline singola ogni tenant usa la politica di scheduling e il traffico
+ * interattivo delle opzioni. Raccoglie le statistiche di ogni tenant e quelle aggregate.
+ */
+void runSharedPipelines(size_t N, size_t NUM_TASKS, IAccelerator *accelerator,
+                        const std::string &kernel_name, const RunOptions &opts,
+                        long long &elapsed_ns, long long &computed_ns,
+                        long long &total_InNode_time_ns, long long &inter_completion_time_ns,
+                        size_t &final_count, std::vector<TenantMetrics> &per_tenant) {
+   SharedAccelerator service(accelerator, kernel_name);
+   size_t num_tenants = opts.tenant_weights.size();
+
+   std::vector<std::unique_ptr<IAccelerator>> tenant_accs;
+   std::vector<std::unique_ptr<StatsCollector>> stats;
+   std::vector<std::future<size_t>> count_futures;
+   std::vector<std::unique_ptr<Emitter>> emitters;
+   std::vector<std::unique_ptr<ff_node_acc_t>> nodes;
+   std::vector<std::unique_ptr<ff_Pipe<>>> pipes;
+
+   for (size_t i = 0; i < num_tenants; ++i) {
+      tenant_accs.push_back(
+         service.make_tenant("tenant" + std::to_string(i), opts.tenant_weights[i]));
+      stats.push_back(std::make_unique<StatsCollector>());
+      stats[i]->latency_samples_ns.reserve(NUM_TASKS);
+      for (auto &samples : stats[i]->class_latency_samples_ns)
+         samples.reserve(NUM_TASKS);
+      count_futures.push_back(stats[i]->count_promise.get_future());
+
+      emitters.push_back(std::make_unique<Emitter>(N, NUM_TASKS));
+      if (opts.interactive_every > 0)
+         emitters[i]->set_interactive_traffic(opts.interactive_every,
+                                              opts.interactive_n > 0 ? opts.interactive_n : N / 100,
+                                              std::chrono::microseconds(opts.deadline_us));
+      nodes.push_back(std::make_unique<ff_node_acc_t>(tenant_accs[i].get(), stats[i].get()));
+      nodes[i]->set_producers(opts.producers);
+      nodes[i]->enable_scheduling(parse_sched_policy(opts.sched),
+                                  std::chrono::microseconds(opts.aging_us));
+      if (opts.batch_bytes > 0)
+         nodes[i]->enable_batching(opts.batch_bytes,
+                                   std::chrono::microseconds(opts.batch_latency_us));
+      pipes.push_back(std::make_unique<ff_Pipe<>>(emitters[i].get(), nodes[i].get()));
+   }
+
+   std::cout << "[Main] Starting " << num_tenants << " FF pipelines on a shared accelerator...\n";
+   auto t0 = std::chrono::steady_clock::now();
+
+   // Ogni pipeline gira nel suo thread; si registra l'istante in cui termina.
+   std::vector<std::chrono::steady_clock::time_point> finish_times(num_tenants);
+   std::vector<std::thread> runners;
+   for (size_t i = 0; i < num_tenants; ++i)
+      runners.emplace_back([&, i] {
+         if (pipes[i]->run_and_wait_end() < 0) {
+            std::cerr << "[ERROR] Main: Pipeline of tenant " << i << " failed.\n";
+            exit(EXIT_FAILURE);
+         }
+         finish_times[i] = std::chrono::steady_clock::now();
+      });
+   for (auto &runner : runners)
+      runner.join();
+
+   auto t1 = std::chrono::steady_clock::now();
+   std::cout << "[Main] All FF pipelines finished.\n";
+
+   // Raccolta dei risultati per tenant e aggregati.
+   elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+   computed_ns = total_InNode_time_ns = inter_completion_time_ns = 0;
+   final_count = 0;
+   per_tenant.clear();
+
+   size_t total_bytes = 0;
+   for (size_t i = 0; i < num_tenants; ++i)
+      total_bytes += service.tenant_stats(i).bytes.load();
+
+   for (size_t i = 0; i < num_tenants; ++i) {
+      const auto &ts = service.tenant_stats(i);
+      size_t count = count_futures[i].get();
+
+      TenantMetrics m;
+      m.name = ts.name;
+      m.weight = ts.weight;
+      m.tasks = count;
+      m.device_share = total_bytes > 0 ? double(ts.bytes.load()) / total_bytes : 0.0;
+      m.avg_wait_ms = ts.tasks > 0 ? ts.wait_ns.load() / 1.0e6 / ts.tasks.load() : 0.0;
+      m.finish_s =
+         std::chrono::duration_cast<std::chrono::nanoseconds>(finish_times[i] - t0).count() /
+         1.0e9;
+      m.latency_samples_ns = std::move(stats[i]->latency_samples_ns);
+      per_tenant.push_back(std::move(m));
+
+      final_count += count;
+      computed_ns += stats[i]->computed_ns.load();
+      total_InNode_time_ns += stats[i]->total_InNode_time_ns.load();
+
+      if (opts.interactive_every > 0) {
+         std::cout << "[Main] " << ts.name << ":\n";
+         print_class_latency_metrics(*stats[i]);
+      }
+   }
+
+   // Come nella farm: i completamenti dei tenant sono interlacciati sullo stesso device.
+   inter_completion_time_ns = mergedInterCompletionNs(stats);
+}
+
+/**
+ * @brief Crea l'acceleratore del tipo richiesto. Per la farm riceve il device OpenCL già scelto
+ * (o la velocità relativa, per i device simulati). Dalle opzioni usa tile_elems e l'autotuning
+ * per 'gpu_opencl', le compute unit e la modalità dei trasferimenti per 'fpga'.
+ */
+std::unique_ptr<IAccelerator> makeAccelerator(const std::string &device_type,
+                                              const std::string &kernel_path,
+                                              const std::string &kernel_name,
+                                              cl_device_id device, double sim_speed,
+                                              const RunOptions &opts = RunOptions()) {
+   if (device_type == "gpu_opencl") {
+      JitOptions jit;
+      jit.by_size = opts.jit;
+      jit.fast_math = opts.jit_fast_math;
+      jit.real_type = opts.jit_type;
+      return std::make_unique<Gpu_OpenCL_Accelerator>(kernel_path, kernel_name, device,
+                                                      opts.tile_elems,
+                                                      opts.autotune ? opts.tune_cache : "", jit,
+                                                      opts.reduce_on_device);
+   }
+   if (device_type == "sim")
+      return std::make_unique<SimulatedAccelerator>(kernel_name, sim_speed);
+#ifdef __APPLE__
+   if (device_type == "gpu_metal")
+      return std::make_unique<Gpu_Metal_Accelerator>(kernel_path, kernel_name);
+#else
+   if (device_type == "fpga")
+      return std::make_unique<FpgaAccelerator>(kernel_path, kernel_name, device, opts.fpga_cus,
+                                               opts.fpga_migrate);
+#endif
+   return nullptr;
+}
+
+/**
+ * @brief Per 'gpu_opencl' con un tipo di device diverso da quello di default (es. il device CPU
+ * di POCL) sceglie il primo device di quel tipo. Altrimenti lascia la scelta all'acceleratore.
+ */
+cl_device_id selectSingleDevice(const std::string &device_type, const RunOptions &opts) {
+   if (device_type != "gpu_opencl" || opts.cl_device_type == "gpu")
+      return nullptr;
+
+   std::vector<cl_device_id> devices = discover_devices(parse_device_type(opts.cl_device_type));
+   if (devices.empty()) {
+      std::cerr << "[FATAL] No OpenCL device of type '" << opts.cl_device_type << "' found.\n";
+      exit(EXIT_FAILURE);
+   }
+   return devices[0];
+}
+
+/**
+ * @brief Crea un acceleratore per ogni device da usare nella farm: i device OpenCL trovati (o i
+ * sub-device del primo), oppure i device simulati richiesti.
+ */
+std::vector<std::unique_ptr<IAccelerator>>
+makeFarmAccelerators(const std::string &device_type, const std::string &kernel_path,
+                     const std::string &kernel_name, const RunOptions &opts,
+                     std::vector<std::string> &device_names) {
+   std::vector<std::unique_ptr<IAccelerator>> accelerators;
+
+   if (device_type == "sim") {
+      size_t count = opts.num_devices > 0 ? opts.num_devices
+                                          : std::max<size_t>(1, opts.sim_speeds.size());
+      for (size_t i = 0; i < count; ++i) {
+         double speed = i < opts.sim_speeds.size() ? opts.sim_speeds[i] : 1.0;
+         accelerators.push_back(makeAccelerator(device_type, kernel_path, kernel_name, nullptr,
+                                                speed));
+         device_names.push_back("sim" + std::to_string(i) + " (speed " + std::to_string(speed) +
+                                ")");
+      }
+      return accelerators;
+   }
+
+   cl_device_type type = (device_type == "fpga") ? CL_DEVICE_TYPE_ACCELERATOR
+                                                 : parse_device_type(opts.cl_device_type);
+   std::vector<cl_device_id> devices = discover_devices(type, opts.sub_devices);
+   if (devices.empty()) {
+      std::cerr << "[FATAL] No OpenCL device found for '" << device_type << "'.\n";
+      exit(EXIT_FAILURE);
+   }
+   if (opts.num_devices > 0 && opts.num_devices < devices.size()) {
+      for (size_t i = opts.num_devices; i < devices.size(); ++i)
+         release_device(devices[i]);
+      devices.resize(opts.num_devices);
+   }
+
+   for (cl_device_id device : devices) {
+      device_names.push_back(get_device_name(device));
+      std::cerr << "[Main] Using device '" << device_names.back() << "'.\n";
+      accelerators.push_back(
+         makeAccelerator(device_type, kernel_path, kernel_name, device, 1.0, opts));
+   }
+   return accelerators;
+}
+
+/**
+ * @brief Percorso di default del kernel di un backend per la modalità 'auto'.
+ */
+std::string autoKernelPath(const std::string &backend, CpuKernel kernel) {
+   if (backend == "gpu_opencl")
+      return std::string("kernels/gpu/") + cpu_kernel_name(kernel) + ".cl";
+   if (backend == "gpu_metal")
+      return std::string("kernels/gpu/") + cpu_kernel_name(kernel) + ".metal";
+   if (backend == "fpga") {
+      switch (kernel) {
+      case CpuKernel::VecAdd:
+         return "kernels/fpga/krnl_vadd.xclbin";
+      case CpuKernel::PolynomialOp:
+         return "kernels/fpga/krnl_polynomial_op.xclbin";
+      case CpuKernel::HeavyCompute:
+         return "kernels/fpga/krnl_heavy_compute.xclbin";
+      case CpuKernel::HeavyComputeFast:
+         return "kernels/fpga/krnl_heavy_compute_fast.xclbin";
+      case CpuKernel::DeepPipeline:
+         return "kernels/fpga/krnl_deep_pipeline_calculation.xclbin";
+      default:
+         break;
+      }
+   }
+   return "";
+}
+
+/**
+ * @brief Verifica che un backend della modalità 'auto' sia utilizzabile su questa macchina e ne
+ * sceglie il device OpenCL (il primo del suo tipo, nullptr per i backend senza OpenCL).
+ */
+bool autoBackendAvailable(const std::string &backend, const std::string &kernel_path,
+                          cl_device_id &device) {
+   device = nullptr;
+   if (backend == "sim")
+      return true;
+   // Percorso vuoto: il backend non ha il kernel (es. le riduzioni su FPGA).
+   if (kernel_path.empty() || !std::ifstream(kernel_path))
+      return false;
+#ifdef __APPLE__
+   if (backend == "gpu_metal")
+      return true;
+#endif
+   cl_device_type type;
+   if (backend == "gpu_opencl")
+      type = CL_DEVICE_TYPE_GPU;
+   else if (backend == "fpga")
+      type = CL_DEVICE_TYPE_ACCELERATOR;
+   else
+      return false;
+   std::vector<cl_device_id> devices = discover_devices(type);
+   if (devices.empty())
+      return false;
+   device = devices[0];
+   return true;
+}
+
+/**
+ * @brief Modalità 'auto': costruisce una farm con il worker CPU e un nodo per ogni acceleratore
+ * disponibile, e invia ogni task al backend che si prevede lo completi prima.
+ *
+ * Il profilo di ogni backend (costo fisso, banda di trasferimento, costo di calcolo per elemento)
+ * viene letto dal ProfileDB; i backend senza profilo, o tutti con --calibrate, vengono misurati e
+ * il database aggiornato. I tempi previsti per N inizializzano i tempi di servizio dello
+ * scheduler, che poi li raffina con le misure.
+ */
+void runAutoFarm(size_t N, size_t NUM_TASKS, const std::string &kernel_name, const RunOptions &opts,
+                 long long &elapsed_ns, long long &computed_ns, long long &total_InNode_time_ns,
+                 long long &inter_completion_time_ns, size_t &final_count,
+                 std::vector<DeviceMetrics> &per_device) {
+   CpuKernel kernel = parse_cpu_kernel(kernel_name);
+   if (kernel == CpuKernel::Unknown) {
+      std::cerr << "[FATAL] Auto: Unknown kernel name '" << kernel_name << "'.\n";
+      exit(EXIT_FAILURE);
+   }
+   std::string canonical_name = cpu_kernel_name(kernel);
+
+   ProfileDB db(opts.profile_db);
+   if (!db.load())
+      std::cerr << "[Auto] No profile database at " << db.path() << ", it will be created.\n";
+
+   std::vector<std::unique_ptr<IAccelerator>> accelerators;
+   std::vector<std::string> backend_names;
+   std::vector<BackendProfile> profiles;
+   bool use_cpu = false;
+   BackendProfile cpu_profile;
+   bool db_changed = false;
+
+   for (const std::string &backend : opts.auto_backends) {
+      BackendProfile profile;
+      bool known = !opts.calibrate && db.find(backend, canonical_name, profile);
+
+      if (backend == "cpu_ff") {
+         if (!known) {
+            std::cerr << "[Auto] Calibrating '" << backend << "'...\n";
+            profile = calibrate_cpu(kernel);
+            db.store(backend, canonical_name, profile);
+            db_changed = true;
+         }
+         use_cpu = true;
+         cpu_profile = profile;
+         continue;
+      }
+
+      std::string kernel_path = autoKernelPath(backend, kernel);
+      cl_device_id device;
+      if (!autoBackendAvailable(backend, kernel_path, device)) {
+         std::cerr << "[Auto] Backend '" << backend << "' not available, skipped.\n";
+         continue;
+      }
+
+      // La calibrazione usa un'istanza dedicata, perché il nodo della farm inizializza la sua,
+      // ma sullo stesso device: il profilo misura il device che eseguirà i task.
+      if (!known) {
+         std::cerr << "[Auto] Calibrating '" << backend << "'...\n";
+         auto probe = makeAccelerator(backend, kernel_path, canonical_name, device, 1.0);
+         if (!probe || !probe->initialize()) {
+            std::cerr << "[Auto] Backend '" << backend << "' failed to initialize, skipped.\n";
+            continue;
+         }
+         profile = calibrate_accelerator(probe.get());
+         db.store(backend, canonical_name, profile);
+         db_changed = true;
+      }
+
+      accelerators.push_back(makeAccelerator(backend, kernel_path, canonical_name, device, 1.0));
+      backend_names.push_back(backend);
+      profiles.push_back(profile);
+   }
+
+   if (db_changed && db.save())
+      std::cerr << "[Auto] Profile database saved to " << db.path() << ".\n";
+
+   // Il worker CPU è l'ultimo della farm.
+   if (use_cpu) {
+      backend_names.push_back("cpu_ff");
+      profiles.push_back(cpu_profile);
+   }
+   if (backend_names.empty()) {
+      std::cerr << "[FATAL] Auto: No usable backend.\n";
+      exit(EXIT_FAILURE);
+   }
+   print_cost_model(backend_names, profiles, N);
+
+   std::vector<long long> seed_service_ns;
+   for (const auto &p : profiles)
+      seed_service_ns.push_back(std::max<long long>(1, (long long)p.predict_ns(N)));
+
+   std::vector<IAccelerator *> raw_accelerators;
+   for (auto &acc : accelerators)
+      raw_accelerators.push_back(acc.get());
+   runAcceleratorFarm(N, NUM_TASKS, raw_accelerators, backend_names, elapsed_ns, computed_ns,
+                      total_InNode_time_ns, inter_completion_time_ns, final_count, per_device,
+                      use_cpu ? canonical_name : "", seed_service_ns);
+}
+
+/**
+ * @brief Le riduzioni scrivono all'inizio di c un solo risultato per task: N deve bastare a
+ * contenerlo, e le modalità che dividono o concatenano i task non si applicano.
+ */
+void checkReductionOptions(size_t N, const std::string &kernel_name, RunOptions &opts) {
+   CpuKernel kernel = parse_cpu_kernel(kernel_name);
+   if (!is_reduction(kernel))
+      return;
+
+   if (N < result_elems(kernel, N)) {
+      std::cerr << "[FATAL] Reduction '" << kernel_name << "' needs N >= "
+                << result_elems(kernel, N) << ".\n";
+      exit(EXIT_FAILURE);
+   }
+   if (opts.hybrid) {
+      std::cerr << "[FATAL] Reduction '" << kernel_name
+                << "' cannot be split between CPU and accelerator (--hybrid).\n";
+      exit(EXIT_FAILURE);
+   }
+   if (opts.batch_bytes > 0) {
+      std::cerr << "[WARNING] Batching is not available for reductions, disabled.\n";
+      opts.batch_bytes = 0;
+   }
+   if (opts.tile_elems > 0) {
+      std::cerr << "[WARNING] Tiling is not available for reductions, disabled.\n";
+      opts.tile_elems = 0;
+   }
+}
+
+/**
+ * @brief Controlli comuni ai kernel i cui task sono problemi interi (gemm, stencil, SpMV). I
+ * kernel esistono solo in OpenCL e nel simulatore (nessun bitstream FPGA né shader Metal), e
+ * girano su CPU o in una pipeline su un solo device; le modalità che dividono, concatenano o
+ * ridimensionano i task vengono disattivate con un avviso.
+ * @param family Nome dei kernel nei messaggi (es. "GEMM").
+ * @param hint Suggerimento aggiunto all'avviso (può essere vuoto).
+ */
+void checkWholeTaskOptions(const char *family, const std::string &device_type, const char *hint,
+                           RunOptions &opts) {
+   if (device_type == "fpga" || device_type == "gpu_metal") {
+      std::cerr << "[FATAL] " << family << ": No kernel for device '" << device_type
+                << "', use 'gpu_opencl', 'sim', 'cpu_ff' or 'cpu_omp'.\n";
+      exit(EXIT_FAILURE);
+   }
+   if (device_type == "auto" || opts.hybrid || opts.num_devices != 1 || opts.sub_devices > 0 ||
+       !opts.tenant_weights.empty()) {
+      std::cerr << "[FATAL] " << family
+                << ": Runs on 'cpu_ff', 'cpu_omp' or a single accelerator pipeline "
+                   "('gpu_opencl', 'sim').\n";
+      exit(EXIT_FAILURE);
+   }
+   if (opts.batch_bytes > 0 || opts.tile_elems > 0 || opts.steal_workers > 0 ||
+       opts.interactive_every > 0) {
+      std::cerr << "[WARNING] Batching, tiling, CPU stealing and interactive traffic are not "
+                   "available for "
+                << family << hint << ", disabled.\n";
+      opts.batch_bytes = opts.tile_elems = opts.steal_workers = opts.interactive_every = 0;
+   }
+}
+
+/**
+ * @brief Con gemm N è il lato delle matrici quadrate, e ogni task è una moltiplicazione intera:
+ * le modalità che dividono, concatenano o ridimensionano i task non si applicano.
+ */
+void checkGemmOptions(size_t N, const std::string &device_type, const std::string &kernel_name,
+                      RunOptions &opts) {
+   const size_t MAX_GEMM_SIDE = 16384; // 3 matrici da 1 GB
+
+   if (parse_cpu_kernel(kernel_name) != CpuKernel::Gemm)
+      return;
+
+   if (N == 0 || N > MAX_GEMM_SIDE) {
+      std::cerr << "[FATAL] GEMM: N is the side of the matrices, it must be between 1 and "
+                << MAX_GEMM_SIDE << ".\n";
+      exit(EXIT_FAILURE);
+   }
+   checkWholeTaskOptions("GEMM", device_type, "", opts);
+}
+
+/**
+ * @brief Con gli stencil N è il lato della griglia e i task sono tile di righe con il proprio
+ * alone: come per gemm le modalità che dividono, concatenano o ridimensionano i task non si
+ * applicano.
+ */
+void checkStencilOptions(size_t N, const std::string &device_type, const std::string &kernel_name,
+                         RunOptions &opts) {
+   const size_t MAX_STENCIL_SIDE = 32768; // 2 griglie da 4 GB
+
+   if (stencil_points(parse_cpu_kernel(kernel_name)) == 0)
+      return;
+
+   if (N == 0 || N > MAX_STENCIL_SIDE || opts.stencil_steps == 0) {
+      std::cerr << "[FATAL] Stencil: N is the side of the grid, it must be between 1 and "
+                << MAX_STENCIL_SIDE << ", and --stencil-steps must be at least 1.\n";
+      exit(EXIT_FAILURE);
+   }
+   checkWholeTaskOptions("Stencil", device_type, " (use --stencil-rows)", opts);
+}
+
+/**
+ * @brief Con le SpMV N è il numero di righe (e colonne) della matrice sparsa e ogni task è una
+ * moltiplicazione intera: come per gemm le modalità che dividono, concatenano o ridimensionano i
+ * task non si applicano. Gli indici CSR sono int, quindi gli elementi non nulli sono limitati.
+ */
+void checkSpmvOptions(size_t N, const std::string &device_type, const std::string &kernel_name,
+                      RunOptions &opts) {
+   if (!is_spmv(parse_cpu_kernel(kernel_name)))
+      return;
+
+   if (N == 0 || opts.spmv_nnz == 0 || N * (opts.spmv_nnz + 1) > size_t(INT_MAX) ||
+       opts.spmv_skew < 0) {
+      std::cerr << "[FATAL] SpMV: N is the number of rows of the matrix, --spmv-nnz must be at "
+                   "least 1, N * (--spmv-nnz + 1) at most "
+                << INT_MAX << " and --spmv-skew not negative.\n";
+      exit(EXIT_FAILURE);
+   }
+   checkWholeTaskOptions("SpMV", device_type, "", opts);
+}
+
+/**
+ * @brief Lo scheduling dei task in attesa (--sched) e il traffico interattivo (--interactive-*,
+ * --deadline-us) esistono solo nel nodo acceleratore delle pipeline su un solo device (singola o
+ * dei tenant): negli altri percorsi (CPU, farm, auto, ibrido) verrebbero ignorati, quindi vengono
+ * disattivati con un avviso. Il work stealing sulla CPU non è disponibile con i tenant, che si
+ * contenderebbero gli stessi core.
+ */
+void checkSchedOptions(const std::string &device_type, RunOptions &opts) {
+   const bool single_device =
+      (device_type == "gpu_opencl" || device_type == "gpu_metal" || device_type == "fpga" ||
+       device_type == "sim") &&
+      opts.num_devices == 1 && opts.sub_devices == 0;
+   const bool tenants = single_device && !opts.tenant_weights.empty();
+
+   if (tenants && opts.steal_workers > 0) {
+      std::cerr << "[WARNING] CPU work stealing (--cpu-steal) is not available with tenants on a "
+                   "shared accelerator, disabled.\n";
+      opts.steal_workers = 0;
+   }
+   if (tenants || (single_device && !opts.hybrid) ||
+       (opts.sched == "fifo" && opts.interactive_every == 0))
+      return;
+
+   std::cerr << "[WARNING] Task scheduling (--sched) and interactive traffic (--interactive-*) "
+                "are only available on a single accelerator pipeline, disabled.\n";
+   opts.sched = "fifo";
+   opts.interactive_every = 0;
+}
+
+/**
+ * @brief Misura all'avvio, prima dei task, i picchi del backend: la banda STREAM della CPU
+ * (stream_gbs, stream_nt_gbs) per i kernel limitati dalla memoria o per il roofline, e con
+ * --roofline i picchi restituiti (CPU: STREAM e FMA con gli stessi thread del runner; OpenCL:
+ * sonde sul device della pipeline singola). Gli altri backend non hanno picchi.
+ */
+RooflinePeaks measurePeaks(size_t N, const std::string &device_type,
+                           const std::string &kernel_name, const RunOptions &opts,
+                           double &stream_gbs, double &stream_nt_gbs) {
+   RooflinePeaks peaks;
+   const bool cpu = device_type == "cpu_ff" || device_type == "cpu_omp";
+   const bool omp = device_type == "cpu_omp";
+   if (cpu && (opts.roofline || is_memory_bound(parse_cpu_kernel(kernel_name)))) {
+#ifndef __APPLE__
+      if (omp)
+         measureCpu_OMP_StreamPeak(N, stream_gbs, stream_nt_gbs);
+      else
+#endif
+         measureCpu_FF_StreamPeak(N, stream_gbs, stream_nt_gbs);
+   }
+   if (!opts.roofline)
+      return peaks;
+
+   if (cpu) {
+      peaks.source = omp ? "STREAM add + FMA probes, OpenMP" : "STREAM add + FMA probes, FastFlow";
+      peaks.bandwidth_gbs = std::max(stream_gbs, stream_nt_gbs);
+#ifndef __APPLE__
+      if (omp)
+         peaks.compute_gops = measureCpu_OMP_FmaPeak();
+      else
+#endif
+         peaks.compute_gops = measureCpu_FF_FmaPeak();
+   } else if (device_type == "gpu_opencl" && opts.num_devices == 1 && opts.sub_devices == 0 &&
+              !opts.hybrid && opts.tenant_weights.empty()) {
+      peaks = measure_opencl_peaks(selectSingleDevice(device_type, opts));
+   } else {
+      std::cerr << "[WARNING] Roofline peaks are measured only on 'cpu_ff', 'cpu_omp' and a "
+                   "single 'gpu_opencl' pipeline: reporting achieved throughput only.\n";
+   }
+   return peaks;
+}
+
+/**
+ * @brief Byte mossi e operazioni dei final_count task completati, per il roofline. I kernel su
+ * vettori usano il costo per elemento (kernel_cost()); matrici, griglie e matrici sparse il
+ * proprio descrittore, con il traffico minimo (ogni matrice o cella letta e scritta una volta).
+ */
+void rooflineWork(size_t N, const std::string &kernel_name, const RunOptions &opts,
+                  const CsrDesc &csr, size_t final_count, double &bytes, double &ops) {
+   const CpuKernel kernel = parse_cpu_kernel(kernel_name);
+   const double tasks = double(final_count);
+   if (kernel == CpuKernel::Gemm) {
+      const MatrixDesc d = MatrixDesc::square(N);
+      ops = d.flops() * tasks;
+      bytes = double(d.a_elems() + d.b_elems() + d.c_elems()) * sizeof(float) * tasks;
+   } else if (size_t points = stencil_points(kernel)) {
+      // 5 punti: 4 somme e un prodotto; 9 punti: 8 somme e 3 prodotti (vedi stencil_rows()).
+      const double cells =
+         stencil_total_cells(N, opts.stencil_rows, opts.stencil_steps, final_count);
+      ops = cells * (points == 5 ? 5 : 11);
+      bytes = cells * 2 * sizeof(float);
+   } else if (csr.valid()) {
+      ops = csr.flops() * tasks;
+      bytes = csr.min_bytes() * tasks;
+   } else {
+      const KernelCost cost = kernel_cost(kernel);
+      ops = cost.ops * double(N) * tasks;
+      bytes = cost.bytes * double(N) * tasks;
+   }
 }
 
 int main(int argc, char *argv[]) {
@@ -121,54 +1084,152 @@ int main(int argc, char *argv[]) {
    size_t N = 1000000, NUM_TASKS = 20; // Default
    std::string device_type = "cpu_ff"; // Default: cpu che usa ff::parallel_for
    std::string kernel_path, kernel_name;
+   RunOptions opts; // Opzioni facoltative (--chiave=valore)
 
    long long elapsed_ns = 0;           // Tempo totale (host) per completare tutti i task
    long long computed_ns = 0;          // Tempo per il singolo calcolo
    size_t final_count = 0;             // Numero totale di task effettivamente completati
    long long total_InNode_time_ns = 0; // Tempo totale dei task dall'ingresso all'uscita del nodo
    long long inter_completion_time_ns = 0; // Tempo di completamento fra due task consecutivi
+   std::vector<DeviceMetrics> per_device;  // Metriche dei singoli device (solo farm)
+   std::vector<TenantMetrics> per_tenant;  // Metriche dei singoli tenant (device condiviso)
 
    // Parsing degli argomenti della command line. Setta anche il kernel di
    // default per GPU e FPGA.
-   parse_args(argc, argv, N, NUM_TASKS, device_type, kernel_path, kernel_name);
+   parse_args(argc, argv, N, NUM_TASKS, device_type, kernel_path, kernel_name, opts);
+   set_host_huge_pages(opts.huge_pages);
 
    print_configuration(N, NUM_TASKS, device_type, kernel_path, kernel_name);
+   checkReductionOptions(N, kernel_name, opts);
+   checkGemmOptions(N, device_type, kernel_name, opts);
+   checkStencilOptions(N, device_type, kernel_name, opts);
+   checkSpmvOptions(N, device_type, kernel_name, opts);
+   checkSchedOptions(device_type, opts);
+   const bool stencil = stencil_points(parse_cpu_kernel(kernel_name)) > 0;
+
+   // Matrice delle SpMV, generata una volta per tutti i backend.
+   CsrMatrix sparse;
+   if (is_spmv(parse_cpu_kernel(kernel_name)))
+      sparse = spmv_generate(N, N, opts.spmv_nnz, opts.spmv_skew);
+   const CsrDesc csr = sparse.desc();
+
+   // Farm multi-device se sono richiesti più device (o tutti, o dei sub-device).
+   bool use_farm = opts.num_devices != 1 || opts.sub_devices > 0;
+
+   // Picchi di banda e di calcolo, misurati prima dei task.
+   double stream_gbs = 0, stream_nt_gbs = 0;
+   const RooflinePeaks peaks =
+      measurePeaks(N, device_type, kernel_name, opts, stream_gbs, stream_nt_gbs);
 
    // In base al device scelto, esegue la parallelizzazione dei task su CPU
    // multicore tramite ff o la pipeline con offloading su GPU/FPGA.
-   if (device_type == "cpu_ff")
-      elapsed_ns = executeCpu_FF_Tasks(N, NUM_TASKS, kernel_name, final_count);
+   if (device_type == "cpu_ff" && csr.valid())
+      elapsed_ns = executeCpu_FF_Spmv(csr, NUM_TASKS, final_count);
 
-#ifdef __APPLE__
-   else if (device_type == "gpu_opencl") {
-      auto accelerator = std::make_unique<Gpu_OpenCL_Accelerator>(kernel_path, kernel_name);
-      runAcceleratorPipeline(N, NUM_TASKS, accelerator.get(), elapsed_ns, computed_ns,
-                             total_InNode_time_ns, inter_completion_time_ns, final_count);
+   else if (device_type == "cpu_ff")
+      elapsed_ns = stencil ? executeCpu_FF_Stencil(N, NUM_TASKS, kernel_name, opts.stencil_steps,
+                                                   opts.stencil_rows, final_count)
+                           : executeCpu_FF_Tasks(N, NUM_TASKS, kernel_name, final_count,
+                                                 opts.nt_stores, opts.perf_counters);
+
+#ifndef __APPLE__
+   else if (device_type == "cpu_omp" && csr.valid())
+      elapsed_ns = executeCpu_OMP_Spmv(csr, NUM_TASKS, final_count);
+
+   else if (device_type == "cpu_omp")
+      elapsed_ns = stencil ? executeCpu_OMP_Stencil(N, NUM_TASKS, kernel_name, opts.stencil_steps,
+                                                    opts.stencil_rows, final_count)
+                           : executeCpu_OMP_Tasks(N, NUM_TASKS, kernel_name, final_count,
+                                                  opts.nt_stores, opts.perf_counters);
+#endif
 
-   } else if (device_type == "gpu_metal") {
-      auto accelerator = std::make_unique<Gpu_Metal_Accelerator>(kernel_path, kernel_name);
-      runAcceleratorPipeline(N, NUM_TASKS, accelerator.get(), elapsed_ns, computed_ns,
-                             total_InNode_time_ns, inter_completion_time_ns, final_count);
+   else if (device_type == "dsl") {
+      // Confronto dei kernel della DSL con quelli scritti a mano: stampa le proprie metriche.
+      runDslBenchmark(N, NUM_TASKS, kernel_name);
+      return 0;
    }
-#else
-   else if (device_type == "cpu_omp") {
-      elapsed_ns = executeCpu_OMP_Tasks(N, NUM_TASKS, kernel_name, final_count);
 
-   } else if (device_type == "fpga") {
-      auto accelerator = std::make_unique<FpgaAccelerator>(kernel_path, kernel_name);
-      runAcceleratorPipeline(N, NUM_TASKS, accelerator.get(), elapsed_ns, computed_ns,
-                             total_InNode_time_ns, inter_completion_time_ns, final_count);
+   else if (device_type == "microbench") {
+      // Banda dei trasferimenti e latenze dei lanci sul primo device OpenCL; NUM_TASKS è il
+      // numero di ripetizioni di ogni trasferimento.
+      std::vector<cl_device_id> devices =
+         discover_devices(parse_device_type(opts.cl_device_type));
+      if (devices.empty()) {
+         std::cerr << "[FATAL] No OpenCL device of type '" << opts.cl_device_type << "' found.\n";
+         exit(EXIT_FAILURE);
+      }
+      runMicroBenchmark(devices[0], N, NUM_TASKS, opts.microbench_max_bytes,
+                        opts.microbench_json);
+      return 0;
    }
-#endif
+
+   else if (device_type == "auto")
+      runAutoFarm(N, NUM_TASKS, kernel_name, opts, elapsed_ns, computed_ns, total_InNode_time_ns,
+                  inter_completion_time_ns, final_count, per_device);
+
+   else if (use_farm && (device_type == "gpu_opencl" || device_type == "fpga" ||
+                         device_type == "sim")) {
+      std::vector<std::string> device_names;
+      auto accelerators =
+         makeFarmAccelerators(device_type, kernel_path, kernel_name, opts, device_names);
+      std::vector<IAccelerator *> raw_accelerators;
+      for (auto &acc : accelerators)
+         raw_accelerators.push_back(acc.get());
+      runAcceleratorFarm(N, NUM_TASKS, raw_accelerators, device_names, elapsed_ns, computed_ns,
+                         total_InNode_time_ns, inter_completion_time_ns, final_count, per_device);
+
+   } else if (auto accelerator = makeAccelerator(
+                 device_type, kernel_path, kernel_name, selectSingleDevice(device_type, opts),
+                 opts.sim_speeds.empty() ? 1.0 : opts.sim_speeds[0], opts)) {
+      if (!opts.tenant_weights.empty())
+         runSharedPipelines(N, NUM_TASKS, accelerator.get(), kernel_name, opts, elapsed_ns,
+                            computed_ns, total_InNode_time_ns, inter_completion_time_ns,
+                            final_count, per_tenant);
+      else if (opts.hybrid)
+         runHybridPipeline(N, NUM_TASKS, accelerator.get(), kernel_name, opts.hybrid_acc_ratio,
+                           elapsed_ns, computed_ns, total_InNode_time_ns, inter_completion_time_ns,
+                           final_count);
+      else
+         runAcceleratorPipeline(N, NUM_TASKS, accelerator.get(), kernel_name, opts, csr,
+                                elapsed_ns, computed_ns, total_InNode_time_ns,
+                                inter_completion_time_ns, final_count);
+   }
+
    else {
       std::cerr << "[ERROR] Invalid device type '" << device_type << "' for this OS.\n\n";
       print_usage(argv[0]);
       return -1;
    }
 
+   // Con il device condiviso ogni tenant ha eseguito NUM_TASKS task.
+   if (!per_tenant.empty())
+      NUM_TASKS *= per_tenant.size();
+
    PerformanceData metrics = calculate_metrics(elapsed_ns, computed_ns, total_InNode_time_ns,
                                                inter_completion_time_ns, final_count);
    print_metrics(N, NUM_TASKS, device_type, kernel_name, metrics, final_count);
+   if (parse_cpu_kernel(kernel_name) == CpuKernel::Gemm)
+      print_gemm_metrics(N, final_count, elapsed_ns, computed_ns);
+   if (stencil)
+      print_stencil_metrics(
+         stencil_total_cells(N, opts.stencil_rows, opts.stencil_steps, final_count), elapsed_ns,
+         computed_ns);
+   if (csr.valid())
+      print_spmv_metrics(csr, final_count, elapsed_ns, computed_ns);
+   if (is_memory_bound(parse_cpu_kernel(kernel_name)) &&
+       (device_type == "cpu_ff" || device_type == "cpu_omp"))
+      print_bandwidth_metrics(stream_bytes_per_elem() * double(N) * double(final_count),
+                              elapsed_ns, stream_gbs, stream_nt_gbs);
+   if (opts.roofline) {
+      double bytes = 0, ops = 0;
+      rooflineWork(N, kernel_name, opts, csr, final_count, bytes, ops);
+      print_roofline_metrics(peaks, bytes, ops, elapsed_ns, computed_ns);
+   }
+
+   if (!per_device.empty())
+      print_device_metrics(per_device);
+   if (!per_tenant.empty())
+      print_tenant_metrics(per_tenant);
 
    return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,116 @@
+#include "Calibrator.hpp"
+#include "../../include/ff_includes.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// Tempo di un task di n elementi: totale (host) e di calcolo puro stimato dal backend.
+struct Sample {
+   size_t n;
+   double total_ns;
+   double compute_ns;
+};
+
+const size_t SMALL_N = 1024;                // Task piccolo: misura i costi fissi
+const size_t MAX_N = size_t(1) << 22;       // Dimensione massima del task grande
+const double MIN_LARGE_RUN_NS = 50e6;       // Durata minima del task grande (50 ms)
+const int REPETITIONS = 3;                  // Ripetizioni misurate, si tiene la migliore
+
+/**
+ * @brief Esegue un task di n elementi 1 + REPETITIONS volte e tiene la misura migliore. La prima
+ * esecuzione non è misurata: scalda cache e buffer (e alloca quelli del device).
+ */
+template <typename RunFn> Sample measure(size_t n, RunFn &run) {
+   std::vector<int> a(n), b(n), c(n);
+   for (size_t i = 0; i < n; ++i) {
+      a[i] = int(i);
+      b[i] = int(2 * i);
+   }
+
+   Sample best{n, std::numeric_limits<double>::max(), 0};
+   for (int r = 0; r <= REPETITIONS; ++r) {
+      long long compute_ns = 0;
+      auto t0 = std::chrono::steady_clock::now();
+      run(a.data(), b.data(), c.data(), n, compute_ns);
+      auto t1 = std::chrono::steady_clock::now();
+
+      double total_ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+      if (r > 0 && total_ns < best.total_ns)
+         best = {n, total_ns, double(compute_ns)};
+   }
+   return best;
+}
+
+/**
+ * @brief Ricava il modello lineare da un task piccolo e da uno grande, raddoppiando il secondo
+ * finché non dura abbastanza da rendere trascurabili i costi fissi e il rumore.
+ */
+template <typename RunFn> BackendProfile calibrate(RunFn run) {
+   Sample small = measure(SMALL_N, run);
+   Sample large{0, 0, 0};
+   for (size_t n = SMALL_N * 16; n <= MAX_N; n *= 2) {
+      large = measure(n, run);
+      if (large.total_ns >= MIN_LARGE_RUN_NS)
+         break;
+   }
+
+   BackendProfile p;
+   double per_elem_ns = std::max(0.0, (large.total_ns - small.total_ns) / (large.n - small.n));
+   p.startup_ns = std::max(0.0, small.total_ns - small.n * per_elem_ns);
+
+   // Senza un tempo di calcolo puro (CPU) tutto il costo per elemento è calcolo.
+   double compute_ns = (large.compute_ns > 0) ? large.compute_ns / large.n : per_elem_ns;
+   p.compute_ns_per_elem = std::min(compute_ns, per_elem_ns);
+   p.transfer_ns_per_byte =
+      (per_elem_ns - p.compute_ns_per_elem) / BackendProfile::BYTES_PER_ELEM;
+
+   std::cerr << "[Calibrator] Small task: n=" << small.n << ", " << small.total_ns / 1e3
+             << " us. Large task: n=" << large.n << ", " << large.total_ns / 1e6 << " ms.\n";
+   return p;
+}
+
+} // namespace
+
+BackendProfile calibrate_accelerator(IAccelerator *accelerator) {
+   auto run = [accelerator](int *a, int *b, int *c, size_t n, long long &compute_ns) {
+      Task task{};
+      task.a = a;
+      task.b = b;
+      task.c = c;
+      task.n = n;
+      task.buffer_idx = accelerator->acquire_buffer_set();
+      auto t0 = std::chrono::steady_clock::now();
+      accelerator->send_data_to_device(&task);
+      accelerator->execute_kernel(&task);
+
+      // I backend OpenCL misurano in get_results_from_device() anche il download di C, che va
+      // contato come trasferimento. Si attende quindi la fine del kernel (upload compreso): il
+      // tempo di get_results_from_device() è allora il solo download, e l'upload (A e B, il
+      // doppio dei byte) si stima con la stessa banda.
+      if (task.event) {
+         clWaitForEvents(1, &task.event);
+         auto t1 = std::chrono::steady_clock::now();
+         long long d2h_ns = 0;
+         accelerator->get_results_from_device(&task, d2h_ns);
+         double device_ns =
+            double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+         compute_ns = std::max(0LL, (long long)(device_ns - 2.0 * double(d2h_ns)));
+      } else {
+         accelerator->get_results_from_device(&task, compute_ns);
+      }
+      accelerator->release_buffer_set(task.buffer_idx);
+   };
+   return calibrate(run);
+}
+
+BackendProfile calibrate_cpu(CpuKernel kernel) {
+   ParallelFor pf;
+   auto run = [&pf, kernel](int *a, int *b, int *c, size_t n, long long &) {
+      run_cpu_kernel_parallel(pf, kernel, a, b, c, n);
+   };
+   return calibrate(run);
+}
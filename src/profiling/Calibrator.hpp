@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../accelerator/IAccelerator.hpp"
+#include "../cpu_runner/CpuKernels.hpp"
+#include "ProfileDB.hpp"
+
+/**
+ * @brief Funzioni di calibrazione usate dalla modalità 'auto' per riempire il ProfileDB.
+ *
+ * Ogni backend esegue lo stesso kernel con un task piccolo (dominato dai costi fissi) e uno grande
+ * (dominato dai costi per elemento). Dai due tempi si ricavano il costo fisso e il costo totale per
+ * elemento; il tempo di calcolo puro riportato dal device separa poi il calcolo dal trasferimento.
+ */
+
+/**
+ * @brief Misura un acceleratore già inizializzato, eseguendo i task direttamente tramite
+ * l'interfaccia IAccelerator (senza pipeline FastFlow).
+ */
+BackendProfile calibrate_accelerator(IAccelerator *accelerator);
+
+/**
+ * @brief Misura l'esecuzione di un task su tutti i core della CPU con il parallel_for di FastFlow,
+ * come fa il worker CPU della farm in modalità 'auto'.
+ */
+BackendProfile calibrate_cpu(CpuKernel kernel);
@@ -0,0 +1,143 @@
+#include "DevicePeaks.hpp"
+#include "../accelerator/DeviceDiscovery.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const size_t PEAK_BUFFER_BYTES = size_t(128) << 20; // Byte per buffer della sonda di banda
+const size_t PEAK_FMA_ITEMS = size_t(1) << 20;      // Work-item della sonda di calcolo
+const int PEAK_FMA_ITERS = 1024;                    // Iterazioni di ogni work-item
+const int PEAK_FMA_CHAINS = 8;                      // Catene di mad di peak_mad
+const int PEAK_REPEATS = 5;                         // Lanci misurati, si tiene il migliore
+
+const char *PEAK_SOURCE = R"CLC(
+__kernel void peak_add(__global const float4 *a, __global const float4 *b,
+                       __global float4 *c) {
+   const size_t i = get_global_id(0);
+   c[i] = a[i] + b[i];
+}
+
+__kernel void peak_mad(__global float *out, const float m, const float add, const int iters) {
+   const float seed = (float)(get_global_id(0) % 97) * 1e-3f;
+   float x0 = seed, x1 = seed + 1e-3f, x2 = seed + 2e-3f, x3 = seed + 3e-3f;
+   float x4 = seed + 4e-3f, x5 = seed + 5e-3f, x6 = seed + 6e-3f, x7 = seed + 7e-3f;
+   for (int i = 0; i < iters; ++i) {
+      x0 = mad(x0, m, add); x1 = mad(x1, m, add); x2 = mad(x2, m, add); x3 = mad(x3, m, add);
+      x4 = mad(x4, m, add); x5 = mad(x5, m, add); x6 = mad(x6, m, add); x7 = mad(x7, m, add);
+   }
+   out[get_global_id(0)] = x0 + x1 + x2 + x3 + x4 + x5 + x6 + x7;
+}
+)CLC";
+
+/**
+ * @brief Lancia kernel su global work-item 1 + PEAK_REPEATS volte e restituisce il tempo del
+ * lancio più veloce in nanosecondi (0 in caso di errore).
+ */
+double best_launch_ns(cl_command_queue queue, cl_kernel kernel, size_t global) {
+   double best_ns = 0;
+   for (int r = 0; r <= PEAK_REPEATS; ++r) {
+      auto t0 = std::chrono::steady_clock::now();
+      if (clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &global, NULL, 0, NULL, NULL) !=
+             CL_SUCCESS ||
+          clFinish(queue) != CL_SUCCESS)
+         return 0;
+      auto t1 = std::chrono::steady_clock::now();
+      double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+      if (r > 0 && (best_ns == 0 || ns < best_ns))
+         best_ns = ns;
+   }
+   return best_ns;
+}
+
+} // namespace
+
+RooflinePeaks measure_opencl_peaks(cl_device_id device) {
+   RooflinePeaks peaks;
+   if (!device) {
+      std::vector<cl_device_id> gpus = discover_devices(CL_DEVICE_TYPE_GPU);
+      if (gpus.empty()) {
+         std::cerr << "[WARNING] Roofline: no OpenCL GPU found, device peaks not measured.\n";
+         return peaks;
+      }
+      device = gpus[0];
+   }
+   peaks.source = "OpenCL probes on " + get_device_name(device);
+
+   cl_int ret;
+   cl_context context = clCreateContext(NULL, 1, &device, NULL, NULL, &ret);
+   if (!context || ret != CL_SUCCESS) {
+      std::cerr << "[WARNING] Roofline: failed to create OpenCL context, peaks not measured.\n";
+      return peaks;
+   }
+   cl_command_queue queue = clCreateCommandQueue(context, device, 0, &ret);
+   cl_program program = clCreateProgramWithSource(context, 1, &PEAK_SOURCE, NULL, &ret);
+   if (!queue || !program || clBuildProgram(program, 1, &device, NULL, NULL, NULL) != CL_SUCCESS) {
+      std::cerr << "[WARNING] Roofline: failed to build the OpenCL probes, peaks not measured.\n";
+      if (program)
+         clReleaseProgram(program);
+      if (queue)
+         clReleaseCommandQueue(queue);
+      clReleaseContext(context);
+      return peaks;
+   }
+
+   // Banda: tre buffer di float4, inizializzati dal device (nessun trasferimento dall'host).
+   cl_ulong max_alloc = 0;
+   clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(max_alloc), &max_alloc, NULL);
+   const size_t buffer_bytes =
+      std::min<size_t>(PEAK_BUFFER_BYTES, static_cast<size_t>(max_alloc)) / 16 * 16;
+   cl_mem mem[3] = {};
+   bool mem_ok = buffer_bytes > 0;
+   for (cl_mem &m : mem) {
+      m = mem_ok ? clCreateBuffer(context, CL_MEM_READ_WRITE, buffer_bytes, NULL, &ret) : NULL;
+      mem_ok = mem_ok && m && ret == CL_SUCCESS;
+   }
+   const float zero = 0.0f;
+   for (cl_mem m : mem)
+      if (mem_ok)
+         mem_ok = clEnqueueFillBuffer(queue, m, &zero, sizeof(zero), 0, buffer_bytes, 0, NULL,
+                                      NULL) == CL_SUCCESS;
+
+   cl_kernel add = clCreateKernel(program, "peak_add", &ret);
+   if (mem_ok && add && ret == CL_SUCCESS) {
+      for (cl_uint i = 0; i < 3; ++i)
+         clSetKernelArg(add, i, sizeof(cl_mem), &mem[i]);
+      double ns = best_launch_ns(queue, add, buffer_bytes / 16);
+      if (ns > 0)
+         peaks.bandwidth_gbs = 3.0 * double(buffer_bytes) / ns;
+   }
+
+   // Calcolo: PEAK_FMA_CHAINS mad per iterazione, un float scritto per work-item.
+   cl_mem out = clCreateBuffer(context, CL_MEM_WRITE_ONLY, PEAK_FMA_ITEMS * sizeof(float), NULL,
+                               &ret);
+   cl_kernel mad = clCreateKernel(program, "peak_mad", &ret);
+   if (out && mad && ret == CL_SUCCESS) {
+      const float m = 0.9999999f, addend = 1e-7f;
+      const int iters = PEAK_FMA_ITERS;
+      clSetKernelArg(mad, 0, sizeof(cl_mem), &out);
+      clSetKernelArg(mad, 1, sizeof(float), &m);
+      clSetKernelArg(mad, 2, sizeof(float), &addend);
+      clSetKernelArg(mad, 3, sizeof(int), &iters);
+      double ns = best_launch_ns(queue, mad, PEAK_FMA_ITEMS);
+      if (ns > 0)
+         peaks.compute_gops =
+            2.0 * PEAK_FMA_CHAINS * double(PEAK_FMA_ITERS) * double(PEAK_FMA_ITEMS) / ns;
+   }
+
+   if (mad)
+      clReleaseKernel(mad);
+   if (add)
+      clReleaseKernel(add);
+   if (out)
+      clReleaseMemObject(out);
+   for (cl_mem m : mem)
+      if (m)
+         clReleaseMemObject(m);
+   clReleaseProgram(program);
+   clReleaseCommandQueue(queue);
+   clReleaseContext(context);
+   return peaks;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../common/PerformanceData.hpp"
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+/**
+ * @brief Sonde dei picchi di un device OpenCL per il modello roofline, compilate da un programma
+ * interno (non dai kernel dei task):
+ * - banda: c = a + b su float4, con buffer di 128 MB (o della dimensione massima di un buffer
+ *   del device, se minore), 12 byte per elemento come lo STREAM della CPU;
+ * - calcolo: 8 catene indipendenti di mad() per work-item, 2 operazioni ciascuna.
+ *
+ * Ogni sonda viene lanciata una volta per scaldare il device e poi 5 volte: vale il
+ * lancio più veloce. Se device è nullptr viene usata la prima GPU trovata, come fa initialize()
+ * di Gpu_OpenCL_Accelerator. In caso di errore i picchi restano a 0.
+ */
+RooflinePeaks measure_opencl_peaks(cl_device_id device);
@@ -0,0 +1,347 @@
+#include "MicroBench.hpp"
+#include "../accelerator/DeviceDiscovery.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const size_t MIN_BYTES = 4096; // Primo trasferimento misurato
+const size_t SIZE_STEP = 4;    // Rapporto fra due dimensioni consecutive
+
+// Tipi di memoria host dei trasferimenti.
+enum HostMemory { Pageable, Pinned, Mapped, NUM_HOST_MEMORY };
+const char *HOST_MEMORY_NAMES[NUM_HOST_MEMORY] = {"pageable", "pinned", "mapped"};
+
+// Banda (GB/s, mediana) dei trasferimenti di una dimensione, 0 = non misurata.
+struct TransferRow {
+   size_t bytes{0};
+   double h2d_gbs[NUM_HOST_MEMORY]{};
+   double d2h_gbs[NUM_HOST_MEMORY]{};
+};
+
+// Mediana e minimo dei campioni di una latenza, in microsecondi.
+struct Latency {
+   const char *name;
+   const char *description;
+   double median_us{0};
+   double min_us{0};
+};
+
+double elapsed_ns(std::chrono::steady_clock::time_point t0) {
+   return double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - t0)
+                    .count());
+}
+
+double median(std::vector<double> samples) {
+   if (samples.empty())
+      return 0;
+   std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+   return samples[samples.size() / 2];
+}
+
+Latency summarize(const char *name, const char *description, const std::vector<double> &ns) {
+   Latency l{name, description};
+   if (ns.empty())
+      return l;
+   l.median_us = median(ns) / 1e3;
+   l.min_us = *std::min_element(ns.begin(), ns.end()) / 1e3;
+   return l;
+}
+
+/**
+ * @brief Esegue transfer() 1 + repetitions volte e restituisce la banda mediana in GB/s (0 se
+ * transfer() fallisce). transfer() deve essere bloccante.
+ */
+template <typename TransferFn>
+double transfer_gbs(size_t bytes, size_t repetitions, TransferFn &&transfer) {
+   if (!transfer())
+      return 0;
+   std::vector<double> ns;
+   for (size_t r = 0; r < repetitions; ++r) {
+      auto t0 = std::chrono::steady_clock::now();
+      if (!transfer())
+         return 0;
+      ns.push_back(elapsed_ns(t0));
+   }
+   double m = median(ns);
+   return m > 0 ? double(bytes) / m : 0;
+}
+
+/**
+ * @brief Misura H2D e D2H di bytes byte con la memoria host memory. Gli oggetti OpenCL vengono
+ * creati e rilasciati qui, così a ogni dimensione è allocato un solo buffer del device.
+ */
+void measure_transfer(cl_context context, cl_command_queue queue, size_t bytes,
+                      size_t repetitions, HostMemory memory, double &h2d_gbs, double &d2h_gbs) {
+   h2d_gbs = d2h_gbs = 0;
+   cl_int ret;
+   const cl_mem_flags flags =
+      CL_MEM_READ_WRITE | (memory == Mapped ? CL_MEM_ALLOC_HOST_PTR : cl_mem_flags(0));
+   cl_mem device_buffer = clCreateBuffer(context, flags, bytes, NULL, &ret);
+   if (!device_buffer || ret != CL_SUCCESS)
+      return;
+
+   std::vector<char> pageable(bytes, 1);
+   cl_mem pinned = NULL;
+   void *host = pageable.data();
+   if (memory == Pinned) {
+      pinned = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bytes, NULL,
+                              &ret);
+      host = pinned ? clEnqueueMapBuffer(queue, pinned, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0,
+                                         bytes, 0, NULL, NULL, &ret)
+                    : NULL;
+      if (!host || ret != CL_SUCCESS) {
+         if (pinned)
+            clReleaseMemObject(pinned);
+         clReleaseMemObject(device_buffer);
+         return;
+      }
+      std::memset(host, 1, bytes);
+   }
+
+   if (memory == Mapped) {
+      // Il buffer è in memoria host: ogni trasferimento è una mappatura e una copia.
+      auto copy = [&](cl_map_flags map_flags, bool to_device) {
+         void *ptr = clEnqueueMapBuffer(queue, device_buffer, CL_TRUE, map_flags, 0, bytes, 0,
+                                        NULL, NULL, &ret);
+         if (!ptr || ret != CL_SUCCESS)
+            return false;
+         if (to_device)
+            std::memcpy(ptr, pageable.data(), bytes);
+         else
+            std::memcpy(pageable.data(), ptr, bytes);
+         return clEnqueueUnmapMemObject(queue, device_buffer, ptr, 0, NULL, NULL) ==
+                   CL_SUCCESS &&
+                clFinish(queue) == CL_SUCCESS;
+      };
+      h2d_gbs = transfer_gbs(bytes, repetitions,
+                             [&] { return copy(CL_MAP_WRITE_INVALIDATE_REGION, true); });
+      d2h_gbs = transfer_gbs(bytes, repetitions, [&] { return copy(CL_MAP_READ, false); });
+   } else {
+      h2d_gbs = transfer_gbs(bytes, repetitions, [&] {
+         return clEnqueueWriteBuffer(queue, device_buffer, CL_TRUE, 0, bytes, host, 0, NULL,
+                                     NULL) == CL_SUCCESS;
+      });
+      d2h_gbs = transfer_gbs(bytes, repetitions, [&] {
+         return clEnqueueReadBuffer(queue, device_buffer, CL_TRUE, 0, bytes, host, 0, NULL,
+                                    NULL) == CL_SUCCESS;
+      });
+   }
+
+   if (pinned) {
+      clEnqueueUnmapMemObject(queue, pinned, host, 0, NULL, NULL);
+      clFinish(queue);
+      clReleaseMemObject(pinned);
+   }
+   clReleaseMemObject(device_buffer);
+}
+
+const char *EMPTY_SOURCE = "__kernel void empty_kernel() {}\n";
+
+/**
+ * @brief Misura le latenze dei lanci e delle sincronizzazioni con il kernel vuoto (un
+ * work-item). queue ha la profilazione abilitata per i tempi del device.
+ */
+std::vector<Latency> measure_latencies(cl_command_queue queue, cl_kernel kernel) {
+   const size_t samples = MICROBENCH_LATENCY_SAMPLES;
+   const size_t global = 1;
+   auto launch = [&](cl_event *event) {
+      return clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &global, NULL, 0, NULL, event) ==
+             CL_SUCCESS;
+   };
+   std::vector<Latency> latencies;
+
+   // Riscaldamento: il primo lancio può includere la compilazione finale del kernel.
+   if (!launch(NULL) || clFinish(queue) != CL_SUCCESS)
+      return latencies;
+
+   std::vector<double> finish_ns, wait_ns, enqueue_ns, idle_ns, queued_ns, run_ns;
+   for (size_t s = 0; s < samples; ++s) {
+      auto t0 = std::chrono::steady_clock::now();
+      launch(NULL);
+      clFinish(queue);
+      finish_ns.push_back(elapsed_ns(t0));
+
+      cl_event event = NULL;
+      t0 = std::chrono::steady_clock::now();
+      if (!launch(&event))
+         continue;
+      clFlush(queue);
+      clWaitForEvents(1, &event);
+      wait_ns.push_back(elapsed_ns(t0));
+
+      cl_ulong queued = 0, start = 0, end = 0;
+      if (clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_QUEUED, sizeof(queued), &queued,
+                                  NULL) == CL_SUCCESS &&
+          clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), &start,
+                                  NULL) == CL_SUCCESS &&
+          clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), &end, NULL) ==
+             CL_SUCCESS &&
+          start >= queued && end >= start) {
+         queued_ns.push_back(double(start - queued));
+         run_ns.push_back(double(end - start));
+      }
+      clReleaseEvent(event);
+
+      t0 = std::chrono::steady_clock::now();
+      clFinish(queue);
+      idle_ns.push_back(elapsed_ns(t0));
+   }
+
+   // Lanci consecutivi senza sincronizzazione: costo dell'accodamento e costo ammortizzato.
+   auto batch_t0 = std::chrono::steady_clock::now();
+   for (size_t s = 0; s < samples; ++s) {
+      auto t0 = std::chrono::steady_clock::now();
+      launch(NULL);
+      enqueue_ns.push_back(elapsed_ns(t0));
+   }
+   clFinish(queue);
+   std::vector<double> amortized_ns = {elapsed_ns(batch_t0) / double(samples)};
+
+   latencies.push_back(summarize("launch_finish", "empty kernel + clFinish", finish_ns));
+   latencies.push_back(summarize("launch_event_wait", "empty kernel + clWaitForEvents", wait_ns));
+   latencies.push_back(summarize("enqueue", "clEnqueueNDRangeKernel call only", enqueue_ns));
+   latencies.push_back(
+      summarize("launch_amortized", "back-to-back launches, per launch", amortized_ns));
+   latencies.push_back(summarize("finish_idle", "clFinish on an empty queue", idle_ns));
+   latencies.push_back(summarize("device_queued_to_start", "device: queued -> start", queued_ns));
+   latencies.push_back(summarize("device_start_to_end", "device: start -> end", run_ns));
+   return latencies;
+}
+
+// Latenza con quel nome (0 se non misurata).
+double latency_us(const std::vector<Latency> &latencies, const std::string &name) {
+   for (const Latency &l : latencies)
+      if (name == l.name)
+         return l.median_us;
+   return 0;
+}
+
+std::string json_escape(const std::string &s) {
+   std::string out;
+   for (char ch : s) {
+      if (ch == '"' || ch == '\\')
+         out += '\\';
+      if (static_cast<unsigned char>(ch) >= 0x20)
+         out += ch;
+   }
+   return out;
+}
+
+} // namespace
+
+void runMicroBenchmark(cl_device_id device, size_t task_n, size_t repetitions, size_t max_bytes,
+                       const std::string &json_path) {
+   const std::string device_name = get_device_name(device);
+   std::cout << "[Microbench] Device: " << device_name << ", " << repetitions
+             << " repetitions per transfer, " << MICROBENCH_LATENCY_SAMPLES
+             << " samples per latency.\n\n";
+
+   cl_int ret;
+   cl_context context = clCreateContext(NULL, 1, &device, NULL, NULL, &ret);
+   if (!context || ret != CL_SUCCESS) {
+      std::cerr << "[FATAL] Microbench: Failed to create OpenCL context.\n";
+      exit(EXIT_FAILURE);
+   }
+   cl_command_queue queue = clCreateCommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE, &ret);
+   cl_program program = clCreateProgramWithSource(context, 1, &EMPTY_SOURCE, NULL, &ret);
+   cl_kernel kernel = NULL;
+   if (queue && program && clBuildProgram(program, 1, &device, NULL, NULL, NULL) == CL_SUCCESS)
+      kernel = clCreateKernel(program, "empty_kernel", &ret);
+   if (!kernel || ret != CL_SUCCESS) {
+      std::cerr << "[FATAL] Microbench: Failed to create the command queue or the empty kernel.\n";
+      exit(EXIT_FAILURE);
+   }
+
+   // --- Trasferimenti ---
+   cl_ulong max_alloc = 0;
+   clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(max_alloc), &max_alloc, NULL);
+   const size_t limit = std::min(max_bytes, static_cast<size_t>(max_alloc));
+
+   std::vector<TransferRow> rows;
+   for (size_t bytes = MIN_BYTES; bytes <= limit; bytes *= SIZE_STEP) {
+      TransferRow row;
+      row.bytes = bytes;
+      for (int m = 0; m < NUM_HOST_MEMORY; ++m)
+         measure_transfer(context, queue, bytes, repetitions, HostMemory(m), row.h2d_gbs[m],
+                          row.d2h_gbs[m]);
+      rows.push_back(row);
+   }
+
+   std::cout << "Transfer bandwidth (GB/s, median)\n" << std::setw(12) << "Size";
+   for (const char *dir : {"H2D", "D2H"})
+      for (const char *memory : HOST_MEMORY_NAMES)
+         std::cout << " | " << std::setw(12) << (std::string(dir) + " " + memory);
+   std::cout << "\n" << std::fixed << std::setprecision(2);
+   for (const TransferRow &row : rows) {
+      std::cout << std::setw(9) << double(row.bytes) / 1024 << " KB";
+      for (const double *gbs : {row.h2d_gbs, row.d2h_gbs})
+         for (int m = 0; m < NUM_HOST_MEMORY; ++m)
+            std::cout << " | " << std::setw(12) << gbs[m];
+      std::cout << "\n";
+   }
+
+   // --- Latenze ---
+   std::vector<Latency> latencies = measure_latencies(queue, kernel);
+   std::cout << "\nLatency (us)\n"
+             << std::setw(34) << std::left << "Primitive" << std::right << " | " << std::setw(10)
+             << "median" << " | " << std::setw(10) << "min" << "\n";
+   for (const Latency &l : latencies)
+      std::cout << std::setw(34) << std::left << l.description << std::right << " | "
+                << std::setw(10) << l.median_us << " | " << std::setw(10) << l.min_us << "\n";
+
+   // --- Costo di gestione di un task vecAdd come nella pipeline ---
+   const size_t task_bytes = task_n * sizeof(int);
+   double up_gbs = 0, down_gbs = 0;
+   if (task_bytes > 0 && task_bytes <= static_cast<size_t>(max_alloc))
+      measure_transfer(context, queue, task_bytes, repetitions, Pageable, up_gbs, down_gbs);
+   const double upload_ms = up_gbs > 0 ? 2.0 * double(task_bytes) / up_gbs / 1e6 : 0;
+   const double download_ms = down_gbs > 0 ? double(task_bytes) / down_gbs / 1e6 : 0;
+   const double launch_ms = latency_us(latencies, "launch_event_wait") / 1e3;
+   const double total_ms = upload_ms + launch_ms + download_ms;
+   std::cout << "\nEstimated overhead of a vecAdd task (N=" << task_n
+             << ", pageable host memory as in the pipeline)\n"
+             << "  2 x upload: " << upload_ms << " ms, launch + event wait: " << launch_ms
+             << " ms, download: " << download_ms << " ms, total: " << total_ms << " ms\n"
+             << "   (Da confrontare con \"Avg Overhead Time\" di gpu_opencl con vecAdd.cl)\n";
+   std::cout.unsetf(std::ios::fixed);
+   std::cout << std::setprecision(6);
+
+   // --- JSON ---
+   std::ofstream json(json_path);
+   if (!json) {
+      std::cerr << "[WARNING] Microbench: Could not write " << json_path << ".\n";
+   } else {
+      json << "{\n  \"device\": \"" << json_escape(device_name) << "\",\n"
+           << "  \"repetitions\": " << repetitions << ",\n"
+           << "  \"latency_samples\": " << MICROBENCH_LATENCY_SAMPLES << ",\n"
+           << "  \"transfers_gbs\": [\n";
+      for (size_t r = 0; r < rows.size(); ++r) {
+         json << "    {\"bytes\": " << rows[r].bytes;
+         for (int m = 0; m < NUM_HOST_MEMORY; ++m)
+            json << ", \"h2d_" << HOST_MEMORY_NAMES[m] << "\": " << rows[r].h2d_gbs[m]
+                 << ", \"d2h_" << HOST_MEMORY_NAMES[m] << "\": " << rows[r].d2h_gbs[m];
+         json << "}" << (r + 1 < rows.size() ? "," : "") << "\n";
+      }
+      json << "  ],\n  \"latency_us\": {\n";
+      for (size_t i = 0; i < latencies.size(); ++i)
+         json << "    \"" << latencies[i].name << "\": {\"median\": " << latencies[i].median_us
+              << ", \"min\": " << latencies[i].min_us << "}"
+              << (i + 1 < latencies.size() ? "," : "") << "\n";
+      json << "  },\n  \"task_overhead_ms\": {\"n\": " << task_n << ", \"upload\": " << upload_ms
+           << ", \"launch\": " << launch_ms << ", \"download\": " << download_ms
+           << ", \"total\": " << total_ms << "}\n}\n";
+      std::cout << "\n[Microbench] Results written to " << json_path << "\n";
+   }
+
+   clReleaseKernel(kernel);
+   clReleaseProgram(program);
+   clReleaseCommandQueue(queue);
+   clReleaseContext(context);
+}
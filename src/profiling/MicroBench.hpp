@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+/**
+ * @brief Modalità 'microbench': misura sul device OpenCL i costi primitivi su cui è costruita la
+ * pipeline, senza FastFlow e senza i kernel dei task.
+ *
+ * - Banda dei trasferimenti host -> device (H2D) e device -> host (D2H) da 4 KB a max_bytes (al
+ *   più la dimensione massima di un buffer del device), con passo 4x, per tre tipi di memoria
+ *   host:
+ *   - pageable: memoria dell'host qualsiasi, letta e scritta con clEnqueueWrite/ReadBuffer;
+ *   - pinned: memoria allocata dal runtime (CL_MEM_ALLOC_HOST_PTR) e mappata una volta, usata
+ *     come sorgente o destinazione di clEnqueueWrite/ReadBuffer;
+ *   - mapped: il buffer stesso è in memoria host (CL_MEM_ALLOC_HOST_PTR), mappato e copiato con
+ *     memcpy a ogni trasferimento.
+ * - Latenze: lancio di un kernel vuoto seguito da clFinish, lancio seguito da clWaitForEvents,
+ *   costo della sola chiamata di accodamento, lanci consecutivi ammortizzati, clFinish su una coda
+ *   vuota e i tempi del device (accodamento -> inizio, inizio -> fine) dai profili degli eventi.
+ *
+ * Ogni trasferimento viene misurato repetitions volte dopo uno di riscaldamento (vale la mediana),
+ * ogni latenza su MICROBENCH_LATENCY_SAMPLES campioni. Infine stima il costo di gestione di un
+ * task vecAdd di task_n elementi come nella pipeline (due upload e un download da memoria
+ * pageable, lancio e attesa dell'evento), da confrontare con "Avg Overhead Time". I risultati
+ * vengono stampati in tabelle e salvati in JSON in json_path.
+ */
+constexpr size_t MICROBENCH_LATENCY_SAMPLES = 1000;
+
+void runMicroBenchmark(cl_device_id device, size_t task_n, size_t repetitions, size_t max_bytes,
+                       const std::string &json_path);
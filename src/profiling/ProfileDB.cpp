@@ -0,0 +1,60 @@
+#include "ProfileDB.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+ProfileDB::ProfileDB(const std::string &path) : path_(path) {}
+
+bool ProfileDB::load() {
+   std::ifstream in(path_);
+   if (!in)
+      return false;
+
+   std::string line;
+   while (std::getline(in, line)) {
+      if (line.empty() || line[0] == '#')
+         continue;
+
+      std::istringstream fields(line);
+      std::string backend, kernel;
+      BackendProfile p;
+      if (!(fields >> backend >> kernel >> p.startup_ns >> p.transfer_ns_per_byte >>
+            p.compute_ns_per_elem)) {
+         std::cerr << "[WARNING] ProfileDB: Ignoring malformed line '" << line << "' in "
+                   << path_ << ".\n";
+         continue;
+      }
+      entries_[key(backend, kernel)] = p;
+   }
+   return true;
+}
+
+bool ProfileDB::save() const {
+   std::ofstream out(path_);
+   if (!out) {
+      std::cerr << "[ERROR] ProfileDB: Cannot write " << path_ << ".\n";
+      return false;
+   }
+
+   out << "# backend kernel startup_ns transfer_ns_per_byte compute_ns_per_elem\n";
+   for (const auto &entry : entries_) {
+      const BackendProfile &p = entry.second;
+      out << entry.first << ' ' << p.startup_ns << ' ' << p.transfer_ns_per_byte << ' '
+          << p.compute_ns_per_elem << '\n';
+   }
+   return true;
+}
+
+bool ProfileDB::find(const std::string &backend, const std::string &kernel,
+                     BackendProfile &out) const {
+   auto it = entries_.find(key(backend, kernel));
+   if (it == entries_.end())
+      return false;
+   out = it->second;
+   return true;
+}
+
+void ProfileDB::store(const std::string &backend, const std::string &kernel,
+                      const BackendProfile &p) {
+   entries_[key(backend, kernel)] = p;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+/**
+ * @brief Modello di costo lineare di un backend (CPU o acceleratore) per un kernel.
+ *
+ * Il tempo previsto per un task di n elementi è:
+ *    startup + (byte trasferiti) * costo per byte + n * costo di calcolo per elemento
+ * dove i byte trasferiti sono i 2 vettori di input e quello di output.
+ */
+struct BackendProfile {
+   double startup_ns = 0;           // Costo fisso per task (lancio, sincronizzazione, code)
+   double transfer_ns_per_byte = 0; // Inverso della banda host <-> device (0 per la CPU)
+   double compute_ns_per_elem = 0;  // Costo di calcolo per elemento
+
+   // Byte trasferiti per elemento: a[i], b[i] verso il device e c[i] verso l'host.
+   static constexpr size_t BYTES_PER_ELEM = 3 * sizeof(int);
+
+   double predict_ns(size_t n) const {
+      return startup_ns + double(n) * (BYTES_PER_ELEM * transfer_ns_per_byte + compute_ns_per_elem);
+   }
+
+   // Banda di trasferimento stimata in GB/s (0 se non ci sono trasferimenti).
+   double bandwidth_gbs() const {
+      return transfer_ns_per_byte > 0 ? 1.0 / transfer_ns_per_byte : 0.0;
+   }
+};
+
+/**
+ * @brief Database persistente dei profili misurati dalla calibrazione, uno per coppia
+ * (backend, kernel).
+ *
+ * È salvato come file di testo con una riga per profilo:
+ *    backend kernel startup_ns transfer_ns_per_byte compute_ns_per_elem
+ */
+class ProfileDB {
+ public:
+   explicit ProfileDB(const std::string &path);
+
+   // Legge il file. Ritorna false se il file non esiste o non è leggibile.
+   bool load();
+
+   // Riscrive il file con tutti i profili.
+   bool save() const;
+
+   // Cerca il profilo di un backend per un kernel.
+   bool find(const std::string &backend, const std::string &kernel, BackendProfile &out) const;
+
+   // Inserisce o sostituisce il profilo di un backend per un kernel.
+   void store(const std::string &backend, const std::string &kernel, const BackendProfile &p);
+
+   const std::string &path() const { return path_; }
+
+ private:
+   static std::string key(const std::string &backend, const std::string &kernel) {
+      return backend + " " + kernel;
+   }
+
+   std::string path_;
+   std::map<std::string, BackendProfile> entries_;
+};
@@ -0,0 +1,68 @@
+#include "TuningCache.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+TuningCache::TuningCache(const std::string &path) : path_(path) {}
+
+std::string TuningCache::key(const std::string &device, const std::string &kernel) {
+   std::string name = device;
+   std::replace(name.begin(), name.end(), ' ', '_');
+   return name + " " + kernel;
+}
+
+bool TuningCache::load() {
+   std::ifstream in(path_);
+   if (!in)
+      return false;
+
+   std::string line;
+   while (std::getline(in, line)) {
+      if (line.empty() || line[0] == '#')
+         continue;
+
+      std::istringstream fields(line);
+      std::string device, kernel;
+      KernelConfig cfg;
+      if (!(fields >> device >> kernel >> cfg.variant >> cfg.vector_width >>
+            cfg.vectors_per_item >> cfg.local_size >> cfg.ns) ||
+          cfg.vector_width == 0 || cfg.vectors_per_item == 0) {
+         std::cerr << "[WARNING] TuningCache: Ignoring malformed line '" << line << "' in "
+                   << path_ << ".\n";
+         continue;
+      }
+      entries_[device + " " + kernel] = cfg;
+   }
+   return true;
+}
+
+bool TuningCache::save() const {
+   std::ofstream out(path_);
+   if (!out) {
+      std::cerr << "[ERROR] TuningCache: Cannot write " << path_ << ".\n";
+      return false;
+   }
+
+   out << "# device kernel variant vector_width vectors_per_item local_size ns\n";
+   for (const auto &entry : entries_) {
+      const KernelConfig &cfg = entry.second;
+      out << entry.first << ' ' << cfg.variant << ' ' << cfg.vector_width << ' '
+          << cfg.vectors_per_item << ' ' << cfg.local_size << ' ' << cfg.ns << '\n';
+   }
+   return true;
+}
+
+bool TuningCache::find(const std::string &device, const std::string &kernel,
+                       KernelConfig &out) const {
+   auto it = entries_.find(key(device, kernel));
+   if (it == entries_.end())
+      return false;
+   out = it->second;
+   return true;
+}
+
+void TuningCache::store(const std::string &device, const std::string &kernel,
+                        const KernelConfig &cfg) {
+   entries_[key(device, kernel)] = cfg;
+}
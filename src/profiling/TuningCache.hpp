@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+/**
+ * @brief Configurazione di lancio di un kernel OpenCL scelta dall'autotuner.
+ *
+ * Il kernel 'variant' elabora vettori da vector_width int, vectors_per_item per work-item: la
+ * dimensione globale di un lancio su n elementi è ceil(ceil(n / vector_width) / vectors_per_item),
+ * arrotondata a un multiplo di local_size. Il kernel base ha vector_width = vectors_per_item = 1.
+ */
+struct KernelConfig {
+   std::string variant;         // Nome del kernel da lanciare (es. "vecAdd_v4")
+   size_t vector_width = 1;     // int per vettore
+   size_t vectors_per_item = 1; // Vettori elaborati da ogni work-item
+   size_t local_size = 0;       // Dimensione del work-group (0 = scelta dal runtime)
+   double ns = 0;               // Tempo misurato di un lancio sulla dimensione di tuning
+
+   size_t global_size(size_t n) const {
+      size_t vectors = (n + vector_width - 1) / vector_width;
+      size_t items = (vectors + vectors_per_item - 1) / vectors_per_item;
+      if (items == 0)
+         items = 1;
+      if (local_size > 0)
+         items = (items + local_size - 1) / local_size * local_size;
+      return items;
+   }
+};
+
+/**
+ * @brief Cache persistente delle configurazioni scelte dall'autotuner, una per coppia
+ * (device, kernel), così le esecuzioni successive saltano la ricerca.
+ *
+ * È salvata come file di testo con una riga per configurazione (gli spazi nel nome del device
+ * diventano '_'):
+ *    device kernel variant vector_width vectors_per_item local_size ns
+ */
+class TuningCache {
+ public:
+   explicit TuningCache(const std::string &path);
+
+   // Legge il file. Ritorna false se il file non esiste o non è leggibile.
+   bool load();
+
+   // Riscrive il file con tutte le configurazioni.
+   bool save() const;
+
+   // Cerca la configurazione di un kernel su un device.
+   bool find(const std::string &device, const std::string &kernel, KernelConfig &out) const;
+
+   // Inserisce o sostituisce la configurazione di un kernel su un device.
+   void store(const std::string &device, const std::string &kernel, const KernelConfig &cfg);
+
+   const std::string &path() const { return path_; }
+
+ private:
+   static std::string key(const std::string &device, const std::string &kernel);
+
+   std::string path_;
+   std::map<std::string, KernelConfig> entries_;
+};